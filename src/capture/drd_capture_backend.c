@@ -0,0 +1,144 @@
+#include "capture/drd_capture_backend.h"
+
+#include <gio/gio.h>
+
+G_DEFINE_INTERFACE(DrdCaptureBackend, drd_capture_backend, G_TYPE_OBJECT)
+
+/*
+ * 功能：初始化捕获后端接口默认实现。
+ * 逻辑：接口方法全部由实现类提供，无默认实现。
+ * 参数：iface 接口结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_capture_backend_default_init(DrdCaptureBackendInterface *iface)
+{
+    (void) iface;
+}
+
+/*
+ * 功能：启动捕获后端。
+ * 逻辑：校验实例后分派到实现类的 start；未实现时返回 NOT_SUPPORTED。
+ * 参数：self 捕获后端；width/height 期望尺寸（0 表示使用显示尺寸）；n_frame_slots 每个输出同时存在的捕获帧上限；error 错误输出。
+ * 外部接口：DrdCaptureBackendInterface::start。
+ */
+gboolean
+drd_capture_backend_start(DrdCaptureBackend *self, guint width, guint height, guint n_frame_slots, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_BACKEND(self), FALSE);
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    if (iface->start == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Capture backend does not implement start");
+        return FALSE;
+    }
+    return iface->start(self, width, height, n_frame_slots, error);
+}
+
+/*
+ * 功能：停止捕获后端。
+ * 逻辑：校验实例后分派到实现类的 stop。
+ * 参数：self 捕获后端。
+ * 外部接口：DrdCaptureBackendInterface::stop。
+ */
+void
+drd_capture_backend_stop(DrdCaptureBackend *self)
+{
+    g_return_if_fail(DRD_IS_CAPTURE_BACKEND(self));
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    if (iface->stop != NULL)
+    {
+        iface->stop(self);
+    }
+}
+
+/*
+ * 功能：查询捕获后端是否运行。
+ * 逻辑：校验实例后分派到实现类的 is_running，未实现视为未运行。
+ * 参数：self 捕获后端。
+ * 外部接口：DrdCaptureBackendInterface::is_running。
+ */
+gboolean
+drd_capture_backend_is_running(DrdCaptureBackend *self)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_BACKEND(self), FALSE);
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    return iface->is_running != NULL && iface->is_running(self);
+}
+
+/*
+ * 功能：读取捕获后端对应显示的分辨率。
+ * 逻辑：校验参数后分派到实现类的 get_display_size；未实现时返回 NOT_SUPPORTED。
+ * 参数：self 捕获后端；out_width/out_height 输出尺寸；error 错误输出。
+ * 外部接口：DrdCaptureBackendInterface::get_display_size。
+ */
+gboolean
+drd_capture_backend_get_display_size(DrdCaptureBackend *self, guint *out_width, guint *out_height, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_BACKEND(self), FALSE);
+    g_return_val_if_fail(out_width != NULL, FALSE);
+    g_return_val_if_fail(out_height != NULL, FALSE);
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    if (iface->get_display_size == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                            "Capture backend does not implement get_display_size");
+        return FALSE;
+    }
+    return iface->get_display_size(self, out_width, out_height, error);
+}
+
+/*
+ * 功能：读取捕获后端的显示器布局。
+ * 逻辑：清空输出数组后分派到实现类的 get_monitors；未实现时按显示尺寸输出单个主显示器。
+ * 参数：self 捕获后端；out_monitors 输出 DrdMonitorInfo 数组；error 错误输出。
+ * 外部接口：DrdCaptureBackendInterface::get_monitors/get_display_size。
+ */
+gboolean
+drd_capture_backend_get_monitors(DrdCaptureBackend *self, GArray *out_monitors, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_BACKEND(self), FALSE);
+    g_return_val_if_fail(out_monitors != NULL, FALSE);
+
+    g_array_set_size(out_monitors, 0);
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    if (iface->get_monitors != NULL)
+    {
+        return iface->get_monitors(self, out_monitors, error);
+    }
+
+    DrdMonitorInfo monitor = {0, 0, 0, 0, TRUE};
+    if (!drd_capture_backend_get_display_size(self, &monitor.width, &monitor.height, error))
+    {
+        return FALSE;
+    }
+    g_array_append_val(out_monitors, monitor);
+    return TRUE;
+}
+
+/*
+ * 功能：读取捕获画面在根窗口中的原点。
+ * 逻辑：先置为 (0, 0)，实现类提供 get_origin 时分派过去；整屏捕获无需实现。
+ * 参数：self 捕获后端；out_x/out_y 输出原点。
+ * 外部接口：DrdCaptureBackendInterface::get_origin。
+ */
+void
+drd_capture_backend_get_origin(DrdCaptureBackend *self, gint *out_x, gint *out_y)
+{
+    g_return_if_fail(DRD_IS_CAPTURE_BACKEND(self));
+    g_return_if_fail(out_x != NULL && out_y != NULL);
+
+    *out_x = 0;
+    *out_y = 0;
+
+    DrdCaptureBackendInterface *iface = DRD_CAPTURE_BACKEND_GET_IFACE(self);
+    if (iface->get_origin != NULL)
+    {
+        iface->get_origin(self, out_x, out_y);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/* 捕获布局中的单个显示器，坐标相对桌面（根窗口）原点 */
+typedef struct
+{
+    gint x;
+    gint y;
+    guint width;
+    guint height;
+    gboolean primary;
+} DrdMonitorInfo;
+
+#define DRD_TYPE_CAPTURE_BACKEND (drd_capture_backend_get_type())
+G_DECLARE_INTERFACE(DrdCaptureBackend, drd_capture_backend, DRD, CAPTURE_BACKEND, GObject)
+
+/*
+ * 捕获后端接口：实现者在构造时绑定 DrdFrameQueue，start 之后由自身线程把帧推入该队列。
+ * start 的 n_frame_slots 为同时存在的捕获帧上限（每个输出），由调用方按下游实际持有的帧数计算，后端据此分配帧环或缓冲池。
+ */
+struct _DrdCaptureBackendInterface
+{
+    GTypeInterface parent_iface;
+
+    gboolean (*start)(DrdCaptureBackend *self, guint width, guint height, guint n_frame_slots, GError **error);
+    void (*stop)(DrdCaptureBackend *self);
+    gboolean (*is_running)(DrdCaptureBackend *self);
+    gboolean (*get_display_size)(DrdCaptureBackend *self, guint *out_width, guint *out_height, GError **error);
+    /* 可选：按捕获顺序输出显示器布局（DrdMonitorInfo），未实现时视为单个整屏显示器 */
+    gboolean (*get_monitors)(DrdCaptureBackend *self, GArray *out_monitors, GError **error);
+    /* 可选：捕获画面左上角在根窗口中的位置，随窗口移动变化；未实现时为 (0, 0) */
+    void (*get_origin)(DrdCaptureBackend *self, gint *out_x, gint *out_y);
+};
+
+gboolean drd_capture_backend_start(DrdCaptureBackend *self,
+                                   guint width,
+                                   guint height,
+                                   guint n_frame_slots,
+                                   GError **error);
+void drd_capture_backend_stop(DrdCaptureBackend *self);
+gboolean drd_capture_backend_is_running(DrdCaptureBackend *self);
+gboolean drd_capture_backend_get_display_size(DrdCaptureBackend *self,
+                                              guint *out_width,
+                                              guint *out_height,
+                                              GError **error);
+gboolean drd_capture_backend_get_monitors(DrdCaptureBackend *self, GArray *out_monitors, GError **error);
+void drd_capture_backend_get_origin(DrdCaptureBackend *self, gint *out_x, gint *out_y);
+
+G_END_DECLS
@@ -2,7 +2,10 @@
 
 #include <gio/gio.h>
 
+#include "capture/drd_capture_backend.h"
+#include "capture/drd_synthetic_capture.h"
 #include "capture/drd_x11_capture.h"
+#include "capture/drd_x11_window_capture.h"
 #include "utils/drd_log.h"
 
 struct _DrdCaptureManager
@@ -10,14 +13,15 @@ struct _DrdCaptureManager
     GObject parent_instance;
     gboolean running;
     DrdFrameQueue *queue;
-    DrdX11Capture *x11_capture;
+    DrdCaptureOptions options;
+    DrdCaptureBackend *backend;
 };
 
 G_DEFINE_TYPE(DrdCaptureManager, drd_capture_manager, G_TYPE_OBJECT)
 
 /*
  * 功能：释放捕获管理器持有的资源并处理运行中状态。
- * 逻辑：若仍在运行则先调用 stop；随后清理队列与 X11 捕获实例，最后交由父类 dispose。
+ * 逻辑：若仍在运行则先调用 stop；随后清理队列与捕获后端实例，最后交由父类 dispose。
  * 参数：object 基类指针，期望为 DrdCaptureManager 实例。
  * 外部接口：GLib 的 g_clear_object 负责引用计数释放，最终调用 GObjectClass::dispose。
  */
@@ -31,7 +35,7 @@ drd_capture_manager_dispose(GObject *object)
     }
 
     g_clear_object(&self->queue);
-    g_clear_object(&self->x11_capture);
+    g_clear_object(&self->backend);
 
     G_OBJECT_CLASS(drd_capture_manager_parent_class)->dispose(object);
 }
@@ -49,18 +53,47 @@ drd_capture_manager_class_init(DrdCaptureManagerClass *klass)
     object_class->dispose = drd_capture_manager_dispose;
 }
 
+/*
+ * 功能：按捕获选项创建对应的捕获后端。
+ * 逻辑：synthetic 创建合成负载源，window 创建绑定目标窗口的 XComposite 捕获，其余情况回退到 X11 捕获并设置是否按显示器分别捕获；后端均绑定管理器的帧队列。
+ * 参数：self 捕获管理器；options 捕获选项。
+ * 外部接口：drd_x11_capture_new/drd_x11_capture_set_per_monitor、drd_x11_window_capture_new、drd_synthetic_capture_new。
+ */
+static DrdCaptureBackend *
+drd_capture_manager_create_backend(DrdCaptureManager *self, const DrdCaptureOptions *options)
+{
+    switch (options->backend)
+    {
+        case DRD_CAPTURE_BACKEND_SYNTHETIC:
+            return DRD_CAPTURE_BACKEND(drd_synthetic_capture_new(self->queue, options->synthetic_workload));
+        case DRD_CAPTURE_BACKEND_WINDOW:
+            return DRD_CAPTURE_BACKEND(drd_x11_window_capture_new(self->queue, options->window_id));
+        case DRD_CAPTURE_BACKEND_X11:
+        default:
+        {
+            DrdX11Capture *capture = drd_x11_capture_new(self->queue);
+            drd_x11_capture_set_per_monitor(capture, options->per_monitor);
+            return DRD_CAPTURE_BACKEND(capture);
+        }
+    }
+}
+
 /*
  * 功能：初始化捕获管理器实例字段。
- * 逻辑：默认置 running 为 FALSE，创建帧队列并实例化 X11 捕获对象。
+ * 逻辑：默认置 running 为 FALSE，创建帧队列并按默认选项实例化 X11 捕获后端。
  * 参数：self 捕获管理器实例。
- * 外部接口：调用 drd_frame_queue_new、drd_x11_capture_new 创建内部组件。
+ * 外部接口：调用 drd_frame_queue_new 与 drd_capture_manager_create_backend 创建内部组件。
  */
 static void
 drd_capture_manager_init(DrdCaptureManager *self)
 {
     self->running = FALSE;
     self->queue = drd_frame_queue_new();
-    self->x11_capture = drd_x11_capture_new(self->queue);
+    self->options.backend = DRD_CAPTURE_DEFAULT_BACKEND;
+    self->options.synthetic_workload = DRD_CAPTURE_DEFAULT_SYNTHETIC_WORKLOAD;
+    self->options.per_monitor = DRD_CAPTURE_DEFAULT_PER_MONITOR;
+    self->options.window_id = DRD_CAPTURE_DEFAULT_WINDOW_ID;
+    self->backend = drd_capture_manager_create_backend(self, &self->options);
 }
 
 /*
@@ -76,13 +109,59 @@ drd_capture_manager_new(void)
 }
 
 /*
- * 功能：启动 X11 捕获线程并准备帧队列。
- * 逻辑：若已运行直接返回；重置队列后启动 X11 捕获，失败则停止队列并返回错误；成功时更新 running 标志。
- * 参数：self 管理器；width/height 期望分辨率；error 输出错误信息。
- * 外部接口：调用 drd_frame_queue_reset / drd_frame_queue_stop 控制队列，drd_x11_capture_start 启动捕获；日志通过 DRD_LOG_MESSAGE。
+ * 功能：切换捕获后端选项。
+ * 逻辑：运行中拒绝切换；选项与当前一致时保持原后端，否则按新选项重建后端。
+ * 参数：self 管理器；options 捕获选项。
+ * 外部接口：drd_capture_manager_create_backend；日志 DRD_LOG_WARNING/DRD_LOG_MESSAGE。
+ */
+void
+drd_capture_manager_set_options(DrdCaptureManager *self, const DrdCaptureOptions *options)
+{
+    g_return_if_fail(DRD_IS_CAPTURE_MANAGER(self));
+    g_return_if_fail(options != NULL);
+
+    if (self->running)
+    {
+        DRD_LOG_WARNING("Capture manager ignoring backend change while running");
+        return;
+    }
+
+    if (self->options.backend == options->backend &&
+        self->options.synthetic_workload == options->synthetic_workload &&
+        self->options.per_monitor == options->per_monitor &&
+        self->options.window_id == options->window_id)
+    {
+        return;
+    }
+
+    self->options = *options;
+    g_clear_object(&self->backend);
+    self->backend = drd_capture_manager_create_backend(self, &self->options);
+    if (self->options.backend == DRD_CAPTURE_BACKEND_SYNTHETIC)
+    {
+        DRD_LOG_MESSAGE("Capture manager using synthetic backend (workload=%s)",
+                        drd_synthetic_workload_to_string(self->options.synthetic_workload));
+    }
+    else if (self->options.backend == DRD_CAPTURE_BACKEND_WINDOW)
+    {
+        DRD_LOG_MESSAGE("Capture manager using window backend (window=0x%x)", self->options.window_id);
+    }
+    else
+    {
+        DRD_LOG_MESSAGE("Capture manager using %s backend (per_monitor=%s)",
+                        drd_capture_backend_kind_to_string(self->options.backend),
+                        self->options.per_monitor ? "true" : "false");
+    }
+}
+
+/*
+ * 功能：启动捕获后端线程并准备帧队列。
+ * 逻辑：若已运行直接返回；重置队列后启动捕获后端，失败则停止队列并返回错误；成功时更新 running 标志。
+ * 参数：self 管理器；width/height 期望分辨率；n_frame_slots 每个输出同时存在的捕获帧上限（由运行时按下游持有的帧数计算）；error 输出错误信息。
+ * 外部接口：调用 drd_frame_queue_reset / drd_frame_queue_stop 控制队列，drd_capture_backend_start 启动捕获；日志通过 DRD_LOG_MESSAGE。
  */
 gboolean
-drd_capture_manager_start(DrdCaptureManager *self, guint width, guint height, GError **error)
+drd_capture_manager_start(DrdCaptureManager *self, guint width, guint height, guint n_frame_slots, GError **error)
 {
     g_return_val_if_fail(DRD_IS_CAPTURE_MANAGER(self), FALSE);
 
@@ -95,7 +174,7 @@ drd_capture_manager_start(DrdCaptureManager *self, guint width, guint height, GE
 
     drd_frame_queue_reset(self->queue);
 
-    if (!drd_x11_capture_start(self->x11_capture, NULL, width, height, error))
+    if (!drd_capture_backend_start(self->backend, width, height, n_frame_slots, error))
     {
         drd_frame_queue_stop(self->queue);
         return FALSE;
@@ -108,9 +187,9 @@ drd_capture_manager_start(DrdCaptureManager *self, guint width, guint height, GE
 
 /*
  * 功能：停止捕获线程并清理队列。
- * 逻辑：若未运行直接返回；先停止 X11 捕获与队列，再输出丢帧统计并清除 running 标志。
+ * 逻辑：若未运行直接返回；先停止捕获后端与队列，再输出丢帧统计并清除 running 标志。
  * 参数：self 管理器实例。
- * 外部接口：调用 drd_x11_capture_stop、drd_frame_queue_stop、drd_frame_queue_get_dropped_frames，日志使用 DRD_LOG_WARNING/DRD_LOG_MESSAGE。
+ * 外部接口：调用 drd_capture_backend_stop、drd_frame_queue_stop、drd_frame_queue_get_dropped_frames，日志使用 DRD_LOG_WARNING/DRD_LOG_MESSAGE。
  */
 void
 drd_capture_manager_stop(DrdCaptureManager *self)
@@ -122,7 +201,7 @@ drd_capture_manager_stop(DrdCaptureManager *self)
         return;
     }
 
-    drd_x11_capture_stop(self->x11_capture);
+    drd_capture_backend_stop(self->backend);
     drd_frame_queue_stop(self->queue);
 
     const guint64 dropped = drd_frame_queue_get_dropped_frames(self->queue);
@@ -151,9 +230,9 @@ drd_capture_manager_is_running(DrdCaptureManager *self)
 
 /*
  * 功能：获取当前显示的实际分辨率。
- * 逻辑：委托 X11 捕获模块读取 Display 宽高。
+ * 逻辑：委托当前捕获后端读取显示尺寸（X11 为 Display 宽高，合成源为固定画布尺寸）。
  * 参数：self 捕获管理器；out_width/out_height 输出值；error 错误输出。
- * 外部接口：drd_x11_capture_get_display_size。
+ * 外部接口：drd_capture_backend_get_display_size。
  */
 gboolean
 drd_capture_manager_get_display_size(DrdCaptureManager *self,
@@ -165,7 +244,49 @@ drd_capture_manager_get_display_size(DrdCaptureManager *self,
     g_return_val_if_fail(out_width != NULL, FALSE);
     g_return_val_if_fail(out_height != NULL, FALSE);
 
-    return drd_x11_capture_get_display_size(self->x11_capture, NULL, out_width, out_height, error);
+    return drd_capture_backend_get_display_size(self->backend, out_width, out_height, error);
+}
+
+/*
+ * 功能：获取捕获布局中的显示器列表。
+ * 逻辑：委托当前捕获后端输出显示器布局；单流捕获时只有一个覆盖整个桌面的显示器。
+ * 参数：self 捕获管理器；out_monitors 输出 DrdMonitorInfo 数组；error 错误输出。
+ * 外部接口：drd_capture_backend_get_monitors。
+ */
+gboolean
+drd_capture_manager_get_monitors(DrdCaptureManager *self, GArray *out_monitors, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_MANAGER(self), FALSE);
+    g_return_val_if_fail(out_monitors != NULL, FALSE);
+
+    return drd_capture_backend_get_monitors(self->backend, out_monitors, error);
+}
+
+/*
+ * 功能：获取捕获画面在根窗口中的原点。
+ * 逻辑：委托当前捕获后端；窗口捕获返回目标窗口当前位置，整屏捕获恒为 (0, 0)。
+ * 参数：self 捕获管理器；out_x/out_y 输出原点。
+ * 外部接口：drd_capture_backend_get_origin。
+ */
+void
+drd_capture_manager_get_origin(DrdCaptureManager *self, gint *out_x, gint *out_y)
+{
+    g_return_if_fail(DRD_IS_CAPTURE_MANAGER(self));
+
+    drd_capture_backend_get_origin(self->backend, out_x, out_y);
+}
+
+/*
+ * 功能：读取当前生效的捕获选项。
+ * 逻辑：返回管理器内部保存的选项，调用方按值复制后修改再通过 set_options 生效。
+ * 参数：self 捕获管理器。
+ * 外部接口：无。
+ */
+const DrdCaptureOptions *
+drd_capture_manager_get_options(DrdCaptureManager *self)
+{
+    g_return_val_if_fail(DRD_IS_CAPTURE_MANAGER(self), NULL);
+    return &self->options;
 }
 
 /*
@@ -2,6 +2,8 @@
 
 #include <glib-object.h>
 
+#include "capture/drd_capture_backend.h"
+#include "core/drd_capture_options.h"
 #include "utils/drd_frame_queue.h"
 #include "utils/drd_frame.h"
 
@@ -11,14 +13,30 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE(DrdCaptureManager, drd_capture_manager, DRD, CAPTURE_MANAGER, GObject)
 
 DrdCaptureManager *drd_capture_manager_new(void);
+void drd_capture_manager_set_options(DrdCaptureManager *self, const DrdCaptureOptions *options);
+const DrdCaptureOptions *drd_capture_manager_get_options(DrdCaptureManager *self);
+/**
+ * drd_capture_manager_start:
+ * @self: the capture manager
+ * @width: requested capture width, 0 for the display width
+ * @height: requested capture height, 0 for the display height
+ * @n_frame_slots: how many captured frames of one output can exist at once:
+ *   the latest one, the one being written and every frame the consumer holds
+ * @error: return location for a #GError
+ */
 gboolean drd_capture_manager_start(DrdCaptureManager *self, guint width,
-                                   guint height, GError **error);
+                                   guint height, guint n_frame_slots,
+                                   GError **error);
 void drd_capture_manager_stop(DrdCaptureManager *self);
 gboolean drd_capture_manager_is_running(DrdCaptureManager *self);
 gboolean drd_capture_manager_get_display_size(DrdCaptureManager *self,
                                               guint *out_width,
                                               guint *out_height,
                                               GError **error);
+gboolean drd_capture_manager_get_monitors(DrdCaptureManager *self,
+                                          GArray *out_monitors,
+                                          GError **error);
+void drd_capture_manager_get_origin(DrdCaptureManager *self, gint *out_x, gint *out_y);
 DrdFrameQueue *drd_capture_manager_get_queue(DrdCaptureManager *self);
 gboolean drd_capture_manager_wait_frame(DrdCaptureManager *self,
                                         gint64 timeout_us, DrdFrame **out_frame,
@@ -0,0 +1,623 @@
+#include "capture/drd_synthetic_capture.h"
+
+#include <gio/gio.h>
+#include <string.h>
+
+#include "capture/drd_capture_backend.h"
+#include "utils/drd_capture_metrics.h"
+#include "utils/drd_frame_pool.h"
+#include "utils/drd_log.h"
+
+#define DRD_SYNTHETIC_BYTES_PER_PIXEL 4
+#define DRD_SYNTHETIC_LINE_HEIGHT 16
+#define DRD_SYNTHETIC_GLYPH_WIDTH 7
+#define DRD_SYNTHETIC_GLYPH_ADVANCE 9
+#define DRD_SYNTHETIC_SCROLL_STEP 8
+#define DRD_SYNTHETIC_TYPING_PERIOD 3
+#define DRD_SYNTHETIC_CARET_BLINK_PERIOD 30
+#define DRD_SYNTHETIC_VIDEO_WIDTH 640
+#define DRD_SYNTHETIC_VIDEO_HEIGHT 360
+#define DRD_SYNTHETIC_BACKPRESSURE_RETRY_US 2000
+
+#define DRD_SYNTHETIC_COLOR_DESKTOP 0xFF2B5797u
+#define DRD_SYNTHETIC_COLOR_PAPER 0xFFFFFFFFu
+#define DRD_SYNTHETIC_COLOR_INK 0xFF303030u
+
+struct _DrdSyntheticCapture
+{
+    GObject parent_instance;
+
+    GMutex mutex;
+    GCond cond;
+    GThread *thread;
+    gboolean running;
+
+    DrdFrameQueue *queue;
+    DrdFramePool *pool;
+    DrdSyntheticWorkload workload;
+
+    guint width;
+    guint height;
+    guint stride;
+    guint8 *canvas;
+    guint64 tick;
+
+    /* 文档窗口内容区，scroll/typing 负载在此区域内变化 */
+    DrdFrameRect content;
+    guint scroll_offset;
+    guint caret_x;
+    guint caret_y;
+    gboolean caret_visible;
+};
+
+static void drd_synthetic_capture_backend_iface_init(DrdCaptureBackendInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(DrdSyntheticCapture, drd_synthetic_capture, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(DRD_TYPE_CAPTURE_BACKEND, drd_synthetic_capture_backend_iface_init))
+
+static void drd_synthetic_capture_stop(DrdSyntheticCapture *self);
+
+/*
+ * 功能：释放合成捕获持有的资源。
+ * 逻辑：先停止线程，再释放队列与缓冲池引用，交由父类 dispose。
+ * 参数：object 基类指针，期望为 DrdSyntheticCapture。
+ * 外部接口：GLib g_clear_object。
+ */
+static void
+drd_synthetic_capture_dispose(GObject *object)
+{
+    DrdSyntheticCapture *self = DRD_SYNTHETIC_CAPTURE(object);
+
+    drd_synthetic_capture_stop(self);
+    g_clear_object(&self->queue);
+    g_clear_object(&self->pool);
+
+    G_OBJECT_CLASS(drd_synthetic_capture_parent_class)->dispose(object);
+}
+
+/*
+ * 功能：清理互斥锁与条件变量。
+ * 逻辑：销毁同步原语后调用父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_mutex_clear/g_cond_clear。
+ */
+static void
+drd_synthetic_capture_finalize(GObject *object)
+{
+    DrdSyntheticCapture *self = DRD_SYNTHETIC_CAPTURE(object);
+
+    g_mutex_clear(&self->mutex);
+    g_cond_clear(&self->cond);
+    G_OBJECT_CLASS(drd_synthetic_capture_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：绑定类级别析构回调。
+ * 逻辑：挂载 dispose/finalize。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_synthetic_capture_class_init(DrdSyntheticCaptureClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = drd_synthetic_capture_dispose;
+    object_class->finalize = drd_synthetic_capture_finalize;
+}
+
+/*
+ * 功能：初始化实例字段。
+ * 逻辑：初始化同步原语，帧缓冲池在启动时按下游持有的帧数创建。
+ * 参数：self 合成捕获实例。
+ * 外部接口：GLib g_mutex_init/g_cond_init。
+ */
+static void
+drd_synthetic_capture_init(DrdSyntheticCapture *self)
+{
+    g_mutex_init(&self->mutex);
+    g_cond_init(&self->cond);
+    self->running = FALSE;
+}
+
+/*
+ * 功能：创建合成捕获后端并绑定输出队列。
+ * 逻辑：校验队列后创建对象，记录负载类型。
+ * 参数：queue 帧输出队列；workload 回放的负载脚本。
+ * 外部接口：GLib g_object_new/g_object_ref。
+ */
+DrdSyntheticCapture *
+drd_synthetic_capture_new(DrdFrameQueue *queue, DrdSyntheticWorkload workload)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_QUEUE(queue), NULL);
+
+    DrdSyntheticCapture *self = g_object_new(DRD_TYPE_SYNTHETIC_CAPTURE, NULL);
+    self->queue = g_object_ref(queue);
+    self->workload = workload;
+    return self;
+}
+
+/*
+ * 功能：整数混洗，生成确定性的伪随机内容。
+ * 逻辑：murmur3 finalizer。
+ * 参数：value 输入。
+ * 外部接口：无。
+ */
+static guint32
+drd_synthetic_capture_hash(guint32 value)
+{
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
+    return value;
+}
+
+/*
+ * 功能：在画布上填充纯色矩形。
+ * 逻辑：裁剪到画布范围后逐行写入 32 位像素。
+ * 参数：self 合成捕获；x/y/width/height 矩形；color BGRX 像素值。
+ * 外部接口：无。
+ */
+static void
+drd_synthetic_capture_fill_rect(DrdSyntheticCapture *self, guint x, guint y, guint width, guint height, guint32 color)
+{
+    const guint x1 = MIN(x + width, self->width);
+    const guint y1 = MIN(y + height, self->height);
+
+    for (guint row = y; row < y1; row++)
+    {
+        guint32 *pixels = (guint32 *) (self->canvas + (gsize) row * self->stride);
+        for (guint col = x; col < x1; col++)
+        {
+            pixels[col] = color;
+        }
+    }
+}
+
+/*
+ * 功能：绘制文档内容的一条像素行。
+ * 逻辑：按 doc_y 定位文本行与行内偏移，行距内的像素以纸色填充；字形区域按 (行号, 列号, 行内偏移) 哈希决定墨点，
+ * 约五分之一的字符位为空格，形成类似文本的高频细节。
+ * 参数：self 合成捕获；screen_y 画布行；doc_y 文档坐标行。
+ * 外部接口：无。
+ */
+static void
+drd_synthetic_capture_paint_doc_row(DrdSyntheticCapture *self, guint screen_y, guint doc_y)
+{
+    guint32 *pixels = (guint32 *) (self->canvas + (gsize) screen_y * self->stride);
+    const guint line = doc_y / DRD_SYNTHETIC_LINE_HEIGHT;
+    const guint row_in_line = doc_y % DRD_SYNTHETIC_LINE_HEIGHT;
+    const gboolean glyph_row = row_in_line >= 2 && row_in_line < DRD_SYNTHETIC_LINE_HEIGHT - 2;
+
+    for (guint col = 0; col < self->content.width; col++)
+    {
+        guint32 color = DRD_SYNTHETIC_COLOR_PAPER;
+        const guint glyph = col / DRD_SYNTHETIC_GLYPH_ADVANCE;
+        const guint glyph_x = col % DRD_SYNTHETIC_GLYPH_ADVANCE;
+
+        if (glyph_row && glyph_x < DRD_SYNTHETIC_GLYPH_WIDTH)
+        {
+            const guint32 seed = drd_synthetic_capture_hash((line * 0x9E3779B1u) ^ glyph);
+            if (seed % 5 != 0)
+            {
+                const guint32 bits = drd_synthetic_capture_hash(seed ^ row_in_line);
+                if (bits & (1u << glyph_x))
+                {
+                    color = DRD_SYNTHETIC_COLOR_INK;
+                }
+            }
+        }
+        pixels[self->content.x + col] = color;
+    }
+}
+
+/*
+ * 功能：绘制完整桌面：背景、文档窗口与文本。
+ * 逻辑：背景填充桌面色，文档内容区按当前滚动偏移逐行绘制；seed 用于 fullscreen 负载改变文档起始行与背景色。
+ * 参数：self 合成捕获；seed 内容种子。
+ * 外部接口：无。
+ */
+static void
+drd_synthetic_capture_paint_desktop(DrdSyntheticCapture *self, guint32 seed)
+{
+    const guint32 desktop = seed == 0 ? DRD_SYNTHETIC_COLOR_DESKTOP : (0xFF000000u | drd_synthetic_capture_hash(seed));
+
+    drd_synthetic_capture_fill_rect(self, 0, 0, self->width, self->height, desktop);
+    for (guint row = 0; row < self->content.height; row++)
+    {
+        drd_synthetic_capture_paint_doc_row(self, self->content.y + row,
+                                            self->scroll_offset + seed * DRD_SYNTHETIC_LINE_HEIGHT * 37u + row);
+    }
+}
+
+/*
+ * 功能：绘制或擦除 typing 负载的插入光标。
+ * 逻辑：在光标位置填充 2 像素宽的竖条，并记录对应损坏矩形。
+ * 参数：self 合成捕获；visible 是否显示；damage 损坏矩形输出。
+ * 外部接口：GLib g_array_append_val。
+ */
+static void
+drd_synthetic_capture_paint_caret(DrdSyntheticCapture *self, gboolean visible, GArray *damage)
+{
+    DrdFrameRect rect = {self->caret_x, self->caret_y, 2, DRD_SYNTHETIC_LINE_HEIGHT};
+
+    drd_synthetic_capture_fill_rect(self, rect.x, rect.y, rect.width, rect.height,
+                                    visible ? DRD_SYNTHETIC_COLOR_INK : DRD_SYNTHETIC_COLOR_PAPER);
+    self->caret_visible = visible;
+    g_array_append_val(damage, rect);
+}
+
+/*
+ * 功能：推进一帧负载脚本，修改画布并输出损坏区域。
+ * 逻辑：idle 仅首帧全屏；scroll 将内容区上移固定步长并补画底部新行；video 重绘居中视频窗口；
+ * typing 每隔几帧输入一个字符并闪烁光标；fullscreen 每帧整屏换内容。
+ * 参数：self 合成捕获；damage 损坏矩形输出；out_full 输出是否整帧变化。
+ * 外部接口：C 库 memmove。
+ */
+static void
+drd_synthetic_capture_step(DrdSyntheticCapture *self, GArray *damage, gboolean *out_full)
+{
+    const guint64 tick = self->tick++;
+
+    g_array_set_size(damage, 0);
+    *out_full = tick == 0;
+    if (tick == 0)
+    {
+        return;
+    }
+
+    switch (self->workload)
+    {
+        case DRD_SYNTHETIC_WORKLOAD_SCROLL:
+        {
+            const gsize row_bytes = (gsize) self->content.width * DRD_SYNTHETIC_BYTES_PER_PIXEL;
+            const gsize x_offset = (gsize) self->content.x * DRD_SYNTHETIC_BYTES_PER_PIXEL;
+            const guint step = MIN(DRD_SYNTHETIC_SCROLL_STEP, self->content.height);
+
+            for (guint row = 0; row + step < self->content.height; row++)
+            {
+                guint8 *dst = self->canvas + (gsize) (self->content.y + row) * self->stride + x_offset;
+                memmove(dst, dst + (gsize) step * self->stride, row_bytes);
+            }
+            self->scroll_offset += step;
+            for (guint row = self->content.height - step; row < self->content.height; row++)
+            {
+                drd_synthetic_capture_paint_doc_row(self, self->content.y + row, self->scroll_offset + row);
+            }
+            g_array_append_val(damage, self->content);
+            break;
+        }
+        case DRD_SYNTHETIC_WORKLOAD_VIDEO:
+        {
+            const guint video_width = MIN(DRD_SYNTHETIC_VIDEO_WIDTH, self->width);
+            const guint video_height = MIN(DRD_SYNTHETIC_VIDEO_HEIGHT, self->height);
+            DrdFrameRect rect = {(self->width - video_width) / 2, (self->height - video_height) / 2, video_width,
+                                 video_height};
+            const guint t = (guint) tick;
+
+            for (guint row = 0; row < rect.height; row++)
+            {
+                guint32 *pixels = (guint32 *) (self->canvas + (gsize) (rect.y + row) * self->stride) + rect.x;
+                for (guint col = 0; col < rect.width; col++)
+                {
+                    const guint32 r = (col + t * 4) & 0xFF;
+                    const guint32 g = (row * 2 + t * 3) & 0xFF;
+                    const guint32 b = ((col ^ row) + t * 5) & 0xFF;
+                    pixels[col] = 0xFF000000u | (r << 16) | (g << 8) | b;
+                }
+            }
+            g_array_append_val(damage, rect);
+            break;
+        }
+        case DRD_SYNTHETIC_WORKLOAD_TYPING:
+        {
+            if (tick % DRD_SYNTHETIC_TYPING_PERIOD == 0)
+            {
+                if (self->caret_visible)
+                {
+                    drd_synthetic_capture_paint_caret(self, FALSE, damage);
+                }
+
+                if (self->caret_x + DRD_SYNTHETIC_GLYPH_ADVANCE > self->content.x + self->content.width)
+                {
+                    self->caret_x = self->content.x;
+                    self->caret_y += DRD_SYNTHETIC_LINE_HEIGHT;
+                }
+                if (self->caret_y + DRD_SYNTHETIC_LINE_HEIGHT > self->content.y + self->content.height)
+                {
+                    drd_synthetic_capture_fill_rect(self, self->content.x, self->content.y, self->content.width,
+                                                    self->content.height, DRD_SYNTHETIC_COLOR_PAPER);
+                    self->caret_x = self->content.x;
+                    self->caret_y = self->content.y;
+                    g_array_set_size(damage, 0);
+                    g_array_append_val(damage, self->content);
+                }
+
+                const guint32 seed = drd_synthetic_capture_hash((guint32) tick);
+                DrdFrameRect glyph = {self->caret_x, self->caret_y, DRD_SYNTHETIC_GLYPH_ADVANCE,
+                                      DRD_SYNTHETIC_LINE_HEIGHT};
+                for (guint row = 2; row < DRD_SYNTHETIC_LINE_HEIGHT - 2; row++)
+                {
+                    guint32 *pixels = (guint32 *) (self->canvas + (gsize) (glyph.y + row) * self->stride) + glyph.x;
+                    const guint32 bits = drd_synthetic_capture_hash(seed ^ row);
+                    for (guint col = 0; col < DRD_SYNTHETIC_GLYPH_WIDTH; col++)
+                    {
+                        pixels[col] = (bits & (1u << col)) ? DRD_SYNTHETIC_COLOR_INK : DRD_SYNTHETIC_COLOR_PAPER;
+                    }
+                }
+                g_array_append_val(damage, glyph);
+                self->caret_x += DRD_SYNTHETIC_GLYPH_ADVANCE;
+                drd_synthetic_capture_paint_caret(self, TRUE, damage);
+            }
+            else if (tick % DRD_SYNTHETIC_CARET_BLINK_PERIOD == 0)
+            {
+                drd_synthetic_capture_paint_caret(self, !self->caret_visible, damage);
+            }
+            break;
+        }
+        case DRD_SYNTHETIC_WORKLOAD_FULLSCREEN:
+            drd_synthetic_capture_paint_desktop(self, (guint32) tick);
+            *out_full = TRUE;
+            break;
+        case DRD_SYNTHETIC_WORKLOAD_IDLE:
+        default:
+            break;
+    }
+}
+
+/*
+ * 功能：合成捕获线程主循环，按目标帧率回放负载并推送帧。
+ * 逻辑：以帧队列反馈的采集间隔为节拍在条件变量上等待（stop 可立即唤醒）；负载脚本模拟交互操作，每拍记为一次输入活动以免触发空闲放宽；
+ * 队列容不下新帧时暂停脚本稍后重试，否则推进负载脚本，有变化时从缓冲池取帧、拷贝画布并附带损坏矩形入队；统计周期内输出帧率、采集间隔、损坏面积占比与推迟次数。
+ * 参数：user_data 合成捕获实例。
+ * 外部接口：drd_capture_metrics_get_* 读取节拍；drd_frame_queue_get_pacing_interval_us/can_accept/note_input_activity 读取下游反馈；
+ * drd_frame_pool_acquire/drd_frame_set_damage/drd_frame_queue_push；GLib g_cond_wait_until。
+ */
+static gpointer
+drd_synthetic_capture_thread(gpointer user_data)
+{
+    DrdSyntheticCapture *self = DRD_SYNTHETIC_CAPTURE(user_data);
+    const gint64 target_interval = drd_capture_metrics_get_target_interval_us();
+    const gint64 stats_interval = drd_capture_metrics_get_stats_interval_us();
+    const gsize frame_size = (gsize) self->stride * self->height;
+    g_autoptr(GArray) damage = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+    gint64 next_deadline = g_get_monotonic_time();
+    gint64 stats_window_start = next_deadline;
+    guint stats_frames = 0;
+    guint stats_deferred = 0;
+    guint64 stats_damage_pixels = 0;
+
+    while (TRUE)
+    {
+        g_mutex_lock(&self->mutex);
+        while (self->running && g_get_monotonic_time() < next_deadline)
+        {
+            g_cond_wait_until(&self->cond, &self->mutex, next_deadline);
+        }
+        const gboolean running = self->running;
+        g_mutex_unlock(&self->mutex);
+
+        if (!running)
+        {
+            break;
+        }
+
+        drd_frame_queue_note_input_activity(self->queue);
+        const gint64 capture_interval = drd_frame_queue_get_pacing_interval_us(self->queue, target_interval, 1);
+        if (!drd_frame_queue_can_accept(self->queue, 1))
+        {
+            /* 下游尚未取走上一帧：暂停脚本，避免生成的帧在队列里被丢弃 */
+            stats_deferred++;
+            next_deadline = g_get_monotonic_time() + DRD_SYNTHETIC_BACKPRESSURE_RETRY_US;
+            continue;
+        }
+
+        gboolean full = FALSE;
+        drd_synthetic_capture_step(self, damage, &full);
+        const gint64 now = g_get_monotonic_time();
+
+        if (full || damage->len > 0)
+        {
+            g_autoptr(DrdFrame) frame = drd_frame_pool_acquire(self->pool, self->width, self->height, self->stride,
+                                                               (guint64) now);
+            guint8 *buffer = drd_frame_ensure_capacity(frame, frame_size);
+            memcpy(buffer, self->canvas, frame_size);
+            if (full)
+            {
+                stats_damage_pixels += (guint64) self->width * self->height;
+            }
+            else
+            {
+                drd_frame_set_damage(frame, (const DrdFrameRect *) damage->data, damage->len);
+                for (guint i = 0; i < damage->len; i++)
+                {
+                    const DrdFrameRect *rect = &g_array_index(damage, DrdFrameRect, i);
+                    stats_damage_pixels += (guint64) rect->width * rect->height;
+                }
+            }
+            drd_frame_queue_push(self->queue, frame);
+            stats_frames++;
+        }
+
+        if (now - stats_window_start >= stats_interval)
+        {
+            const gdouble elapsed = (gdouble) (now - stats_window_start);
+            const gdouble fps = (gdouble) stats_frames * (gdouble) G_USEC_PER_SEC / elapsed;
+            const gdouble damage_ratio = stats_frames > 0 ? (gdouble) stats_damage_pixels * 100.0 /
+                                                                    ((gdouble) stats_frames * self->width * self->height)
+                                                          : 0.0;
+            DRD_LOG_MESSAGE("Synthetic capture (%s) fps=%.2f, interval=%.1fms, damage=%.1f%%, deferred=%u, pool hits=%" G_GUINT64_FORMAT
+                            " misses=%" G_GUINT64_FORMAT,
+                            drd_synthetic_workload_to_string(self->workload), fps, (gdouble) capture_interval / 1000.0,
+                            damage_ratio, stats_deferred, drd_frame_pool_get_hits(self->pool),
+                            drd_frame_pool_get_misses(self->pool));
+            stats_window_start = now;
+            stats_frames = 0;
+            stats_deferred = 0;
+            stats_damage_pixels = 0;
+        }
+
+        next_deadline += capture_interval;
+        if (next_deadline < now)
+        {
+            next_deadline = now + capture_interval;
+        }
+    }
+
+    g_object_unref(self);
+    return NULL;
+}
+
+/*
+ * 功能：启动合成捕获线程。
+ * 逻辑：已运行直接返回；按请求尺寸（0 使用默认）分配画布，按同时存在的帧数重建帧缓冲池，布置文档窗口并绘制初始桌面，随后启动线程。
+ * 参数：self 合成捕获；width/height 期望尺寸；n_frame_slots 同时存在的帧上限，即缓冲池保留的空闲缓冲数。
+ * 外部接口：GLib g_malloc/g_thread_new；drd_frame_pool_new；日志 DRD_LOG_MESSAGE。
+ */
+static gboolean
+drd_synthetic_capture_start(DrdSyntheticCapture *self, guint width, guint height, guint n_frame_slots)
+{
+    g_mutex_lock(&self->mutex);
+    if (self->running)
+    {
+        g_mutex_unlock(&self->mutex);
+        return TRUE;
+    }
+
+    self->width = width > 0 ? width : DRD_SYNTHETIC_CAPTURE_DEFAULT_WIDTH;
+    self->height = height > 0 ? height : DRD_SYNTHETIC_CAPTURE_DEFAULT_HEIGHT;
+    self->stride = self->width * DRD_SYNTHETIC_BYTES_PER_PIXEL;
+    g_clear_pointer(&self->canvas, g_free);
+    self->canvas = g_malloc((gsize) self->stride * self->height);
+    g_clear_object(&self->pool);
+    self->pool = drd_frame_pool_new(n_frame_slots);
+    self->tick = 0;
+    self->scroll_offset = 0;
+    self->content.x = self->width / 10;
+    self->content.y = self->height / 10;
+    self->content.width = self->width * 7 / 10;
+    self->content.height = self->height * 8 / 10;
+    self->caret_x = self->content.x;
+    self->caret_y = self->content.y;
+    self->caret_visible = FALSE;
+    drd_synthetic_capture_paint_desktop(self, 0);
+    if (self->workload == DRD_SYNTHETIC_WORKLOAD_TYPING)
+    {
+        drd_synthetic_capture_fill_rect(self, self->content.x, self->content.y, self->content.width,
+                                        self->content.height, DRD_SYNTHETIC_COLOR_PAPER);
+    }
+
+    self->running = TRUE;
+    self->thread = g_thread_new("drd-synthetic-capture", drd_synthetic_capture_thread, g_object_ref(self));
+    g_mutex_unlock(&self->mutex);
+
+    DRD_LOG_MESSAGE("Synthetic capture started at %ux%u (workload=%s)", self->width, self->height,
+                    drd_synthetic_workload_to_string(self->workload));
+    return TRUE;
+}
+
+/*
+ * 功能：停止合成捕获线程并释放画布。
+ * 逻辑：持锁清除运行标志并唤醒线程，join 后释放画布。
+ * 参数：self 合成捕获。
+ * 外部接口：GLib g_cond_broadcast/g_thread_join/g_free。
+ */
+static void
+drd_synthetic_capture_stop(DrdSyntheticCapture *self)
+{
+    g_mutex_lock(&self->mutex);
+    if (!self->running)
+    {
+        g_mutex_unlock(&self->mutex);
+        return;
+    }
+    self->running = FALSE;
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->mutex);
+
+    if (self->thread != NULL)
+    {
+        g_thread_join(self->thread);
+        self->thread = NULL;
+    }
+    g_clear_pointer(&self->canvas, g_free);
+
+    DRD_LOG_MESSAGE("Synthetic capture stopped");
+}
+
+/*
+ * 功能：捕获后端接口 start 适配。
+ * 逻辑：转发到 drd_synthetic_capture_start，合成源不会失败。
+ * 参数：backend 捕获后端；width/height 期望尺寸；n_frame_slots 同时存在的帧上限；error 未使用。
+ * 外部接口：无。
+ */
+static gboolean
+drd_synthetic_capture_backend_start(DrdCaptureBackend *backend, guint width, guint height, guint n_frame_slots, GError **error)
+{
+    (void) error;
+    return drd_synthetic_capture_start(DRD_SYNTHETIC_CAPTURE(backend), width, height, n_frame_slots);
+}
+
+/*
+ * 功能：捕获后端接口 stop 适配。
+ * 逻辑：转发到 drd_synthetic_capture_stop。
+ * 参数：backend 捕获后端。
+ * 外部接口：无。
+ */
+static void
+drd_synthetic_capture_backend_stop(DrdCaptureBackend *backend)
+{
+    drd_synthetic_capture_stop(DRD_SYNTHETIC_CAPTURE(backend));
+}
+
+/*
+ * 功能：捕获后端接口 is_running 适配。
+ * 逻辑：持锁读取运行标志。
+ * 参数：backend 捕获后端。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+static gboolean
+drd_synthetic_capture_backend_is_running(DrdCaptureBackend *backend)
+{
+    DrdSyntheticCapture *self = DRD_SYNTHETIC_CAPTURE(backend);
+
+    g_mutex_lock(&self->mutex);
+    const gboolean running = self->running;
+    g_mutex_unlock(&self->mutex);
+    return running;
+}
+
+/*
+ * 功能：捕获后端接口 get_display_size 适配。
+ * 逻辑：合成源的“显示器”固定为默认尺寸。
+ * 参数：backend 捕获后端；out_width/out_height 输出尺寸；error 未使用。
+ * 外部接口：无。
+ */
+static gboolean
+drd_synthetic_capture_backend_get_display_size(DrdCaptureBackend *backend,
+                                               guint *out_width,
+                                               guint *out_height,
+                                               GError **error)
+{
+    (void) backend;
+    (void) error;
+    *out_width = DRD_SYNTHETIC_CAPTURE_DEFAULT_WIDTH;
+    *out_height = DRD_SYNTHETIC_CAPTURE_DEFAULT_HEIGHT;
+    return TRUE;
+}
+
+/*
+ * 功能：挂载捕获后端接口实现。
+ * 逻辑：把各接口方法指向合成源适配函数。
+ * 参数：iface 接口结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_synthetic_capture_backend_iface_init(DrdCaptureBackendInterface *iface)
+{
+    iface->start = drd_synthetic_capture_backend_start;
+    iface->stop = drd_synthetic_capture_backend_stop;
+    iface->is_running = drd_synthetic_capture_backend_is_running;
+    iface->get_display_size = drd_synthetic_capture_backend_get_display_size;
+}
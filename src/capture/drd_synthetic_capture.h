@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glib-object.h>
+
+#include "core/drd_capture_options.h"
+#include "utils/drd_frame_queue.h"
+
+G_BEGIN_DECLS
+
+#define DRD_SYNTHETIC_CAPTURE_DEFAULT_WIDTH 1920
+#define DRD_SYNTHETIC_CAPTURE_DEFAULT_HEIGHT 1080
+
+#define DRD_TYPE_SYNTHETIC_CAPTURE (drd_synthetic_capture_get_type())
+G_DECLARE_FINAL_TYPE(DrdSyntheticCapture, drd_synthetic_capture, DRD, SYNTHETIC_CAPTURE, GObject)
+
+DrdSyntheticCapture *drd_synthetic_capture_new(DrdFrameQueue *queue, DrdSyntheticWorkload workload);
+
+G_END_DECLS
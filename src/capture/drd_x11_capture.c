@@ -1,30 +1,69 @@
 #include "capture/drd_x11_capture.h"
 
+#include <X11/Xlib-xcb.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/XShm.h>
 #include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xrandr.h>
+#include <xcb/shm.h>
+#include <xcb/xcb.h>
 
 #include <gio/gio.h>
 #include <glib-unix.h>
 #include <glib.h>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <unistd.h>
 
+#include "capture/drd_capture_backend.h"
+#include "capture/drd_x11_shm_ring.h"
 #include "utils/drd_capture_metrics.h"
 #include "utils/drd_frame.h"
 #include "utils/drd_log.h"
 
+/* 损坏矩形超过该数量时合并为外接矩形，避免逐个读回的往返开销 */
+#define DRD_X11_CAPTURE_MAX_DAMAGE_RECTS 128
+/* 损坏面积占比超过该值时直接整屏读回 */
+#define DRD_X11_CAPTURE_FULL_FETCH_RATIO 0.5
+/* 帧队列容不下本轮帧时的重试间隔 */
+#define DRD_X11_CAPTURE_BACKPRESSURE_RETRY_US 2000
+
 typedef struct
 {
     XShmSegmentInfo info;
 } DrdX11ShmArea;
 
+/* 已发出但尚未回收的 XCB SHM 读回请求 */
+typedef struct
+{
+    xcb_shm_get_image_cookie_t cookie;
+    DrdFrameRect rect;
+    gsize offset;
+    gsize pitch;
+    gboolean direct;
+} DrdX11PendingRead;
+
+/* 单个捕获输出：单流模式下为整个根窗口，多显示器模式下对应一个 XRandR 显示器 */
+typedef struct
+{
+    DrdMonitorInfo monitor;
+    DrdX11ShmRing *ring;
+    gboolean backing_valid;
+    gint slot;
+    gboolean full;
+    gboolean full_fetch;
+    GArray *rects;
+    GArray *pending_reads;
+} DrdX11CaptureOutput;
+
 struct _DrdX11Capture
 {
     GObject parent_instance;
@@ -34,23 +73,31 @@ struct _DrdX11Capture
     GThread *thread;
 
     gboolean running;
+    gboolean per_monitor;
+    guint n_frame_slots; /* 每个输出的帧环槽位数，由调用方按下游持有的帧数给出 */
     gchar *display_name;
 
     Display *display;
+    xcb_connection_t *xcb;
     int screen;
     Window root;
-    XImage *image;
-    DrdX11ShmArea shm;
-    gboolean attached;
+    GArray *outputs;
+    XImage *rect_image;
+    DrdX11ShmArea rect_shm;
+    gboolean rect_attached;
     Damage damage;
     int damage_event_base;
+    XserverRegion damage_region;
 
     guint width;
     guint height;
     int wakeup_pipe[2];
 };
 
-G_DEFINE_TYPE(DrdX11Capture, drd_x11_capture, G_TYPE_OBJECT)
+static void drd_x11_capture_backend_iface_init(DrdCaptureBackendInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(DrdX11Capture, drd_x11_capture, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(DRD_TYPE_CAPTURE_BACKEND, drd_x11_capture_backend_iface_init))
 
 static gpointer drd_x11_capture_thread(gpointer user_data);
 
@@ -108,15 +155,15 @@ static void drd_x11_capture_class_init(DrdX11CaptureClass *klass)
 
 /*
  * 功能：初始化实例字段。
- * 逻辑：初始化互斥锁与共享内存标记，置运行状态与唤醒管道为未激活。
+ * 逻辑：初始化互斥锁与矩形暂存共享内存标记，置运行状态与唤醒管道为未激活。
  * 参数：self 捕获实例。
  * 外部接口：GLib g_mutex_init、C 库 memset。
  */
 static void drd_x11_capture_init(DrdX11Capture *self)
 {
     g_mutex_init(&self->state_mutex);
-    memset(&self->shm.info, 0, sizeof(self->shm.info));
-    self->shm.info.shmid = -1;
+    memset(&self->rect_shm.info, 0, sizeof(self->rect_shm.info));
+    self->rect_shm.info.shmid = -1;
     self->running = FALSE;
     self->wakeup_pipe[0] = -1;
     self->wakeup_pipe[1] = -1;
@@ -170,12 +217,204 @@ gboolean drd_x11_capture_get_display_size(DrdX11Capture *self, const gchar *disp
     return TRUE;
 }
 
+/*
+ * 功能：查询 XRandR 显示器布局。
+ * 逻辑：服务器支持 RandR 1.5 时通过 XRRGetMonitors 取得活动显示器，裁剪到捕获范围并把主显示器排在首位；不支持、无可用显示器或显示器多于帧队列信箱数（即 Rdpgfx 可描述的显示器上限）时输出覆盖整个捕获范围的单个主显示器，退回单流整屏捕获而不是丢弃多出的显示器。
+ * 参数：display X 连接；root 根窗口；width/height 捕获范围；out_monitors 输出 DrdMonitorInfo 数组。
+ * 外部接口：XRRQueryExtension/XRRQueryVersion 检查扩展版本；XRRGetMonitors/XRRFreeMonitors 读取显示器。
+ */
+static void drd_x11_capture_query_monitors(Display *display, Window root, guint width, guint height, GArray *out_monitors)
+{
+    int event_base = 0;
+    int error_base = 0;
+    int major = 0;
+    int minor = 0;
+
+    g_array_set_size(out_monitors, 0);
+    if (XRRQueryExtension(display, &event_base, &error_base) && XRRQueryVersion(display, &major, &minor) && (major > 1 || (major == 1 && minor >= 5)))
+    {
+        int n_monitors = 0;
+        XRRMonitorInfo *infos = XRRGetMonitors(display, root, True, &n_monitors);
+        for (int i = 0; infos != NULL && i < n_monitors; i++)
+        {
+            const gint x0 = MAX(infos[i].x, 0);
+            const gint y0 = MAX(infos[i].y, 0);
+            const gint x1 = MIN(infos[i].x + infos[i].width, (gint) width);
+            const gint y1 = MIN(infos[i].y + infos[i].height, (gint) height);
+            if (x1 <= x0 || y1 <= y0)
+            {
+                continue;
+            }
+
+            DrdMonitorInfo monitor = {x0, y0, (guint) (x1 - x0), (guint) (y1 - y0), infos[i].primary ? TRUE : FALSE};
+            if (monitor.primary)
+            {
+                g_array_prepend_val(out_monitors, monitor);
+            }
+            else
+            {
+                g_array_append_val(out_monitors, monitor);
+            }
+        }
+        if (infos != NULL)
+        {
+            XRRFreeMonitors(infos);
+        }
+    }
+
+    if (out_monitors->len > DRD_FRAME_QUEUE_MAX_MONITORS)
+    {
+        DRD_LOG_WARNING("X11 capture found %u monitors, more than the %u monitor streams supported, capturing the whole screen as one stream",
+                        out_monitors->len, DRD_FRAME_QUEUE_MAX_MONITORS);
+        g_array_set_size(out_monitors, 0);
+    }
+    if (out_monitors->len == 0)
+    {
+        DrdMonitorInfo monitor = {0, 0, width, height, TRUE};
+        g_array_append_val(out_monitors, monitor);
+    }
+    g_array_index(out_monitors, DrdMonitorInfo, 0).primary = TRUE;
+}
+
+/*
+ * 功能：读取捕获布局中的显示器列表。
+ * 逻辑：打开 X11 Display；多显示器模式下按 XRandR 查询显示器，否则输出覆盖整个屏幕的单个显示器；完成后关闭连接。
+ * 参数：self 捕获实例；display_name 指定显示名（NULL 使用默认）；out_monitors 输出 DrdMonitorInfo 数组；error 错误输出。
+ * 外部接口：X11 XOpenDisplay/XCloseDisplay；drd_x11_capture_query_monitors 查询 XRandR 布局。
+ */
+gboolean drd_x11_capture_get_monitors(DrdX11Capture *self, const gchar *display_name, GArray *out_monitors, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_X11_CAPTURE(self), FALSE);
+    g_return_val_if_fail(out_monitors != NULL, FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    const gboolean per_monitor = self->per_monitor;
+    g_mutex_unlock(&self->state_mutex);
+
+    Display *display = XOpenDisplay(display_name);
+    if (display == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open X11 display for monitor query");
+        return FALSE;
+    }
+
+    const int screen = DefaultScreen(display);
+    const guint width = (guint) DisplayWidth(display, screen);
+    const guint height = (guint) DisplayHeight(display, screen);
+    g_array_set_size(out_monitors, 0);
+    if (per_monitor)
+    {
+        drd_x11_capture_query_monitors(display, RootWindow(display, screen), width, height, out_monitors);
+    }
+    else
+    {
+        DrdMonitorInfo monitor = {0, 0, width, height, TRUE};
+        g_array_append_val(out_monitors, monitor);
+    }
+    XCloseDisplay(display);
+    return TRUE;
+}
+
+/*
+ * 功能：设置是否按显示器分别捕获。
+ * 逻辑：持锁记录标志，下一次 start 时生效。
+ * 参数：self 捕获实例；per_monitor TRUE 表示每个 XRandR 显示器输出独立帧流。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+void drd_x11_capture_set_per_monitor(DrdX11Capture *self, gboolean per_monitor)
+{
+    g_return_if_fail(DRD_IS_X11_CAPTURE(self));
+
+    g_mutex_lock(&self->state_mutex);
+    self->per_monitor = per_monitor;
+    g_mutex_unlock(&self->state_mutex);
+}
+
+/*
+ * 功能：创建与屏幕同尺寸的 XShm 图像并附加共享内存段。
+ * 逻辑：XShmCreateImage 创建图像头；按 bytes_per_line*height 申请 SysV 共享内存并映射；写回 data 指针后 XShmAttach 绑定到 X 服务器。
+ * 参数：self 捕获实例；area 共享内存描述；out_image 输出图像；out_attached 输出附加标记；error 错误输出。
+ * 外部接口：X11 XShmCreateImage/XShmAttach；SysV shmget/shmat。
+ */
+static gboolean drd_x11_capture_create_shm_image(DrdX11Capture *self, DrdX11ShmArea *area, XImage **out_image, gboolean *out_attached, GError **error)
+{
+    XImage *image = XShmCreateImage(self->display, DefaultVisual(self->display, self->screen), DefaultDepth(self->display, self->screen), ZPixmap, NULL, &area->info, (int) self->width, (int) self->height);
+    if (image == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create XShm image");
+        return FALSE;
+    }
+    *out_image = image;
+
+    const size_t image_size = (size_t) image->bytes_per_line * (size_t) image->height;
+    area->info.shmid = shmget(IPC_PRIVATE, image_size, IPC_CREAT | 0600);
+    if (area->info.shmid < 0)
+    {
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmget failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    area->info.shmaddr = (char *) shmat(area->info.shmid, NULL, 0);
+    if (area->info.shmaddr == (char *) (-1))
+    {
+        area->info.shmaddr = NULL;
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmat failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    area->info.readOnly = False;
+    image->data = area->info.shmaddr;
+
+    if (!XShmAttach(self->display, &area->info))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "XShmAttach failed");
+        return FALSE;
+    }
+    *out_attached = TRUE;
+    return TRUE;
+}
+
+/*
+ * 功能：释放 XShm 图像及其共享内存段。
+ * 逻辑：已附加则先从 X 服务器分离；销毁图像头（data 置空避免被 free）；shmdt 解除映射并 IPC_RMID 回收段。
+ * 参数：self 捕获实例；area 共享内存描述；image 图像指针地址；attached 附加标记地址。
+ * 外部接口：XShmDetach/XDestroyImage；SysV shmdt/shmctl。
+ */
+static void drd_x11_capture_release_shm_image(DrdX11Capture *self, DrdX11ShmArea *area, XImage **image, gboolean *attached)
+{
+    if (*attached && self->display != NULL)
+    {
+        XShmDetach(self->display, &area->info);
+        *attached = FALSE;
+    }
+
+    if (*image != NULL)
+    {
+        (*image)->data = NULL;
+        XDestroyImage(*image);
+        *image = NULL;
+    }
+
+    if (area->info.shmaddr != NULL)
+    {
+        shmdt(area->info.shmaddr);
+        area->info.shmaddr = NULL;
+    }
+
+    if (area->info.shmid >= 0)
+    {
+        shmctl(area->info.shmid, IPC_RMID, NULL);
+        area->info.shmid = -1;
+        area->info.shmseg = 0;
+    }
+}
+
 /*
  * 功能：打开 X11 连接并准备共享内存截图资源。
- * 逻辑：依次打开 Display，检测 XShm/XDamage 扩展；获取屏幕/root 窗口与目标尺寸；创建 XShm 图像与共享内存段并附加；创建 Damage 句柄。
+ * 逻辑：依次打开 Display 并取得其底层 XCB 连接，检测 XShm/XDamage/XFixes 扩展；获取屏幕/root 窗口与目标尺寸；创建矩形读回暂存图像；确定捕获输出（单流模式为整个根窗口，多显示器模式为各 XRandR 显示器）并为每个输出创建共享内存帧环；创建 Damage 句柄及用于取回损坏区域的 XFixes region。
  * 参数：self 捕获实例；display_name 显示名称；requested_width/height 期望尺寸；error 错误输出。
- * 外部接口：X11/XShm/XDamage 相关 API：XOpenDisplay 打开连接；XShmQueryExtension/XDamageQueryExtension 检查扩展；XShmCreateImage 创建共享内存图像；shmget/shmat 创建并附加 SysV 共享内存；XShmAttach 绑定共享内存到 X 服务器；XDamageCreate
- * 注册屏幕损坏事件；XSync 刷新事件队列。
+ * 外部接口：X11/XShm/XDamage/XFixes 相关 API：XOpenDisplay 打开连接；XGetXCBConnection 取得 XCB 连接用于异步读回；XShmQueryExtension/XDamageQueryExtension/XFixesQueryExtension 检查扩展；drd_x11_capture_create_shm_image 创建暂存图像；drd_x11_capture_query_monitors 查询显示器布局；drd_x11_shm_ring_new 创建帧环；XDamageCreate
+ * 注册屏幕损坏事件；XFixesCreateRegion 创建损坏区域；XSync 刷新事件队列。
  */
 static gboolean drd_x11_capture_prepare_display(DrdX11Capture *self, const gchar *display_name, guint requested_width, guint requested_height, GError **error)
 {
@@ -185,6 +424,7 @@ static gboolean drd_x11_capture_prepare_display(DrdX11Capture *self, const gchar
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open X11 display");
         return FALSE;
     }
+    self->xcb = XGetXCBConnection(self->display);
 
     if (!XShmQueryExtension(self->display))
     {
@@ -201,43 +441,51 @@ static gboolean drd_x11_capture_prepare_display(DrdX11Capture *self, const gchar
     }
     self->damage_event_base = damage_event;
 
+    int fixes_event = 0;
+    int fixes_error = 0;
+    if (!XFixesQueryExtension(self->display, &fixes_event, &fixes_error))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XFixes extension not available on X server");
+        return FALSE;
+    }
+
     self->screen = DefaultScreen(self->display);
     self->root = RootWindow(self->display, self->screen);
 
     self->width = (requested_width > 0) ? requested_width : (guint) DisplayWidth(self->display, self->screen);
     self->height = (requested_height > 0) ? requested_height : (guint) DisplayHeight(self->display, self->screen);
 
-    self->image = XShmCreateImage(self->display, DefaultVisual(self->display, self->screen), DefaultDepth(self->display, self->screen), ZPixmap, NULL, &self->shm.info, (int) self->width, (int) self->height);
-    if (self->image == NULL)
+    if (!drd_x11_capture_create_shm_image(self, &self->rect_shm, &self->rect_image, &self->rect_attached, error))
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create XShm image");
         return FALSE;
     }
 
-    const size_t image_size = (size_t) self->image->bytes_per_line * (size_t) self->image->height;
-    self->shm.info.shmid = shmget(IPC_PRIVATE, image_size, IPC_CREAT | 0600);
-    if (self->shm.info.shmid < 0)
+    g_autoptr(GArray) monitors = g_array_new(FALSE, FALSE, sizeof(DrdMonitorInfo));
+    if (self->per_monitor)
     {
-        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmget failed: %s", g_strerror(errno));
-        return FALSE;
+        drd_x11_capture_query_monitors(self->display, self->root, self->width, self->height, monitors);
     }
-
-    self->shm.info.shmaddr = (char *) shmat(self->shm.info.shmid, NULL, 0);
-    if (self->shm.info.shmaddr == (char *) (-1))
+    else
     {
-        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmat failed: %s", g_strerror(errno));
-        return FALSE;
+        DrdMonitorInfo monitor = {0, 0, self->width, self->height, TRUE};
+        g_array_append_val(monitors, monitor);
     }
 
-    self->shm.info.readOnly = False;
-    self->image->data = self->shm.info.shmaddr;
-
-    if (!XShmAttach(self->display, &self->shm.info))
+    self->outputs = g_array_new(FALSE, TRUE, sizeof(DrdX11CaptureOutput));
+    for (guint i = 0; i < monitors->len; i++)
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "XShmAttach failed");
-        return FALSE;
+        DrdX11CaptureOutput output = {0};
+        output.monitor = g_array_index(monitors, DrdMonitorInfo, i);
+        output.slot = -1;
+        output.rects = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+        output.pending_reads = g_array_new(FALSE, FALSE, sizeof(DrdX11PendingRead));
+        output.ring = drd_x11_shm_ring_new(self->display, self->n_frame_slots, output.monitor.width, output.monitor.height, error);
+        g_array_append_val(self->outputs, output);
+        if (output.ring == NULL)
+        {
+            return FALSE;
+        }
     }
-    self->attached = TRUE;
 
     self->damage = XDamageCreate(self->display, self->root, XDamageReportNonEmpty);
     if (self->damage == 0)
@@ -246,6 +494,8 @@ static gboolean drd_x11_capture_prepare_display(DrdX11Capture *self, const gchar
         return FALSE;
     }
 
+    self->damage_region = XFixesCreateRegion(self->display, NULL, 0);
+
     XSync(self->display, False);
     return TRUE;
 }
@@ -253,12 +503,13 @@ static gboolean drd_x11_capture_prepare_display(DrdX11Capture *self, const gchar
 /*
  * 功能：启动 X11 捕获线程并准备资源。
  * 逻辑：持锁检查运行状态；记录 display 名称；创建唤醒管道并准备显示资源；成功后标记 running 并启动线程。
- * 参数：self 捕获实例；display_name 目标显示；requested_width/height 期望尺寸；error 错误输出。
+ * 参数：self 捕获实例；display_name 目标显示；requested_width/height 期望尺寸；n_frame_slots 每个输出的帧环槽位数；error 错误输出。
  * 外部接口：GLib g_mutex_lock/unlock、g_thread_new 创建线程；内部调用 drd_x11_capture_setup_wakeup_pipe 与 drd_x11_capture_prepare_display，日志通过 DRD_LOG_MESSAGE。
  */
-gboolean drd_x11_capture_start(DrdX11Capture *self, const gchar *display_name, guint requested_width, guint requested_height, GError **error)
+gboolean drd_x11_capture_start(DrdX11Capture *self, const gchar *display_name, guint requested_width, guint requested_height, guint n_frame_slots, GError **error)
 {
     g_return_val_if_fail(DRD_IS_X11_CAPTURE(self), FALSE);
+    g_return_val_if_fail(n_frame_slots >= 2, FALSE);
 
     g_mutex_lock(&self->state_mutex);
     if (self->running)
@@ -267,6 +518,7 @@ gboolean drd_x11_capture_start(DrdX11Capture *self, const gchar *display_name, g
         return TRUE;
     }
 
+    self->n_frame_slots = n_frame_slots;
     g_clear_pointer(&self->display_name, g_free);
     if (display_name != NULL)
     {
@@ -291,15 +543,15 @@ gboolean drd_x11_capture_start(DrdX11Capture *self, const gchar *display_name, g
     self->thread = g_thread_new("drd-x11-capture", drd_x11_capture_thread, g_object_ref(self));
 
     g_mutex_unlock(&self->state_mutex);
-    DRD_LOG_MESSAGE("X11 capture started at %ux%u", self->width, self->height);
+    DRD_LOG_MESSAGE("X11 capture started at %ux%u with %u output(s)", self->width, self->height, self->outputs->len);
     return TRUE;
 }
 
 /*
  * 功能：清理 X11 捕获持有的底层资源（需持锁调用）。
- * 逻辑：销毁 Damage 句柄；卸载共享内存与图像；分离并回收 SysV 共享内存；关闭 X Display。
+ * 逻辑：销毁 Damage 句柄与损坏 region；各输出帧环从 X 服务器分离后释放自身引用（仍被帧引用的槽位映射保留到最后一帧释放）；释放暂存图像共享内存；关闭 X Display。
  * 参数：self 捕获实例。
- * 外部接口：XDamageDestroy/XShmDetach/XDestroyImage/shmdt/shmctl/XCloseDisplay 等 X11 与 SysV 共享内存 API。
+ * 外部接口：XDamageDestroy/XFixesDestroyRegion/XCloseDisplay，drd_x11_shm_ring_detach 分离帧环，drd_x11_capture_release_shm_image 回收 XShm 与 SysV 共享内存。
  */
 static void drd_x11_capture_cleanup_locked(DrdX11Capture *self)
 {
@@ -309,36 +561,35 @@ static void drd_x11_capture_cleanup_locked(DrdX11Capture *self)
         self->damage = 0;
     }
 
-    if (self->attached && self->display != NULL)
+    if (self->damage_region != None && self->display != NULL)
     {
-        XShmDetach(self->display, &self->shm.info);
-        self->attached = FALSE;
+        XFixesDestroyRegion(self->display, self->damage_region);
+        self->damage_region = None;
     }
 
-    if (self->image != NULL)
+    if (self->outputs != NULL)
     {
-        self->image->data = NULL;
-        XDestroyImage(self->image);
-        self->image = NULL;
-    }
-
-    if (self->shm.info.shmaddr != NULL)
-    {
-        shmdt(self->shm.info.shmaddr);
-        self->shm.info.shmaddr = NULL;
+        for (guint i = 0; i < self->outputs->len; i++)
+        {
+            DrdX11CaptureOutput *output = &g_array_index(self->outputs, DrdX11CaptureOutput, i);
+            if (output->ring != NULL)
+            {
+                drd_x11_shm_ring_detach(output->ring, self->display);
+                g_clear_object(&output->ring);
+            }
+            g_clear_pointer(&output->rects, g_array_unref);
+            g_clear_pointer(&output->pending_reads, g_array_unref);
+        }
+        g_clear_pointer(&self->outputs, g_array_unref);
     }
 
-    if (self->shm.info.shmid >= 0)
-    {
-        shmctl(self->shm.info.shmid, IPC_RMID, NULL);
-        self->shm.info.shmid = -1;
-        self->shm.info.shmseg = 0;
-    }
+    drd_x11_capture_release_shm_image(self, &self->rect_shm, &self->rect_image, &self->rect_attached);
 
     if (self->display != NULL)
     {
         XCloseDisplay(self->display);
         self->display = NULL;
+        self->xcb = NULL;
     }
 }
 
@@ -407,12 +658,315 @@ gboolean drd_x11_capture_is_running(DrdX11Capture *self)
     return running;
 }
 
+/*
+ * 功能：取回本周期累积的损坏矩形。
+ * 逻辑：把 XDamage 累积的区域转移到 XFixes region 并取回矩形，裁剪到根窗口捕获范围后输出（桌面坐标）。
+ * 参数：self 捕获实例；display X 连接；rects 输出裁剪后的损坏矩形。
+ * 外部接口：XDamageSubtract/XFixesFetchRegion 获取损坏区域；XFree 释放矩形数组。
+ */
+static void drd_x11_capture_collect_damage(DrdX11Capture *self, Display *display, GArray *rects)
+{
+    int n_boxes = 0;
+
+    g_array_set_size(rects, 0);
+    XDamageSubtract(display, self->damage, None, self->damage_region);
+    XRectangle *boxes = XFixesFetchRegion(display, self->damage_region, &n_boxes);
+    for (int i = 0; i < n_boxes; i++)
+    {
+        const gint x0 = MAX((gint) boxes[i].x, 0);
+        const gint y0 = MAX((gint) boxes[i].y, 0);
+        const gint x1 = MIN((gint) boxes[i].x + (gint) boxes[i].width, (gint) self->width);
+        const gint y1 = MIN((gint) boxes[i].y + (gint) boxes[i].height, (gint) self->height);
+        if (x1 <= x0 || y1 <= y0)
+        {
+            continue;
+        }
+
+        DrdFrameRect rect = {(guint) x0, (guint) y0, (guint) (x1 - x0), (guint) (y1 - y0)};
+        g_array_append_val(rects, rect);
+    }
+    if (boxes != NULL)
+    {
+        XFree(boxes);
+    }
+}
+
+/*
+ * 功能：把桌面损坏矩形分配到单个捕获输出，并决定该输出本帧是否整屏读回。
+ * 逻辑：按输出区域裁剪并平移为输出内坐标；矩形过多时合并为外接矩形；帧环尚无有效内容或损坏面积超过阈值时标记整屏读回。
+ * 参数：output 捕获输出；rects 桌面坐标的损坏矩形。
+ * 外部接口：drd_x11_shm_ring_has_latest 判断帧环是否已有参考内容。
+ */
+static void drd_x11_capture_plan_output(DrdX11CaptureOutput *output, GArray *rects)
+{
+    const DrdMonitorInfo *monitor = &output->monitor;
+    guint64 damaged_pixels = 0;
+
+    g_array_set_size(output->rects, 0);
+    for (guint i = 0; i < rects->len; i++)
+    {
+        const DrdFrameRect *rect = &g_array_index(rects, DrdFrameRect, i);
+        const gint x0 = MAX((gint) rect->x, monitor->x);
+        const gint y0 = MAX((gint) rect->y, monitor->y);
+        const gint x1 = MIN((gint) (rect->x + rect->width), monitor->x + (gint) monitor->width);
+        const gint y1 = MIN((gint) (rect->y + rect->height), monitor->y + (gint) monitor->height);
+        if (x1 <= x0 || y1 <= y0)
+        {
+            continue;
+        }
+
+        DrdFrameRect local = {(guint) (x0 - monitor->x), (guint) (y0 - monitor->y), (guint) (x1 - x0), (guint) (y1 - y0)};
+        g_array_append_val(output->rects, local);
+        damaged_pixels += (guint64) local.width * local.height;
+    }
+
+    if (output->rects->len > DRD_X11_CAPTURE_MAX_DAMAGE_RECTS)
+    {
+        guint x0 = G_MAXUINT;
+        guint y0 = G_MAXUINT;
+        guint x1 = 0;
+        guint y1 = 0;
+        for (guint i = 0; i < output->rects->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(output->rects, DrdFrameRect, i);
+            x0 = MIN(x0, rect->x);
+            y0 = MIN(y0, rect->y);
+            x1 = MAX(x1, rect->x + rect->width);
+            y1 = MAX(y1, rect->y + rect->height);
+        }
+        DrdFrameRect bounds = {x0, y0, x1 - x0, y1 - y0};
+        g_array_set_size(output->rects, 1);
+        g_array_index(output->rects, DrdFrameRect, 0) = bounds;
+        damaged_pixels = (guint64) bounds.width * bounds.height;
+    }
+
+    output->full = !output->backing_valid || !drd_x11_shm_ring_has_latest(output->ring);
+    const guint64 output_pixels = (guint64) monitor->width * (guint64) monitor->height;
+    output->full_fetch = output->full || (gdouble) damaged_pixels >= (gdouble) output_pixels * DRD_X11_CAPTURE_FULL_FETCH_RATIO;
+}
+
+/*
+ * 功能：发出单个输出本帧所需的全部 XCB SHM 读回请求，不等待应答也不 flush。
+ * 逻辑：整屏读回时直接以槽位共享内存段为目标发出单个请求（按输出原点截取根窗口）；否则把各损坏矩形按紧凑行距依次排布在暂存段中（偏移按 64 字节对齐，
+ * 从各输出共用的 staging_offset 继续排布），每个矩形各发一个 xcb_shm_get_image 并记录 cookie；暂存段剩余空间放不下本输出的矩形时（镜像等显示器重叠的布局）改为整屏读回。
+ * 参数：self 捕获实例；root 根窗口；output 已领取槽位的捕获输出；staging_offset 输入输出暂存段已用字节数。
+ * 外部接口：xcb_shm_get_image 发出异步读回请求；drd_x11_shm_ring_get_segment 获取槽位段标识。
+ */
+static void drd_x11_capture_issue_reads(DrdX11Capture *self, Window root, DrdX11CaptureOutput *output, gsize *staging_offset)
+{
+    const DrdMonitorInfo *monitor = &output->monitor;
+    XImage *image = drd_x11_shm_ring_get_image(output->ring, output->slot);
+    const gsize staging_size = (gsize) self->rect_image->bytes_per_line * (gsize) self->rect_image->height;
+    gsize offset = *staging_offset;
+
+    g_array_set_size(output->pending_reads, 0);
+    if (!output->full_fetch)
+    {
+        for (guint i = 0; i < output->rects->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(output->rects, DrdFrameRect, i);
+            const gsize pitch = (((gsize) rect->width * (gsize) image->bits_per_pixel + (gsize) image->bitmap_pad - 1) / (gsize) image->bitmap_pad) * ((gsize) image->bitmap_pad / 8);
+            offset += (pitch * rect->height + 63) & ~(gsize) 63;
+        }
+        output->full_fetch = offset > staging_size;
+        offset = *staging_offset;
+    }
+
+    if (output->full_fetch)
+    {
+        DrdX11PendingRead read = {0};
+        read.cookie = xcb_shm_get_image(self->xcb, (xcb_drawable_t) root, (int16_t) monitor->x, (int16_t) monitor->y, (uint16_t) monitor->width, (uint16_t) monitor->height,
+                                        G_MAXUINT32, XCB_IMAGE_FORMAT_Z_PIXMAP, (xcb_shm_seg_t) drd_x11_shm_ring_get_segment(output->ring, output->slot), 0);
+        read.direct = TRUE;
+        g_array_append_val(output->pending_reads, read);
+        return;
+    }
+
+    for (guint i = 0; i < output->rects->len; i++)
+    {
+        const DrdFrameRect *rect = &g_array_index(output->rects, DrdFrameRect, i);
+        DrdX11PendingRead read = {0};
+
+        /* 服务端按 bitmap_pad 对齐的紧凑行距把矩形写入暂存段 */
+        read.rect = *rect;
+        read.pitch = (((gsize) rect->width * (gsize) image->bits_per_pixel + (gsize) image->bitmap_pad - 1) / (gsize) image->bitmap_pad) * ((gsize) image->bitmap_pad / 8);
+        read.offset = offset;
+        read.cookie = xcb_shm_get_image(self->xcb, (xcb_drawable_t) root, (int16_t) (monitor->x + (gint) rect->x), (int16_t) (monitor->y + (gint) rect->y), (uint16_t) rect->width,
+                                        (uint16_t) rect->height, G_MAXUINT32, XCB_IMAGE_FORMAT_Z_PIXMAP, (xcb_shm_seg_t) self->rect_shm.info.shmseg, (uint32_t) offset);
+        g_array_append_val(output->pending_reads, read);
+        offset += (read.pitch * rect->height + 63) & ~(gsize) 63;
+    }
+    *staging_offset = offset;
+}
+
+/*
+ * 功能：回收单个输出已发出的读回请求，把矩形像素写入槽位。
+ * 逻辑：按发出顺序逐个等待应答（首个应答到达时其余读回通常已在服务端完成）；整屏请求直接落在槽位无需拷贝，矩形请求从暂存段按行拷贝到槽位对应位置；
+ * 任一请求失败时仍回收剩余 cookie，并使该输出的后备内容失效以便下一帧整屏读回。
+ * 参数：self 捕获实例；output 已领取槽位的捕获输出。
+ * 外部接口：xcb_shm_get_image_reply 等待应答；C 库 free/memcpy。
+ */
+static gboolean drd_x11_capture_reap_reads(DrdX11Capture *self, DrdX11CaptureOutput *output)
+{
+    XImage *image = drd_x11_shm_ring_get_image(output->ring, output->slot);
+    const gsize bytes_per_pixel = (gsize) image->bits_per_pixel / 8;
+    gboolean ok = TRUE;
+
+    for (guint i = 0; i < output->pending_reads->len; i++)
+    {
+        const DrdX11PendingRead *read = &g_array_index(output->pending_reads, DrdX11PendingRead, i);
+        xcb_generic_error_t *xcb_error = NULL;
+        xcb_shm_get_image_reply_t *reply = xcb_shm_get_image_reply(self->xcb, read->cookie, &xcb_error);
+
+        if (reply == NULL)
+        {
+            free(xcb_error);
+            ok = FALSE;
+            continue;
+        }
+        free(reply);
+
+        if (!ok || read->direct)
+        {
+            continue;
+        }
+
+        const gsize row_bytes = (gsize) read->rect.width * bytes_per_pixel;
+        const guint8 *src = (const guint8 *) self->rect_shm.info.shmaddr + read->offset;
+        guint8 *dst = (guint8 *) image->data + (gsize) read->rect.y * (gsize) image->bytes_per_line + (gsize) read->rect.x * bytes_per_pixel;
+        for (guint row = 0; row < read->rect.height; row++)
+        {
+            memcpy(dst, src, row_bytes);
+            src += read->pitch;
+            dst += image->bytes_per_line;
+        }
+    }
+
+    g_array_set_size(output->pending_reads, 0);
+    output->backing_valid = ok;
+    return ok;
+}
+
+/*
+ * 功能：为全部捕获输出领取帧环槽位。
+ * 逻辑：依次领取各输出槽位，任一输出无空闲槽位时归还已领取的槽位并返回失败，保证各显示器在同一周期内一起抓帧。
+ * 参数：outputs 捕获输出数组。
+ * 外部接口：drd_x11_shm_ring_acquire/abort。
+ */
+static gboolean drd_x11_capture_acquire_slots(GArray *outputs)
+{
+    for (guint i = 0; i < outputs->len; i++)
+    {
+        DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+        output->slot = drd_x11_shm_ring_acquire(output->ring);
+        if (output->slot >= 0)
+        {
+            continue;
+        }
+
+        for (guint j = 0; j < i; j++)
+        {
+            DrdX11CaptureOutput *acquired = &g_array_index(outputs, DrdX11CaptureOutput, j);
+            drd_x11_shm_ring_abort(acquired->ring, acquired->slot);
+            acquired->slot = -1;
+        }
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：发布单个输出已读回的槽位。
+ * 逻辑：发布槽位并包装为帧，增量帧标注损坏矩形，记录显示器编号与原点后入队。
+ * 参数：self 捕获实例；output 已回收读回的捕获输出；index 输出编号；timestamp 帧时间戳；out_damage_pixels 累加本帧损坏像素数。
+ * 外部接口：drd_x11_shm_ring_publish/wrap_frame；drd_frame_set_damage/set_monitor 与 drd_frame_queue_push。
+ */
+static void drd_x11_capture_publish_output(DrdX11Capture *self, DrdX11CaptureOutput *output, guint index, guint64 timestamp, guint64 *out_damage_pixels)
+{
+    drd_x11_shm_ring_publish(output->ring, output->slot, (const DrdFrameRect *) output->rects->data, output->rects->len, output->full);
+    g_autoptr(DrdFrame) frame = drd_x11_shm_ring_wrap_frame(output->ring, output->slot, timestamp);
+    output->slot = -1;
+    if (output->full)
+    {
+        *out_damage_pixels += (guint64) output->monitor.width * output->monitor.height;
+    }
+    else
+    {
+        drd_frame_set_damage(frame, (const DrdFrameRect *) output->rects->data, output->rects->len);
+        for (guint i = 0; i < output->rects->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(output->rects, DrdFrameRect, i);
+            *out_damage_pixels += (guint64) rect->width * rect->height;
+        }
+    }
+    drd_frame_set_monitor(frame, index, output->monitor.x, output->monitor.y);
+    drd_frame_queue_push(self->queue, frame);
+}
+
+/*
+ * 功能：读回并发布全部捕获输出的帧。
+ * 逻辑：先为每个有损坏的输出发出读回请求（无损坏的输出直接归还槽位），全部请求一次 flush，使各显示器的读回在服务端连续执行；
+ * 请求在途期间依次同步各增量输出的槽位过期区域，之后按输出回收应答，成功的输出发布入队，失败的输出归还槽位。
+ * 参数：self 捕获实例；root 根窗口；outputs 已领取槽位的捕获输出数组；timestamp 帧时间戳；out_damage_pixels 累加本帧损坏像素数。
+ * 外部接口：drd_x11_capture_issue_reads/reap_reads/publish_output；xcb_flush；drd_x11_shm_ring_sync_slot/abort。
+ */
+static gboolean drd_x11_capture_emit_outputs(DrdX11Capture *self, Window root, GArray *outputs, guint64 timestamp, guint64 *out_damage_pixels)
+{
+    gsize staging_offset = 0;
+    gboolean ok = TRUE;
+
+    for (guint i = 0; i < outputs->len; i++)
+    {
+        DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+        if (!output->full_fetch && output->rects->len == 0)
+        {
+            drd_x11_shm_ring_abort(output->ring, output->slot);
+            output->slot = -1;
+            continue;
+        }
+        drd_x11_capture_issue_reads(self, root, output, &staging_offset);
+    }
+    xcb_flush(self->xcb);
+
+    /* 读回请求全部在途时同步槽位过期区域，CPU 拷贝与服务端读回重叠 */
+    for (guint i = 0; i < outputs->len; i++)
+    {
+        DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+        if (output->slot >= 0 && !output->full_fetch)
+        {
+            drd_x11_shm_ring_sync_slot(output->ring, output->slot);
+        }
+    }
+
+    for (guint i = 0; i < outputs->len; i++)
+    {
+        DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+        if (output->slot < 0)
+        {
+            continue;
+        }
+        if (!drd_x11_capture_reap_reads(self, output))
+        {
+            drd_x11_shm_ring_abort(output->ring, output->slot);
+            output->slot = -1;
+            ok = FALSE;
+            continue;
+        }
+        drd_x11_capture_publish_output(self, output, i, timestamp, out_damage_pixels);
+    }
+    return ok;
+}
+
 /*
  * 功能：捕获线程主循环，从 X11 拉帧并写入队列。
- * 逻辑：循环读取运行状态与资源；按 target_interval 驱动一次事件消费与抓帧，期间用 g_poll 监听 X 连接和唤醒管道；每个间隔都会触发一次抓帧，XDamage 事件仅用于清理队列与统计，避免被合成器合并后的事件频率限制帧率。
+ * 逻辑：循环读取运行状态与资源；用 g_poll 监听 X 连接和唤醒管道，有待处理损坏时等待到下一个抓帧时刻，抓帧间隔取自帧队列的下游反馈（跟随编码与确认速率，空闲放宽、输入即恢复）；
+ * 到抓帧时刻若队列容不下本轮各输出的帧则保留损坏稍后重试，避免采集后又在队列中被丢弃；XDamage 事件只标记存在损坏，损坏区域留在服务端累积，
+ * 到抓帧时刻为每个捕获输出（单流模式为整个根窗口，多显示器模式为各 XRandR 显示器）领取帧环槽位，一次性取回损坏后按输出裁剪，把所有输出全部矩形的 XCB SHM 读回请求一起发出，
+ * 在应答返回前同步各槽位过期区域，回收应答后只把损坏矩形拷入槽位，发布后直接包装为带显示器编号的帧入队（无额外分配与整帧拷贝）；任一输出槽位全部被下游持有时保留损坏等待下一周期，读回失败时保留待处理标记在下一周期重读；
+ * 统计周期内输出帧率、当前抓帧间隔、损坏面积占比、槽位繁忙与反压推迟次数。
  * 参数：user_data 线程参数，DrdX11Capture 实例。
- * 外部接口：XPending/XNextEvent/XDamageSubtract 处理 Damage 事件；g_poll 监听文件描述符；XShmGetImage 抓帧；glib 时间函数 g_get_monotonic_time；DrdFrame API drd_frame_new/configure/ensure_capacity 与 drd_frame_queue_push；日志
- * DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ * 外部接口：XPending/XNextEvent 处理 Damage 事件；g_poll 监听文件描述符；drd_frame_queue_get_pacing_interval_us/can_accept 读取下游反馈；drd_x11_capture_acquire_slots/collect_damage/plan_output/emit_outputs 取回损坏并流水线读回；
+ * glib 时间函数 g_get_monotonic_time；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
  */
 static gpointer drd_x11_capture_thread(gpointer user_data)
 {
@@ -423,33 +977,33 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
     const gint64 stats_interval = drd_capture_metrics_get_stats_interval_us();
     gint64 stats_window_start = 0;
     guint stats_frames = 0;
+    guint64 stats_damage_pixels = 0;
+    guint stats_ring_busy = 0;
+    guint stats_deferred = 0;
     gint64 next_capture_deadline = 0;
     gint64 now = 0;
+    gboolean damage_pending = FALSE;
+    g_autoptr(GArray) damage_rects = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
 
     while (TRUE)
     {
         Display *display = NULL;
-        XImage *image = NULL;
+        GArray *outputs = NULL;
         Window root;
         int damage_event_base = 0;
-        guint width = 0;
-        guint height = 0;
         gboolean running;
         int wake_fd = -1;
-        gboolean damage = FALSE;
 
         g_mutex_lock(&self->state_mutex);
         running = self->running;
         display = self->display;
-        image = self->image;
+        outputs = self->outputs;
         root = self->root;
         damage_event_base = self->damage_event_base;
-        width = self->width;
-        height = self->height;
         wake_fd = self->wakeup_pipe[0];
         g_mutex_unlock(&self->state_mutex);
 
-        if (!running || display == NULL || image == NULL)
+        if (!running || display == NULL || outputs == NULL || outputs->len == 0)
         {
             DRD_LOG_MESSAGE("break x11 capture thread");
             break;
@@ -459,6 +1013,7 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
         {
             next_capture_deadline = g_get_monotonic_time();
         }
+        const gint64 capture_interval = drd_frame_queue_get_pacing_interval_us(self->queue, target_interval, outputs->len);
         GPollFD pfds[2];
         nfds_t poll_count = 0;
         int wake_index = -1;
@@ -476,7 +1031,14 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
             poll_count++;
         }
 
-        gint poll_result = g_poll(pfds, poll_count, target_interval / 1000);
+        gint poll_timeout_ms = (gint) (target_interval / 1000);
+        if (damage_pending)
+        {
+            const gint64 wait_us = next_capture_deadline - g_get_monotonic_time();
+            poll_timeout_ms = wait_us > 0 ? (gint) ((wait_us + 999) / 1000) : 0;
+        }
+
+        gint poll_result = g_poll(pfds, poll_count, poll_timeout_ms);
         if (poll_result < 0)
         {
             continue;
@@ -492,11 +1054,10 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
             XNextEvent(display, &event);
             if (event.type == damage_event_base + XDamageNotify)
             {
-                XDamageSubtract(display, self->damage, None, None);
-                damage = TRUE;
+                damage_pending = TRUE;
             }
         }
-        if (!damage)
+        if (!damage_pending)
             continue;
         now = g_get_monotonic_time();
         if (now < next_capture_deadline)
@@ -504,25 +1065,55 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
             continue;
         }
 
-        if (!XShmGetImage(display, root, image, 0, 0, AllPlanes))
+        if (!drd_frame_queue_can_accept(self->queue, outputs->len))
         {
-            DRD_LOG_WARNING("XShmGetImage failed, retrying");
-            next_capture_deadline = now + target_interval;
+            /* 下游尚未取走上一轮的帧：损坏留在服务端累积，稍后重试而不是采集后在队列里丢弃 */
+            stats_deferred++;
+            next_capture_deadline = now + DRD_X11_CAPTURE_BACKPRESSURE_RETRY_US;
             continue;
         }
-        stats_frames++;
-        g_autoptr(DrdFrame) frame = drd_frame_new();
-        now = g_get_monotonic_time();
-        drd_frame_configure(frame, width, height, (guint) image->bytes_per_line, (guint64) now);
 
-        const gsize frame_size = (gsize) image->bytes_per_line * (gsize) image->height;
-        guint8 *buffer = drd_frame_ensure_capacity(frame, frame_size);
-        if (buffer != NULL)
+        if (!drd_x11_capture_acquire_slots(outputs))
         {
-            memcpy(buffer, image->data, frame_size);
-            drd_frame_queue_push(self->queue, frame);
+            /* 槽位仍被下游持有：损坏留在服务端，下一周期再取 */
+            stats_ring_busy++;
+            next_capture_deadline = now + capture_interval;
+            continue;
         }
 
+        drd_x11_capture_collect_damage(self, display, damage_rects);
+        damage_pending = FALSE;
+
+        gboolean any_work = FALSE;
+        for (guint i = 0; i < outputs->len; i++)
+        {
+            DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+            drd_x11_capture_plan_output(output, damage_rects);
+            any_work = any_work || output->full_fetch || output->rects->len > 0;
+        }
+
+        if (!any_work)
+        {
+            for (guint i = 0; i < outputs->len; i++)
+            {
+                DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+                drd_x11_shm_ring_abort(output->ring, output->slot);
+                output->slot = -1;
+            }
+            continue;
+        }
+        if (!drd_x11_capture_emit_outputs(self, root, outputs, (guint64) g_get_monotonic_time(), &stats_damage_pixels))
+        {
+            /* 损坏已从服务端取走，失败的输出后备内容已失效：保留待处理标记，下一周期按截止时间整屏重读，而不是等待新的 XDamage 事件 */
+            DRD_LOG_WARNING("xcb_shm_get_image failed, retrying");
+            damage_pending = TRUE;
+            next_capture_deadline = now + capture_interval;
+            continue;
+        }
+
+        stats_frames++;
+        now = g_get_monotonic_time();
+
         if (stats_window_start == 0)
         {
             stats_window_start = now;
@@ -532,18 +1123,30 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
             const gint64 stats_elapsed = now - stats_window_start;
             if (stats_elapsed >= stats_interval)
             {
+                guint64 capture_pixels = 0;
+                for (guint i = 0; i < outputs->len; i++)
+                {
+                    const DrdX11CaptureOutput *output = &g_array_index(outputs, DrdX11CaptureOutput, i);
+                    capture_pixels += (guint64) output->monitor.width * output->monitor.height;
+                }
                 const gdouble actual_fps = (gdouble) stats_frames * (gdouble) G_USEC_PER_SEC / (gdouble) stats_elapsed;
                 const gboolean reached_target = actual_fps >= (gdouble) target_fps;
-                DRD_LOG_MESSAGE("X11 capture fps=%.2f (target=%u): %s", actual_fps, target_fps, reached_target ? "reached target" : "below target");
+                const gdouble damage_ratio = stats_frames > 0 ? (gdouble) stats_damage_pixels * 100.0 / ((gdouble) stats_frames * (gdouble) capture_pixels) : 0.0;
+                DRD_LOG_MESSAGE("X11 capture fps=%.2f (target=%u, outputs=%u): %s, interval=%.1fms, damage=%.1f%%, ring busy=%u, deferred=%u",
+                                actual_fps, target_fps, outputs->len, reached_target ? "reached target" : "below target",
+                                (gdouble) capture_interval / 1000.0, damage_ratio, stats_ring_busy, stats_deferred);
                 stats_frames = 0;
+                stats_damage_pixels = 0;
+                stats_ring_busy = 0;
+                stats_deferred = 0;
                 stats_window_start = now;
             }
         }
 
-        next_capture_deadline += target_interval;
+        next_capture_deadline += capture_interval;
         if (next_capture_deadline < now)
         {
-            next_capture_deadline = now + target_interval;
+            next_capture_deadline = now + capture_interval;
         }
     }
 
@@ -553,7 +1156,7 @@ static gpointer drd_x11_capture_thread(gpointer user_data)
 
 /*
  * 功能：创建唤醒管道供线程退出时使用。
- * 逻辑：若已有管道直接返回；否则通过 g_unix_open_pipe 创建带 CLOEXEC 标志的管道并缓存 fd。
+ * 逻辑：若已有管道直接返回；否则通过 g_unix_open_pipe 创建带 CLOEXEC 标志的管道并缓存 fd（GLib 2.78 之前只接受 FD_CLOEXEC）。
  * 参数：self 捕获实例；error 错误输出。
  * 外部接口：glib-unix g_unix_open_pipe 创建管道。
  */
@@ -565,7 +1168,7 @@ static gboolean drd_x11_capture_setup_wakeup_pipe(DrdX11Capture *self, GError **
     }
 
     int fds[2] = {-1, -1};
-    if (!g_unix_open_pipe(fds, O_CLOEXEC, error))
+    if (!g_unix_open_pipe(fds, FD_CLOEXEC, error))
     {
         return FALSE;
     }
@@ -636,3 +1239,73 @@ static void drd_x11_capture_drain_wakeup_pipe(int fd)
         break;
     }
 }
+
+/*
+ * 功能：捕获后端接口 start 适配。
+ * 逻辑：使用默认显示调用 drd_x11_capture_start。
+ * 参数：backend 捕获后端；width/height 期望尺寸；n_frame_slots 每个输出的帧环槽位数；error 错误输出。
+ * 外部接口：drd_x11_capture_start。
+ */
+static gboolean drd_x11_capture_backend_start(DrdCaptureBackend *backend, guint width, guint height, guint n_frame_slots, GError **error)
+{
+    return drd_x11_capture_start(DRD_X11_CAPTURE(backend), NULL, width, height, n_frame_slots, error);
+}
+
+/*
+ * 功能：捕获后端接口 stop 适配。
+ * 逻辑：转发到 drd_x11_capture_stop。
+ * 参数：backend 捕获后端。
+ * 外部接口：drd_x11_capture_stop。
+ */
+static void drd_x11_capture_backend_stop(DrdCaptureBackend *backend)
+{
+    drd_x11_capture_stop(DRD_X11_CAPTURE(backend));
+}
+
+/*
+ * 功能：捕获后端接口 is_running 适配。
+ * 逻辑：转发到 drd_x11_capture_is_running。
+ * 参数：backend 捕获后端。
+ * 外部接口：drd_x11_capture_is_running。
+ */
+static gboolean drd_x11_capture_backend_is_running(DrdCaptureBackend *backend)
+{
+    return drd_x11_capture_is_running(DRD_X11_CAPTURE(backend));
+}
+
+/*
+ * 功能：捕获后端接口 get_display_size 适配。
+ * 逻辑：使用默认显示调用 drd_x11_capture_get_display_size。
+ * 参数：backend 捕获后端；out_width/out_height 输出尺寸；error 错误输出。
+ * 外部接口：drd_x11_capture_get_display_size。
+ */
+static gboolean drd_x11_capture_backend_get_display_size(DrdCaptureBackend *backend, guint *out_width, guint *out_height, GError **error)
+{
+    return drd_x11_capture_get_display_size(DRD_X11_CAPTURE(backend), NULL, out_width, out_height, error);
+}
+
+/*
+ * 功能：捕获后端接口 get_monitors 适配。
+ * 逻辑：使用默认显示调用 drd_x11_capture_get_monitors。
+ * 参数：backend 捕获后端；out_monitors 输出显示器数组；error 错误输出。
+ * 外部接口：drd_x11_capture_get_monitors。
+ */
+static gboolean drd_x11_capture_backend_get_monitors(DrdCaptureBackend *backend, GArray *out_monitors, GError **error)
+{
+    return drd_x11_capture_get_monitors(DRD_X11_CAPTURE(backend), NULL, out_monitors, error);
+}
+
+/*
+ * 功能：挂载捕获后端接口实现。
+ * 逻辑：把各接口方法指向 X11 适配函数。
+ * 参数：iface 接口结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void drd_x11_capture_backend_iface_init(DrdCaptureBackendInterface *iface)
+{
+    iface->start = drd_x11_capture_backend_start;
+    iface->stop = drd_x11_capture_backend_stop;
+    iface->is_running = drd_x11_capture_backend_is_running;
+    iface->get_display_size = drd_x11_capture_backend_get_display_size;
+    iface->get_monitors = drd_x11_capture_backend_get_monitors;
+}
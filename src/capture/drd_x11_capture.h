@@ -13,7 +13,7 @@ DrdX11Capture *drd_x11_capture_new(DrdFrameQueue *queue);
 
 gboolean drd_x11_capture_start(DrdX11Capture *self, const gchar *display_name,
                                guint requested_width, guint requested_height,
-                               GError **error);
+                               guint n_frame_slots, GError **error);
 
 void drd_x11_capture_stop(DrdX11Capture *self);
 gboolean drd_x11_capture_is_running(DrdX11Capture *self);
@@ -21,5 +21,10 @@ gboolean drd_x11_capture_get_display_size(DrdX11Capture *self,
                                           const gchar *display_name,
                                           guint *out_width, guint *out_height,
                                           GError **error);
+gboolean drd_x11_capture_get_monitors(DrdX11Capture *self,
+                                      const gchar *display_name,
+                                      GArray *out_monitors,
+                                      GError **error);
+void drd_x11_capture_set_per_monitor(DrdX11Capture *self, gboolean per_monitor);
 
 G_END_DECLS
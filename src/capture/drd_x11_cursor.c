@@ -0,0 +1,477 @@
+#include "capture/drd_x11_cursor.h"
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+
+#include <gio/gio.h>
+#include <glib-unix.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "utils/drd_capture_metrics.h"
+#include "utils/drd_log.h"
+
+struct _DrdX11Cursor
+{
+    GObject parent_instance;
+
+    GMutex state_mutex;
+    GThread *thread;
+    gboolean running;
+
+    Display *display;
+    Window root;
+    int fixes_event_base;
+    int wakeup_pipe[2];
+
+    DrdCursorShape *shape;
+    guint64 generation;
+    gint x;
+    gint y;
+    gboolean has_position;
+};
+
+G_DEFINE_TYPE(DrdX11Cursor, drd_x11_cursor, G_TYPE_OBJECT)
+
+static gpointer drd_x11_cursor_thread(gpointer user_data);
+
+/*
+ * 功能：释放光标形状快照的像素数据。
+ * 逻辑：作为 g_atomic_rc_box 的清理回调释放 GBytes。
+ * 参数：data 光标形状。
+ * 外部接口：GLib g_bytes_unref。
+ */
+static void
+drd_cursor_shape_clear(gpointer data)
+{
+    DrdCursorShape *shape = data;
+    g_clear_pointer(&shape->pixels, g_bytes_unref);
+}
+
+/*
+ * 功能：增加光标形状引用。
+ * 逻辑：原子递增引用计数。
+ * 参数：shape 光标形状。
+ * 外部接口：GLib g_atomic_rc_box_acquire。
+ */
+DrdCursorShape *
+drd_cursor_shape_ref(DrdCursorShape *shape)
+{
+    g_return_val_if_fail(shape != NULL, NULL);
+    return g_atomic_rc_box_acquire(shape);
+}
+
+/*
+ * 功能：释放光标形状引用。
+ * 逻辑：原子递减引用计数，归零时释放像素数据。
+ * 参数：shape 光标形状。
+ * 外部接口：GLib g_atomic_rc_box_release_full。
+ */
+void
+drd_cursor_shape_unref(DrdCursorShape *shape)
+{
+    g_return_if_fail(shape != NULL);
+    g_atomic_rc_box_release_full(shape, drd_cursor_shape_clear);
+}
+
+/*
+ * 功能：释放光标跟踪器资源。
+ * 逻辑：停止线程后释放当前形状，交由父类 dispose。
+ * 参数：object 基类指针。
+ * 外部接口：drd_x11_cursor_stop；GLib g_clear_pointer。
+ */
+static void
+drd_x11_cursor_dispose(GObject *object)
+{
+    DrdX11Cursor *self = DRD_X11_CURSOR(object);
+
+    drd_x11_cursor_stop(self);
+    g_clear_pointer(&self->shape, drd_cursor_shape_unref);
+
+    G_OBJECT_CLASS(drd_x11_cursor_parent_class)->dispose(object);
+}
+
+/*
+ * 功能：清理互斥锁。
+ * 逻辑：销毁 state_mutex 后调用父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_mutex_clear。
+ */
+static void
+drd_x11_cursor_finalize(GObject *object)
+{
+    DrdX11Cursor *self = DRD_X11_CURSOR(object);
+    g_mutex_clear(&self->state_mutex);
+    G_OBJECT_CLASS(drd_x11_cursor_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：挂载 dispose/finalize。
+ * 逻辑：设置 GObjectClass 回调。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_x11_cursor_class_init(DrdX11CursorClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = drd_x11_cursor_dispose;
+    object_class->finalize = drd_x11_cursor_finalize;
+}
+
+/*
+ * 功能：初始化实例字段。
+ * 逻辑：初始化互斥锁，唤醒管道置为无效。
+ * 参数：self 光标跟踪器。
+ * 外部接口：GLib g_mutex_init。
+ */
+static void
+drd_x11_cursor_init(DrdX11Cursor *self)
+{
+    g_mutex_init(&self->state_mutex);
+    self->wakeup_pipe[0] = -1;
+    self->wakeup_pipe[1] = -1;
+}
+
+/*
+ * 功能：创建光标跟踪器。
+ * 逻辑：调用 g_object_new。
+ * 参数：无。
+ * 外部接口：GLib g_object_new。
+ */
+DrdX11Cursor *
+drd_x11_cursor_new(void)
+{
+    return g_object_new(DRD_TYPE_X11_CURSOR, NULL);
+}
+
+/*
+ * 功能：读取当前光标图像并转换为形状快照。
+ * 逻辑：XFixesGetCursorImage 取回光标；把 unsigned long 承载的预乘 ARGB 像素压成 32 位 BGRA；全部像素透明或尺寸为 0 时标记隐藏；同时输出光标位置。
+ * 参数：display X 连接；out_x/out_y 输出光标位置。
+ * 外部接口：XFixesGetCursorImage/XFree；GLib g_atomic_rc_box_new0/g_bytes_new_take。
+ */
+static DrdCursorShape *
+drd_x11_cursor_fetch_shape(Display *display, gint *out_x, gint *out_y)
+{
+    XFixesCursorImage *image = XFixesGetCursorImage(display);
+    if (image == NULL)
+    {
+        return NULL;
+    }
+
+    DrdCursorShape *shape = g_atomic_rc_box_new0(DrdCursorShape);
+    shape->serial = (guint32) image->cursor_serial;
+    shape->width = image->width;
+    shape->height = image->height;
+    shape->hotspot_x = image->xhot;
+    shape->hotspot_y = image->yhot;
+    shape->hidden = TRUE;
+
+    const gsize n_pixels = (gsize) image->width * (gsize) image->height;
+    guint32 *pixels = g_new(guint32, MAX(n_pixels, 1));
+    for (gsize i = 0; i < n_pixels; i++)
+    {
+        /* XFixes 在 64 位平台上以 unsigned long 存放 32 位像素 */
+        pixels[i] = GUINT32_TO_LE((guint32) image->pixels[i]);
+        if ((pixels[i] & GUINT32_TO_LE(0xff000000u)) != 0)
+        {
+            shape->hidden = FALSE;
+        }
+    }
+    shape->pixels = g_bytes_new_take(pixels, n_pixels * sizeof(guint32));
+
+    *out_x = image->x;
+    *out_y = image->y;
+    XFree(image);
+    return shape;
+}
+
+/*
+ * 功能：发布新的光标形状。
+ * 逻辑：持锁替换当前形状、递增代数并更新位置。
+ * 参数：self 光标跟踪器；shape (transfer full) 新形状；x/y 光标位置。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+static void
+drd_x11_cursor_publish_shape(DrdX11Cursor *self, DrdCursorShape *shape, gint x, gint y)
+{
+    g_mutex_lock(&self->state_mutex);
+    g_clear_pointer(&self->shape, drd_cursor_shape_unref);
+    self->shape = shape;
+    self->generation++;
+    self->x = x;
+    self->y = y;
+    self->has_position = TRUE;
+    g_mutex_unlock(&self->state_mutex);
+}
+
+/*
+ * 功能：关闭唤醒管道与 X 连接。
+ * 逻辑：关闭有效 fd 并置 -1；关闭 Display。
+ * 参数：self 光标跟踪器。
+ * 外部接口：POSIX close；XCloseDisplay。
+ */
+static void
+drd_x11_cursor_cleanup(DrdX11Cursor *self)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (self->wakeup_pipe[i] >= 0)
+        {
+            close(self->wakeup_pipe[i]);
+            self->wakeup_pipe[i] = -1;
+        }
+    }
+
+    if (self->display != NULL)
+    {
+        XCloseDisplay(self->display);
+        self->display = NULL;
+    }
+}
+
+/*
+ * 功能：启动光标跟踪线程。
+ * 逻辑：创建非阻塞唤醒管道（GLib 2.78 之前 g_unix_open_pipe 只接受 FD_CLOEXEC）；打开独立 X 连接并检查 XFixes；订阅根窗口的 DisplayCursorNotify；读取初始形状后启动线程。
+ * 参数：self 光标跟踪器；display_name 显示名（NULL 使用默认）；error 错误输出。
+ * 外部接口：g_unix_open_pipe/g_unix_set_fd_nonblocking；XOpenDisplay/XFixesQueryExtension/XFixesSelectCursorInput；g_thread_new。
+ */
+gboolean
+drd_x11_cursor_start(DrdX11Cursor *self, const gchar *display_name, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_X11_CURSOR(self), FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    if (self->running)
+    {
+        g_mutex_unlock(&self->state_mutex);
+        return TRUE;
+    }
+    g_mutex_unlock(&self->state_mutex);
+
+    if (!g_unix_open_pipe(self->wakeup_pipe, FD_CLOEXEC, error) ||
+        !g_unix_set_fd_nonblocking(self->wakeup_pipe[0], TRUE, error) ||
+        !g_unix_set_fd_nonblocking(self->wakeup_pipe[1], TRUE, error))
+    {
+        drd_x11_cursor_cleanup(self);
+        return FALSE;
+    }
+
+    self->display = XOpenDisplay(display_name);
+    if (self->display == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open X11 display for cursor tracking");
+        drd_x11_cursor_cleanup(self);
+        return FALSE;
+    }
+
+    int fixes_error = 0;
+    if (!XFixesQueryExtension(self->display, &self->fixes_event_base, &fixes_error))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XFixes extension not available on X server");
+        drd_x11_cursor_cleanup(self);
+        return FALSE;
+    }
+
+    self->root = DefaultRootWindow(self->display);
+    XFixesSelectCursorInput(self->display, self->root, XFixesDisplayCursorNotifyMask);
+
+    gint x = 0;
+    gint y = 0;
+    DrdCursorShape *shape = drd_x11_cursor_fetch_shape(self->display, &x, &y);
+    if (shape != NULL)
+    {
+        drd_x11_cursor_publish_shape(self, shape, x, y);
+    }
+    XSync(self->display, False);
+
+    g_mutex_lock(&self->state_mutex);
+    self->running = TRUE;
+    g_mutex_unlock(&self->state_mutex);
+    self->thread = g_thread_new("drd-x11-cursor", drd_x11_cursor_thread, g_object_ref(self));
+
+    DRD_LOG_MESSAGE("X11 cursor tracking started");
+    return TRUE;
+}
+
+/*
+ * 功能：停止光标跟踪线程。
+ * 逻辑：清除运行标志并写唤醒管道，join 线程后关闭连接与管道。
+ * 参数：self 光标跟踪器。
+ * 外部接口：POSIX write；GLib g_thread_join；drd_x11_cursor_cleanup。
+ */
+void
+drd_x11_cursor_stop(DrdX11Cursor *self)
+{
+    g_return_if_fail(DRD_IS_X11_CURSOR(self));
+
+    g_mutex_lock(&self->state_mutex);
+    if (!self->running)
+    {
+        g_mutex_unlock(&self->state_mutex);
+        return;
+    }
+    self->running = FALSE;
+    g_mutex_unlock(&self->state_mutex);
+
+    if (self->wakeup_pipe[1] >= 0)
+    {
+        const gchar signal_byte = 'x';
+        if (write(self->wakeup_pipe[1], &signal_byte, 1) < 0)
+        {
+            (void) signal_byte;
+        }
+    }
+
+    if (self->thread != NULL)
+    {
+        g_thread_join(self->thread);
+        self->thread = NULL;
+    }
+
+    drd_x11_cursor_cleanup(self);
+    DRD_LOG_MESSAGE("X11 cursor tracking stopped");
+}
+
+/*
+ * 功能：查询跟踪线程是否运行。
+ * 逻辑：持锁读取 running。
+ * 参数：self 光标跟踪器。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+gboolean
+drd_x11_cursor_is_running(DrdX11Cursor *self)
+{
+    g_return_val_if_fail(DRD_IS_X11_CURSOR(self), FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    const gboolean running = self->running;
+    g_mutex_unlock(&self->state_mutex);
+    return running;
+}
+
+/*
+ * 功能：获取自调用方上次读取以来变化的光标形状。
+ * 逻辑：持锁比较代数，变化时返回当前形状引用并更新调用方代数，未变化返回 NULL。
+ * 参数：self 光标跟踪器；inout_generation 调用方已读取的代数。
+ * 外部接口：drd_cursor_shape_ref。
+ */
+DrdCursorShape *
+drd_x11_cursor_get_shape(DrdX11Cursor *self, guint64 *inout_generation)
+{
+    g_return_val_if_fail(DRD_IS_X11_CURSOR(self), NULL);
+    g_return_val_if_fail(inout_generation != NULL, NULL);
+
+    DrdCursorShape *shape = NULL;
+    g_mutex_lock(&self->state_mutex);
+    if (self->shape != NULL && self->generation != *inout_generation)
+    {
+        shape = drd_cursor_shape_ref(self->shape);
+        *inout_generation = self->generation;
+    }
+    g_mutex_unlock(&self->state_mutex);
+    return shape;
+}
+
+/*
+ * 功能：获取最近一次采样的光标位置（根窗口坐标）。
+ * 逻辑：持锁读取位置，尚无采样时返回 FALSE。
+ * 参数：self 光标跟踪器；out_x/out_y 输出位置。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+gboolean
+drd_x11_cursor_get_position(DrdX11Cursor *self, gint *out_x, gint *out_y)
+{
+    g_return_val_if_fail(DRD_IS_X11_CURSOR(self), FALSE);
+    g_return_val_if_fail(out_x != NULL && out_y != NULL, FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    const gboolean has_position = self->has_position;
+    *out_x = self->x;
+    *out_y = self->y;
+    g_mutex_unlock(&self->state_mutex);
+    return has_position;
+}
+
+/*
+ * 功能：光标跟踪线程主循环。
+ * 逻辑：用 g_poll 同时监听 X 连接与唤醒管道，超时取捕获目标间隔；收到 XFixesCursorNotify 时才取回光标图像（形状不变时不产生任何读回）；
+ *       每个周期用 XQueryPointer 采样一次位置供会话发送指针位置更新。
+ * 参数：user_data DrdX11Cursor 实例。
+ * 外部接口：XPending/XNextEvent/XQueryPointer；g_poll；drd_capture_metrics_get_target_interval_us。
+ */
+static gpointer
+drd_x11_cursor_thread(gpointer user_data)
+{
+    DrdX11Cursor *self = DRD_X11_CURSOR(user_data);
+    Display *display = self->display;
+    const gint poll_timeout_ms = (gint) MAX(drd_capture_metrics_get_target_interval_us() / 1000, 1);
+
+    while (drd_x11_cursor_is_running(self))
+    {
+        GPollFD pfds[2];
+        pfds[0].fd = XConnectionNumber(display);
+        pfds[0].events = G_IO_IN;
+        pfds[0].revents = 0;
+        pfds[1].fd = self->wakeup_pipe[0];
+        pfds[1].events = G_IO_IN;
+        pfds[1].revents = 0;
+
+        if (g_poll(pfds, 2, poll_timeout_ms) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (pfds[1].revents & G_IO_IN)
+        {
+            gchar buffer[64];
+            while (read(self->wakeup_pipe[0], buffer, sizeof(buffer)) > 0)
+            {
+            }
+        }
+
+        gboolean shape_changed = FALSE;
+        while (XPending(display) > 0)
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == self->fixes_event_base + XFixesCursorNotify)
+            {
+                shape_changed = TRUE;
+            }
+        }
+
+        if (shape_changed)
+        {
+            gint x = 0;
+            gint y = 0;
+            DrdCursorShape *shape = drd_x11_cursor_fetch_shape(display, &x, &y);
+            if (shape != NULL)
+            {
+                drd_x11_cursor_publish_shape(self, shape, x, y);
+                continue;
+            }
+        }
+
+        Window root_return;
+        Window child_return;
+        int root_x = 0;
+        int root_y = 0;
+        int win_x = 0;
+        int win_y = 0;
+        unsigned int mask = 0;
+        if (XQueryPointer(display, self->root, &root_return, &child_return, &root_x, &root_y, &win_x, &win_y, &mask))
+        {
+            g_mutex_lock(&self->state_mutex);
+            self->x = root_x;
+            self->y = root_y;
+            self->has_position = TRUE;
+            g_mutex_unlock(&self->state_mutex);
+        }
+    }
+
+    g_object_unref(self);
+    return NULL;
+}
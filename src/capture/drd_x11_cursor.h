@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/* 光标形状快照：像素为 BGRA32（与 XFixes 的预乘 ARGB 同字节序），自上而下逐行排列 */
+typedef struct
+{
+    guint32 serial;
+    guint width;
+    guint height;
+    guint hotspot_x;
+    guint hotspot_y;
+    gboolean hidden;
+    GBytes *pixels;
+} DrdCursorShape;
+
+DrdCursorShape *drd_cursor_shape_ref(DrdCursorShape *shape);
+void drd_cursor_shape_unref(DrdCursorShape *shape);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(DrdCursorShape, drd_cursor_shape_unref)
+
+#define DRD_TYPE_X11_CURSOR (drd_x11_cursor_get_type())
+G_DECLARE_FINAL_TYPE(DrdX11Cursor, drd_x11_cursor, DRD, X11_CURSOR, GObject)
+
+DrdX11Cursor *drd_x11_cursor_new(void);
+
+gboolean drd_x11_cursor_start(DrdX11Cursor *self, const gchar *display_name, GError **error);
+void drd_x11_cursor_stop(DrdX11Cursor *self);
+gboolean drd_x11_cursor_is_running(DrdX11Cursor *self);
+
+/**
+ * drd_x11_cursor_get_shape:
+ * @self: the cursor tracker
+ * @inout_generation: generation last seen by the caller, updated on return
+ *
+ * Returns: (transfer full) (nullable): the current shape when it changed since
+ * @inout_generation, otherwise %NULL. Each consumer keeps its own generation.
+ */
+DrdCursorShape *drd_x11_cursor_get_shape(DrdX11Cursor *self, guint64 *inout_generation);
+gboolean drd_x11_cursor_get_position(DrdX11Cursor *self, gint *out_x, gint *out_y);
+
+G_END_DECLS
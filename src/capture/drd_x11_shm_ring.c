@@ -0,0 +1,440 @@
+#include "capture/drd_x11_shm_ring.h"
+
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+#include <gio/gio.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+/* 单个槽位累计的过期矩形超过该数量时改为整帧同步 */
+#define DRD_X11_SHM_RING_MAX_STALE_RECTS 256
+
+typedef struct
+{
+    DrdX11ShmRing *ring;
+    XShmSegmentInfo info;
+    XImage *image;
+    gboolean attached;
+    gboolean in_use;
+    GArray *stale;
+    gboolean stale_full;
+} DrdX11ShmSlot;
+
+struct _DrdX11ShmRing
+{
+    GObject parent_instance;
+
+    GMutex mutex;
+    DrdX11ShmSlot *slots;
+    guint n_slots;
+    gint latest;
+    guint width;
+    guint height;
+    gsize frame_size;
+};
+
+G_DEFINE_TYPE(DrdX11ShmRing, drd_x11_shm_ring, G_TYPE_OBJECT)
+
+/*
+ * 功能：释放所有槽位的共享内存映射与图像头。
+ * 逻辑：逐个销毁 XImage 头（data 置空避免被 free）、shmdt 解除映射；段在创建时已标记 IPC_RMID，最后一个映射解除后由内核回收；清理过期矩形数组与互斥锁。
+ * 参数：object 基类指针，期望为 DrdX11ShmRing。
+ * 外部接口：XDestroyImage；SysV shmdt；GLib g_array_unref/g_mutex_clear。
+ */
+static void
+drd_x11_shm_ring_finalize(GObject *object)
+{
+    DrdX11ShmRing *self = DRD_X11_SHM_RING(object);
+
+    for (guint i = 0; i < self->n_slots; i++)
+    {
+        DrdX11ShmSlot *slot = &self->slots[i];
+
+        if (slot->image != NULL)
+        {
+            slot->image->data = NULL;
+            XDestroyImage(slot->image);
+            slot->image = NULL;
+        }
+
+        if (slot->info.shmaddr != NULL)
+        {
+            shmdt(slot->info.shmaddr);
+            slot->info.shmaddr = NULL;
+        }
+
+        if (slot->info.shmid >= 0)
+        {
+            shmctl(slot->info.shmid, IPC_RMID, NULL);
+            slot->info.shmid = -1;
+        }
+
+        g_clear_pointer(&slot->stale, g_array_unref);
+    }
+
+    g_clear_pointer(&self->slots, g_free);
+    g_mutex_clear(&self->mutex);
+    G_OBJECT_CLASS(drd_x11_shm_ring_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：绑定类级别析构回调。
+ * 逻辑：将自定义 finalize 挂载到 GObjectClass。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_x11_shm_ring_class_init(DrdX11ShmRingClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = drd_x11_shm_ring_finalize;
+}
+
+/*
+ * 功能：初始化环形缓冲实例。
+ * 逻辑：初始化互斥锁，尚无最新槽位。
+ * 参数：self 环形缓冲实例。
+ * 外部接口：GLib g_mutex_init。
+ */
+static void
+drd_x11_shm_ring_init(DrdX11ShmRing *self)
+{
+    g_mutex_init(&self->mutex);
+    self->latest = -1;
+}
+
+/*
+ * 功能：为单个槽位创建 XShm 图像并附加共享内存段。
+ * 逻辑：XShmCreateImage 创建整屏图像头；shmget/shmat 申请并映射段；XShmAttach 绑定到 X 服务器。
+ * 参数：self 环形缓冲；slot 槽位；display X 连接；error 错误输出。
+ * 外部接口：X11 XShmCreateImage/XShmAttach；SysV shmget/shmat。
+ */
+static gboolean
+drd_x11_shm_ring_prepare_slot(DrdX11ShmRing *self, DrdX11ShmSlot *slot, Display *display, GError **error)
+{
+    const int screen = DefaultScreen(display);
+
+    slot->image = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap, NULL,
+                                  &slot->info, (int) self->width, (int) self->height);
+    if (slot->image == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create XShm ring image");
+        return FALSE;
+    }
+
+    const size_t image_size = (size_t) slot->image->bytes_per_line * (size_t) slot->image->height;
+    slot->info.shmid = shmget(IPC_PRIVATE, image_size, IPC_CREAT | 0600);
+    if (slot->info.shmid < 0)
+    {
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmget failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    slot->info.shmaddr = (char *) shmat(slot->info.shmid, NULL, 0);
+    if (slot->info.shmaddr == (char *) (-1))
+    {
+        slot->info.shmaddr = NULL;
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmat failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    slot->info.readOnly = False;
+    slot->image->data = slot->info.shmaddr;
+    if (!XShmAttach(display, &slot->info))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "XShmAttach failed for ring slot");
+        return FALSE;
+    }
+    slot->attached = TRUE;
+    self->frame_size = image_size;
+    return TRUE;
+}
+
+/*
+ * 功能：创建由 X 服务器直接写入的共享内存帧环。
+ * 逻辑：分配 n_slots 个整屏槽位并逐个附加到 X 服务器；XSync 确认服务端完成附加后立即 IPC_RMID，
+ * 段在最后一次 shmdt 后由内核回收，进程异常退出也不会遗留；所有槽位初始标记为需整帧同步。
+ * 参数：display X 连接；n_slots 槽位数量；width/height 帧尺寸；error 错误输出。
+ * 外部接口：drd_x11_shm_ring_prepare_slot；X11 XSync；SysV shmctl。
+ */
+DrdX11ShmRing *
+drd_x11_shm_ring_new(Display *display, guint n_slots, guint width, guint height, GError **error)
+{
+    g_return_val_if_fail(display != NULL, NULL);
+    g_return_val_if_fail(n_slots >= 2, NULL);
+
+    DrdX11ShmRing *self = g_object_new(DRD_TYPE_X11_SHM_RING, NULL);
+    self->width = width;
+    self->height = height;
+    self->n_slots = n_slots;
+    self->slots = g_new0(DrdX11ShmSlot, n_slots);
+
+    for (guint i = 0; i < n_slots; i++)
+    {
+        DrdX11ShmSlot *slot = &self->slots[i];
+        slot->ring = self;
+        slot->info.shmid = -1;
+        slot->stale = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+        slot->stale_full = TRUE;
+    }
+
+    for (guint i = 0; i < n_slots; i++)
+    {
+        if (!drd_x11_shm_ring_prepare_slot(self, &self->slots[i], display, error))
+        {
+            drd_x11_shm_ring_detach(self, display);
+            g_object_unref(self);
+            return NULL;
+        }
+    }
+
+    XSync(display, False);
+    for (guint i = 0; i < n_slots; i++)
+    {
+        shmctl(self->slots[i].info.shmid, IPC_RMID, NULL);
+        self->slots[i].info.shmid = -1;
+    }
+
+    return self;
+}
+
+/*
+ * 功能：从 X 服务器分离所有槽位。
+ * 逻辑：对已附加的槽位调用 XShmDetach；客户端映射保留到环形缓冲 finalize，仍被帧引用的像素保持可读。
+ * 参数：self 环形缓冲；display X 连接。
+ * 外部接口：X11 XShmDetach。
+ */
+void
+drd_x11_shm_ring_detach(DrdX11ShmRing *self, Display *display)
+{
+    g_return_if_fail(DRD_IS_X11_SHM_RING(self));
+
+    for (guint i = 0; i < self->n_slots; i++)
+    {
+        DrdX11ShmSlot *slot = &self->slots[i];
+        if (slot->attached && display != NULL)
+        {
+            XShmDetach(display, &slot->info);
+        }
+        slot->attached = FALSE;
+    }
+}
+
+/*
+ * 功能：领取一个可写槽位。
+ * 逻辑：持锁从最新槽位之后轮询，跳过最新槽位（作为同步参考）与仍被帧引用的槽位，领取后标记占用。
+ * 参数：self 环形缓冲。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ * 返回：槽位索引，全部被占用时返回 -1。
+ */
+gint
+drd_x11_shm_ring_acquire(DrdX11ShmRing *self)
+{
+    g_return_val_if_fail(DRD_IS_X11_SHM_RING(self), -1);
+
+    gint result = -1;
+    g_mutex_lock(&self->mutex);
+    for (guint i = 1; i <= self->n_slots; i++)
+    {
+        const guint index = (guint) (self->latest + (gint) i) % self->n_slots;
+        if ((gint) index == self->latest || self->slots[index].in_use)
+        {
+            continue;
+        }
+        self->slots[index].in_use = TRUE;
+        result = (gint) index;
+        break;
+    }
+    g_mutex_unlock(&self->mutex);
+    return result;
+}
+
+/*
+ * 功能：放弃已领取但未发布的槽位。
+ * 逻辑：持锁清除占用标记，过期矩形保持不变。
+ * 参数：self 环形缓冲；slot 槽位索引。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+void
+drd_x11_shm_ring_abort(DrdX11ShmRing *self, gint slot)
+{
+    g_return_if_fail(DRD_IS_X11_SHM_RING(self));
+    g_return_if_fail(slot >= 0 && (guint) slot < self->n_slots);
+
+    g_mutex_lock(&self->mutex);
+    self->slots[slot].in_use = FALSE;
+    g_mutex_unlock(&self->mutex);
+}
+
+/*
+ * 功能：获取槽位对应的 XShm 图像，供 XShmGetImage 直接写入。
+ * 逻辑：校验索引后返回图像头。
+ * 参数：self 环形缓冲；slot 槽位索引。
+ * 外部接口：无。
+ */
+XImage *
+drd_x11_shm_ring_get_image(DrdX11ShmRing *self, gint slot)
+{
+    g_return_val_if_fail(DRD_IS_X11_SHM_RING(self), NULL);
+    g_return_val_if_fail(slot >= 0 && (guint) slot < self->n_slots, NULL);
+
+    return self->slots[slot].image;
+}
+
+/*
+ * 功能：获取槽位共享内存段在 X 服务器侧的标识，供 xcb_shm_get_image 直接写入。
+ * 逻辑：校验索引后返回 XShmAttach 分配的段 XID。
+ * 参数：self 环形缓冲；slot 槽位索引。
+ * 外部接口：无。
+ */
+ShmSeg
+drd_x11_shm_ring_get_segment(DrdX11ShmRing *self, gint slot)
+{
+    g_return_val_if_fail(DRD_IS_X11_SHM_RING(self), 0);
+    g_return_val_if_fail(slot >= 0 && (guint) slot < self->n_slots, 0);
+
+    return self->slots[slot].info.shmseg;
+}
+
+/*
+ * 功能：判断是否已有发布过的最新槽位。
+ * 逻辑：latest 非负即存在可作为增量同步参考的内容。
+ * 参数：self 环形缓冲。
+ * 外部接口：无。
+ */
+gboolean
+drd_x11_shm_ring_has_latest(DrdX11ShmRing *self)
+{
+    g_return_val_if_fail(DRD_IS_X11_SHM_RING(self), FALSE);
+    return self->latest >= 0;
+}
+
+/*
+ * 功能：把槽位内容同步到最新槽位的状态。
+ * 逻辑：仅拷贝该槽位上次发布后累计的过期矩形；累计过多或未初始化时整帧拷贝；最新槽位只读，消费者持有时读取安全。
+ * 参数：self 环形缓冲；slot 已领取的槽位索引。
+ * 外部接口：C 库 memcpy。
+ */
+void
+drd_x11_shm_ring_sync_slot(DrdX11ShmRing *self, gint slot)
+{
+    g_return_if_fail(DRD_IS_X11_SHM_RING(self));
+    g_return_if_fail(slot >= 0 && (guint) slot < self->n_slots);
+
+    if (self->latest < 0 || self->latest == slot)
+    {
+        return;
+    }
+
+    DrdX11ShmSlot *target = &self->slots[slot];
+    const XImage *src_image = self->slots[self->latest].image;
+    XImage *dst_image = target->image;
+
+    if (target->stale_full)
+    {
+        memcpy(dst_image->data, src_image->data, self->frame_size);
+    }
+    else
+    {
+        const gsize bytes_per_pixel = (gsize) dst_image->bits_per_pixel / 8;
+        const gsize stride = (gsize) dst_image->bytes_per_line;
+        for (guint i = 0; i < target->stale->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(target->stale, DrdFrameRect, i);
+            const gsize offset = (gsize) rect->y * stride + (gsize) rect->x * bytes_per_pixel;
+            const gsize row_bytes = (gsize) rect->width * bytes_per_pixel;
+            for (guint row = 0; row < rect->height; row++)
+            {
+                memcpy(dst_image->data + offset + row * stride, src_image->data + offset + row * stride, row_bytes);
+            }
+        }
+    }
+
+    g_array_set_size(target->stale, 0);
+    target->stale_full = FALSE;
+}
+
+/*
+ * 功能：发布已写好的槽位为最新帧。
+ * 逻辑：其余槽位追加本帧损坏矩形为过期区域（full 或累计过多时改为整帧过期）；本槽位过期信息清空；持锁更新 latest。
+ * 参数：self 环形缓冲；slot 槽位索引；damage/n_damage 本帧损坏矩形；full 本帧损坏范围未知需按整帧处理。
+ * 外部接口：GLib g_array_append_vals/g_mutex_lock/unlock。
+ */
+void
+drd_x11_shm_ring_publish(DrdX11ShmRing *self, gint slot, const DrdFrameRect *damage, guint n_damage, gboolean full)
+{
+    g_return_if_fail(DRD_IS_X11_SHM_RING(self));
+    g_return_if_fail(slot >= 0 && (guint) slot < self->n_slots);
+
+    for (guint i = 0; i < self->n_slots; i++)
+    {
+        DrdX11ShmSlot *other = &self->slots[i];
+        if ((gint) i == slot || other->stale_full)
+        {
+            continue;
+        }
+
+        if (full || other->stale->len + n_damage > DRD_X11_SHM_RING_MAX_STALE_RECTS)
+        {
+            g_array_set_size(other->stale, 0);
+            other->stale_full = TRUE;
+            continue;
+        }
+
+        if (n_damage > 0)
+        {
+            g_array_append_vals(other->stale, damage, n_damage);
+        }
+    }
+
+    g_array_set_size(self->slots[slot].stale, 0);
+    self->slots[slot].stale_full = FALSE;
+
+    g_mutex_lock(&self->mutex);
+    self->latest = slot;
+    g_mutex_unlock(&self->mutex);
+}
+
+/*
+ * 功能：帧销毁时把槽位归还给环形缓冲。
+ * 逻辑：持锁清除占用标记，并释放帧持有的环形缓冲引用。
+ * 参数：frame 被销毁的帧；user_data 槽位指针。
+ * 外部接口：GLib g_mutex_lock/unlock/g_object_unref。
+ */
+static void
+drd_x11_shm_ring_release_frame(DrdFrame *frame, gpointer user_data)
+{
+    DrdX11ShmSlot *slot = user_data;
+    DrdX11ShmRing *ring = slot->ring;
+
+    g_mutex_lock(&ring->mutex);
+    slot->in_use = FALSE;
+    g_mutex_unlock(&ring->mutex);
+
+    g_object_unref(ring);
+}
+
+/*
+ * 功能：创建直接引用槽位像素的帧。
+ * 逻辑：配置几何后以 drd_frame_wrap_data 包装槽位共享内存，帧持有环形缓冲引用，最后一个引用释放时槽位自动归还。
+ * 参数：self 环形缓冲；slot 已发布的槽位索引；timestamp 帧时间戳。
+ * 外部接口：drd_frame_new/drd_frame_configure/drd_frame_wrap_data；GLib g_object_ref。
+ */
+DrdFrame *
+drd_x11_shm_ring_wrap_frame(DrdX11ShmRing *self, gint slot, guint64 timestamp)
+{
+    g_return_val_if_fail(DRD_IS_X11_SHM_RING(self), NULL);
+    g_return_val_if_fail(slot >= 0 && (guint) slot < self->n_slots, NULL);
+
+    DrdX11ShmSlot *target = &self->slots[slot];
+    DrdFrame *frame = drd_frame_new();
+    drd_frame_configure(frame, self->width, self->height, (guint) target->image->bytes_per_line, timestamp);
+    drd_frame_wrap_data(frame, (const guint8 *) target->image->data, self->frame_size,
+                        drd_x11_shm_ring_release_frame, target);
+    g_object_ref(self);
+    return frame;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glib-object.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+
+#include "utils/drd_frame.h"
+
+G_BEGIN_DECLS
+
+#define DRD_TYPE_X11_SHM_RING (drd_x11_shm_ring_get_type())
+G_DECLARE_FINAL_TYPE(DrdX11ShmRing, drd_x11_shm_ring, DRD, X11_SHM_RING, GObject)
+
+DrdX11ShmRing *drd_x11_shm_ring_new(Display *display,
+                                    guint n_slots,
+                                    guint width,
+                                    guint height,
+                                    GError **error);
+
+void drd_x11_shm_ring_detach(DrdX11ShmRing *self, Display *display);
+
+gint drd_x11_shm_ring_acquire(DrdX11ShmRing *self);
+void drd_x11_shm_ring_abort(DrdX11ShmRing *self, gint slot);
+
+XImage *drd_x11_shm_ring_get_image(DrdX11ShmRing *self, gint slot);
+ShmSeg drd_x11_shm_ring_get_segment(DrdX11ShmRing *self, gint slot);
+gboolean drd_x11_shm_ring_has_latest(DrdX11ShmRing *self);
+void drd_x11_shm_ring_sync_slot(DrdX11ShmRing *self, gint slot);
+void drd_x11_shm_ring_publish(DrdX11ShmRing *self,
+                              gint slot,
+                              const DrdFrameRect *damage,
+                              guint n_damage,
+                              gboolean full);
+
+DrdFrame *drd_x11_shm_ring_wrap_frame(DrdX11ShmRing *self, gint slot, guint64 timestamp);
+
+G_END_DECLS
@@ -0,0 +1,1270 @@
+#include "capture/drd_x11_window_capture.h"
+
+#include <X11/Xlib-xcb.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#include <xcb/composite.h>
+#include <xcb/damage.h>
+#include <xcb/shm.h>
+#include <xcb/xcb.h>
+
+#include <gio/gio.h>
+#include <glib-unix.h>
+#include <glib.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <unistd.h>
+
+#include "capture/drd_capture_backend.h"
+#include "capture/drd_x11_shm_ring.h"
+#include "utils/drd_capture_metrics.h"
+#include "utils/drd_frame.h"
+#include "utils/drd_log.h"
+
+/* 损坏矩形超过该数量时合并为外接矩形 */
+#define DRD_X11_WINDOW_CAPTURE_MAX_DAMAGE_RECTS 128
+/* 损坏面积占可见区域比例超过该值时整窗读回 */
+#define DRD_X11_WINDOW_CAPTURE_FULL_FETCH_RATIO 0.5
+/* 帧队列容不下本轮帧时的重试间隔 */
+#define DRD_X11_WINDOW_CAPTURE_BACKPRESSURE_RETRY_US 2000
+
+/* 已发出但尚未回收的 XCB SHM 读回请求 */
+typedef struct
+{
+    xcb_shm_get_image_cookie_t cookie;
+    DrdFrameRect rect;
+    gsize offset;
+    gsize pitch;
+    gboolean direct;
+} DrdX11WindowPendingRead;
+
+struct _DrdX11WindowCapture
+{
+    GObject parent_instance;
+
+    GMutex state_mutex;
+    DrdFrameQueue *queue;
+    GThread *thread;
+
+    gboolean running;
+    guint32 window_id;
+    guint n_frame_slots; /* 帧环槽位数，由调用方按下游持有的帧数给出 */
+    gchar *display_name;
+
+    Display *display;
+    xcb_connection_t *xcb;
+    int screen;
+    Window root;
+    /* 目标窗口经 XComposite 重定向后的后备 pixmap，映射或尺寸变化时重新命名 */
+    xcb_pixmap_t pixmap;
+    gboolean redirected;
+    xcb_damage_damage_t damage;
+    int damage_event_base;
+    XserverRegion damage_region;
+
+    DrdX11ShmRing *ring;
+    XImage *staging_image;
+    XShmSegmentInfo staging_info;
+    gboolean staging_attached;
+    GArray *rects;
+    GArray *pending_reads;
+
+    /* 画布尺寸在捕获期间固定，窗口尺寸随 ConfigureNotify 更新 */
+    guint width;
+    guint height;
+    guint window_width;
+    guint window_height;
+    gint origin_x;
+    gint origin_y;
+    gboolean mapped;
+    gboolean window_gone;
+    gboolean backing_valid;
+    gboolean geometry_changed;
+    int wakeup_pipe[2];
+};
+
+static void drd_x11_window_capture_backend_iface_init(DrdCaptureBackendInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(DrdX11WindowCapture, drd_x11_window_capture, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(DRD_TYPE_CAPTURE_BACKEND, drd_x11_window_capture_backend_iface_init))
+
+static gpointer drd_x11_window_capture_thread(gpointer user_data);
+
+static void drd_x11_window_capture_cleanup_locked(DrdX11WindowCapture *self);
+
+/*
+ * 功能：释放窗口捕获实例持有的资源。
+ * 逻辑：调用 stop 确保线程退出；清理 display 名称与帧队列引用，最后交由父类 dispose。
+ * 参数：object 基类指针，期望为 DrdX11WindowCapture。
+ * 外部接口：GLib g_clear_pointer/g_clear_object，最终调用 GObjectClass::dispose。
+ */
+static void drd_x11_window_capture_dispose(GObject *object)
+{
+    DrdX11WindowCapture *self = DRD_X11_WINDOW_CAPTURE(object);
+
+    drd_x11_window_capture_stop(self);
+
+    g_clear_pointer(&self->display_name, g_free);
+    g_clear_object(&self->queue);
+
+    G_OBJECT_CLASS(drd_x11_window_capture_parent_class)->dispose(object);
+}
+
+/*
+ * 功能：清理矩形数组与互斥锁。
+ * 逻辑：释放损坏矩形与读回请求数组并销毁 state_mutex，然后调用父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_array_unref/g_mutex_clear。
+ */
+static void drd_x11_window_capture_finalize(GObject *object)
+{
+    DrdX11WindowCapture *self = DRD_X11_WINDOW_CAPTURE(object);
+    g_clear_pointer(&self->rects, g_array_unref);
+    g_clear_pointer(&self->pending_reads, g_array_unref);
+    g_mutex_clear(&self->state_mutex);
+    G_OBJECT_CLASS(drd_x11_window_capture_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：初始化类回调，挂载 dispose/finalize。
+ * 逻辑：将自定义释放函数设置到 GObjectClass。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void drd_x11_window_capture_class_init(DrdX11WindowCaptureClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = drd_x11_window_capture_dispose;
+    object_class->finalize = drd_x11_window_capture_finalize;
+}
+
+/*
+ * 功能：初始化实例字段。
+ * 逻辑：初始化互斥锁、矩形数组与暂存共享内存标记，置运行状态与唤醒管道为未激活。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：GLib g_mutex_init/g_array_new、C 库 memset。
+ */
+static void drd_x11_window_capture_init(DrdX11WindowCapture *self)
+{
+    g_mutex_init(&self->state_mutex);
+    self->rects = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+    self->pending_reads = g_array_new(FALSE, FALSE, sizeof(DrdX11WindowPendingRead));
+    memset(&self->staging_info, 0, sizeof(self->staging_info));
+    self->staging_info.shmid = -1;
+    self->running = FALSE;
+    self->wakeup_pipe[0] = -1;
+    self->wakeup_pipe[1] = -1;
+}
+
+/*
+ * 功能：创建窗口捕获对象并绑定输出队列与目标窗口。
+ * 逻辑：校验队列类型后创建对象，持有队列引用并记录窗口 XID。
+ * 参数：queue 捕获帧输出队列；window_id 目标顶层窗口 XID。
+ * 外部接口：GLib g_object_new/g_object_ref。
+ */
+DrdX11WindowCapture *drd_x11_window_capture_new(DrdFrameQueue *queue, guint32 window_id)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_QUEUE(queue), NULL);
+
+    DrdX11WindowCapture *self = g_object_new(DRD_TYPE_X11_WINDOW_CAPTURE, NULL);
+    self->queue = g_object_ref(queue);
+    self->window_id = window_id;
+    return self;
+}
+
+/*
+ * 功能：等待无应答请求的执行结果。
+ * 逻辑：检查 checked 请求是否产生错误，错误由调用方处理而不会交给 Xlib 默认错误处理（进程退出）。
+ * 参数：xcb XCB 连接；cookie 请求 cookie。
+ * 外部接口：xcb_request_check；C 库 free。
+ */
+static gboolean drd_x11_window_capture_check_request(xcb_connection_t *xcb, xcb_void_cookie_t cookie)
+{
+    xcb_generic_error_t *xcb_error = xcb_request_check(xcb, cookie);
+    if (xcb_error != NULL)
+    {
+        free(xcb_error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：读取目标窗口尺寸。
+ * 逻辑：打开 X11 Display，通过 XCB 查询窗口几何后关闭连接；未选择窗口或窗口不存在时报错。
+ * 参数：self 窗口捕获实例；display_name 指定显示名（NULL 使用默认）；out_width/out_height 输出值；error 错误输出。
+ * 外部接口：X11 XOpenDisplay/XCloseDisplay；XCB xcb_get_geometry。
+ */
+gboolean drd_x11_window_capture_get_window_size(DrdX11WindowCapture *self, const gchar *display_name, guint *out_width, guint *out_height, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_X11_WINDOW_CAPTURE(self), FALSE);
+    g_return_val_if_fail(out_width != NULL, FALSE);
+    g_return_val_if_fail(out_height != NULL, FALSE);
+
+    if (self->window_id == 0)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "No window selected for window capture");
+        return FALSE;
+    }
+
+    Display *display = XOpenDisplay(display_name);
+    if (display == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open X11 display for window query");
+        return FALSE;
+    }
+
+    xcb_connection_t *xcb = XGetXCBConnection(display);
+    xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(xcb, xcb_get_geometry(xcb, self->window_id), NULL);
+    if (geometry == NULL)
+    {
+        XCloseDisplay(display);
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "X11 window 0x%x not found", self->window_id);
+        return FALSE;
+    }
+
+    *out_width = geometry->width;
+    *out_height = geometry->height;
+    free(geometry);
+    XCloseDisplay(display);
+    return TRUE;
+}
+
+/*
+ * 功能：读取目标窗口在根窗口中的位置。
+ * 逻辑：持锁读取最近一次几何查询得到的原点，供输入与光标坐标映射。
+ * 参数：self 窗口捕获实例；out_x/out_y 输出原点。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+void drd_x11_window_capture_get_origin(DrdX11WindowCapture *self, gint *out_x, gint *out_y)
+{
+    g_return_if_fail(DRD_IS_X11_WINDOW_CAPTURE(self));
+
+    g_mutex_lock(&self->state_mutex);
+    if (out_x != NULL)
+    {
+        *out_x = self->origin_x;
+    }
+    if (out_y != NULL)
+    {
+        *out_y = self->origin_y;
+    }
+    g_mutex_unlock(&self->state_mutex);
+}
+
+/*
+ * 功能：刷新目标窗口尺寸与根窗口原点。
+ * 逻辑：同时发出几何查询与坐标转换请求后回收应答；窗口已销毁时返回 FALSE；原点持锁写入，尺寸变化时输出 TRUE。
+ * 参数：self 窗口捕获实例；out_resized 输出尺寸是否变化。
+ * 外部接口：XCB xcb_get_geometry/xcb_translate_coordinates。
+ */
+static gboolean drd_x11_window_capture_query_geometry(DrdX11WindowCapture *self, gboolean *out_resized)
+{
+    xcb_get_geometry_cookie_t geometry_cookie = xcb_get_geometry(self->xcb, self->window_id);
+    xcb_translate_coordinates_cookie_t translate_cookie = xcb_translate_coordinates(self->xcb, self->window_id, (xcb_window_t) self->root, 0, 0);
+    xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(self->xcb, geometry_cookie, NULL);
+    xcb_translate_coordinates_reply_t *translate = xcb_translate_coordinates_reply(self->xcb, translate_cookie, NULL);
+
+    if (geometry == NULL || translate == NULL)
+    {
+        free(geometry);
+        free(translate);
+        return FALSE;
+    }
+
+    *out_resized = geometry->width != self->window_width || geometry->height != self->window_height;
+    self->window_width = geometry->width;
+    self->window_height = geometry->height;
+
+    g_mutex_lock(&self->state_mutex);
+    self->origin_x = translate->dst_x;
+    self->origin_y = translate->dst_y;
+    g_mutex_unlock(&self->state_mutex);
+
+    free(geometry);
+    free(translate);
+    return TRUE;
+}
+
+/*
+ * 功能：为目标窗口当前的后备存储命名 pixmap。
+ * 逻辑：释放旧 pixmap 后调用 CompositeNameWindowPixmap；窗口未映射时服务器返回错误，此时不持有 pixmap，等待 MapNotify 再命名。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：XCB xcb_free_pixmap_checked/xcb_composite_name_window_pixmap_checked/xcb_generate_id。
+ */
+static gboolean drd_x11_window_capture_name_pixmap(DrdX11WindowCapture *self)
+{
+    if (self->pixmap != XCB_NONE)
+    {
+        drd_x11_window_capture_check_request(self->xcb, xcb_free_pixmap_checked(self->xcb, self->pixmap));
+        self->pixmap = XCB_NONE;
+    }
+
+    const xcb_pixmap_t pixmap = xcb_generate_id(self->xcb);
+    if (!drd_x11_window_capture_check_request(self->xcb, xcb_composite_name_window_pixmap_checked(self->xcb, self->window_id, pixmap)))
+    {
+        return FALSE;
+    }
+
+    self->pixmap = pixmap;
+    self->backing_valid = FALSE;
+    return TRUE;
+}
+
+/*
+ * 功能：创建画布尺寸的 XShm 暂存图像，用于矩形读回。
+ * 逻辑：XShmCreateImage 创建图像头；申请 SysV 共享内存并映射；XShmAttach 绑定到 X 服务器。
+ * 参数：self 窗口捕获实例；error 错误输出。
+ * 外部接口：X11 XShmCreateImage/XShmAttach；SysV shmget/shmat。
+ */
+static gboolean drd_x11_window_capture_create_staging(DrdX11WindowCapture *self, GError **error)
+{
+    self->staging_image = XShmCreateImage(self->display, DefaultVisual(self->display, self->screen), DefaultDepth(self->display, self->screen), ZPixmap, NULL, &self->staging_info,
+                                          (int) self->width, (int) self->height);
+    if (self->staging_image == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create XShm staging image");
+        return FALSE;
+    }
+
+    const size_t image_size = (size_t) self->staging_image->bytes_per_line * (size_t) self->staging_image->height;
+    self->staging_info.shmid = shmget(IPC_PRIVATE, image_size, IPC_CREAT | 0600);
+    if (self->staging_info.shmid < 0)
+    {
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmget failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    self->staging_info.shmaddr = (char *) shmat(self->staging_info.shmid, NULL, 0);
+    if (self->staging_info.shmaddr == (char *) (-1))
+    {
+        self->staging_info.shmaddr = NULL;
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno), "shmat failed: %s", g_strerror(errno));
+        return FALSE;
+    }
+
+    self->staging_info.readOnly = False;
+    self->staging_image->data = self->staging_info.shmaddr;
+    if (!XShmAttach(self->display, &self->staging_info))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "XShmAttach failed");
+        return FALSE;
+    }
+    self->staging_attached = TRUE;
+    return TRUE;
+}
+
+/*
+ * 功能：释放暂存图像及其共享内存段。
+ * 逻辑：已附加则先从 X 服务器分离；销毁图像头（data 置空避免被 free）；shmdt 解除映射并 IPC_RMID 回收段。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：XShmDetach/XDestroyImage；SysV shmdt/shmctl。
+ */
+static void drd_x11_window_capture_release_staging(DrdX11WindowCapture *self)
+{
+    if (self->staging_attached && self->display != NULL)
+    {
+        XShmDetach(self->display, &self->staging_info);
+        self->staging_attached = FALSE;
+    }
+
+    if (self->staging_image != NULL)
+    {
+        self->staging_image->data = NULL;
+        XDestroyImage(self->staging_image);
+        self->staging_image = NULL;
+    }
+
+    if (self->staging_info.shmaddr != NULL)
+    {
+        shmdt(self->staging_info.shmaddr);
+        self->staging_info.shmaddr = NULL;
+    }
+
+    if (self->staging_info.shmid >= 0)
+    {
+        shmctl(self->staging_info.shmid, IPC_RMID, NULL);
+        self->staging_info.shmid = -1;
+        self->staging_info.shmseg = 0;
+    }
+}
+
+/*
+ * 功能：打开 X11 连接并把目标窗口重定向到离屏存储。
+ * 逻辑：打开 Display 并取得底层 XCB 连接，检测 XShm/XDamage/XFixes 与 XComposite 0.2（NameWindowPixmap）；查询窗口几何与原点确定画布尺寸；
+ * 在窗口上订阅结构事件、以自动模式重定向（显示不受影响）、窗口可见时命名后备 pixmap；对窗口创建 Damage 与取回区域用的 XFixes region；最后创建帧环与暂存图像。
+ * 窗口相关请求全部用 checked 请求发出，窗口随时可能被关闭，错误在本地处理而不触发 Xlib 默认错误处理。
+ * 参数：self 窗口捕获实例；display_name 显示名称；requested_width/height 画布尺寸（0 使用窗口尺寸）；error 错误输出。
+ * 外部接口：X11 XOpenDisplay/XGetXCBConnection/XShmQueryExtension/XDamageQueryExtension/XFixesQueryExtension/XFixesCreateRegion；
+ * XCB xcb_composite_query_version/redirect_window、xcb_damage_query_version/create、xcb_change_window_attributes、xcb_get_window_attributes；drd_x11_shm_ring_new 创建帧环。
+ */
+static gboolean drd_x11_window_capture_prepare_display(DrdX11WindowCapture *self, const gchar *display_name, guint requested_width, guint requested_height, GError **error)
+{
+    if (self->window_id == 0)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "No window selected for window capture");
+        return FALSE;
+    }
+
+    self->display = XOpenDisplay(display_name);
+    if (self->display == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open X11 display");
+        return FALSE;
+    }
+    self->xcb = XGetXCBConnection(self->display);
+
+    if (!XShmQueryExtension(self->display))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XShm extension not available on X server");
+        return FALSE;
+    }
+
+    int damage_event = 0;
+    int damage_error = 0;
+    if (!XDamageQueryExtension(self->display, &damage_event, &damage_error))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XDamage extension not available on X server");
+        return FALSE;
+    }
+    self->damage_event_base = damage_event;
+
+    int fixes_event = 0;
+    int fixes_error = 0;
+    if (!XFixesQueryExtension(self->display, &fixes_event, &fixes_error))
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XFixes extension not available on X server");
+        return FALSE;
+    }
+
+    const xcb_query_extension_reply_t *composite_ext = xcb_get_extension_data(self->xcb, &xcb_composite_id);
+    xcb_composite_query_version_reply_t *composite_version =
+            composite_ext != NULL && composite_ext->present ? xcb_composite_query_version_reply(self->xcb, xcb_composite_query_version(self->xcb, 0, 2), NULL) : NULL;
+    const gboolean composite_ok = composite_version != NULL && (composite_version->major_version > 0 || composite_version->minor_version >= 2);
+    free(composite_version);
+    if (!composite_ok)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "XComposite 0.2 not available on X server");
+        return FALSE;
+    }
+    free(xcb_damage_query_version_reply(self->xcb, xcb_damage_query_version(self->xcb, 1, 1), NULL));
+
+    self->screen = DefaultScreen(self->display);
+    self->root = RootWindow(self->display, self->screen);
+
+    gboolean resized = FALSE;
+    if (!drd_x11_window_capture_query_geometry(self, &resized))
+    {
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "X11 window 0x%x not found", self->window_id);
+        return FALSE;
+    }
+    self->width = requested_width > 0 ? requested_width : self->window_width;
+    self->height = requested_height > 0 ? requested_height : self->window_height;
+
+    const uint32_t event_mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    if (!drd_x11_window_capture_check_request(self->xcb, xcb_change_window_attributes_checked(self->xcb, self->window_id, XCB_CW_EVENT_MASK, &event_mask)))
+    {
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Failed to watch X11 window 0x%x", self->window_id);
+        return FALSE;
+    }
+
+    if (!drd_x11_window_capture_check_request(self->xcb, xcb_composite_redirect_window_checked(self->xcb, self->window_id, XCB_COMPOSITE_REDIRECT_AUTOMATIC)))
+    {
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to redirect X11 window 0x%x", self->window_id);
+        return FALSE;
+    }
+    self->redirected = TRUE;
+
+    xcb_get_window_attributes_reply_t *attributes = xcb_get_window_attributes_reply(self->xcb, xcb_get_window_attributes(self->xcb, self->window_id), NULL);
+    self->mapped = attributes != NULL && attributes->map_state == XCB_MAP_STATE_VIEWABLE;
+    free(attributes);
+    if (self->mapped && !drd_x11_window_capture_name_pixmap(self))
+    {
+        self->mapped = FALSE;
+    }
+
+    self->damage = xcb_generate_id(self->xcb);
+    if (!drd_x11_window_capture_check_request(self->xcb, xcb_damage_create_checked(self->xcb, self->damage, self->window_id, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY)))
+    {
+        self->damage = XCB_NONE;
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create XDamage handle for window");
+        return FALSE;
+    }
+    self->damage_region = XFixesCreateRegion(self->display, NULL, 0);
+
+    self->ring = drd_x11_shm_ring_new(self->display, self->n_frame_slots, self->width, self->height, error);
+    if (self->ring == NULL || !drd_x11_window_capture_create_staging(self, error))
+    {
+        return FALSE;
+    }
+
+    self->window_gone = FALSE;
+    self->backing_valid = FALSE;
+    self->geometry_changed = TRUE;
+    XSync(self->display, False);
+    return TRUE;
+}
+
+/*
+ * 功能：创建唤醒管道供线程退出时使用。
+ * 逻辑：若已有管道直接返回；否则创建带 CLOEXEC 的非阻塞管道并缓存 fd。GLib 2.78 之前 g_unix_open_pipe 只接受 FD_CLOEXEC，传 O_CLOEXEC 会断言失败。
+ * 参数：self 窗口捕获实例；error 错误输出。
+ * 外部接口：glib-unix g_unix_open_pipe/g_unix_set_fd_nonblocking。
+ */
+static gboolean drd_x11_window_capture_setup_wakeup_pipe(DrdX11WindowCapture *self, GError **error)
+{
+    if (self->wakeup_pipe[0] >= 0 && self->wakeup_pipe[1] >= 0)
+    {
+        return TRUE;
+    }
+
+    int fds[2] = {-1, -1};
+    if (!g_unix_open_pipe(fds, FD_CLOEXEC, error))
+    {
+        return FALSE;
+    }
+
+    if (!g_unix_set_fd_nonblocking(fds[0], TRUE, error) || !g_unix_set_fd_nonblocking(fds[1], TRUE, error))
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return FALSE;
+    }
+
+    self->wakeup_pipe[0] = fds[0];
+    self->wakeup_pipe[1] = fds[1];
+    return TRUE;
+}
+
+/*
+ * 功能：关闭并清理唤醒管道 fd。
+ * 逻辑：遍历两个 fd，若有效则 close 并置为 -1。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：POSIX close。
+ */
+static void drd_x11_window_capture_close_wakeup_pipe(DrdX11WindowCapture *self)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (self->wakeup_pipe[i] >= 0)
+        {
+            close(self->wakeup_pipe[i]);
+            self->wakeup_pipe[i] = -1;
+        }
+    }
+}
+
+/*
+ * 功能：清空唤醒管道中的残留数据。
+ * 逻辑：循环读取直到管道为空或出错。
+ * 参数：fd 管道读端。
+ * 外部接口：POSIX read。
+ */
+static void drd_x11_window_capture_drain_wakeup_pipe(int fd)
+{
+    char buffer[64];
+    while (fd >= 0)
+    {
+        const ssize_t ret = read(fd, buffer, sizeof(buffer));
+        if (ret > 0 || (ret < 0 && errno == EINTR))
+        {
+            continue;
+        }
+        break;
+    }
+}
+
+/*
+ * 功能：启动窗口捕获线程并准备资源。
+ * 逻辑：持锁检查运行状态；记录 display 名称；创建唤醒管道并准备显示资源；成功后标记 running 并启动线程。
+ * 参数：self 窗口捕获实例；display_name 目标显示；requested_width/height 画布尺寸；n_frame_slots 帧环槽位数；error 错误输出。
+ * 外部接口：GLib g_mutex_lock/unlock、g_thread_new；日志 DRD_LOG_MESSAGE。
+ */
+gboolean drd_x11_window_capture_start(DrdX11WindowCapture *self, const gchar *display_name, guint requested_width, guint requested_height, guint n_frame_slots, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_X11_WINDOW_CAPTURE(self), FALSE);
+    g_return_val_if_fail(n_frame_slots >= 2, FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    if (self->running)
+    {
+        g_mutex_unlock(&self->state_mutex);
+        return TRUE;
+    }
+
+    self->n_frame_slots = n_frame_slots;
+    g_clear_pointer(&self->display_name, g_free);
+    self->display_name = g_strdup(display_name);
+
+    if (!drd_x11_window_capture_setup_wakeup_pipe(self, error))
+    {
+        g_mutex_unlock(&self->state_mutex);
+        return FALSE;
+    }
+    g_mutex_unlock(&self->state_mutex);
+
+    /* 几何查询会持锁写入原点，准备阶段在锁外进行；running 仍为 FALSE，其他线程不会访问 X 资源 */
+    if (!drd_x11_window_capture_prepare_display(self, display_name, requested_width, requested_height, error))
+    {
+        g_mutex_lock(&self->state_mutex);
+        drd_x11_window_capture_cleanup_locked(self);
+        drd_x11_window_capture_close_wakeup_pipe(self);
+        g_mutex_unlock(&self->state_mutex);
+        return FALSE;
+    }
+
+    g_mutex_lock(&self->state_mutex);
+    self->running = TRUE;
+    self->thread = g_thread_new("drd-x11-window", drd_x11_window_capture_thread, g_object_ref(self));
+    g_mutex_unlock(&self->state_mutex);
+
+    DRD_LOG_MESSAGE("X11 window capture started for 0x%x at %ux%u (window %ux%u at %d,%d%s)", self->window_id, self->width, self->height, self->window_width, self->window_height,
+                    self->origin_x, self->origin_y, self->mapped ? "" : ", unmapped");
+    return TRUE;
+}
+
+/*
+ * 功能：清理窗口捕获持有的底层资源（需持锁调用）。
+ * 逻辑：销毁 Damage 与 region、释放 pixmap 并取消重定向（窗口可能已关闭，错误忽略）；帧环从 X 服务器分离后释放自身引用；释放暂存图像；关闭 X Display。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：xcb_damage_destroy_checked/xcb_free_pixmap_checked/xcb_composite_unredirect_window_checked、XFixesDestroyRegion/XCloseDisplay、drd_x11_shm_ring_detach。
+ */
+static void drd_x11_window_capture_cleanup_locked(DrdX11WindowCapture *self)
+{
+    if (self->display != NULL)
+    {
+        if (self->damage != XCB_NONE)
+        {
+            drd_x11_window_capture_check_request(self->xcb, xcb_damage_destroy_checked(self->xcb, self->damage));
+            self->damage = XCB_NONE;
+        }
+        if (self->damage_region != None)
+        {
+            XFixesDestroyRegion(self->display, self->damage_region);
+            self->damage_region = None;
+        }
+        if (self->pixmap != XCB_NONE)
+        {
+            drd_x11_window_capture_check_request(self->xcb, xcb_free_pixmap_checked(self->xcb, self->pixmap));
+            self->pixmap = XCB_NONE;
+        }
+        if (self->redirected)
+        {
+            drd_x11_window_capture_check_request(self->xcb, xcb_composite_unredirect_window_checked(self->xcb, self->window_id, XCB_COMPOSITE_REDIRECT_AUTOMATIC));
+            self->redirected = FALSE;
+        }
+    }
+
+    if (self->ring != NULL)
+    {
+        drd_x11_shm_ring_detach(self->ring, self->display);
+        g_clear_object(&self->ring);
+    }
+    drd_x11_window_capture_release_staging(self);
+
+    if (self->display != NULL)
+    {
+        XCloseDisplay(self->display);
+        self->display = NULL;
+        self->xcb = NULL;
+    }
+}
+
+/*
+ * 功能：停止捕获线程并回收资源。
+ * 逻辑：持锁清除运行标志后写唤醒管道并 join 线程，随后持锁清理资源与管道。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：POSIX write；GLib g_thread_join/g_mutex；日志 DRD_LOG_MESSAGE。
+ */
+void drd_x11_window_capture_stop(DrdX11WindowCapture *self)
+{
+    g_return_if_fail(DRD_IS_X11_WINDOW_CAPTURE(self));
+
+    g_mutex_lock(&self->state_mutex);
+    if (!self->running)
+    {
+        g_mutex_unlock(&self->state_mutex);
+        return;
+    }
+    self->running = FALSE;
+    g_mutex_unlock(&self->state_mutex);
+
+    if (self->wakeup_pipe[1] >= 0)
+    {
+        const gchar signal_byte = 'x';
+        if (write(self->wakeup_pipe[1], &signal_byte, 1) < 0)
+        {
+            (void) signal_byte;
+        }
+    }
+
+    if (self->thread != NULL)
+    {
+        g_thread_join(self->thread);
+        self->thread = NULL;
+    }
+
+    g_mutex_lock(&self->state_mutex);
+    drd_x11_window_capture_cleanup_locked(self);
+    drd_x11_window_capture_close_wakeup_pipe(self);
+    g_mutex_unlock(&self->state_mutex);
+
+    DRD_LOG_MESSAGE("X11 window capture stopped");
+}
+
+/*
+ * 功能：查询捕获线程是否运行。
+ * 逻辑：持锁读取 running 标志并返回。
+ * 参数：self 窗口捕获实例。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+gboolean drd_x11_window_capture_is_running(DrdX11WindowCapture *self)
+{
+    g_return_val_if_fail(DRD_IS_X11_WINDOW_CAPTURE(self), FALSE);
+
+    g_mutex_lock(&self->state_mutex);
+    const gboolean running = self->running;
+    g_mutex_unlock(&self->state_mutex);
+    return running;
+}
+
+/*
+ * 功能：处理目标窗口的结构与损坏事件。
+ * 逻辑：Damage 事件标记存在损坏；ConfigureNotify（含窗口管理器移动外框时发送的合成事件）刷新原点，尺寸变化时重新命名 pixmap 并要求整帧；
+ * MapNotify 时窗口重新获得后备存储，重新命名 pixmap；UnmapNotify 暂停抓帧；DestroyNotify 标记窗口已关闭。
+ * 参数：self 窗口捕获实例；event X 事件；damage_pending 输入输出损坏标记。
+ * 外部接口：drd_x11_window_capture_query_geometry/name_pixmap；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ */
+static void drd_x11_window_capture_handle_event(DrdX11WindowCapture *self, const XEvent *event, gboolean *damage_pending)
+{
+    if (event->type == self->damage_event_base + XDamageNotify)
+    {
+        *damage_pending = TRUE;
+        return;
+    }
+
+    gboolean resized = FALSE;
+    switch (event->type)
+    {
+        case ConfigureNotify:
+            if (event->xconfigure.window != (Window) self->window_id || !drd_x11_window_capture_query_geometry(self, &resized) || !resized)
+            {
+                break;
+            }
+            DRD_LOG_MESSAGE("X11 window 0x%x resized to %ux%u (canvas %ux%u)", self->window_id, self->window_width, self->window_height, self->width, self->height);
+            self->geometry_changed = TRUE;
+            if (self->mapped && !drd_x11_window_capture_name_pixmap(self))
+            {
+                self->mapped = FALSE;
+            }
+            *damage_pending = TRUE;
+            break;
+        case MapNotify:
+            if (event->xmap.window != (Window) self->window_id)
+            {
+                break;
+            }
+            drd_x11_window_capture_query_geometry(self, &resized);
+            self->mapped = drd_x11_window_capture_name_pixmap(self);
+            self->geometry_changed = TRUE;
+            *damage_pending = TRUE;
+            break;
+        case UnmapNotify:
+            if (event->xunmap.window == (Window) self->window_id)
+            {
+                self->mapped = FALSE;
+            }
+            break;
+        case DestroyNotify:
+            if (event->xdestroywindow.window == (Window) self->window_id)
+            {
+                DRD_LOG_WARNING("X11 window 0x%x was destroyed, window capture idle", self->window_id);
+                self->window_gone = TRUE;
+                self->mapped = FALSE;
+                /* 窗口销毁时服务器已回收 Damage 与重定向 */
+                self->damage = XCB_NONE;
+                self->redirected = FALSE;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * 功能：取回本周期累积的损坏并规划读回矩形。
+ * 逻辑：把 Damage 累积区域转移到 XFixes region 后取回，裁剪到窗口与画布的交集（可见区域）；几何变化或尚无参考内容时整帧读回可见区域，
+ * 其余情况矩形过多时合并为外接矩形、面积超过阈值时整窗读回；整帧时画布与窗口尺寸一致即可直接写入槽位。
+ * 参数：self 窗口捕获实例；out_full 输出本帧是否整帧；out_full_fetch 输出是否读回整个可见区域；out_direct 输出是否直接写入槽位。
+ * 外部接口：xcb_damage_subtract_checked/XFixesFetchRegion 取回损坏区域；drd_x11_shm_ring_has_latest。
+ */
+static gboolean drd_x11_window_capture_plan(DrdX11WindowCapture *self, gboolean *out_full, gboolean *out_full_fetch, gboolean *out_direct)
+{
+    const guint visible_width = MIN(self->window_width, self->width);
+    const guint visible_height = MIN(self->window_height, self->height);
+    guint64 damaged_pixels = 0;
+    int n_boxes = 0;
+
+    g_array_set_size(self->rects, 0);
+    if (!drd_x11_window_capture_check_request(self->xcb, xcb_damage_subtract_checked(self->xcb, self->damage, XCB_NONE, (xcb_xfixes_region_t) self->damage_region)))
+    {
+        return FALSE;
+    }
+
+    XRectangle *boxes = XFixesFetchRegion(self->display, self->damage_region, &n_boxes);
+    for (int i = 0; i < n_boxes; i++)
+    {
+        const gint x0 = MAX((gint) boxes[i].x, 0);
+        const gint y0 = MAX((gint) boxes[i].y, 0);
+        const gint x1 = MIN((gint) boxes[i].x + (gint) boxes[i].width, (gint) visible_width);
+        const gint y1 = MIN((gint) boxes[i].y + (gint) boxes[i].height, (gint) visible_height);
+        if (x1 <= x0 || y1 <= y0)
+        {
+            continue;
+        }
+
+        DrdFrameRect rect = {(guint) x0, (guint) y0, (guint) (x1 - x0), (guint) (y1 - y0)};
+        g_array_append_val(self->rects, rect);
+        damaged_pixels += (guint64) rect.width * rect.height;
+    }
+    if (boxes != NULL)
+    {
+        XFree(boxes);
+    }
+
+    if (self->rects->len > DRD_X11_WINDOW_CAPTURE_MAX_DAMAGE_RECTS)
+    {
+        guint x0 = G_MAXUINT;
+        guint y0 = G_MAXUINT;
+        guint x1 = 0;
+        guint y1 = 0;
+        for (guint i = 0; i < self->rects->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(self->rects, DrdFrameRect, i);
+            x0 = MIN(x0, rect->x);
+            y0 = MIN(y0, rect->y);
+            x1 = MAX(x1, rect->x + rect->width);
+            y1 = MAX(y1, rect->y + rect->height);
+        }
+        DrdFrameRect bounds = {x0, y0, x1 - x0, y1 - y0};
+        g_array_set_size(self->rects, 1);
+        g_array_index(self->rects, DrdFrameRect, 0) = bounds;
+        damaged_pixels = (guint64) bounds.width * bounds.height;
+    }
+
+    const guint64 visible_pixels = (guint64) visible_width * visible_height;
+    *out_full = self->geometry_changed || !self->backing_valid || !drd_x11_shm_ring_has_latest(self->ring);
+    *out_full_fetch = *out_full || (gdouble) damaged_pixels >= (gdouble) visible_pixels * DRD_X11_WINDOW_CAPTURE_FULL_FETCH_RATIO;
+    if (*out_full_fetch && visible_pixels > 0)
+    {
+        DrdFrameRect visible = {0, 0, visible_width, visible_height};
+        g_array_set_size(self->rects, 1);
+        g_array_index(self->rects, DrdFrameRect, 0) = visible;
+    }
+    *out_direct = *out_full_fetch && visible_width == self->width && visible_height == self->height;
+    return TRUE;
+}
+
+/*
+ * 功能：一次性发出本帧全部 XCB SHM 读回请求，不等待应答。
+ * 逻辑：直接模式以槽位共享内存段为目标读回整个 pixmap；否则把各矩形按紧凑行距依次排布到暂存段（偏移按 64 字节对齐），每个矩形各发一个请求，最后 flush。
+ * 参数：self 窗口捕获实例；slot 已领取的槽位；direct 是否直接写入槽位。
+ * 外部接口：xcb_shm_get_image/xcb_flush；drd_x11_shm_ring_get_segment。
+ */
+static void drd_x11_window_capture_issue_reads(DrdX11WindowCapture *self, gint slot, gboolean direct)
+{
+    gsize offset = 0;
+
+    g_array_set_size(self->pending_reads, 0);
+    if (direct)
+    {
+        DrdX11WindowPendingRead read = {0};
+        read.cookie = xcb_shm_get_image(self->xcb, self->pixmap, 0, 0, (uint16_t) self->width, (uint16_t) self->height, G_MAXUINT32, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                        (xcb_shm_seg_t) drd_x11_shm_ring_get_segment(self->ring, slot), 0);
+        read.direct = TRUE;
+        g_array_append_val(self->pending_reads, read);
+        xcb_flush(self->xcb);
+        return;
+    }
+
+    for (guint i = 0; i < self->rects->len; i++)
+    {
+        const DrdFrameRect *rect = &g_array_index(self->rects, DrdFrameRect, i);
+        DrdX11WindowPendingRead read = {0};
+
+        read.rect = *rect;
+        read.pitch = (((gsize) rect->width * (gsize) self->staging_image->bits_per_pixel + (gsize) self->staging_image->bitmap_pad - 1) / (gsize) self->staging_image->bitmap_pad) *
+                     ((gsize) self->staging_image->bitmap_pad / 8);
+        read.offset = offset;
+        read.cookie = xcb_shm_get_image(self->xcb, self->pixmap, (int16_t) rect->x, (int16_t) rect->y, (uint16_t) rect->width, (uint16_t) rect->height, G_MAXUINT32,
+                                        XCB_IMAGE_FORMAT_Z_PIXMAP, (xcb_shm_seg_t) self->staging_info.shmseg, (uint32_t) offset);
+        g_array_append_val(self->pending_reads, read);
+        offset += (read.pitch * rect->height + 63) & ~(gsize) 63;
+    }
+    xcb_flush(self->xcb);
+}
+
+/*
+ * 功能：回收读回请求并把矩形像素写入槽位。
+ * 逻辑：按发出顺序等待应答；直接请求无需拷贝，矩形请求从暂存段逐行拷入槽位；任一失败时仍回收剩余 cookie 并使后备内容失效。
+ * 参数：self 窗口捕获实例；slot 已领取的槽位。
+ * 外部接口：xcb_shm_get_image_reply；C 库 free/memcpy。
+ */
+static gboolean drd_x11_window_capture_reap_reads(DrdX11WindowCapture *self, gint slot)
+{
+    XImage *image = drd_x11_shm_ring_get_image(self->ring, slot);
+    const gsize bytes_per_pixel = (gsize) image->bits_per_pixel / 8;
+    gboolean ok = TRUE;
+
+    for (guint i = 0; i < self->pending_reads->len; i++)
+    {
+        const DrdX11WindowPendingRead *read = &g_array_index(self->pending_reads, DrdX11WindowPendingRead, i);
+        xcb_generic_error_t *xcb_error = NULL;
+        xcb_shm_get_image_reply_t *reply = xcb_shm_get_image_reply(self->xcb, read->cookie, &xcb_error);
+
+        if (reply == NULL)
+        {
+            free(xcb_error);
+            ok = FALSE;
+            continue;
+        }
+        free(reply);
+
+        if (!ok || read->direct)
+        {
+            continue;
+        }
+
+        const gsize row_bytes = (gsize) read->rect.width * bytes_per_pixel;
+        const guint8 *src = (const guint8 *) self->staging_info.shmaddr + read->offset;
+        guint8 *dst = (guint8 *) image->data + (gsize) read->rect.y * (gsize) image->bytes_per_line + (gsize) read->rect.x * bytes_per_pixel;
+        for (guint row = 0; row < read->rect.height; row++)
+        {
+            memcpy(dst, src, row_bytes);
+            src += read->pitch;
+            dst += image->bytes_per_line;
+        }
+    }
+
+    g_array_set_size(self->pending_reads, 0);
+    self->backing_valid = ok;
+    return ok;
+}
+
+/*
+ * 功能：把画布上窗口以外的区域清为黑色。
+ * 逻辑：窗口比画布窄时清除可见行右侧，比画布矮时清除下方整行。
+ * 参数：self 窗口捕获实例；slot 已领取的槽位。
+ * 外部接口：C 库 memset。
+ */
+static void drd_x11_window_capture_clear_outside(DrdX11WindowCapture *self, gint slot)
+{
+    XImage *image = drd_x11_shm_ring_get_image(self->ring, slot);
+    const gsize bytes_per_pixel = (gsize) image->bits_per_pixel / 8;
+    const guint visible_width = MIN(self->window_width, self->width);
+    const guint visible_height = MIN(self->window_height, self->height);
+
+    if (visible_width < self->width)
+    {
+        const gsize tail = (gsize) (self->width - visible_width) * bytes_per_pixel;
+        for (guint row = 0; row < visible_height; row++)
+        {
+            memset(image->data + (gsize) row * image->bytes_per_line + (gsize) visible_width * bytes_per_pixel, 0, tail);
+        }
+    }
+    if (visible_height < self->height)
+    {
+        memset(image->data + (gsize) visible_height * image->bytes_per_line, 0, (gsize) (self->height - visible_height) * image->bytes_per_line);
+    }
+}
+
+/*
+ * 功能：读回并发布一帧窗口内容。
+ * 逻辑：非直接写入的增量帧在请求在途期间同步槽位过期区域；整帧且窗口小于画布时清除窗口外区域；回收应答后发布槽位并包装为帧，
+ * 增量帧标注损坏矩形，帧原点记录窗口在根窗口中的位置后入队。
+ * 参数：self 窗口捕获实例；slot 已领取的槽位；full 是否整帧；direct 是否直接写入槽位；timestamp 帧时间戳；out_damage_pixels 累加损坏像素数。
+ * 外部接口：drd_x11_window_capture_issue_reads/reap_reads/clear_outside；drd_x11_shm_ring_sync_slot/abort/publish/wrap_frame；drd_frame_set_damage/set_monitor 与 drd_frame_queue_push。
+ */
+static gboolean drd_x11_window_capture_emit(DrdX11WindowCapture *self, gint slot, gboolean full, gboolean direct, guint64 timestamp, guint64 *out_damage_pixels)
+{
+    drd_x11_window_capture_issue_reads(self, slot, direct);
+    if (!direct && !full)
+    {
+        drd_x11_shm_ring_sync_slot(self->ring, slot);
+    }
+    else if (!direct)
+    {
+        drd_x11_window_capture_clear_outside(self, slot);
+    }
+    if (!drd_x11_window_capture_reap_reads(self, slot))
+    {
+        drd_x11_shm_ring_abort(self->ring, slot);
+        return FALSE;
+    }
+
+    drd_x11_shm_ring_publish(self->ring, slot, (const DrdFrameRect *) self->rects->data, self->rects->len, full);
+    g_autoptr(DrdFrame) frame = drd_x11_shm_ring_wrap_frame(self->ring, slot, timestamp);
+    if (full)
+    {
+        *out_damage_pixels += (guint64) self->width * self->height;
+    }
+    else
+    {
+        drd_frame_set_damage(frame, (const DrdFrameRect *) self->rects->data, self->rects->len);
+        for (guint i = 0; i < self->rects->len; i++)
+        {
+            const DrdFrameRect *rect = &g_array_index(self->rects, DrdFrameRect, i);
+            *out_damage_pixels += (guint64) rect->width * rect->height;
+        }
+    }
+
+    gint origin_x = 0;
+    gint origin_y = 0;
+    drd_x11_window_capture_get_origin(self, &origin_x, &origin_y);
+    drd_frame_set_monitor(frame, 0, origin_x, origin_y);
+    drd_frame_queue_push(self->queue, frame);
+    self->geometry_changed = FALSE;
+    return TRUE;
+}
+
+/*
+ * 功能：窗口捕获线程主循环。
+ * 逻辑：g_poll 监听 X 连接与唤醒管道，处理窗口结构与损坏事件；有损坏时按帧队列下游反馈的抓帧间隔等待，队列容不下时保留损坏稍后重试；
+ * 窗口未映射或已关闭时丢弃损坏标记并空转；到抓帧时刻领取帧环槽位、取回并规划损坏，流水线读回 pixmap 后发布带窗口原点的帧；统计周期内输出帧率与损坏占比。
+ * 参数：user_data 线程参数，DrdX11WindowCapture 实例。
+ * 外部接口：XPending/XNextEvent、g_poll；drd_frame_queue_get_pacing_interval_us/can_accept；drd_x11_shm_ring_acquire；drd_x11_window_capture_plan/emit；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ */
+static gpointer drd_x11_window_capture_thread(gpointer user_data)
+{
+    DrdX11WindowCapture *self = DRD_X11_WINDOW_CAPTURE(user_data);
+
+    const guint target_fps = drd_capture_metrics_get_target_fps();
+    const gint64 target_interval = drd_capture_metrics_get_target_interval_us();
+    const gint64 stats_interval = drd_capture_metrics_get_stats_interval_us();
+    gint64 stats_window_start = 0;
+    guint stats_frames = 0;
+    guint64 stats_damage_pixels = 0;
+    guint stats_ring_busy = 0;
+    guint stats_deferred = 0;
+    gint64 next_capture_deadline = 0;
+    /* Damage 只报告创建之后的变化，静止窗口不会触发首个事件；启动时 geometry_changed 已要求整帧，直接视为有损坏 */
+    gboolean damage_pending = TRUE;
+
+    while (TRUE)
+    {
+        g_mutex_lock(&self->state_mutex);
+        const gboolean running = self->running;
+        const int wake_fd = self->wakeup_pipe[0];
+        g_mutex_unlock(&self->state_mutex);
+
+        if (!running || self->display == NULL)
+        {
+            break;
+        }
+
+        if (next_capture_deadline == 0)
+        {
+            next_capture_deadline = g_get_monotonic_time();
+        }
+        const gint64 capture_interval = drd_frame_queue_get_pacing_interval_us(self->queue, target_interval, 1);
+
+        GPollFD pfds[2];
+        guint poll_count = 0;
+        pfds[poll_count].fd = XConnectionNumber(self->display);
+        pfds[poll_count].events = G_IO_IN;
+        pfds[poll_count].revents = 0;
+        poll_count++;
+        if (wake_fd >= 0)
+        {
+            pfds[poll_count].fd = wake_fd;
+            pfds[poll_count].events = G_IO_IN;
+            pfds[poll_count].revents = 0;
+            poll_count++;
+        }
+
+        gint poll_timeout_ms = (gint) (target_interval / 1000);
+        if (damage_pending)
+        {
+            const gint64 wait_us = next_capture_deadline - g_get_monotonic_time();
+            poll_timeout_ms = wait_us > 0 ? (gint) ((wait_us + 999) / 1000) : 0;
+        }
+        if (g_poll(pfds, poll_count, poll_timeout_ms) < 0)
+        {
+            continue;
+        }
+        if (wake_fd >= 0 && (pfds[1].revents & G_IO_IN))
+        {
+            drd_x11_window_capture_drain_wakeup_pipe(wake_fd);
+        }
+
+        while (XPending(self->display) > 0)
+        {
+            XEvent event;
+            XNextEvent(self->display, &event);
+            drd_x11_window_capture_handle_event(self, &event, &damage_pending);
+        }
+
+        if (self->window_gone || !self->mapped || self->pixmap == XCB_NONE)
+        {
+            damage_pending = FALSE;
+            continue;
+        }
+        if (!damage_pending)
+        {
+            continue;
+        }
+
+        gint64 now = g_get_monotonic_time();
+        if (now < next_capture_deadline)
+        {
+            continue;
+        }
+        if (!drd_frame_queue_can_accept(self->queue, 1))
+        {
+            stats_deferred++;
+            next_capture_deadline = now + DRD_X11_WINDOW_CAPTURE_BACKPRESSURE_RETRY_US;
+            continue;
+        }
+
+        const gint slot = drd_x11_shm_ring_acquire(self->ring);
+        if (slot < 0)
+        {
+            stats_ring_busy++;
+            next_capture_deadline = now + capture_interval;
+            continue;
+        }
+
+        gboolean full = FALSE;
+        gboolean full_fetch = FALSE;
+        gboolean direct = FALSE;
+        if (!drd_x11_window_capture_plan(self, &full, &full_fetch, &direct))
+        {
+            /* Damage 已随窗口一起被服务器回收，等待 DestroyNotify */
+            drd_x11_shm_ring_abort(self->ring, slot);
+            damage_pending = FALSE;
+            continue;
+        }
+        damage_pending = FALSE;
+        if (self->rects->len == 0)
+        {
+            drd_x11_shm_ring_abort(self->ring, slot);
+            continue;
+        }
+
+        if (!drd_x11_window_capture_emit(self, slot, full, direct, (guint64) g_get_monotonic_time(), &stats_damage_pixels))
+        {
+            DRD_LOG_WARNING("xcb_shm_get_image failed for window 0x%x, retrying", self->window_id);
+            damage_pending = TRUE;
+            next_capture_deadline = now + capture_interval;
+            continue;
+        }
+
+        stats_frames++;
+        now = g_get_monotonic_time();
+        if (stats_window_start == 0)
+        {
+            stats_window_start = now;
+        }
+        else if (now - stats_window_start >= stats_interval)
+        {
+            const gint64 stats_elapsed = now - stats_window_start;
+            const gdouble actual_fps = (gdouble) stats_frames * (gdouble) G_USEC_PER_SEC / (gdouble) stats_elapsed;
+            const gdouble damage_ratio = (gdouble) stats_damage_pixels * 100.0 / ((gdouble) stats_frames * (gdouble) self->width * (gdouble) self->height);
+            DRD_LOG_MESSAGE("X11 window capture fps=%.2f (target=%u): %s, interval=%.1fms, damage=%.1f%%, ring busy=%u, deferred=%u", actual_fps, target_fps,
+                            actual_fps >= (gdouble) target_fps ? "reached target" : "below target", (gdouble) capture_interval / 1000.0, damage_ratio, stats_ring_busy,
+                            stats_deferred);
+            stats_frames = 0;
+            stats_damage_pixels = 0;
+            stats_ring_busy = 0;
+            stats_deferred = 0;
+            stats_window_start = now;
+        }
+
+        next_capture_deadline += capture_interval;
+        if (next_capture_deadline < now)
+        {
+            next_capture_deadline = now + capture_interval;
+        }
+    }
+
+    g_object_unref(self);
+    return NULL;
+}
+
+/*
+ * 功能：捕获后端接口 start 适配。
+ * 逻辑：使用默认显示调用 drd_x11_window_capture_start。
+ * 参数：backend 捕获后端；width/height 画布尺寸；n_frame_slots 帧环槽位数；error 错误输出。
+ * 外部接口：drd_x11_window_capture_start。
+ */
+static gboolean drd_x11_window_capture_backend_start(DrdCaptureBackend *backend, guint width, guint height, guint n_frame_slots, GError **error)
+{
+    return drd_x11_window_capture_start(DRD_X11_WINDOW_CAPTURE(backend), NULL, width, height, n_frame_slots, error);
+}
+
+/*
+ * 功能：捕获后端接口 stop 适配。
+ * 逻辑：转发到 drd_x11_window_capture_stop。
+ * 参数：backend 捕获后端。
+ * 外部接口：drd_x11_window_capture_stop。
+ */
+static void drd_x11_window_capture_backend_stop(DrdCaptureBackend *backend)
+{
+    drd_x11_window_capture_stop(DRD_X11_WINDOW_CAPTURE(backend));
+}
+
+/*
+ * 功能：捕获后端接口 is_running 适配。
+ * 逻辑：转发到 drd_x11_window_capture_is_running。
+ * 参数：backend 捕获后端。
+ * 外部接口：drd_x11_window_capture_is_running。
+ */
+static gboolean drd_x11_window_capture_backend_is_running(DrdCaptureBackend *backend)
+{
+    return drd_x11_window_capture_is_running(DRD_X11_WINDOW_CAPTURE(backend));
+}
+
+/*
+ * 功能：捕获后端接口 get_display_size 适配。
+ * 逻辑：窗口捕获的“显示尺寸”即目标窗口当前尺寸，编码几何按其确定。
+ * 参数：backend 捕获后端；out_width/out_height 输出尺寸；error 错误输出。
+ * 外部接口：drd_x11_window_capture_get_window_size。
+ */
+static gboolean drd_x11_window_capture_backend_get_display_size(DrdCaptureBackend *backend, guint *out_width, guint *out_height, GError **error)
+{
+    return drd_x11_window_capture_get_window_size(DRD_X11_WINDOW_CAPTURE(backend), NULL, out_width, out_height, error);
+}
+
+/*
+ * 功能：捕获后端接口 get_origin 适配。
+ * 逻辑：转发到 drd_x11_window_capture_get_origin。
+ * 参数：backend 捕获后端；out_x/out_y 输出原点。
+ * 外部接口：drd_x11_window_capture_get_origin。
+ */
+static void drd_x11_window_capture_backend_get_origin(DrdCaptureBackend *backend, gint *out_x, gint *out_y)
+{
+    drd_x11_window_capture_get_origin(DRD_X11_WINDOW_CAPTURE(backend), out_x, out_y);
+}
+
+/*
+ * 功能：挂载捕获后端接口实现。
+ * 逻辑：把各接口方法指向窗口捕获适配函数；显示器布局使用接口默认的单个整画布显示器。
+ * 参数：iface 接口结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void drd_x11_window_capture_backend_iface_init(DrdCaptureBackendInterface *iface)
+{
+    iface->start = drd_x11_window_capture_backend_start;
+    iface->stop = drd_x11_window_capture_backend_stop;
+    iface->is_running = drd_x11_window_capture_backend_is_running;
+    iface->get_display_size = drd_x11_window_capture_backend_get_display_size;
+    iface->get_origin = drd_x11_window_capture_backend_get_origin;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glib-object.h>
+
+#include "utils/drd_frame_queue.h"
+
+G_BEGIN_DECLS
+
+#define DRD_TYPE_X11_WINDOW_CAPTURE (drd_x11_window_capture_get_type())
+G_DECLARE_FINAL_TYPE(DrdX11WindowCapture, drd_x11_window_capture, DRD, X11_WINDOW_CAPTURE, GObject)
+
+DrdX11WindowCapture *drd_x11_window_capture_new(DrdFrameQueue *queue, guint32 window_id);
+
+/**
+ * drd_x11_window_capture_start:
+ * @self: the window capture
+ * @display_name: X display to open, %NULL for the default one
+ * @requested_width: canvas width, 0 to use the window width
+ * @requested_height: canvas height, 0 to use the window height
+ * @n_frame_slots: frame ring size, at least the number of frames the
+ *   consumer can hold at once plus the latest and the one being written
+ * @error: return location for a #GError
+ *
+ * Redirects the target toplevel with XComposite and starts a thread that reads
+ * only the damaged parts of its pixmap. Frames keep the canvas size: a smaller
+ * window is padded with black, a larger one is cropped.
+ */
+gboolean drd_x11_window_capture_start(DrdX11WindowCapture *self,
+                                      const gchar *display_name,
+                                      guint requested_width,
+                                      guint requested_height,
+                                      guint n_frame_slots,
+                                      GError **error);
+void drd_x11_window_capture_stop(DrdX11WindowCapture *self);
+gboolean drd_x11_window_capture_is_running(DrdX11WindowCapture *self);
+gboolean drd_x11_window_capture_get_window_size(DrdX11WindowCapture *self,
+                                                const gchar *display_name,
+                                                guint *out_width,
+                                                guint *out_height,
+                                                GError **error);
+void drd_x11_window_capture_get_origin(DrdX11WindowCapture *self, gint *out_x, gint *out_y);
+
+G_END_DECLS
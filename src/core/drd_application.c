@@ -278,6 +278,10 @@ static gboolean drd_application_prepare_runtime(DrdApplication *self, DrdRuntime
         guint display_width = 0;
         guint display_height = 0;
         DrdCaptureManager *capture = drd_server_runtime_get_capture(self->runtime);
+        if (capture != NULL)
+        {
+            drd_capture_manager_set_options(capture, drd_config_get_capture_options(self->config));
+        }
         if (capture == NULL || !drd_capture_manager_get_display_size(capture, &display_width, &display_height, error))
         {
             if (error != NULL && *error == NULL)
@@ -346,7 +350,7 @@ static gboolean drd_application_start_listener(DrdApplication *self, GError **er
     }
 
     g_clear_object(&self->mode_controller);
-    self->mode_controller = G_OBJECT(drd_user_dbus_service_new(self->config));
+    self->mode_controller = G_OBJECT(drd_user_dbus_service_new(self->config, self->runtime));
     if (self->mode_controller == NULL)
     {
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate user DBus service");
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+    DRD_CAPTURE_BACKEND_X11 = 0,
+    DRD_CAPTURE_BACKEND_SYNTHETIC,
+    DRD_CAPTURE_BACKEND_WINDOW
+} DrdCaptureBackendKind;
+
+typedef enum
+{
+    DRD_SYNTHETIC_WORKLOAD_IDLE = 0,
+    DRD_SYNTHETIC_WORKLOAD_SCROLL,
+    DRD_SYNTHETIC_WORKLOAD_VIDEO,
+    DRD_SYNTHETIC_WORKLOAD_TYPING,
+    DRD_SYNTHETIC_WORKLOAD_FULLSCREEN
+} DrdSyntheticWorkload;
+
+#define DRD_CAPTURE_DEFAULT_BACKEND DRD_CAPTURE_BACKEND_X11
+#define DRD_CAPTURE_DEFAULT_SYNTHETIC_WORKLOAD DRD_SYNTHETIC_WORKLOAD_SCROLL
+#define DRD_CAPTURE_DEFAULT_PER_MONITOR FALSE
+#define DRD_CAPTURE_DEFAULT_WINDOW_ID 0
+
+static inline const gchar *
+drd_capture_backend_kind_to_string(DrdCaptureBackendKind kind)
+{
+    switch (kind)
+    {
+        case DRD_CAPTURE_BACKEND_X11:
+            return "x11";
+        case DRD_CAPTURE_BACKEND_SYNTHETIC:
+            return "synthetic";
+        case DRD_CAPTURE_BACKEND_WINDOW:
+            return "window";
+        default:
+            return "unknown";
+    }
+}
+
+static inline const gchar *
+drd_synthetic_workload_to_string(DrdSyntheticWorkload workload)
+{
+    switch (workload)
+    {
+        case DRD_SYNTHETIC_WORKLOAD_IDLE:
+            return "idle";
+        case DRD_SYNTHETIC_WORKLOAD_SCROLL:
+            return "scroll";
+        case DRD_SYNTHETIC_WORKLOAD_VIDEO:
+            return "video";
+        case DRD_SYNTHETIC_WORKLOAD_TYPING:
+            return "typing";
+        case DRD_SYNTHETIC_WORKLOAD_FULLSCREEN:
+            return "fullscreen";
+        default:
+            return "unknown";
+    }
+}
+
+typedef struct
+{
+    DrdCaptureBackendKind backend;
+    DrdSyntheticWorkload synthetic_workload;
+    /* 每个 XRandR 显示器独立捕获并映射为独立的图形表面 */
+    gboolean per_monitor;
+    /* window 后端共享的顶层窗口 XID */
+    guint32 window_id;
+} DrdCaptureOptions;
+
+G_END_DECLS
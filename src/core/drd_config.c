@@ -23,6 +23,7 @@ struct _DrdConfig
     DrdEncodingOptions encoding;
     guint capture_target_fps;
     guint capture_stats_interval_sec;
+    DrdCaptureOptions capture;
     gboolean single_login_logout_local_session;
 };
 
@@ -38,6 +39,15 @@ static gboolean drd_config_parse_runtime_mode(const gchar *value,
 
 static void drd_config_set_runtime_mode_internal(DrdConfig *self, DrdRuntimeMode mode);
 
+static gboolean drd_config_parse_capture_backend(const gchar *value,
+                                                 DrdCaptureBackendKind *out_kind,
+                                                 GError **error);
+
+static gboolean drd_config_parse_window_id(const gchar *value, guint32 *out_window_id, GError **error);
+static gboolean drd_config_parse_synthetic_workload(const gchar *value,
+                                                    DrdSyntheticWorkload *out_workload,
+                                                    GError **error);
+
 static void drd_config_refresh_pam_service(DrdConfig * self);
 
 /*
@@ -96,6 +106,8 @@ drd_config_init(DrdConfig *self)
     self->encoding.gfx_large_change_threshold = DRD_GFX_DEFAULT_LARGE_CHANGE_THRESHOLD;
     self->encoding.gfx_progressive_refresh_interval = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_INTERVAL;
     self->encoding.gfx_progressive_refresh_timeout_ms = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_TIMEOUT_MS;
+    self->encoding.gfx_damage_full_scan_interval = DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL;
+    self->encoding.scale_to_client = DRD_GFX_DEFAULT_SCALE_TO_CLIENT;
     self->base_dir = g_get_current_dir();
     self->nla_username = NULL;
     self->nla_password = NULL;
@@ -105,6 +117,10 @@ drd_config_init(DrdConfig *self)
     self->pam_service = NULL;
     self->capture_target_fps = 60;
     self->capture_stats_interval_sec = 5;
+    self->capture.backend = DRD_CAPTURE_DEFAULT_BACKEND;
+    self->capture.synthetic_workload = DRD_CAPTURE_DEFAULT_SYNTHETIC_WORKLOAD;
+    self->capture.per_monitor = DRD_CAPTURE_DEFAULT_PER_MONITOR;
+    self->capture.window_id = DRD_CAPTURE_DEFAULT_WINDOW_ID;
     self->single_login_logout_local_session = FALSE;
     drd_config_refresh_pam_service(self);
 }
@@ -194,6 +210,117 @@ drd_config_parse_runtime_mode(const gchar *value,
     return FALSE;
 }
 
+/*
+ * 功能：解析捕获后端名称。
+ * 逻辑：匹配 x11/window/synthetic，写入枚举值，其他值报错。
+ * 参数：value 字符串；out_kind 输出枚举；error 错误输出。
+ * 外部接口：GLib g_ascii_strcasecmp/g_set_error。
+ */
+static gboolean
+drd_config_parse_capture_backend(const gchar *value,
+                                 DrdCaptureBackendKind *out_kind,
+                                 GError **error)
+{
+    if (value == NULL)
+    {
+        return FALSE;
+    }
+
+    if (g_ascii_strcasecmp(value, "x11") == 0)
+    {
+        *out_kind = DRD_CAPTURE_BACKEND_X11;
+        return TRUE;
+    }
+    if (g_ascii_strcasecmp(value, "window") == 0)
+    {
+        *out_kind = DRD_CAPTURE_BACKEND_WINDOW;
+        return TRUE;
+    }
+    if (g_ascii_strcasecmp(value, "synthetic") == 0)
+    {
+        *out_kind = DRD_CAPTURE_BACKEND_SYNTHETIC;
+        return TRUE;
+    }
+
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Invalid capture backend '%s' (expected x11, window or synthetic)",
+                value);
+    return FALSE;
+}
+
+/*
+ * 功能：解析共享窗口的 XID。
+ * 逻辑：按 C 语法解析十进制或 0x 开头的十六进制，超出 32 位或含多余字符时报错。
+ * 参数：value 字符串；out_window_id 输出 XID；error 错误输出。
+ * 外部接口：GLib g_ascii_strtoull/g_set_error。
+ */
+static gboolean
+drd_config_parse_window_id(const gchar *value, guint32 *out_window_id, GError **error)
+{
+    if (value == NULL)
+    {
+        return FALSE;
+    }
+
+    gchar *end = NULL;
+    const guint64 parsed = g_ascii_strtoull(value, &end, 0);
+    if (end == value || *end != '\0' || parsed > G_MAXUINT32)
+    {
+        g_set_error(error,
+                    G_IO_ERROR,
+                    G_IO_ERROR_INVALID_ARGUMENT,
+                    "Invalid capture window id '%s'",
+                    value);
+        return FALSE;
+    }
+
+    *out_window_id = (guint32) parsed;
+    return TRUE;
+}
+
+/*
+ * 功能：解析合成负载名称。
+ * 逻辑：匹配 idle/scroll/video/typing/fullscreen，写入枚举值，其他值报错。
+ * 参数：value 字符串；out_workload 输出枚举；error 错误输出。
+ * 外部接口：GLib g_ascii_strcasecmp/g_set_error。
+ */
+static gboolean
+drd_config_parse_synthetic_workload(const gchar *value,
+                                    DrdSyntheticWorkload *out_workload,
+                                    GError **error)
+{
+    static const DrdSyntheticWorkload workloads[] = {
+        DRD_SYNTHETIC_WORKLOAD_IDLE,
+        DRD_SYNTHETIC_WORKLOAD_SCROLL,
+        DRD_SYNTHETIC_WORKLOAD_VIDEO,
+        DRD_SYNTHETIC_WORKLOAD_TYPING,
+        DRD_SYNTHETIC_WORKLOAD_FULLSCREEN,
+    };
+
+    if (value == NULL)
+    {
+        return FALSE;
+    }
+
+    for (gsize i = 0; i < G_N_ELEMENTS(workloads); i++)
+    {
+        if (g_ascii_strcasecmp(value, drd_synthetic_workload_to_string(workloads[i])) == 0)
+        {
+            *out_workload = workloads[i];
+            return TRUE;
+        }
+    }
+
+    g_set_error(error,
+                G_IO_ERROR,
+                G_IO_ERROR_INVALID_ARGUMENT,
+                "Invalid synthetic workload '%s' (expected idle, scroll, video, typing or fullscreen)",
+                value);
+    return FALSE;
+}
+
 /*
  * 功能：设置运行模式并刷新相关配置。
  * 逻辑：在模式变更时更新内部枚举并调用 PAM 服务刷新。
@@ -409,6 +536,53 @@ drd_config_load_from_key_file(DrdConfig *self, GKeyFile *keyfile, GError **error
         }
     }
 
+    if (g_key_file_has_key(keyfile, "capture", "backend", NULL))
+    {
+        g_autofree gchar *backend = g_key_file_get_string(keyfile, "capture", "backend", NULL);
+        if (!drd_config_parse_capture_backend(backend, &self->capture.backend, error))
+        {
+            return FALSE;
+        }
+    }
+
+    if (g_key_file_has_key(keyfile, "capture", "synthetic_workload", NULL))
+    {
+        g_autofree gchar *workload = g_key_file_get_string(keyfile, "capture", "synthetic_workload", NULL);
+        if (!drd_config_parse_synthetic_workload(workload, &self->capture.synthetic_workload, error))
+        {
+            return FALSE;
+        }
+    }
+
+    if (g_key_file_has_key(keyfile, "capture", "per_monitor", NULL))
+    {
+        g_autofree gchar *per_monitor = g_key_file_get_string(keyfile, "capture", "per_monitor", NULL);
+        gboolean value = FALSE;
+        if (!drd_config_parse_bool(per_monitor, &value, error))
+        {
+            return FALSE;
+        }
+        self->capture.per_monitor = value;
+    }
+
+    if (g_key_file_has_key(keyfile, "capture", "window_id", NULL))
+    {
+        g_autofree gchar *window_id = g_key_file_get_string(keyfile, "capture", "window_id", NULL);
+        if (!drd_config_parse_window_id(window_id, &self->capture.window_id, error))
+        {
+            return FALSE;
+        }
+    }
+
+    if (self->capture.backend == DRD_CAPTURE_BACKEND_WINDOW && self->capture.window_id == 0)
+    {
+        g_set_error_literal(error,
+                            G_IO_ERROR,
+                            G_IO_ERROR_INVALID_ARGUMENT,
+                            "Capture backend 'window' requires [capture] window_id");
+        return FALSE;
+    }
+
     if (g_key_file_has_key(keyfile, "encoding", "mode", NULL))
     {
         g_autofree gchar *mode = g_key_file_get_string(keyfile, "encoding", "mode", NULL);
@@ -497,6 +671,17 @@ drd_config_load_from_key_file(DrdConfig *self, GKeyFile *keyfile, GError **error
         self->encoding.h264_vm_support = value;
     }
 
+    if (g_key_file_has_key(keyfile, "encoding", "scale_to_client", NULL))
+    {
+        g_autofree gchar *scale = g_key_file_get_string(keyfile, "encoding", "scale_to_client", NULL);
+        gboolean value = DRD_GFX_DEFAULT_SCALE_TO_CLIENT;
+        if (!drd_config_parse_bool(scale, &value, error))
+        {
+            return FALSE;
+        }
+        self->encoding.scale_to_client = value;
+    }
+
     if (g_key_file_has_key(keyfile, "encoding", "gfx_large_change_threshold", NULL))
     {
         gdouble threshold = g_key_file_get_double(keyfile, "encoding", "gfx_large_change_threshold", NULL);
@@ -542,6 +727,21 @@ drd_config_load_from_key_file(DrdConfig *self, GKeyFile *keyfile, GError **error
         self->encoding.gfx_progressive_refresh_timeout_ms = (guint) timeout_ms;
     }
 
+    if (g_key_file_has_key(keyfile, "encoding", "gfx_damage_full_scan_interval", NULL))
+    {
+        gint64 interval = g_key_file_get_integer(keyfile, "encoding", "gfx_damage_full_scan_interval", NULL);
+        if (interval < 0)
+        {
+            g_set_error(error,
+                        G_IO_ERROR,
+                        G_IO_ERROR_INVALID_ARGUMENT,
+                        "Invalid gfx_damage_full_scan_interval %" G_GINT64_FORMAT " (must be >=0)",
+                        interval);
+            return FALSE;
+        }
+        self->encoding.gfx_damage_full_scan_interval = (guint) interval;
+    }
+
     if (g_key_file_has_key(keyfile, "auth", "username", NULL))
     {
         g_clear_pointer(&self->nla_username, g_free);
@@ -1068,6 +1268,19 @@ drd_config_get_capture_stats_interval_sec(DrdConfig *self)
     return self->capture_stats_interval_sec;
 }
 
+/*
+ * 功能：获取捕获后端选项结构体。
+ * 逻辑：类型检查后返回内部 capture 指针。
+ * 参数：self 配置实例。
+ * 外部接口：无额外外部库。
+ */
+const DrdCaptureOptions *
+drd_config_get_capture_options(DrdConfig *self)
+{
+    g_return_val_if_fail(DRD_IS_CONFIG(self), NULL);
+    return &self->capture;
+}
+
 /*
  * 功能：获取编码选项结构体。
  * 逻辑：类型检查后返回内部 encoding 指针。
@@ -2,6 +2,7 @@
 
 #include <glib-object.h>
 
+#include "core/drd_capture_options.h"
 #include "core/drd_encoding_options.h"
 
 G_BEGIN_DECLS
@@ -50,6 +51,7 @@ guint drd_config_get_capture_width(DrdConfig *self);
 guint drd_config_get_capture_height(DrdConfig *self);
 guint drd_config_get_capture_target_fps(DrdConfig *self);
 guint drd_config_get_capture_stats_interval_sec(DrdConfig *self);
+const DrdCaptureOptions *drd_config_get_capture_options(DrdConfig *self);
 const DrdEncodingOptions *drd_config_get_encoding_options(DrdConfig *self);
 gboolean drd_config_should_logout_local_session_on_single_login(DrdConfig *self);
 
@@ -17,10 +17,14 @@ typedef enum
 #define DRD_H264_DEFAULT_QP 15
 #define DRD_H264_DEFAULT_HW_ACCEL FALSE
 #define DRD_H264_DEFAULT_VM_SUPPORT FALSE
+/* VAAPI 流水线最多容纳的已提交、尚未发送的帧数，每帧持有其输入帧的引用 */
+#define DRD_VAAPI_PIPELINE_DEPTH 3
 
 #define DRD_GFX_DEFAULT_LARGE_CHANGE_THRESHOLD 0.05
 #define DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_INTERVAL 6
 #define DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_TIMEOUT_MS 100
+#define DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL 30
+#define DRD_GFX_DEFAULT_SCALE_TO_CLIENT FALSE
 
 static inline const gchar *
 drd_encoding_mode_to_string(DrdEncodingMode mode)
@@ -54,6 +58,8 @@ typedef struct
     gdouble gfx_large_change_threshold;
     guint gfx_progressive_refresh_interval;
     guint gfx_progressive_refresh_timeout_ms;
+    guint gfx_damage_full_scan_interval;
+    gboolean scale_to_client;
 } DrdEncodingOptions;
 
 G_END_DECLS
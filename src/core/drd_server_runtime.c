@@ -11,7 +11,23 @@ struct _DrdServerRuntime
 
     DrdCaptureManager *capture;
     DrdEncodingManager *encoder;
+    /* 多显示器流：monitors 为 DrdMonitorInfo 布局，encoders 按显示器编号排列且 [0] 即 encoder；单流时 monitors 为空 */
+    GArray *monitors;
+    GPtrArray *encoders;
+    /* 客户端 tile 缓存属于图形通道，由全部显示器编码器共享 */
+    DrdGfxCache *gfx_cache;
+    guint refresh_cursor;
+    /* 流尺寸与桌面尺寸不同时由 scaler 在编码前缩放；0 表示与桌面一致 */
+    guint stream_width;
+    guint stream_height;
+    DrdFrameScaler *scaler;
     DrdInputDispatcher *input;
+    guint input_event_count;
+    /* 窗口共享时捕获画面在根窗口中的原点，随窗口移动更新输入映射；由会话线程读取，原子访问 */
+    gboolean capture_area_active;
+    gint capture_origin_x;
+    gint capture_origin_y;
+    DrdX11Cursor *cursor;
     DrdTlsCredentials *tls;
     DrdEncodingOptions encoding_options;
     gboolean has_encoding_options;
@@ -23,7 +39,7 @@ G_DEFINE_TYPE(DrdServerRuntime, drd_server_runtime, G_TYPE_OBJECT)
 
 /*
  * 功能：释放运行时持有的模块资源。
- * 逻辑：调用 stop 停止流后，依次释放 capture/encoder/input/TLS 对象，再交给父类 dispose。
+ * 逻辑：调用 stop 停止流后，依次释放 capture/encoder（含各显示器编码器）/tile 缓存/scaler/input/cursor/TLS 对象，再交给父类 dispose。
  * 参数：object 基类指针，期望为 DrdServerRuntime。
  * 外部接口：drd_server_runtime_stop 关闭模块；GLib g_clear_object；GObjectClass::dispose。
  */
@@ -33,8 +49,13 @@ drd_server_runtime_dispose(GObject *object)
     DrdServerRuntime *self = DRD_SERVER_RUNTIME(object);
     drd_server_runtime_stop(self);
     g_clear_object(&self->capture);
+    g_clear_pointer(&self->encoders, g_ptr_array_unref);
+    g_clear_pointer(&self->monitors, g_array_unref);
     g_clear_object(&self->encoder);
+    g_clear_object(&self->gfx_cache);
+    g_clear_object(&self->scaler);
     g_clear_object(&self->input);
+    g_clear_object(&self->cursor);
     g_clear_object(&self->tls);
 
     G_OBJECT_CLASS(drd_server_runtime_parent_class)->dispose(object);
@@ -55,16 +76,30 @@ drd_server_runtime_class_init(DrdServerRuntimeClass *klass)
 
 /*
  * 功能：初始化运行时对象的成员。
- * 逻辑：创建捕获/编码/输入子模块，初始化标志位与默认传输模式。
+ * 逻辑：创建捕获/编码/输入/光标子模块，编码器同时作为 0 号显示器编码器登记并接入共享的客户端 tile 缓存，初始化标志位与默认传输模式。
  * 参数：self 运行时实例。
- * 外部接口：drd_capture_manager_new、drd_encoding_manager_new、drd_input_dispatcher_new 创建子组件；GLib g_atomic_int_set 设置原子值。
+ * 外部接口：drd_capture_manager_new、drd_encoding_manager_new、drd_gfx_cache_new、drd_input_dispatcher_new、drd_x11_cursor_new 创建子组件；
+ *           drd_encoding_manager_set_gfx_cache；GLib g_atomic_int_set 设置原子值。
  */
 static void
 drd_server_runtime_init(DrdServerRuntime *self)
 {
     self->capture = drd_capture_manager_new();
     self->encoder = drd_encoding_manager_new();
+    self->monitors = g_array_new(FALSE, FALSE, sizeof(DrdMonitorInfo));
+    self->encoders = g_ptr_array_new_with_free_func(g_object_unref);
+    g_ptr_array_add(self->encoders, g_object_ref(self->encoder));
+    self->gfx_cache = drd_gfx_cache_new();
+    drd_encoding_manager_set_gfx_cache(self->encoder, self->gfx_cache);
+    self->refresh_cursor = 0;
+    self->stream_width = 0;
+    self->stream_height = 0;
+    self->scaler = NULL;
     self->input = drd_input_dispatcher_new();
+    self->capture_area_active = FALSE;
+    g_atomic_int_set(&self->capture_origin_x, 0);
+    g_atomic_int_set(&self->capture_origin_y, 0);
+    self->cursor = drd_x11_cursor_new();
     self->tls = NULL;
     self->has_encoding_options = FALSE;
     self->stream_running = FALSE;
@@ -109,6 +144,19 @@ drd_server_runtime_get_encoder(DrdServerRuntime *self)
     return self->encoder;
 }
 
+/*
+ * 功能：获取光标跟踪器。
+ * 逻辑：类型检查后返回光标跟踪器指针；未运行时调用方应跳过指针同步。
+ * 参数：self 运行时实例。
+ * 外部接口：无额外外部库。
+ */
+DrdX11Cursor *
+drd_server_runtime_get_cursor(DrdServerRuntime *self)
+{
+    g_return_val_if_fail(DRD_IS_SERVER_RUNTIME(self), NULL);
+    return self->cursor;
+}
+
 /*
  * 功能：获取输入分发器。
  * 逻辑：类型检查后返回输入组件指针。
@@ -122,11 +170,116 @@ drd_server_runtime_get_input(DrdServerRuntime *self)
     return self->input;
 }
 
+/*
+ * 功能：重置全部编码器并回到单流布局。
+ * 逻辑：逐个重置各显示器编码器，只保留 0 号编码器并清空显示器布局。
+ * 参数：self 运行时实例。
+ * 外部接口：drd_encoding_manager_reset；GLib g_ptr_array_set_size/g_array_set_size。
+ */
+static void
+drd_server_runtime_reset_encoders(DrdServerRuntime *self)
+{
+    for (guint i = 0; i < self->encoders->len; i++)
+    {
+        drd_encoding_manager_reset(g_ptr_array_index(self->encoders, i));
+    }
+    g_ptr_array_set_size(self->encoders, 1);
+    g_array_set_size(self->monitors, 0);
+    self->refresh_cursor = 0;
+}
+
+/*
+ * 功能：按捕获布局准备各显示器的编码器。
+ * 逻辑：向捕获管理器查询显示器布局，只有一个显示器或需要缩放到流尺寸时保持单流（0 号编码器使用流尺寸）；多个显示器时每个显示器各用一个按其尺寸准备的编码器，0 号编码器对应主显示器；任一失败时回到单流并返回错误。
+ * 参数：self 运行时实例；encoding_options 编码选项；error 错误输出。
+ * 外部接口：drd_capture_manager_get_monitors 查询布局；drd_encoding_manager_new/set_gfx_cache/prepare 准备编码器；日志 DRD_LOG_WARNING/DRD_LOG_MESSAGE。
+ */
+static gboolean
+drd_server_runtime_prepare_encoders(DrdServerRuntime *self,
+                                    const DrdEncodingOptions *encoding_options,
+                                    GError **error)
+{
+    g_autoptr(GError) monitor_error = NULL;
+
+    g_ptr_array_set_size(self->encoders, 1);
+    g_array_set_size(self->monitors, 0);
+    self->refresh_cursor = 0;
+    if (!drd_capture_manager_get_monitors(self->capture, self->monitors, &monitor_error))
+    {
+        DRD_LOG_WARNING("Server runtime failed to query monitor layout, using single stream: %s",
+                        monitor_error != NULL ? monitor_error->message : "unknown");
+        g_array_set_size(self->monitors, 0);
+    }
+    if (self->monitors->len <= 1 || self->scaler != NULL)
+    {
+        g_array_set_size(self->monitors, 0);
+        return drd_encoding_manager_prepare(self->encoder, encoding_options, error);
+    }
+
+    for (guint i = 0; i < self->monitors->len; i++)
+    {
+        const DrdMonitorInfo *monitor = &g_array_index(self->monitors, DrdMonitorInfo, i);
+        DrdEncodingOptions monitor_options = *encoding_options;
+        monitor_options.width = monitor->width;
+        monitor_options.height = monitor->height;
+
+        if (i > 0)
+        {
+            DrdEncodingManager *encoder = drd_encoding_manager_new();
+            drd_encoding_manager_set_gfx_cache(encoder, self->gfx_cache);
+            g_ptr_array_add(self->encoders, encoder);
+        }
+        if (!drd_encoding_manager_prepare(g_ptr_array_index(self->encoders, i), &monitor_options, error))
+        {
+            drd_server_runtime_reset_encoders(self);
+            return FALSE;
+        }
+        DRD_LOG_MESSAGE("Server runtime monitor %u: %ux%u at (%d,%d)%s", i, monitor->width, monitor->height, monitor->x,
+                        monitor->y, monitor->primary ? " primary" : "");
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：计算编码器跨帧持有的帧数。
+ * 逻辑：启用硬件 H.264 时为流水线在途各帧的输入（差分参考帧即最近提交的一帧），否则为差分参考帧。
+ * 参数：encoding_options 编码选项。
+ * 外部接口：无额外外部库。
+ */
+static guint
+drd_server_runtime_get_encoder_held_frames(const DrdEncodingOptions *encoding_options)
+{
+    return encoding_options->h264_hw_accel ? DRD_VAAPI_PIPELINE_DEPTH : 1;
+}
+
+/*
+ * 功能：计算每个捕获输出需要的帧槽位数。
+ * 逻辑：按实际持有捕获帧的位置逐项相加：最新帧（新槽位增量同步的来源）与正在写入的一帧；帧队列中该输出信箱里的一帧；
+ *       渲染线程取出后正在处理的一帧；编码器跨帧持有的帧。缩放时编码器持有的是缩放器输出，捕获帧缩放完即释放，不再计入编码器持有的帧。
+ * 参数：self 运行时实例；encoding_options 编码选项。
+ * 外部接口：drd_server_runtime_get_encoder_held_frames。
+ */
+static guint
+drd_server_runtime_get_capture_frame_slots(DrdServerRuntime *self, const DrdEncodingOptions *encoding_options)
+{
+    /* 最新帧、正在写入的一帧、信箱中的一帧与渲染线程正在处理的一帧 */
+    guint slots = 4;
+    if (self->scaler == NULL)
+    {
+        slots += drd_server_runtime_get_encoder_held_frames(encoding_options);
+    }
+    return slots;
+}
+
 /*
  * 功能：准备捕获/编码/输入流水线并启动捕获线程。
- * 逻辑：若已运行则直接返回；缓存编码配置并设置默认传输模式；依次准备编码器、输入分发器与捕获管理器，任一失败则回滚已启动的模块；成功后标记 stream_running。
+ * 逻辑：若已运行则直接返回；缓存编码配置并设置默认传输模式；流尺寸与桌面尺寸不同时创建缩放器（输出缓冲数为编码器跨帧持有的帧数加正在写入的一帧），
+ *       编码器与输入分发器使用流尺寸、捕获仍使用桌面尺寸；
+ *       依次按显示器布局准备编码器、输入分发器与捕获管理器（帧槽位数按下游实际持有的捕获帧计算），任一失败则回滚已启动的模块并释放缩放器；窗口共享时把输入映射到窗口所在区域；
+ *       随后启动光标跟踪（失败只告警，光标退回画面内绘制）；成功后标记 stream_running。
  * 参数：self 运行时实例；encoding_options 编码选项；error 错误输出。
- * 外部接口：drd_encoding_manager_prepare/reset、drd_input_dispatcher_start/stop、drd_capture_manager_start；日志 DRD_LOG_MESSAGE。
+ * 外部接口：drd_frame_scaler_new、drd_server_runtime_prepare_encoders/reset_encoders/get_encoder_held_frames/get_capture_frame_slots、drd_input_dispatcher_start/stop/set_capture_area、drd_capture_manager_start/get_origin、drd_x11_cursor_start；
+ *           日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
  */
 gboolean
 drd_server_runtime_prepare_stream(DrdServerRuntime *self,
@@ -145,42 +298,88 @@ drd_server_runtime_prepare_stream(DrdServerRuntime *self,
     self->has_encoding_options = TRUE;
     g_atomic_int_set(&self->transport_mode, DRD_FRAME_TRANSPORT_GRAPHICS_PIPELINE);
 
-    if (!drd_encoding_manager_prepare(self->encoder, encoding_options, error))
+    DrdEncodingOptions stream_options = *encoding_options;
+    drd_server_runtime_get_stream_size(self, &stream_options.width, &stream_options.height);
+    g_clear_object(&self->scaler);
+    if (stream_options.width != encoding_options->width || stream_options.height != encoding_options->height)
+    {
+        self->scaler = drd_frame_scaler_new(stream_options.width,
+                                            stream_options.height,
+                                            drd_server_runtime_get_encoder_held_frames(encoding_options) + 1);
+    }
+
+    if (!drd_server_runtime_prepare_encoders(self, &stream_options, error))
     {
+        g_clear_object(&self->scaler);
         return FALSE;
     }
 
     if (!drd_input_dispatcher_start(self->input,
-                                    encoding_options->width,
-                                    encoding_options->height,
+                                    stream_options.width,
+                                    stream_options.height,
                                     error))
     {
-        drd_encoding_manager_reset(self->encoder);
+        drd_server_runtime_reset_encoders(self);
+        g_clear_object(&self->scaler);
         return FALSE;
     }
 
     if (!drd_capture_manager_start(self->capture,
                                    encoding_options->width,
                                    encoding_options->height,
+                                   drd_server_runtime_get_capture_frame_slots(self, encoding_options),
                                    error))
     {
         drd_input_dispatcher_stop(self->input);
-        drd_encoding_manager_reset(self->encoder);
+        drd_server_runtime_reset_encoders(self);
+        g_clear_object(&self->scaler);
         return FALSE;
     }
 
+    gint origin_x = 0;
+    gint origin_y = 0;
+    self->capture_area_active = drd_capture_manager_get_options(self->capture)->backend == DRD_CAPTURE_BACKEND_WINDOW;
+    if (self->capture_area_active)
+    {
+        drd_capture_manager_get_origin(self->capture, &origin_x, &origin_y);
+        drd_input_dispatcher_set_capture_area(self->input, origin_x, origin_y, encoding_options->width, encoding_options->height);
+    }
+    else
+    {
+        drd_input_dispatcher_set_capture_area(self->input, 0, 0, 0, 0);
+    }
+    g_atomic_int_set(&self->capture_origin_x, origin_x);
+    g_atomic_int_set(&self->capture_origin_y, origin_y);
+
+    g_autoptr(GError) cursor_error = NULL;
+    if (!drd_x11_cursor_start(self->cursor, NULL, &cursor_error))
+    {
+        DRD_LOG_WARNING("Server runtime cursor tracking unavailable: %s",
+                        cursor_error != NULL ? cursor_error->message : "unknown");
+    }
+
     self->stream_running = TRUE;
-    DRD_LOG_MESSAGE("Server runtime prepared stream with geometry %ux%u",
-                    encoding_options->width,
-                    encoding_options->height);
+    if (self->scaler != NULL)
+    {
+        DRD_LOG_MESSAGE("Server runtime scaling desktop %ux%u to stream %ux%u (%s kernel)",
+                        encoding_options->width,
+                        encoding_options->height,
+                        stream_options.width,
+                        stream_options.height,
+                        drd_frame_scaler_get_kernel_name());
+    }
+    DRD_LOG_MESSAGE("Server runtime prepared stream with geometry %ux%u (%u monitor stream(s))",
+                    stream_options.width,
+                    stream_options.height,
+                    self->encoders->len);
     return TRUE;
 }
 
 /*
  * 功能：停止正在运行的捕获/编码流水线。
- * 逻辑：若未运行则返回；清除运行标志后停止捕获、重置编码器并刷新/停止输入分发器。
+ * 逻辑：若未运行则返回；清除运行标志后停止捕获与光标跟踪、重置全部编码器、释放缩放器并刷新/停止输入分发器。
  * 参数：self 运行时实例。
- * 外部接口：drd_capture_manager_stop、drd_encoding_manager_reset、drd_input_dispatcher_flush/stop；日志 DRD_LOG_MESSAGE。
+ * 外部接口：drd_capture_manager_stop、drd_x11_cursor_stop、drd_server_runtime_reset_encoders、drd_input_dispatcher_flush/stop；日志 DRD_LOG_MESSAGE。
  */
 void
 drd_server_runtime_stop(DrdServerRuntime *self)
@@ -195,12 +394,108 @@ drd_server_runtime_stop(DrdServerRuntime *self)
 
     self->stream_running = FALSE;
     drd_capture_manager_stop(self->capture);
-    drd_encoding_manager_reset(self->encoder);
+    drd_x11_cursor_stop(self->cursor);
+    drd_server_runtime_reset_encoders(self);
+    g_clear_object(&self->scaler);
     drd_input_dispatcher_flush(self->input);
     drd_input_dispatcher_stop(self->input);
     DRD_LOG_MESSAGE("Server runtime stopped and released capture/encoding resources");
 }
 
+/*
+ * 功能：选出下一次缓存刷新使用的编码器。
+ * 逻辑：多显示器流时在各显示器编码器间轮转，使每个表面都能定期刷新；输出对应的表面偏移。
+ * 参数：self 运行时实例；out_index 输出显示器编号。
+ * 外部接口：无额外外部库。
+ */
+static DrdEncodingManager *
+drd_server_runtime_next_refresh_encoder(DrdServerRuntime *self, guint *out_index)
+{
+    const guint index = self->refresh_cursor % self->encoders->len;
+    self->refresh_cursor = index + 1;
+    *out_index = index;
+    return g_ptr_array_index(self->encoders, index);
+}
+
+/*
+ * 功能：按需把捕获帧缩放为流尺寸。
+ * 逻辑：未启用缩放时保持原帧；否则用缩放器只重新采样损坏区域，替换为流尺寸的帧。
+ * 参数：self 运行时实例；frame 输入输出帧。
+ * 外部接口：drd_frame_scaler_process。
+ */
+static void
+drd_server_runtime_scale_frame(DrdServerRuntime *self, DrdFrame **frame)
+{
+    if (self->scaler == NULL)
+    {
+        return;
+    }
+
+    DrdFrame *scaled = drd_frame_scaler_process(self->scaler, *frame);
+    if (scaled != NULL)
+    {
+        g_object_unref(*frame);
+        *frame = scaled;
+    }
+}
+
+/*
+ * 功能：把客户端输入活动转告采集节奏。
+ * 逻辑：比较输入分发器的事件计数，变化时通知帧队列，使采集间隔立即退出空闲放宽。
+ * 参数：self 运行时实例。
+ * 外部接口：drd_input_dispatcher_get_input_event_count；drd_capture_manager_get_queue/drd_frame_queue_note_input_activity。
+ */
+static void
+drd_server_runtime_forward_input_activity(DrdServerRuntime *self)
+{
+    if (self->input == NULL)
+    {
+        return;
+    }
+
+    const guint input_events = drd_input_dispatcher_get_input_event_count(self->input);
+    if (input_events != self->input_event_count)
+    {
+        self->input_event_count = input_events;
+        drd_frame_queue_note_input_activity(drd_capture_manager_get_queue(self->capture));
+    }
+}
+
+/*
+ * 功能：跟随共享窗口的移动更新输入映射。
+ * 逻辑：仅窗口共享时生效；读取捕获后端记录的窗口原点，变化时写入原子字段并更新输入分发器的捕获区域。
+ * 参数：self 运行时实例。
+ * 外部接口：drd_capture_manager_get_origin、drd_input_dispatcher_set_capture_area。
+ */
+static void
+drd_server_runtime_sync_capture_origin(DrdServerRuntime *self)
+{
+    if (!self->capture_area_active)
+    {
+        return;
+    }
+
+    gint origin_x = 0;
+    gint origin_y = 0;
+    drd_capture_manager_get_origin(self->capture, &origin_x, &origin_y);
+    if (origin_x == g_atomic_int_get(&self->capture_origin_x) && origin_y == g_atomic_int_get(&self->capture_origin_y))
+    {
+        return;
+    }
+
+    g_atomic_int_set(&self->capture_origin_x, origin_x);
+    g_atomic_int_set(&self->capture_origin_y, origin_y);
+    drd_input_dispatcher_set_capture_area(self->input, origin_x, origin_y, self->encoding_options.width, self->encoding_options.height);
+}
+
+/*
+ * 功能：等待捕获帧并通过 Rdpgfx 编码发送。
+ * 逻辑：先把输入活动转告采集节奏并跟随共享窗口的位置，再等待捕获队列；超时时先发送编码流水线中待发的帧，
+ *       没有待发帧且刷新间隔到达时发送缓存帧刷新（多显示器时轮转）；取到帧后按需缩放为流尺寸，再按帧的显示器编号选择编码器，并发送到 surface_id + 显示器编号对应的表面。
+ * 参数：self 运行时实例；settings FreeRDP 设置；context Rdpgfx 上下文；surface_id 首个表面编号；timeout_us 等待时长；frame_id 帧序号；h264 输出是否使用 H.264；error 错误输出。
+ * 外部接口：drd_capture_manager_wait_frame、drd_encoding_manager_encode_surface_gfx/encode_cached_frame_gfx/refresh_interval_reached/
+ *           has_pending_gfx/flush_gfx。
+ */
 gboolean drd_server_runtime_pull_encoded_frame_surface_gfx(DrdServerRuntime *self,
                                                            rdpSettings *settings,
                                                            RdpgfxServerContext *context,
@@ -217,20 +512,39 @@ gboolean drd_server_runtime_pull_encoded_frame_surface_gfx(DrdServerRuntime *sel
     const gboolean auto_switch = self->has_encoding_options &&
                                  self->encoding_options.mode == DRD_ENCODING_MODE_AUTO;
 
+    drd_server_runtime_forward_input_activity(self);
+    drd_server_runtime_sync_capture_origin(self);
     g_autoptr(DrdFrame) frame = NULL;
     g_autoptr(GError) capture_error = NULL;
     if (!drd_capture_manager_wait_frame(self->capture, timeout_us, &frame, &capture_error))
     {
-        const gboolean refresh_due = drd_encoding_manager_refresh_interval_reached(self->encoder);
+        /* 没有新帧时先送出编码流水线中已提交的帧，否则它们要等到下一次捕获 */
+        if (capture_error != NULL && capture_error->domain == G_IO_ERROR &&
+            capture_error->code == G_IO_ERROR_TIMED_OUT && context != NULL)
+        {
+            for (guint i = 0; i < self->encoders->len; ++i)
+            {
+                DrdEncodingManager *encoder = g_ptr_array_index(self->encoders, i);
+                if (drd_encoding_manager_has_pending_gfx(encoder))
+                {
+                    return drd_encoding_manager_flush_gfx(encoder, context, (guint16) (surface_id + i), frame_id,
+                                                          h264, error);
+                }
+            }
+        }
+
+        guint refresh_index = 0;
+        DrdEncodingManager *refresh_encoder = drd_server_runtime_next_refresh_encoder(self, &refresh_index);
+        const gboolean refresh_due = drd_encoding_manager_refresh_interval_reached(refresh_encoder);
 
         if (capture_error != NULL && capture_error->domain == G_IO_ERROR &&
             capture_error->code == G_IO_ERROR_TIMED_OUT && refresh_due)
         {
             g_clear_error(&capture_error);
-            return drd_encoding_manager_encode_cached_frame_gfx(self->encoder,
+            return drd_encoding_manager_encode_cached_frame_gfx(refresh_encoder,
                                                                 settings,
                                                                 context,
-                                                                surface_id,
+                                                                (guint16) (surface_id + refresh_index),
                                                                 frame_id,
                                                                 h264,
                                                                 auto_switch,
@@ -245,10 +559,19 @@ gboolean drd_server_runtime_pull_encoded_frame_surface_gfx(DrdServerRuntime *sel
         return FALSE;
     }
 
-    return drd_encoding_manager_encode_surface_gfx(self->encoder,
+    drd_server_runtime_scale_frame(self, &frame);
+    const guint monitor = drd_frame_get_monitor(frame);
+    if (monitor >= self->encoders->len)
+    {
+        /* 布局在捕获与编码器准备之间发生变化，丢弃无法映射的帧 */
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_PENDING, "Dropped frame for unmapped monitor %u", monitor);
+        return FALSE;
+    }
+
+    return drd_encoding_manager_encode_surface_gfx(g_ptr_array_index(self->encoders, monitor),
                                                    settings,
                                                    context,
-                                                   surface_id,
+                                                   (guint16) (surface_id + monitor),
                                                    frame,
                                                    frame_id,
                                                    h264,
@@ -256,6 +579,12 @@ gboolean drd_server_runtime_pull_encoded_frame_surface_gfx(DrdServerRuntime *sel
                                                    error);
 }
 
+/*
+ * 功能：发送缓存帧刷新。
+ * 逻辑：选出下一个刷新编码器（多显示器时轮转），对其缓存帧编码并发送到对应表面。
+ * 参数：self 运行时实例；settings FreeRDP 设置；context Rdpgfx 上下文；surface_id 首个表面编号；frame_id 帧序号；h264 输出是否使用 H.264；error 错误输出。
+ * 外部接口：drd_encoding_manager_encode_cached_frame_gfx。
+ */
 gboolean drd_server_runtime_send_cached_frame_surface_gfx(DrdServerRuntime *self,
                                                           rdpSettings *settings,
                                                           RdpgfxServerContext *context,
@@ -272,10 +601,12 @@ gboolean drd_server_runtime_send_cached_frame_surface_gfx(DrdServerRuntime *self
     const gboolean auto_switch = self->has_encoding_options &&
                                  self->encoding_options.mode == DRD_ENCODING_MODE_AUTO;
 
-    return drd_encoding_manager_encode_cached_frame_gfx(self->encoder,
+    guint refresh_index = 0;
+    DrdEncodingManager *refresh_encoder = drd_server_runtime_next_refresh_encoder(self, &refresh_index);
+    return drd_encoding_manager_encode_cached_frame_gfx(refresh_encoder,
                                                         settings,
                                                         context,
-                                                        surface_id,
+                                                        (guint16) (surface_id + refresh_index),
                                                         frame_id,
                                                         h264,
                                                         auto_switch,
@@ -293,12 +624,15 @@ gboolean drd_server_runtime_pull_encoded_frame_surface_bit(DrdServerRuntime *sel
     g_return_val_if_fail(self->capture != NULL, FALSE);
     g_return_val_if_fail(context != NULL, FALSE);
 
+    drd_server_runtime_forward_input_activity(self);
+    drd_server_runtime_sync_capture_origin(self);
     g_autoptr(DrdFrame) frame = NULL;
     if (!drd_capture_manager_wait_frame(self->capture, timeout_us, &frame, error))
     {
         return FALSE;
     }
 
+    drd_server_runtime_scale_frame(self, &frame);
     return drd_encoding_manager_encode_surface_bit(self->encoder,
                                                    context,
                                                    frame,
@@ -311,7 +645,7 @@ gboolean drd_server_runtime_pull_encoded_frame_surface_bit(DrdServerRuntime *sel
  * 功能：切换帧传输模式并在变更时请求关键帧。
  * 逻辑：使用原子 CAS 更新 transport_mode；仅当实际发生切换时触发编码器关键帧，避免互斥锁竞争。
  * 参数：self 运行时实例；transport 目标传输模式。
- * 外部接口：GLib g_atomic_int_get/g_atomic_int_compare_and_exchange；调用 drd_encoding_manager_force_keyframe。
+ * 外部接口：GLib g_atomic_int_get/g_atomic_int_compare_and_exchange；调用 drd_server_runtime_request_keyframe。
  */
 void
 drd_server_runtime_set_transport(DrdServerRuntime *self, DrdFrameTransport transport)
@@ -332,7 +666,7 @@ drd_server_runtime_set_transport(DrdServerRuntime *self, DrdFrameTransport trans
          */
         if (g_atomic_int_compare_and_exchange(&self->transport_mode, current, desired))
         {
-            drd_encoding_manager_force_keyframe(self->encoder);
+            drd_server_runtime_request_keyframe(self);
             return;
         }
     }
@@ -402,7 +736,10 @@ drd_server_runtime_set_encoding_options(DrdServerRuntime *self,
                                       self->encoding_options.gfx_progressive_refresh_interval !=
                                               encoding_options->gfx_progressive_refresh_interval ||
                                       self->encoding_options.gfx_progressive_refresh_timeout_ms !=
-                                              encoding_options->gfx_progressive_refresh_timeout_ms);
+                                              encoding_options->gfx_progressive_refresh_timeout_ms ||
+                                      self->encoding_options.gfx_damage_full_scan_interval !=
+                                              encoding_options->gfx_damage_full_scan_interval ||
+                                      self->encoding_options.scale_to_client != encoding_options->scale_to_client);
 
     self->encoding_options = *encoding_options;
     self->has_encoding_options = TRUE;
@@ -426,6 +763,125 @@ drd_server_runtime_is_stream_running(DrdServerRuntime *self)
     return self->stream_running;
 }
 
+/*
+ * 功能：设置客户端流尺寸。
+ * 逻辑：0 或与桌面尺寸相同表示不缩放；流未运行时记录并在下次准备流时生效，流已运行时只有与当前流尺寸一致才返回 TRUE。
+ * 参数：self 运行时实例；width/height 流尺寸。
+ * 外部接口：无额外外部库。
+ */
+gboolean
+drd_server_runtime_set_stream_size(DrdServerRuntime *self, guint width, guint height)
+{
+    g_return_val_if_fail(DRD_IS_SERVER_RUNTIME(self), FALSE);
+
+    if (self->has_encoding_options && width == self->encoding_options.width &&
+        height == self->encoding_options.height)
+    {
+        width = 0;
+        height = 0;
+    }
+    if (width == 0 || height == 0)
+    {
+        width = 0;
+        height = 0;
+    }
+
+    if (self->stream_running)
+    {
+        return self->stream_width == width && self->stream_height == height;
+    }
+
+    self->stream_width = width;
+    self->stream_height = height;
+    return TRUE;
+}
+
+/*
+ * 功能：获取实际编码与发送的流尺寸。
+ * 逻辑：设置过流尺寸时返回该尺寸，否则返回编码配置中的桌面尺寸。
+ * 参数：self 运行时实例；out_width/out_height 输出尺寸。
+ * 外部接口：无额外外部库。
+ */
+void
+drd_server_runtime_get_stream_size(DrdServerRuntime *self, guint *out_width, guint *out_height)
+{
+    g_return_if_fail(DRD_IS_SERVER_RUNTIME(self));
+    g_return_if_fail(out_width != NULL && out_height != NULL);
+
+    if (self->stream_width > 0 && self->stream_height > 0)
+    {
+        *out_width = self->stream_width;
+        *out_height = self->stream_height;
+        return;
+    }
+    *out_width = self->encoding_options.width;
+    *out_height = self->encoding_options.height;
+}
+
+/*
+ * 功能：读取捕获画面在根窗口中的原点。
+ * 逻辑：原子读取最近一次同步的原点；整屏捕获时为 (0, 0)，窗口共享时为窗口左上角。
+ * 参数：self 运行时实例；out_x/out_y 输出原点。
+ * 外部接口：GLib g_atomic_int_get。
+ */
+void
+drd_server_runtime_get_capture_origin(DrdServerRuntime *self, gint *out_x, gint *out_y)
+{
+    g_return_if_fail(DRD_IS_SERVER_RUNTIME(self));
+    g_return_if_fail(out_x != NULL && out_y != NULL);
+
+    *out_x = g_atomic_int_get(&self->capture_origin_x);
+    *out_y = g_atomic_int_get(&self->capture_origin_y);
+}
+
+/*
+ * 功能：切换共享的窗口。
+ * 逻辑：流运行中拒绝切换；窗口 XID 非 0 时切换到 window 捕获后端，为 0 时从窗口共享回到整屏 X11 捕获；
+ *       查询新的捕获尺寸失败（窗口不存在等）时恢复原捕获选项，成功则以其更新编码几何，下一次准备流时生效。
+ * 参数：self 运行时实例；window_id 目标顶层窗口 XID，0 表示整个桌面；error 错误输出。
+ * 外部接口：drd_capture_manager_get_options/set_options/get_display_size；GLib g_set_error_literal；日志 DRD_LOG_MESSAGE。
+ */
+gboolean
+drd_server_runtime_set_capture_window(DrdServerRuntime *self, guint32 window_id, GError **error)
+{
+    g_return_val_if_fail(DRD_IS_SERVER_RUNTIME(self), FALSE);
+
+    if (self->stream_running)
+    {
+        g_set_error_literal(error,
+                            G_IO_ERROR,
+                            G_IO_ERROR_BUSY,
+                            "Cannot switch the shared window while a stream is running");
+        return FALSE;
+    }
+
+    const DrdCaptureOptions previous = *drd_capture_manager_get_options(self->capture);
+    DrdCaptureOptions options = previous;
+    if (window_id != 0)
+    {
+        options.backend = DRD_CAPTURE_BACKEND_WINDOW;
+    }
+    else if (previous.backend == DRD_CAPTURE_BACKEND_WINDOW)
+    {
+        options.backend = DRD_CAPTURE_BACKEND_X11;
+    }
+    options.window_id = window_id;
+    drd_capture_manager_set_options(self->capture, &options);
+
+    guint width = 0;
+    guint height = 0;
+    if (!drd_capture_manager_get_display_size(self->capture, &width, &height, error))
+    {
+        drd_capture_manager_set_options(self->capture, &previous);
+        return FALSE;
+    }
+
+    self->encoding_options.width = width;
+    self->encoding_options.height = height;
+    DRD_LOG_MESSAGE("Server runtime sharing %s (%ux%u)", window_id != 0 ? "window" : "desktop", width, height);
+    return TRUE;
+}
+
 /*
  * 功能：设置 TLS 凭据。
  * 逻辑：引用计数新凭据并替换旧值。
@@ -459,7 +915,7 @@ drd_server_runtime_get_tls_credentials(DrdServerRuntime *self)
 
 /*
  * 功能：请求编码器生成关键帧。
- * 逻辑：直接调用编码管理器的强制关键帧接口。
+ * 逻辑：对每个显示器编码器调用强制关键帧接口。
  * 参数：self 运行时实例。
  * 外部接口：drd_encoding_manager_force_keyframe。
  */
@@ -467,9 +923,49 @@ void
 drd_server_runtime_request_keyframe(DrdServerRuntime *self)
 {
     g_return_if_fail(DRD_IS_SERVER_RUNTIME(self));
-    drd_encoding_manager_force_keyframe(self->encoder);
+    for (guint i = 0; i < self->encoders->len; i++)
+    {
+        drd_encoding_manager_force_keyframe(g_ptr_array_index(self->encoders, i));
+    }
+}
+
+/*
+ * 功能：清空客户端 tile 缓存的服务端记录。
+ * 逻辑：图形通道重新打开后客户端缓存为空，请求共享缓存在下一帧编码前清空。
+ * 参数：self 运行时实例。
+ * 外部接口：drd_gfx_cache_invalidate。
+ */
+void
+drd_server_runtime_reset_gfx_cache(DrdServerRuntime *self)
+{
+    g_return_if_fail(DRD_IS_SERVER_RUNTIME(self));
+    drd_gfx_cache_invalidate(self->gfx_cache);
+}
+
+/*
+ * 功能：获取多显示器流的显示器布局。
+ * 逻辑：返回按显示器编号排列的布局数组；单流时返回 NULL 且数量为 0，调用方使用单个桌面表面。
+ * 参数：self 运行时实例；n_monitors 输出显示器数量。
+ * 外部接口：无额外外部库。
+ */
+const DrdMonitorInfo *
+drd_server_runtime_get_monitors(DrdServerRuntime *self, guint *n_monitors)
+{
+    g_return_val_if_fail(DRD_IS_SERVER_RUNTIME(self), NULL);
+    g_return_val_if_fail(n_monitors != NULL, NULL);
+
+    *n_monitors = self->monitors->len;
+    return self->monitors->len > 0 ? (const DrdMonitorInfo *) self->monitors->data : NULL;
 }
+
 gboolean drd_runtime_encoder_prepare(DrdServerRuntime *self, guint32 codecs, rdpSettings *settings)
 {
-    return drd_encoder_prepare(self->encoder, codecs, settings);
+    for (guint i = 0; i < self->encoders->len; i++)
+    {
+        if (!drd_encoder_prepare(g_ptr_array_index(self->encoders, i), codecs, settings))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
 }
@@ -3,8 +3,10 @@
 #include <glib-object.h>
 
 #include "capture/drd_capture_manager.h"
+#include "capture/drd_x11_cursor.h"
 #include "core/drd_encoding_options.h"
 #include "encoding/drd_encoding_manager.h"
+#include "encoding/drd_frame_scaler.h"
 #include "input/drd_input_dispatcher.h"
 #include "security/drd_tls_credentials.h"
 
@@ -24,6 +26,7 @@ DrdServerRuntime *drd_server_runtime_new(void);
 DrdCaptureManager *drd_server_runtime_get_capture(DrdServerRuntime *self);
 DrdEncodingManager *drd_server_runtime_get_encoder(DrdServerRuntime *self);
 DrdInputDispatcher *drd_server_runtime_get_input(DrdServerRuntime *self);
+DrdX11Cursor *drd_server_runtime_get_cursor(DrdServerRuntime *self);
 
 gboolean drd_server_runtime_prepare_stream(DrdServerRuntime *self, const DrdEncodingOptions *encoding_options,
                                            GError **error);
@@ -56,9 +59,39 @@ DrdFrameTransport drd_server_runtime_get_transport(DrdServerRuntime *self);
 gboolean drd_server_runtime_get_encoding_options(DrdServerRuntime *self, DrdEncodingOptions *out_options);
 void drd_server_runtime_set_encoding_options(DrdServerRuntime *self, const DrdEncodingOptions *encoding_options);
 gboolean drd_server_runtime_is_stream_running(DrdServerRuntime *self);
+
+/**
+ * drd_server_runtime_set_stream_size:
+ * @self: the runtime
+ * @width: client stream width, 0 for the desktop width
+ * @height: client stream height, 0 for the desktop height
+ *
+ * Sets the geometry frames are encoded at. A size other than the desktop
+ * size makes the next prepared stream scale captured frames before encoding.
+ *
+ * Returns: %FALSE when a running stream uses a different size.
+ */
+gboolean drd_server_runtime_set_stream_size(DrdServerRuntime *self, guint width, guint height);
+void drd_server_runtime_get_stream_size(DrdServerRuntime *self, guint *out_width, guint *out_height);
+
+/**
+ * drd_server_runtime_set_capture_window:
+ * @self: the runtime
+ * @window_id: XID of the toplevel to share, 0 for the whole desktop
+ * @error: return location for a #GError
+ *
+ * Switches capture between a single window and the desktop. The encoding
+ * geometry follows the new capture size from the next prepared stream on.
+ *
+ * Returns: %FALSE while a stream is running or when the window does not exist.
+ */
+gboolean drd_server_runtime_set_capture_window(DrdServerRuntime *self, guint32 window_id, GError **error);
+void drd_server_runtime_get_capture_origin(DrdServerRuntime *self, gint *out_x, gint *out_y);
 void drd_server_runtime_set_tls_credentials(DrdServerRuntime *self, DrdTlsCredentials *credentials);
 DrdTlsCredentials *drd_server_runtime_get_tls_credentials(DrdServerRuntime *self);
 void drd_server_runtime_request_keyframe(DrdServerRuntime *self);
+void drd_server_runtime_reset_gfx_cache(DrdServerRuntime *self);
+const DrdMonitorInfo *drd_server_runtime_get_monitors(DrdServerRuntime *self, guint *n_monitors);
 
 gboolean drd_runtime_encoder_prepare(DrdServerRuntime *self, guint32 codecs, rdpSettings *settings);
 
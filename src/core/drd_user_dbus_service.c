@@ -16,6 +16,7 @@ struct _DrdUserDbusService
     GObject parent_instance;
 
     DrdConfig *config;
+    DrdServerRuntime *runtime;
 
     GDBusConnection *connection;
     guint bus_name_owner_id;
@@ -62,6 +63,7 @@ static void drd_user_dbus_service_dispose(GObject *object)
     DrdUserDbusService *self = DRD_USER_DBUS_SERVICE(object);
     drd_user_dbus_service_reset_bus_context(self);
     g_clear_object(&self->config);
+    g_clear_object(&self->runtime);
     G_OBJECT_CLASS(drd_user_dbus_service_parent_class)->dispose(object);
 }
 
@@ -79,12 +81,14 @@ static void drd_user_dbus_service_init(DrdUserDbusService *self)
     self->shadow_iface = NULL;
 }
 
-DrdUserDbusService *drd_user_dbus_service_new(DrdConfig *config)
+DrdUserDbusService *drd_user_dbus_service_new(DrdConfig *config, DrdServerRuntime *runtime)
 {
     g_return_val_if_fail(DRD_IS_CONFIG(config), NULL);
+    g_return_val_if_fail(DRD_IS_SERVER_RUNTIME(runtime), NULL);
 
     DrdUserDbusService *self = g_object_new(DRD_TYPE_USER_DBUS_SERVICE, NULL);
     self->config = g_object_ref(config);
+    self->runtime = g_object_ref(runtime);
     return self;
 }
 
@@ -190,6 +194,24 @@ static gboolean drd_user_dbus_shadow_handle_gen_nla_credential(DrdDBusRemoteDesk
     return drd_user_dbus_shadow_handle_stub(interface, invocation, user_data, "GenNlaCredential");
 }
 
+static gboolean drd_user_dbus_shadow_handle_share_window(DrdDBusRemoteDesktop1RemoteDesktop1Shadow *interface,
+                                                          GDBusMethodInvocation *invocation, guint window_id,
+                                                          gpointer user_data)
+{
+    DrdUserDbusService *self = DRD_USER_DBUS_SERVICE(user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!drd_server_runtime_set_capture_window(self->runtime, window_id, &error))
+    {
+        g_dbus_method_invocation_return_gerror(invocation, error);
+        return TRUE;
+    }
+
+    drd_dbus_remote_desktop1_remote_desktop1_shadow_set_shared_window(interface, window_id);
+    drd_dbus_remote_desktop1_remote_desktop1_shadow_complete_share_window(interface, invocation);
+    return TRUE;
+}
+
 gboolean drd_user_dbus_service_start(DrdUserDbusService *self, GError **error)
 {
     g_return_val_if_fail(DRD_IS_USER_DBUS_SERVICE(self), FALSE);
@@ -240,6 +262,13 @@ gboolean drd_user_dbus_service_start(DrdUserDbusService *self, GError **error)
     drd_dbus_remote_desktop1_remote_desktop1_shadow_set_lock_on_disconnect(self->shadow_iface, FALSE);
     drd_dbus_remote_desktop1_remote_desktop1_shadow_set_nla_update_interval(self->shadow_iface, 0);
     drd_dbus_remote_desktop1_remote_desktop1_shadow_set_connection_state(self->shadow_iface, 0);
+    {
+        const DrdCaptureOptions *capture_options =
+                drd_capture_manager_get_options(drd_server_runtime_get_capture(self->runtime));
+        drd_dbus_remote_desktop1_remote_desktop1_shadow_set_shared_window(
+                self->shadow_iface,
+                capture_options->backend == DRD_CAPTURE_BACKEND_WINDOW ? capture_options->window_id : 0);
+    }
 
     g_signal_connect(self->shadow_iface, "handle-enable-shadow", G_CALLBACK(drd_user_dbus_shadow_handle_enable_shadow),
                      self);
@@ -263,6 +292,8 @@ gboolean drd_user_dbus_service_start(DrdUserDbusService *self, GError **error)
                      G_CALLBACK(drd_user_dbus_shadow_handle_switch_connection_state), self);
     g_signal_connect(self->shadow_iface, "handle-gen-nla-credential",
                      G_CALLBACK(drd_user_dbus_shadow_handle_gen_nla_credential), self);
+    g_signal_connect(self->shadow_iface, "handle-share-window", G_CALLBACK(drd_user_dbus_shadow_handle_share_window),
+                     self);
 
     if (!g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(self->common_iface), self->connection,
                                           DRD_REMOTE_DESKTOP_OBJECT_PATH, error))
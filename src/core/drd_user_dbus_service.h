@@ -3,13 +3,14 @@
 #include <glib-object.h>
 
 #include "core/drd_config.h"
+#include "core/drd_server_runtime.h"
 
 G_BEGIN_DECLS
 
 #define DRD_TYPE_USER_DBUS_SERVICE (drd_user_dbus_service_get_type())
 G_DECLARE_FINAL_TYPE(DrdUserDbusService, drd_user_dbus_service, DRD, USER_DBUS_SERVICE, GObject)
 
-DrdUserDbusService *drd_user_dbus_service_new(DrdConfig *config);
+DrdUserDbusService *drd_user_dbus_service_new(DrdConfig *config, DrdServerRuntime *runtime);
 
 gboolean drd_user_dbus_service_start(DrdUserDbusService *self, GError **error);
 
@@ -2,13 +2,13 @@
 
 #include <gio/gio.h>
 #include <string.h>
+#include <time.h>
 
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
-#include <libswscale/swscale.h>
 
 #include <freerdp/codec/color.h>
 #include <freerdp/codec/h264.h>
@@ -16,18 +16,114 @@
 #include <freerdp/codec/rfx.h>
 #include <winpr/stream.h>
 
+#include "encoding/drd_nv12.h"
+#include "encoding/drd_tile_hash.h"
 #include "utils/drd_log.h"
 
 /* SurfaceBits 未实现标志，拒绝切换 */
 #define SURFACE_BITS_NOT_IMPLEMENTED
 
+/* tile 数达到该值才把差分分析拆成行带并行，小画面单线程反而更快（约 2560x1440 起） */
+#define DRD_GFX_ANALYSIS_PARALLEL_MIN_TILES 800
+/* 差分分析的最大行带数，含渲染线程自己处理的一带 */
+#define DRD_GFX_ANALYSIS_MAX_BANDS 16
+/* Rdpgfx 坐标为 16 位，一行最多 1024 个 64 像素 tile，一行内的脏 tile 段数不超过其一半 */
+#define DRD_GFX_MAX_TILES_X ((G_MAXUINT16 + 63) / 64)
+#define DRD_GFX_MAX_ROW_SPANS (DRD_GFX_MAX_TILES_X / 2 + 1)
+/* 变化 tile 数达到该值才尝试滚动/移动检测；移动区域沿移动方向至少覆盖该行（列）数 */
+#define DRD_GFX_MOVE_MIN_TILES 8
+#define DRD_GFX_MOVE_MIN_LINES 64
+/* VAAPI 上传表面环的大小，即 frames 池的固定大小；需大于编码器同时持有的输入帧数 */
+#define DRD_VAAPI_SURFACE_RING 4
+
+/* 上一帧行（列）哈希及其位置，按哈希排序后用于查找当前帧同内容的行（列） */
+typedef struct
+{
+    guint64 hash;
+    guint index;
+} DrdGfxLineHash;
+
+/* 一次并行分析的共享参数与完成计数 */
+typedef struct
+{
+    DrdEncodingManager *manager;
+    const guint8 *data;
+    const guint8 *previous;
+    guint stride;
+    GMutex mutex;
+    GCond cond;
+    guint pending;
+} DrdGfxAnalysisBatch;
+
+/* 一个行带：[row_begin, row_end) 范围内的 tile 行，changed 为该带的变化 tile 数 */
+typedef struct
+{
+    DrdGfxAnalysisBatch *batch;
+    guint row_begin;
+    guint row_end;
+    guint changed;
+} DrdGfxAnalysisBand;
+
+/* 一个命中客户端缓存的脏 tile：CacheToSurface 把 slot 的内容复制到 dest */
+typedef struct
+{
+    guint16 slot;
+    RDPGFX_POINT16 dest;
+} DrdGfxCacheHit;
+
+/* 一个纯色矩形：由颜色相同的相邻纯色 tile 合并而成，color 为 0x00RRGGBB */
+typedef struct
+{
+    guint32 color;
+    RECTANGLE_16 rect;
+} DrdGfxSolidFill;
+
+/* 一个本帧编码后写入客户端缓存的 tile：evict 为 TRUE 时先驱逐槽位中的旧内容 */
+typedef struct
+{
+    guint64 key;
+    guint16 slot;
+    gboolean evict;
+    RECTANGLE_16 rect;
+} DrdGfxCacheStore;
+
+/*
+ * VAAPI 流水线中的一帧：渲染线程分析后提交，编码线程转换、上传并编码，完成后由渲染线程按提交顺序发送。
+ * 数组在提交时与管理器的同名数组交换，槽位及其数组、packet 常驻复用。
+ */
+typedef struct
+{
+    DrdFrame *input;
+    guint64 serial; /* 本帧提交后的 gfx_previous_serial */
+    guint64 base_serial; /* 提交时上一帧的序号，0 表示不以上一帧为基准；暂存帧恰转换自它时只转换变化 tile */
+    gboolean keyframe;
+    guint tiles_x;
+    guint tiles_y;
+    guint row_words;
+    GArray *changed_bitmap;
+    GArray *region_rects; /* 为空时本帧只有移动、纯色填充与缓存还原，不编码 */
+    gboolean move_active;
+    RECTANGLE_16 move_source;
+    RDPGFX_POINT16 move_dest;
+    GArray *solid_fills;
+    GArray *cache_hits;
+    RDPGFX_SURFACE_COMMAND cmd;
+    RDPGFX_AVC420_BITMAP_STREAM avc420; /* data/length 指向 packet 或 bitstream */
+    AVPacket *packet;
+    GByteArray *bitstream; /* 一次取出多个 packet 时的拼接缓冲，只增不缩：出现过的最大拼接长度之后不再重新分配 */
+    gboolean done; /* 以下两项由编码线程在 vaapi_mutex 下写入 */
+    GError *error;
+} DrdVaapiJob;
+
+static gsize drd_gfx_analysis_pool_once = 0;
+static GThreadPool *drd_gfx_analysis_pool = NULL;
+
 static void drd_vaapi_encoder_release(DrdEncodingManager *self);
 static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **error);
-static gboolean drd_h264_build_fullframe_metablock(const RECTANGLE_16 *regionRect, RDPGFX_H264_METABLOCK *meta,
-                                                   GError **error);
-static gboolean drd_vaapi_encode_avc420(DrdEncodingManager *self, const guint8 *data, guint stride,
-                                        const RECTANGLE_16 *regionRect, RDPGFX_AVC420_BITMAP_STREAM *avc420,
-                                        GByteArray **bitstream_out, GError **error);
+static void drd_vaapi_pipeline_discard(DrdEncodingManager *self);
+static void drd_h264_fill_region_metablock(DrdEncodingManager *self, GArray *regions, RDPGFX_H264_METABLOCK *meta);
+static void drd_vaapi_convert_nv12(DrdEncodingManager *self, const DrdVaapiJob *job, gboolean partial);
+static gboolean drd_vaapi_encode_avc420(DrdEncodingManager *self, DrdVaapiJob *job, GError **error);
 
 struct _DrdEncodingManager
 {
@@ -45,18 +141,54 @@ struct _DrdEncodingManager
     AVCodecContext *vaapi_encoder;
     AVBufferRef *vaapi_device;
     AVBufferRef *vaapi_frames;
-    AVFrame *vaapi_sw_frame;
-    struct SwsContext *vaapi_sws;
+    AVFrame *vaapi_sw_frame; /* 常驻的 NV12 暂存帧，只重写变化区域 */
+    guint64 vaapi_staging_serial; /* vaapi_sw_frame 当前内容转换自的帧序号，0 表示内容无效 */
+    AVFrame *vaapi_surfaces[DRD_VAAPI_SURFACE_RING]; /* 常驻的上传表面，编码器释放引用后轮流复用 */
+    guint vaapi_surface_next;
+    AVPacket *vaapi_packet_extra; /* 编码线程收取同一帧后续 packet 的暂存 */
     guint vaapi_width;
     guint vaapi_height;
+    /*
+     * 编码流水线：vaapi_pool 为单线程池，按提交顺序处理 vaapi_jobs；有帧在途时上面的编码器资源只由编码线程使用，
+     * 渲染线程先 drd_vaapi_pipeline_discard 等流水线清空后才释放或重建。槽位下标与计数只由渲染线程读写。
+     */
+    GThreadPool *vaapi_pool;
+    GMutex vaapi_mutex;
+    GCond vaapi_cond;
+    DrdVaapiJob vaapi_jobs[DRD_VAAPI_PIPELINE_DEPTH];
+    guint vaapi_job_head; /* 最早提交、尚未发送的一帧 */
+    guint vaapi_job_count;
 
     guint32 codecs;
     H264_CONTEXT *h264;
     RFX_CONTEXT *rfx;
     PROGRESSIVE_CONTEXT *progressive;
-    GByteArray *gfx_previous_frame;
+    DrdFrame *gfx_previous_frame; /* 上一次成功编码的输入帧，按引用持有，帧发布后不可变 */
+    guint64 gfx_previous_serial; /* 每次提交上一帧时递增，VAAPI 暂存帧以它判断来源，不再额外持有帧引用 */
     GArray *gfx_tile_hashes;
+    GArray *gfx_pending_hashes; /* 本次分析算出的 tile hash，编码成功后与 gfx_tile_hashes 交换 */
+    GArray *gfx_dirty_bitmap; /* 脏 tile 位图，每个 tile 行占 gfx_dirty_row_words 个 64 位字，行之间互不共享 */
+    guint gfx_dirty_row_words;
+    GArray *gfx_damage_bitmap; /* 输入帧损坏矩形覆盖的 tile，布局同 gfx_dirty_bitmap */
+    gboolean gfx_damage_hint_active;
+    guint gfx_damage_hint_tiles;
+    gboolean gfx_damage_baseline; /* 上一帧即上一个输入帧，输入帧的损坏信息正是相对它描述 */
+    guint gfx_damage_full_scan_interval;
+    guint gfx_frames_since_full_scan;
+    gboolean gfx_move_active; /* 本帧需先发送的 SurfaceToSurface 移动，源为上一帧坐标 */
+    RECTANGLE_16 gfx_move_source;
+    RDPGFX_POINT16 gfx_move_dest;
+    GArray *gfx_solid_bitmap; /* 变化 tile 中的纯色 tile，布局同 gfx_dirty_bitmap，颜色在 gfx_solid_colors */
+    GArray *gfx_solid_colors;
+    GArray *gfx_solid_fills; /* 本帧以 SolidFill 填充的合并矩形，按颜色排序，对应 tile 已从脏位图清除 */
+    GArray *gfx_solid_rects; /* 发送时同色矩形的暂存数组 */
+    DrdGfxCache *gfx_cache; /* 与同一图形通道的其他 surface 共享的客户端 tile 缓存，可为 NULL */
+    GArray *gfx_cache_hits; /* 本帧以 CacheToSurface 还原的脏 tile，已从脏位图清除 */
+    GArray *gfx_cache_stores; /* 本帧 SurfaceCommand 之后以 SurfaceToCache 写入缓存的 tile */
     GArray *gfx_dirty_rects;
+    GArray *gfx_region_rects; /* AVC420 元数据上报的更新区域（RECTANGLE_16） */
+    GArray *gfx_region_quality; /* 与 gfx_region_rects 一一对应的量化参数，元数据直接引用这两个数组 */
+    GArray *gfx_changed_bitmap; /* 分析得到的全部变化 tile，在移动/填充/缓存还原清除脏标记之前复制，供 VAAPI 转换 */
     guint gfx_tiles_x;
     guint gfx_tiles_y;
     guint gfx_diff_width;
@@ -76,8 +208,8 @@ G_DEFINE_TYPE(DrdEncodingManager, drd_encoding_manager, G_TYPE_OBJECT)
 
 /*
  * 功能：释放编码管理器持有的编码器及缓冲区，避免悬挂引用。
- * 逻辑：先调用 drd_encoding_manager_reset 清空运行时状态，再释放 raw_encoder 和 scratch_frame，
- *       最后交给父类 dispose 做剩余清理。
+ * 逻辑：先调用 drd_encoding_manager_reset 清空运行时状态，清空 VAAPI 流水线并等待编码线程退出，
+ *       再释放 raw_encoder、scratch_frame 与流水线槽位，最后交给父类 dispose 做剩余清理。
  * 参数：object GObject 指针，期望为 DrdEncodingManager 实例。
  * 外部接口：依赖 GLib 的 g_clear_object 处理引用计数，最终调用父类 GObjectClass::dispose。
  */
@@ -85,25 +217,69 @@ static void drd_encoding_manager_dispose(GObject *object)
 {
     DrdEncodingManager *self = DRD_ENCODING_MANAGER(object);
     drd_encoding_manager_reset(self);
+    drd_vaapi_encoder_release(self);
+    if (self->vaapi_pool != NULL)
+    {
+        g_thread_pool_free(self->vaapi_pool, FALSE, TRUE);
+        self->vaapi_pool = NULL;
+    }
+    for (guint i = 0; i < DRD_VAAPI_PIPELINE_DEPTH; ++i)
+    {
+        DrdVaapiJob *job = &self->vaapi_jobs[i];
+        g_clear_pointer(&job->changed_bitmap, g_array_unref);
+        g_clear_pointer(&job->region_rects, g_array_unref);
+        g_clear_pointer(&job->solid_fills, g_array_unref);
+        g_clear_pointer(&job->cache_hits, g_array_unref);
+        g_clear_pointer(&job->bitstream, g_byte_array_unref);
+        av_packet_free(&job->packet);
+    }
     g_clear_pointer(&self->h264, h264_context_free);
     g_clear_pointer(&self->rfx, rfx_context_free);
     g_clear_pointer(&self->progressive, progressive_context_free);
-    g_clear_pointer(&self->gfx_previous_frame, g_byte_array_unref);
+    g_clear_object(&self->gfx_previous_frame);
     g_clear_pointer(&self->gfx_tile_hashes, g_array_unref);
+    g_clear_pointer(&self->gfx_pending_hashes, g_array_unref);
+    g_clear_pointer(&self->gfx_dirty_bitmap, g_array_unref);
+    g_clear_pointer(&self->gfx_damage_bitmap, g_array_unref);
     g_clear_pointer(&self->gfx_dirty_rects, g_array_unref);
+    g_clear_pointer(&self->gfx_region_rects, g_array_unref);
+    g_clear_pointer(&self->gfx_region_quality, g_array_unref);
+    g_clear_pointer(&self->gfx_changed_bitmap, g_array_unref);
+    g_clear_pointer(&self->gfx_solid_bitmap, g_array_unref);
+    g_clear_pointer(&self->gfx_solid_colors, g_array_unref);
+    g_clear_pointer(&self->gfx_solid_fills, g_array_unref);
+    g_clear_pointer(&self->gfx_solid_rects, g_array_unref);
+    g_clear_pointer(&self->gfx_cache_hits, g_array_unref);
+    g_clear_pointer(&self->gfx_cache_stores, g_array_unref);
+    g_clear_object(&self->gfx_cache);
     G_OBJECT_CLASS(drd_encoding_manager_parent_class)->dispose(object);
 }
 
+/*
+ * 功能：清理 VAAPI 流水线的互斥量与条件变量。
+ * 逻辑：dispose 已等待编码线程退出，此处只清理同步原语后交给父类 finalize。
+ * 参数：object GObject 指针，期望为 DrdEncodingManager 实例。
+ * 外部接口：GLib g_cond_clear/g_mutex_clear。
+ */
+static void drd_encoding_manager_finalize(GObject *object)
+{
+    DrdEncodingManager *self = DRD_ENCODING_MANAGER(object);
+    g_cond_clear(&self->vaapi_cond);
+    g_mutex_clear(&self->vaapi_mutex);
+    G_OBJECT_CLASS(drd_encoding_manager_parent_class)->finalize(object);
+}
+
 /*
  * 功能：初始化编码管理器的类回调。
- * 逻辑：注册自定义 dispose 以释放内部 encoder；其他生命周期保持默认。
+ * 逻辑：注册自定义 dispose 以释放内部 encoder，finalize 清理流水线同步原语。
  * 参数：klass 类结构指针。
- * 外部接口：使用 GLib 类型系统，将 dispose 挂载到 GObjectClass。
+ * 外部接口：使用 GLib 类型系统，将 dispose/finalize 挂载到 GObjectClass。
  */
 static void drd_encoding_manager_class_init(DrdEncodingManagerClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
     object_class->dispose = drd_encoding_manager_dispose;
+    object_class->finalize = drd_encoding_manager_finalize;
 }
 
 /*
@@ -126,15 +302,50 @@ static void drd_encoding_manager_init(DrdEncodingManager *self)
     self->vaapi_device = NULL;
     self->vaapi_frames = NULL;
     self->vaapi_sw_frame = NULL;
-    self->vaapi_sws = NULL;
+    self->vaapi_staging_serial = 0;
     self->vaapi_width = 0;
     self->vaapi_height = 0;
+    self->vaapi_pool = NULL;
+    g_mutex_init(&self->vaapi_mutex);
+    g_cond_init(&self->vaapi_cond);
+    for (guint i = 0; i < DRD_VAAPI_PIPELINE_DEPTH; ++i)
+    {
+        DrdVaapiJob *job = &self->vaapi_jobs[i];
+        job->changed_bitmap = g_array_new(FALSE, TRUE, sizeof(guint64));
+        job->region_rects = g_array_new(FALSE, FALSE, sizeof(RECTANGLE_16));
+        job->solid_fills = g_array_new(FALSE, FALSE, sizeof(DrdGfxSolidFill));
+        job->cache_hits = g_array_new(FALSE, FALSE, sizeof(DrdGfxCacheHit));
+        job->bitstream = g_byte_array_new();
+        job->packet = av_packet_alloc();
+    }
+    self->vaapi_job_head = 0;
+    self->vaapi_job_count = 0;
     self->h264 = NULL;
     self->rfx = NULL;
     self->progressive = NULL;
-    self->gfx_previous_frame = g_byte_array_new();
+    self->gfx_previous_frame = NULL;
     self->gfx_tile_hashes = g_array_new(FALSE, TRUE, sizeof(guint64));
+    self->gfx_pending_hashes = g_array_new(FALSE, TRUE, sizeof(guint64));
+    self->gfx_dirty_bitmap = g_array_new(FALSE, TRUE, sizeof(guint64));
+    self->gfx_dirty_row_words = 0;
+    self->gfx_damage_bitmap = g_array_new(FALSE, TRUE, sizeof(guint64));
+    self->gfx_damage_hint_active = FALSE;
+    self->gfx_damage_hint_tiles = 0;
+    self->gfx_damage_baseline = FALSE;
+    self->gfx_damage_full_scan_interval = DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL;
+    self->gfx_frames_since_full_scan = 0;
+    self->gfx_move_active = FALSE;
+    self->gfx_solid_bitmap = g_array_new(FALSE, TRUE, sizeof(guint64));
+    self->gfx_solid_colors = g_array_new(FALSE, TRUE, sizeof(guint32));
+    self->gfx_solid_fills = g_array_new(FALSE, FALSE, sizeof(DrdGfxSolidFill));
+    self->gfx_solid_rects = g_array_new(FALSE, FALSE, sizeof(RECTANGLE_16));
+    self->gfx_cache = NULL;
+    self->gfx_cache_hits = g_array_new(FALSE, FALSE, sizeof(DrdGfxCacheHit));
+    self->gfx_cache_stores = g_array_new(FALSE, FALSE, sizeof(DrdGfxCacheStore));
     self->gfx_dirty_rects = g_array_new(FALSE, FALSE, sizeof(RFX_RECT));
+    self->gfx_region_rects = g_array_new(FALSE, FALSE, sizeof(RECTANGLE_16));
+    self->gfx_region_quality = g_array_new(FALSE, FALSE, sizeof(RDPGFX_H264_QUANT_QUALITY));
+    self->gfx_changed_bitmap = g_array_new(FALSE, TRUE, sizeof(guint64));
     self->gfx_tiles_x = 0;
     self->gfx_tiles_y = 0;
     self->gfx_diff_width = 0;
@@ -145,6 +356,7 @@ static void drd_encoding_manager_init(DrdEncodingManager *self)
     self->gfx_large_change_threshold = DRD_GFX_DEFAULT_LARGE_CHANGE_THRESHOLD;
     self->gfx_progressive_refresh_interval = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_INTERVAL;
     self->gfx_progressive_refresh_timeout_ms = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_TIMEOUT_MS;
+    self->gfx_damage_full_scan_interval = DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL;
     self->gfx_last_codec = DRD_ENCODING_CODEC_CLASS_UNKNOWN;
     self->gfx_avc_to_non_avc_transition = FALSE;
     self->gfx_non_avc_switch_timestamp_us = 0;
@@ -153,18 +365,21 @@ static void drd_encoding_manager_init(DrdEncodingManager *self)
 
 /*
  * 功能：释放 VAAPI 编码器相关资源，避免重建或重置时泄漏。
- * 逻辑：依次释放 sws 转换器、软帧、硬件帧池与编码器上下文，同时清零尺寸缓存。
+ * 逻辑：先清空编码流水线，保证编码线程不再使用这些资源，再依次作废暂存帧来源、释放 packet 暂存、
+ *       上传表面环、硬件帧池与编码器上下文，同时清零尺寸缓存。
  * 参数：self 编码管理器实例。
- * 外部接口：libswscale 的 sws_freeContext，libavutil 的 av_buffer_unref/av_frame_free，
- *           libavcodec 的 avcodec_free_context。
+ * 外部接口：libavutil 的 av_buffer_unref/av_frame_free，libavcodec 的 av_packet_free/avcodec_free_context。
  */
 static void drd_vaapi_encoder_release(DrdEncodingManager *self)
 {
-    if (self->vaapi_sws != NULL)
+    drd_vaapi_pipeline_discard(self);
+    self->vaapi_staging_serial = 0;
+    av_packet_free(&self->vaapi_packet_extra);
+    for (guint i = 0; i < DRD_VAAPI_SURFACE_RING; ++i)
     {
-        sws_freeContext(self->vaapi_sws);
-        self->vaapi_sws = NULL;
+        av_frame_free(&self->vaapi_surfaces[i]);
     }
+    self->vaapi_surface_next = 0;
     if (self->vaapi_sw_frame != NULL)
     {
         av_frame_free(&self->vaapi_sw_frame);
@@ -186,13 +401,13 @@ static void drd_vaapi_encoder_release(DrdEncodingManager *self)
 }
 
 /*
- * 功能：准备 VAAPI 编码器上下文与 BGRA→NV12 的 swscale 转换器。
- * 逻辑：按当前分辨率初始化 VAAPI 设备、frames 池、编码器上下文和 sws 颜色空间转换，
- *       已准备且尺寸一致时直接复用；失败时释放中间资源并返回错误。
+ * 功能：准备 VAAPI 编码器上下文、NV12 暂存帧与常驻的上传表面和输出 packet。
+ * 逻辑：按当前分辨率初始化 VAAPI 设备、frames 池、编码器上下文和常驻的 NV12 暂存帧，并一次性取出
+ *       frames 池的全部表面组成上传表面环、分配 packet 暂存，使稳态编码不再分配；
+ *       已准备且尺寸一致时直接复用，否则经 drd_vaapi_encoder_release 清空流水线后重建；失败时释放中间资源并返回错误。
  * 参数：self 编码管理器实例；error GLib 错误返回。
  * 外部接口：libavcodec 的 avcodec_find_encoder_by_name/avcodec_alloc_context3/avcodec_open2，
- *           libavutil 的 av_hwdevice_ctx_create/av_hwframe_ctx_alloc/av_hwframe_ctx_init，
- *           libswscale 的 sws_getContext。
+ *           libavutil 的 av_hwdevice_ctx_create/av_hwframe_ctx_alloc/av_hwframe_ctx_init/av_frame_get_buffer。
  */
 static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **error)
 {
@@ -230,13 +445,13 @@ static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **err
         drd_vaapi_encoder_release(self);
         return FALSE;
     }
-    // TODO 在 sws_scale时，是否可以将服务端的分辨率缩放成客户端的分辨率
+    /* 服务端到客户端分辨率的缩放在编码前由 DrdFrameScaler 完成，这里的尺寸即流尺寸 */
     frames_ctx = (AVHWFramesContext *) self->vaapi_frames->data;
     frames_ctx->format = AV_PIX_FMT_VAAPI;
     frames_ctx->sw_format = AV_PIX_FMT_NV12;
     frames_ctx->width = (int) self->frame_width;
     frames_ctx->height = (int) self->frame_height;
-    frames_ctx->initial_pool_size = 4;
+    frames_ctx->initial_pool_size = DRD_VAAPI_SURFACE_RING;
 
     ret = av_hwframe_ctx_init(self->vaapi_frames);
     if (ret < 0)
@@ -274,6 +489,8 @@ static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **err
     self->vaapi_encoder->me_cmp = FF_CMP_VSAD;
     self->vaapi_encoder->profile = FF_PROFILE_H264_CONSTRAINED_BASELINE;
     self->vaapi_encoder->level = 41;
+    /* 流水线由编码线程提供，编码器内部不再攒帧，每帧送入后即可取回该帧的 packet；旧版本没有该选项时本就同步 */
+    av_opt_set_int(self->vaapi_encoder->priv_data, "async_depth", 1, 0);
 
     if (self->vaapi_encoder->hw_frames_ctx == NULL)
     {
@@ -289,17 +506,6 @@ static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **err
         drd_vaapi_encoder_release(self);
         return FALSE;
     }
-    // TODO 用 vaapi 替代 sws_scale完成色彩转换
-    self->vaapi_sws = sws_getContext((int) self->frame_width, (int) self->frame_height, AV_PIX_FMT_BGRA,
-                                     (int) self->frame_width, (int) self->frame_height, AV_PIX_FMT_NV12, SWS_BILINEAR,
-                                     NULL, NULL, NULL);
-    if (self->vaapi_sws == NULL)
-    {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to create swscale context");
-        drd_vaapi_encoder_release(self);
-        return FALSE;
-    }
-
     self->vaapi_sw_frame = av_frame_alloc();
     if (self->vaapi_sw_frame == NULL)
     {
@@ -320,61 +526,109 @@ static gboolean drd_vaapi_encoder_prepare(DrdEncodingManager *self, GError **err
         return FALSE;
     }
 
+    for (guint i = 0; i < DRD_VAAPI_SURFACE_RING; ++i)
+    {
+        self->vaapi_surfaces[i] = av_frame_alloc();
+        if (self->vaapi_surfaces[i] == NULL ||
+            av_hwframe_get_buffer(self->vaapi_frames, self->vaapi_surfaces[i], 0) < 0)
+        {
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate VAAPI surface ring");
+            drd_vaapi_encoder_release(self);
+            return FALSE;
+        }
+    }
+
+    self->vaapi_packet_extra = av_packet_alloc();
+    if (self->vaapi_packet_extra == NULL)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate AVPacket");
+        drd_vaapi_encoder_release(self);
+        return FALSE;
+    }
+
     self->vaapi_width = self->frame_width;
     self->vaapi_height = self->frame_height;
     return TRUE;
 }
 
 /*
- * 功能：构造 AVC420 全帧元数据，供 Rdpgfx H264 元数据发送。
- * 逻辑：填充单区域矩形与量化/质量默认值；分配失败时释放并返回错误。
- * 参数：regionRect 全帧矩形；meta 输出元数据；error GLib 错误。
- * 外部接口：FreeRDP h264 的 free_h264_metablock。
+ * 功能：用本帧更新矩形填充 AVC420 区域元数据，供 Rdpgfx H264 元数据发送。
+ * 逻辑：每个更新矩形一项区域，客户端只把这些区域从解码结果复制到表面；量化参数取配置 QP（上限 51），
+ *       质量值按 100 - QP 给出，与 FreeRDP 默认元数据一致。元数据直接引用 regions 与 gfx_region_quality
+ *       的存储，不另行分配，调用方发送后只需清空指针，不能交给 free_h264_metablock。
+ * 参数：self 编码管理器；regions 更新矩形（RECTANGLE_16，至少一项）；meta 输出元数据。
+ * 外部接口：无，纯内存操作。
  */
-static gboolean drd_h264_build_fullframe_metablock(const RECTANGLE_16 *regionRect, RDPGFX_H264_METABLOCK *meta, GError **error)
+static void drd_h264_fill_region_metablock(DrdEncodingManager *self, GArray *regions, RDPGFX_H264_METABLOCK *meta)
 {
-    WINPR_ASSERT(regionRect != NULL);
+    GArray *quality = self->gfx_region_quality;
+    const guint qp = MIN(self->h264_qp, 51);
+
+    WINPR_ASSERT(regions->len > 0);
     WINPR_ASSERT(meta != NULL);
 
-    memset(meta, 0, sizeof(*meta));
-    meta->numRegionRects = 1;
-    meta->regionRects = g_malloc0(sizeof(*meta->regionRects));
-    meta->quantQualityVals = g_malloc0(sizeof(*meta->quantQualityVals));
-    if (meta->regionRects == NULL || meta->quantQualityVals == NULL)
+    g_array_set_size(quality, regions->len);
+    for (guint i = 0; i < quality->len; ++i)
     {
-        free_h264_metablock(meta);
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate h264 metablock");
-        return FALSE;
+        RDPGFX_H264_QUANT_QUALITY *value = &g_array_index(quality, RDPGFX_H264_QUANT_QUALITY, i);
+        value->qp = (BYTE) qp;
+        value->p = 0;
+        value->qualityVal = (BYTE) (100 - qp);
     }
 
-    meta->regionRects[0] = *regionRect;
-    memset(meta->quantQualityVals, 0, sizeof(*meta->quantQualityVals));
-    return TRUE;
+    memset(meta, 0, sizeof(*meta));
+    meta->numRegionRects = regions->len;
+    meta->regionRects = (RECTANGLE_16 *) regions->data;
+    meta->quantQualityVals = (RDPGFX_H264_QUANT_QUALITY *) quality->data;
+}
+
+/*
+ * 功能：取一个编码器未持有的上传表面。
+ * 逻辑：从上次位置起轮询表面环，缓冲引用计数为 1 说明编码器已释放该表面，可覆盖上传；
+ *       全部仍在编码中时返回 NULL。
+ * 参数：self 编码管理器。
+ * 外部接口：libavutil 的 av_buffer_get_ref_count。
+ */
+static AVFrame *drd_vaapi_acquire_surface(DrdEncodingManager *self)
+{
+    for (guint i = 0; i < DRD_VAAPI_SURFACE_RING; ++i)
+    {
+        const guint slot = (self->vaapi_surface_next + i) % DRD_VAAPI_SURFACE_RING;
+        AVFrame *surface = self->vaapi_surfaces[slot];
+        if (av_buffer_get_ref_count(surface->buf[0]) == 1)
+        {
+            self->vaapi_surface_next = (slot + 1) % DRD_VAAPI_SURFACE_RING;
+            return surface;
+        }
+    }
+    return NULL;
 }
 
 /*
- * 功能：使用 VAAPI 硬件加速编码 BGRA 帧为 AVC420，并填充 Rdpgfx 需要的元数据。
- * 逻辑：通过 swscale 将 BGRA 转 NV12，上传到 VAAPI 硬件帧后编码，收集 H264 packet，
- *       拼接输出到 avc420->data/length，并构造全帧元数据。
- * 参数：self 编码管理器；data 原始 BGRA 像素；stride 行跨度；regionRect 全帧矩形；
- *       avc420 输出结构；bitstream_out 返回缓存；error GLib 错误。
- * 外部接口：libswscale 的 sws_scale，libavcodec 的 avcodec_send_frame/avcodec_receive_packet，
- *           libavutil 的 av_hwframe_get_buffer/av_hwframe_transfer_data。
+ * 功能：在编码线程上把一帧编码为 AVC420。
+ * 逻辑：把 BGRA 转为 NV12 写入常驻暂存帧（暂存帧恰为提交时的上一帧的转换结果时只转换变化 tile），
+ *       没有更新区域时到此为止，只让暂存帧跟上移动、纯色填充与缓存还原带来的变化；否则上传到表面环中编码器已释放的表面，
+ *       关键帧强制为 IDR，编码后收取 packet 到槽位的常驻 packet。通常一帧一个 packet，job->avc420.data 直接指向
+ *       packet 数据；一次取出多个时才拼接到槽位的常驻缓冲。元数据由渲染线程发送前填充。
+ * 参数：self 编码管理器；job 流水线槽位；error GLib 错误。
+ * 外部接口：drd_nv12_convert，libavcodec 的 avcodec_send_frame/avcodec_receive_packet，
+ *           libavutil 的 av_hwframe_transfer_data。
  */
-static gboolean drd_vaapi_encode_avc420(DrdEncodingManager *self, const guint8 *data, guint stride,
-                                        const RECTANGLE_16 *regionRect, RDPGFX_AVC420_BITMAP_STREAM *avc420,
-                                        GByteArray **bitstream_out, GError **error)
-{
-    const uint8_t *src_slices[4] = {data, NULL, NULL, NULL};
-    int src_strides[4] = {(int) stride, 0, 0, 0};
-    GByteArray *bitstream = NULL;
-    AVPacket *packet = NULL;
-    AVFrame *hw_frame = NULL;
+static gboolean drd_vaapi_encode_avc420(DrdEncodingManager *self, DrdVaapiJob *job, GError **error)
+{
+    AVPacket *packet = job->packet;
+    AVPacket *extra = self->vaapi_packet_extra;
+    AVFrame *surface = NULL;
     int ret = 0;
 
-    if (!drd_vaapi_encoder_prepare(self, error))
+    if (job->region_rects->len > 0)
     {
-        return FALSE;
+        surface = drd_vaapi_acquire_surface(self);
+        if (surface == NULL)
+        {
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "all VAAPI surfaces busy in encoder");
+            return FALSE;
+        }
     }
 
     ret = av_frame_make_writable(self->vaapi_sw_frame);
@@ -384,90 +638,151 @@ static gboolean drd_vaapi_encode_avc420(DrdEncodingManager *self, const guint8 *
         return FALSE;
     }
 
-    ret = sws_scale(self->vaapi_sws, src_slices, src_strides, 0, (int) self->frame_height,
-                    self->vaapi_sw_frame->data, self->vaapi_sw_frame->linesize);
-    if (ret <= 0)
-    {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "sws_scale failed for BGRA to NV12 conversion");
-        return FALSE;
-    }
+    /* 暂存帧之外的帧（其他编码路径或未编码的帧）成为上一帧后，暂存内容不再可作为基准，需整帧转换 */
+    const gboolean partial = job->base_serial != 0 && self->vaapi_staging_serial == job->base_serial;
+    drd_vaapi_convert_nv12(self, job, partial);
+    self->vaapi_staging_serial = job->serial;
 
-    hw_frame = av_frame_alloc();
-    if (hw_frame == NULL)
+    if (surface == NULL)
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate VAAPI frame");
-        return FALSE;
+        return TRUE;
     }
 
-    hw_frame->format = AV_PIX_FMT_VAAPI;
-    hw_frame->width = (int) self->frame_width;
-    hw_frame->height = (int) self->frame_height;
-
-    ret = av_hwframe_get_buffer(self->vaapi_frames, hw_frame, 0);
+    ret = av_hwframe_transfer_data(surface, self->vaapi_sw_frame, 0);
     if (ret < 0)
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to get VAAPI frame buffer");
-        av_frame_free(&hw_frame);
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to upload data to VAAPI frame");
         return FALSE;
     }
 
-    ret = av_hwframe_transfer_data(hw_frame, self->vaapi_sw_frame, 0);
+    /* 编码器对表面另加引用，编码完成后释放；表面本身留在环中供之后复用 */
+    surface->pict_type = job->keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    ret = avcodec_send_frame(self->vaapi_encoder, surface);
     if (ret < 0)
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to upload data to VAAPI frame");
-        av_frame_free(&hw_frame);
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to send VAAPI frame to encoder");
         return FALSE;
     }
 
-    ret = avcodec_send_frame(self->vaapi_encoder, hw_frame);
-    av_frame_free(&hw_frame);
-    if (ret < 0)
+    ret = avcodec_receive_packet(self->vaapi_encoder, packet);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
     {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to send VAAPI frame to encoder");
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "no avc420 frame produced by VAAPI");
         return FALSE;
     }
-
-    bitstream = g_byte_array_new();
-    packet = av_packet_alloc();
-    if (packet == NULL)
+    if (ret < 0)
     {
-        g_byte_array_unref(bitstream);
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate AVPacket");
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to receive VAAPI packet");
         return FALSE;
     }
+    job->avc420.data = packet->data;
+    job->avc420.length = (UINT32) packet->size;
 
-    while ((ret = avcodec_receive_packet(self->vaapi_encoder, packet)) == 0)
+    /*
+     * 拼接缓冲弹出时只清零长度、保留容量，增长只发生在长度超过此前最大值的帧上，属一次性预热；
+     * async_depth 为 1 时编码器通常一帧只出一个 packet，不经过这里。
+     */
+    while ((ret = avcodec_receive_packet(self->vaapi_encoder, extra)) == 0)
     {
-        g_byte_array_append(bitstream, packet->data, packet->size);
-        av_packet_unref(packet);
+        if (job->bitstream->len == 0)
+        {
+            g_byte_array_append(job->bitstream, packet->data, (guint) packet->size);
+        }
+        g_byte_array_append(job->bitstream, extra->data, (guint) extra->size);
+        av_packet_unref(extra);
+        job->avc420.data = job->bitstream->data;
+        job->avc420.length = job->bitstream->len;
     }
 
-    av_packet_free(&packet);
-
     if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
     {
-        g_byte_array_unref(bitstream);
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to receive VAAPI packet");
         return FALSE;
     }
+    return TRUE;
+}
+
+/*
+ * 功能：编码线程的任务入口。
+ * 逻辑：编码一帧后在 vaapi_mutex 下写入结果并唤醒等待的渲染线程。
+ * 参数：data 流水线槽位；user_data 编码管理器。
+ * 外部接口：GLib g_mutex_lock/g_cond_broadcast。
+ */
+static void drd_vaapi_pipeline_worker(gpointer data, gpointer user_data)
+{
+    DrdVaapiJob *job = data;
+    DrdEncodingManager *self = DRD_ENCODING_MANAGER(user_data);
+    GError *error = NULL;
+
+    drd_vaapi_encode_avc420(self, job, &error);
+
+    g_mutex_lock(&self->vaapi_mutex);
+    job->error = error;
+    job->done = TRUE;
+    g_cond_broadcast(&self->vaapi_cond);
+    g_mutex_unlock(&self->vaapi_mutex);
+}
+
+/*
+ * 功能：判断流水线中最早的一帧是否已编码完成，可按需阻塞等待。
+ * 逻辑：在 vaapi_mutex 下读取完成标记，wait 为 TRUE 时在 vaapi_cond 上等到完成为止。
+ * 参数：self 编码管理器（流水线非空）；wait 是否等待。
+ * 外部接口：GLib g_mutex_lock/g_cond_wait。
+ */
+static gboolean drd_vaapi_pipeline_oldest_done(DrdEncodingManager *self, gboolean wait)
+{
+    DrdVaapiJob *job = &self->vaapi_jobs[self->vaapi_job_head];
+    gboolean done = FALSE;
 
-    if (bitstream->len == 0)
+    WINPR_ASSERT(self->vaapi_job_count > 0);
+    g_mutex_lock(&self->vaapi_mutex);
+    while (wait && !job->done)
     {
-        g_byte_array_unref(bitstream);
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "no avc420 frame produced by VAAPI");
-        return FALSE;
+        g_cond_wait(&self->vaapi_cond, &self->vaapi_mutex);
     }
+    done = job->done;
+    g_mutex_unlock(&self->vaapi_mutex);
+    return done;
+}
+
+/*
+ * 功能：移出流水线中最早的一帧（须已完成）。
+ * 逻辑：释放输入帧引用与 packet，清空拼接缓冲与错误，槽位留待下次提交复用。
+ * 参数：self 编码管理器。
+ * 外部接口：libavcodec 的 av_packet_unref。
+ */
+static void drd_vaapi_pipeline_pop(DrdEncodingManager *self)
+{
+    DrdVaapiJob *job = &self->vaapi_jobs[self->vaapi_job_head];
+
+    g_clear_object(&job->input);
+    av_packet_unref(job->packet);
+    g_byte_array_set_size(job->bitstream, 0);
+    memset(&job->avc420, 0, sizeof(job->avc420));
+    g_clear_error(&job->error);
+    job->done = FALSE;
+    self->vaapi_job_head = (self->vaapi_job_head + 1) % DRD_VAAPI_PIPELINE_DEPTH;
+    self->vaapi_job_count--;
+}
 
-    if (!drd_h264_build_fullframe_metablock(regionRect, &avc420->meta, error))
+/*
+ * 功能：丢弃流水线中尚未发送的全部帧。
+ * 逻辑：差分状态在提交时已前移，丢弃的帧客户端收不到，逐帧等编码线程处理完后移出，并强制下一帧关键帧。
+ * 参数：self 编码管理器。
+ * 外部接口：无。
+ */
+static void drd_vaapi_pipeline_discard(DrdEncodingManager *self)
+{
+    if (self->vaapi_job_count == 0)
     {
-        g_byte_array_unref(bitstream);
-        return FALSE;
+        return;
     }
-
-    avc420->data = bitstream->data;
-    avc420->length = bitstream->len;
-    *bitstream_out = bitstream;
-    return TRUE;
+    while (self->vaapi_job_count > 0)
+    {
+        drd_vaapi_pipeline_oldest_done(self, TRUE);
+        drd_vaapi_pipeline_pop(self);
+    }
+    self->gfx_force_keyframe = TRUE;
 }
 
 /*
@@ -518,6 +833,8 @@ gboolean drd_encoding_manager_prepare(DrdEncodingManager *self, const DrdEncodin
     self->gfx_large_change_threshold = options->gfx_large_change_threshold;
     self->gfx_progressive_refresh_interval = options->gfx_progressive_refresh_interval;
     self->gfx_progressive_refresh_timeout_ms = options->gfx_progressive_refresh_timeout_ms;
+    self->gfx_damage_full_scan_interval = options->gfx_damage_full_scan_interval;
+    self->gfx_frames_since_full_scan = 0;
     self->gfx_last_codec = DRD_ENCODING_CODEC_CLASS_UNKNOWN;
     self->gfx_avc_to_non_avc_transition = FALSE;
     self->frame_width = options->width;
@@ -545,6 +862,7 @@ void drd_encoding_manager_reset(DrdEncodingManager *self)
     }
 
     DRD_LOG_MESSAGE("Encoding manager reset");
+    drd_vaapi_encoder_release(self);
     self->codecs = 0;
     self->frame_width = 0;
     self->frame_height = 0;
@@ -553,18 +871,65 @@ void drd_encoding_manager_reset(DrdEncodingManager *self)
     g_clear_pointer(&self->h264, h264_context_free);
     g_clear_pointer(&self->rfx, rfx_context_free);
     g_clear_pointer(&self->progressive, progressive_context_free);
-    if (self->gfx_previous_frame != NULL)
-    {
-        g_byte_array_set_size(self->gfx_previous_frame, 0);
-    }
+    g_clear_object(&self->gfx_previous_frame);
     if (self->gfx_tile_hashes != NULL)
     {
         g_array_set_size(self->gfx_tile_hashes, 0);
     }
+    if (self->gfx_pending_hashes != NULL)
+    {
+        g_array_set_size(self->gfx_pending_hashes, 0);
+    }
+    if (self->gfx_dirty_bitmap != NULL)
+    {
+        g_array_set_size(self->gfx_dirty_bitmap, 0);
+    }
+    self->gfx_dirty_row_words = 0;
+    if (self->gfx_damage_bitmap != NULL)
+    {
+        g_array_set_size(self->gfx_damage_bitmap, 0);
+    }
+    self->gfx_damage_hint_active = FALSE;
+    self->gfx_damage_hint_tiles = 0;
+    self->gfx_damage_baseline = FALSE;
+    self->gfx_frames_since_full_scan = 0;
+    self->gfx_move_active = FALSE;
+    if (self->gfx_solid_bitmap != NULL)
+    {
+        g_array_set_size(self->gfx_solid_bitmap, 0);
+    }
+    if (self->gfx_solid_colors != NULL)
+    {
+        g_array_set_size(self->gfx_solid_colors, 0);
+    }
+    if (self->gfx_solid_fills != NULL)
+    {
+        g_array_set_size(self->gfx_solid_fills, 0);
+    }
+    if (self->gfx_cache_hits != NULL)
+    {
+        g_array_set_size(self->gfx_cache_hits, 0);
+    }
+    if (self->gfx_cache_stores != NULL)
+    {
+        g_array_set_size(self->gfx_cache_stores, 0);
+    }
     if (self->gfx_dirty_rects != NULL)
     {
         g_array_set_size(self->gfx_dirty_rects, 0);
     }
+    if (self->gfx_region_rects != NULL)
+    {
+        g_array_set_size(self->gfx_region_rects, 0);
+    }
+    if (self->gfx_region_quality != NULL)
+    {
+        g_array_set_size(self->gfx_region_quality, 0);
+    }
+    if (self->gfx_changed_bitmap != NULL)
+    {
+        g_array_set_size(self->gfx_changed_bitmap, 0);
+    }
     self->gfx_tiles_x = 0;
     self->gfx_tiles_y = 0;
     self->gfx_diff_width = 0;
@@ -575,11 +940,26 @@ void drd_encoding_manager_reset(DrdEncodingManager *self)
     self->gfx_large_change_threshold = DRD_GFX_DEFAULT_LARGE_CHANGE_THRESHOLD;
     self->gfx_progressive_refresh_interval = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_INTERVAL;
     self->gfx_progressive_refresh_timeout_ms = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_TIMEOUT_MS;
+    self->gfx_damage_full_scan_interval = DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL;
     self->gfx_last_codec = DRD_ENCODING_CODEC_CLASS_UNKNOWN;
     self->gfx_avc_to_non_avc_transition = FALSE;
     self->gfx_non_avc_switch_timestamp_us = 0;
 }
 
+/*
+ * 功能：设置共享的客户端 tile 缓存。
+ * 逻辑：替换持有的缓存引用；缓存属于图形通道而非单个 surface，reset 时保留。
+ * 参数：self 管理器；cache 客户端 tile 缓存，可为 NULL 以关闭缓存复用。
+ * 外部接口：GLib g_set_object。
+ */
+void drd_encoding_manager_set_gfx_cache(DrdEncodingManager *self, DrdGfxCache *cache)
+{
+    g_return_if_fail(DRD_IS_ENCODING_MANAGER(self));
+    g_return_if_fail(cache == NULL || DRD_IS_GFX_CACHE(cache));
+
+    g_set_object(&self->gfx_cache, cache);
+}
+
 gboolean drd_encoding_manager_has_avc_to_non_avc_transition( DrdEncodingManager *self)
 {
     g_return_val_if_fail(DRD_IS_ENCODING_MANAGER(self), FALSE);
@@ -622,12 +1002,11 @@ gboolean drd_encoding_manager_refresh_interval_reached( DrdEncodingManager *self
 
 /*
  * 功能：在无新捕获帧时复用上一帧并强制输出 Surface GFX 关键帧。
- * 逻辑：校验缓存帧与差分状态可用，构造临时 DrdFrame 承载上一帧像素，置位关键帧标志后复用 Surface GFX
- *       编码路径发送全量帧。
+ * 逻辑：校验上一帧引用与差分状态可用，置位关键帧标志后直接以上一帧（按引用持有、不可变）复用 Surface GFX 编码路径发送全量帧，
+ *       无需复制像素。
  * 参数：self 管理器；settings 客户端编码设置；context Rdpgfx 上下文；surface_id 目标 surface；frame_id 帧序号；h264 输出是否
  *       使用 H264；auto_switch 自动切换编码策略；error 错误输出。
- * 外部接口：GLib g_get_monotonic_time/g_set_error；调用 drd_frame_new/drd_frame_configure/drd_frame_ensure_capacity 以及
- *           drd_encoding_manager_encode_surface_gfx 复用现有编码逻辑。
+ * 外部接口：GLib g_set_error/g_object_ref；调用 drd_encoding_manager_encode_surface_gfx 复用现有编码逻辑。
  */
 gboolean
 drd_encoding_manager_encode_cached_frame_gfx(DrdEncodingManager *self,
@@ -649,27 +1028,15 @@ drd_encoding_manager_encode_cached_frame_gfx(DrdEncodingManager *self,
         return FALSE;
     }
 
-    if (self->gfx_previous_frame->len == 0 || self->gfx_diff_width == 0 || self->gfx_diff_height == 0 ||
+    if (self->gfx_previous_frame == NULL || self->gfx_diff_width == 0 || self->gfx_diff_height == 0 ||
         self->gfx_diff_stride == 0)
     {
         g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "No cached frame available for refresh");
         return FALSE;
     }
 
-    g_autoptr(DrdFrame) cached_frame = drd_frame_new();
-    drd_frame_configure(cached_frame,
-                        self->gfx_diff_width,
-                        self->gfx_diff_height,
-                        self->gfx_diff_stride,
-                        (guint64) g_get_monotonic_time());
-
-    guint8 *buffer = drd_frame_ensure_capacity(cached_frame, self->gfx_previous_frame->len);
-    if (buffer == NULL)
-    {
-        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate cached frame buffer");
-        return FALSE;
-    }
-    memcpy(buffer, self->gfx_previous_frame->data, self->gfx_previous_frame->len);
+    /* 编码成功后 gfx_previous_frame 会被替换为同一帧，先持有引用 */
+    g_autoptr(DrdFrame) cached_frame = g_object_ref(self->gfx_previous_frame);
 
     self->gfx_force_keyframe = TRUE;
     DRD_LOG_MESSAGE("encode cached frame");
@@ -855,87 +1222,11 @@ static INLINE UINT32 rdpgfx_estimate_h264_avc420(RDPGFX_AVC420_BITMAP_STREAM *ha
            havc420->length;
 }
 
-/*
- * 功能：对 64 位整数执行左循环位移，作为 tile hash 的扰动基础。
- * 逻辑：将值左移指定位数并与右移互补位或运算。
- * 参数：value 原始数；shift 左移位数（0-63）。
- * 外部接口：无。
- */
-static inline guint64 drd_gfx_rotl64(guint64 value, guint shift) { return (value << shift) | (value >> (64 - shift)); }
-
-/*
- * 功能：将 64 位块混入 hash，降低 tile 哈希碰撞概率。
- * 逻辑：执行 xor/乘法/移位混合，随后回滚并再扰动。
- * 参数：hash 当前 hash 值；chunk 待混入数据。
- * 外部接口：无。
- */
-static inline guint64 drd_gfx_mix_chunk(guint64 hash, guint64 chunk)
-{
-    chunk ^= chunk >> 30;
-    chunk *= G_GUINT64_CONSTANT(0xbf58476d1ce4e5b9);
-    chunk ^= chunk >> 27;
-    chunk *= G_GUINT64_CONSTANT(0x94d049bb133111eb);
-    chunk ^= chunk >> 31;
-
-    hash ^= chunk;
-    hash = drd_gfx_rotl64(hash, 29);
-    hash *= G_GUINT64_CONSTANT(0x9e3779b185ebca87);
-    return hash;
-}
-
-/*
- * 功能：计算指定 tile 的哈希，用于 surface gfx 的差分检测。
- * 逻辑：按行遍历 tile，将 16/8 字节块混入 hash，尾部按长度补齐。
- * 参数：data 帧缓冲；stride 行步长；x/y 左上角；width/height tile 尺寸。
- * 外部接口：C 标准库 memcpy。
- */
-static guint64 drd_gfx_hash_tile(const guint8 *data, guint stride, guint32 x, guint32 y, guint32 width, guint32 height)
-{
-    guint64 hash = G_GUINT64_CONSTANT(0xcbf29ce484222325);
-    const guint32 bytes_per_row = width * 4u;
-
-    for (guint row = 0; row < height; ++row)
-    {
-        const guint8 *ptr = data + ((gsize) (y + row) * stride) + (gsize) x * 4;
-        guint32 remaining = bytes_per_row;
-
-        while (remaining >= 16)
-        {
-            guint64 lo, hi;
-            memcpy(&lo, ptr, sizeof(lo));
-            memcpy(&hi, ptr + 8, sizeof(hi));
-            hash = drd_gfx_mix_chunk(hash, lo);
-            hash = drd_gfx_mix_chunk(hash, hi);
-            ptr += 16;
-            remaining -= 16;
-        }
-
-        while (remaining >= 8)
-        {
-            guint64 chunk;
-            memcpy(&chunk, ptr, sizeof(chunk));
-            hash = drd_gfx_mix_chunk(hash, chunk);
-            ptr += 8;
-            remaining -= 8;
-        }
-
-        if (remaining > 0)
-        {
-            guint64 tail = 0;
-            memcpy(&tail, ptr, remaining);
-            tail ^= ((guint64) remaining << 56);
-            hash = drd_gfx_mix_chunk(hash, tail);
-        }
-    }
-
-    return hash;
-}
-
 /*
  * 功能：根据帧尺寸与 stride 初始化 surface gfx 差分状态。
- * 逻辑：尺寸变化时重建 tile 哈希与 previous buffer，并强制关键帧。
+ * 逻辑：尺寸变化时重建 tile 哈希数组、丢弃上一帧引用，并强制关键帧。
  * 参数：self 管理器；width/height/stride 当前帧几何。
- * 外部接口：GLib g_byte_array_set_size/g_array_set_size。
+ * 外部接口：GLib g_array_set_size/g_clear_object。
  */
 static void drd_encoding_manager_prepare_gfx_diff_state(DrdEncodingManager *self, guint width, guint height,
                                                         guint stride)
@@ -946,7 +1237,7 @@ static void drd_encoding_manager_prepare_gfx_diff_state(DrdEncodingManager *self
     const guint tiles_y = (height + 63) / 64;
     const gboolean tiles_changed = self->gfx_tiles_x != tiles_x || self->gfx_tiles_y != tiles_y;
 
-    if (!size_changed && !tiles_changed && self->gfx_previous_frame->len == (gsize) stride * height)
+    if (!size_changed && !tiles_changed && self->gfx_tile_hashes->len == tiles_x * tiles_y)
     {
         return;
     }
@@ -956,196 +1247,563 @@ static void drd_encoding_manager_prepare_gfx_diff_state(DrdEncodingManager *self
     self->gfx_diff_stride = stride;
     self->gfx_tiles_x = tiles_x;
     self->gfx_tiles_y = tiles_y;
-    g_byte_array_set_size(self->gfx_previous_frame, (gsize) stride * height);
-    memset(self->gfx_previous_frame->data, 0, self->gfx_previous_frame->len);
+    g_clear_object(&self->gfx_previous_frame);
     g_array_set_size(self->gfx_tile_hashes, self->gfx_tiles_x * self->gfx_tiles_y);
     memset(self->gfx_tile_hashes->data, 0, self->gfx_tile_hashes->len * sizeof(guint64));
+    g_array_set_size(self->gfx_pending_hashes, self->gfx_tiles_x * self->gfx_tiles_y);
+    self->gfx_dirty_row_words = (self->gfx_tiles_x + 63) / 64;
+    g_array_set_size(self->gfx_dirty_bitmap, self->gfx_dirty_row_words * self->gfx_tiles_y);
+    g_array_set_size(self->gfx_damage_bitmap, self->gfx_dirty_row_words * self->gfx_tiles_y);
+    g_array_set_size(self->gfx_solid_bitmap, self->gfx_dirty_row_words * self->gfx_tiles_y);
+    g_array_set_size(self->gfx_solid_colors, self->gfx_tiles_x * self->gfx_tiles_y);
+    self->gfx_damage_baseline = FALSE;
     self->gfx_force_keyframe = TRUE;
     self->gfx_progressive_rfx_frames = 0;
 }
 
-static void drd_encoding_manager_store_previous_frame(DrdEncodingManager *self, const guint8 *data, guint stride,
-                                                       guint height)
+/*
+ * 功能：编码成功后提交差分状态。
+ * 逻辑：以引用替换上一帧（帧发布后不可变，无需复制像素），此后下一输入帧的损坏信息可作为差分提示；
+ *       分析阶段已为全部 tile 算出 hash，直接与当前 hash 数组交换，不再重新遍历整帧。
+ * 参数：self 管理器；input 本次编码的输入帧。
+ * 外部接口：GLib g_object_ref/g_clear_object。
+ */
+static void drd_encoding_manager_commit_gfx_diff_state(DrdEncodingManager *self, DrdFrame *input)
 {
-    if (self->gfx_previous_frame->len != (gsize) stride * height)
+    DrdFrame *previous = self->gfx_previous_frame;
+    self->gfx_previous_frame = g_object_ref(input);
+    g_clear_object(&previous);
+    self->gfx_previous_serial++;
+    self->gfx_damage_baseline = TRUE;
+
+    if (self->gfx_pending_hashes->len == self->gfx_tile_hashes->len)
     {
-        g_byte_array_set_size(self->gfx_previous_frame, (gsize) stride * height);
+        GArray *committed = self->gfx_tile_hashes;
+        self->gfx_tile_hashes = self->gfx_pending_hashes;
+        self->gfx_pending_hashes = committed;
     }
-    memcpy(self->gfx_previous_frame->data, data, self->gfx_previous_frame->len);
 }
 
 /*
- * 功能：按当前帧预计算 tile hash，便于后续差分复用。
- * 逻辑：遍历 64x64 tile 计算 hash 并写回缓存。
- * 参数：self 管理器；data 当前帧；stride 行步长。
- * 外部接口：无。
+ * 功能：在一行脏 tile 位图中查找下一个指定状态的位。
+ * 逻辑：从 from 所在的字开始，按需取反后屏蔽 from 之前的位，逐字跳过全零字，命中后用 ctz 定位；行尾填充位恒为 0。
+ * 参数：bits 行位图；n_bits 有效位数（tile 列数）；from 起始位；set TRUE 查找置位、FALSE 查找清零位。
+ * 外部接口：GCC/Clang __builtin_ctzll。
  */
-static void drd_encoding_manager_update_tile_hashes(DrdEncodingManager *self, const guint8 *data, guint stride)
+static guint drd_encoding_manager_find_dirty_bit(const guint64 *bits, guint n_bits, guint from, gboolean set)
 {
-    if (self->gfx_tiles_x == 0 || self->gfx_tiles_y == 0)
+    if (from >= n_bits)
     {
-        return;
+        return n_bits;
     }
 
-    for (guint y = 0; y < self->gfx_diff_height; y += 64)
+    const guint n_words = (n_bits + 63) / 64;
+    guint word = from / 64;
+    guint64 value = (set ? bits[word] : ~bits[word]) & (G_MAXUINT64 << (from % 64));
+
+    while (value == 0)
     {
-        const guint tile_h = MIN(64u, self->gfx_diff_height - y);
-        for (guint x = 0; x < self->gfx_diff_width; x += 64)
+        if (++word >= n_words)
         {
-            const guint tile_w = MIN(64u, self->gfx_diff_width - x);
-            const guint index = (y / 64) * self->gfx_tiles_x + (x / 64);
-            guint64 hash = drd_gfx_hash_tile(data, stride, x, y, tile_w, tile_h);
-            guint64 *stored = &g_array_index(self->gfx_tile_hashes, guint64, index);
-            *stored = hash;
+            return n_bits;
         }
+        value = set ? bits[word] : ~bits[word];
     }
+
+    return MIN(word * 64 + (guint) __builtin_ctzll(value), n_bits);
 }
 
 /*
- * 功能：基于预计算的脏块标记生成 REGION16 或 RFX_RECT，供 Progressive/RemoteFX 共用。
- * 逻辑：按 64x64 tile 读取 dirty_flags，命中时写入矩形或合并 REGION16，避免重复像素比对。
- * 参数：self 管理器；dirty_flags 脏块标记；region/rects 输出容器。
- * 外部接口：WinPR region16_union_rect；GLib g_array_append_val。
+ * 功能：把脏 tile 位图合并为尽量少的 RFX_RECT，供 Progressive/RemoteFX 共用。
+ * 逻辑：逐 tile 行用 ctz 取出连续脏 tile 段；与上一行左右边界完全相同的段向下延伸已有矩形，否则新建矩形。
+ *       两行的段都按 x 递增排列，双指针匹配即可；右/下边界裁剪到画面尺寸。结果写入 rects，不做任何像素比对。
+ * 参数：self 管理器；rects RFX_RECT 输出数组（调用方清空）。
+ * 外部接口：GLib g_array_append_val。
  */
-static gboolean drd_encoding_manager_collect_dirty_tiles(DrdEncodingManager *self, const GArray *dirty_flags,
-                                                         REGION16 *region, GArray *rects)
+static gboolean drd_encoding_manager_collect_dirty_rects(DrdEncodingManager *self, GArray *rects)
 {
     if (self->gfx_tiles_x == 0 || self->gfx_tiles_y == 0)
     {
         return FALSE;
     }
 
-    const guint total_tiles = self->gfx_tiles_x * self->gfx_tiles_y;
-    WINPR_ASSERT(dirty_flags != NULL);
-    WINPR_ASSERT(dirty_flags->len == total_tiles);
+    WINPR_ASSERT(self->gfx_tiles_x <= DRD_GFX_MAX_TILES_X);
+    WINPR_ASSERT(self->gfx_dirty_bitmap->len == self->gfx_dirty_row_words * self->gfx_tiles_y);
 
-    gboolean has_dirty = FALSE;
+    /* 上一行/本行仍可向下延伸的矩形在 rects 中的下标 */
+    guint open_storage[DRD_GFX_MAX_ROW_SPANS];
+    guint next_storage[DRD_GFX_MAX_ROW_SPANS];
+    guint *open = open_storage;
+    guint *next = next_storage;
+    guint n_open = 0;
+    const guint first = rects->len;
 
-    for (guint y = 0; y < self->gfx_diff_height; y += 64)
+    for (guint row = 0; row < self->gfx_tiles_y; ++row)
     {
-        const guint tile_h = MIN(64u, self->gfx_diff_height - y);
-        for (guint x = 0; x < self->gfx_diff_width; x += 64)
+        const guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row * self->gfx_dirty_row_words);
+        const guint y = row * 64;
+        const guint bottom = MIN(y + 64, self->gfx_diff_height);
+        guint n_next = 0;
+        guint candidate = 0;
+
+        for (guint begin = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, 0, TRUE);
+             begin < self->gfx_tiles_x;)
         {
-            const guint tile_w = MIN(64u, self->gfx_diff_width - x);
-            const guint index = (y / 64) * self->gfx_tiles_x + (x / 64);
-            const gboolean different = g_array_index(dirty_flags, gboolean, index);
+            const guint end = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, begin, FALSE);
+            const guint left = begin * 64;
+            const guint width = MIN(end * 64, self->gfx_diff_width) - left;
 
-            if (different)
+            while (candidate < n_open && g_array_index(rects, RFX_RECT, open[candidate]).x < left)
             {
-                if (rects != NULL)
-                {
-                    RFX_RECT rect = {(UINT16) x, (UINT16) y, (UINT16) tile_w, (UINT16) tile_h};
-                    g_array_append_val(rects, rect);
-                }
-                if (region != NULL)
-                {
-                    const guint32 right = x + tile_w;
-                    const guint32 bottom = y + tile_h;
-                    RECTANGLE_16 region_rect;
-                    WINPR_ASSERT(right <= UINT16_MAX);
-                    WINPR_ASSERT(bottom <= UINT16_MAX);
-                    region_rect.left = (UINT16) x;
-                    region_rect.top = (UINT16) y;
-                    region_rect.right = (UINT16) right;
-                    region_rect.bottom = (UINT16) bottom;
-                    region16_union_rect(region, region, &region_rect);
-                }
-                has_dirty = TRUE;
+                candidate++;
+            }
+
+            if (candidate < n_open && g_array_index(rects, RFX_RECT, open[candidate]).x == left &&
+                g_array_index(rects, RFX_RECT, open[candidate]).width == width)
+            {
+                RFX_RECT *rect = &g_array_index(rects, RFX_RECT, open[candidate]);
+                rect->height = (UINT16) (bottom - rect->y);
+                next[n_next++] = open[candidate++];
+            }
+            else
+            {
+                RFX_RECT rect = {(UINT16) left, (UINT16) y, (UINT16) width, (UINT16) (bottom - y)};
+                g_array_append_val(rects, rect);
+                next[n_next++] = rects->len - 1;
             }
+
+            begin = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, end, TRUE);
         }
+
+        guint *swap = open;
+        open = next;
+        next = swap;
+        n_open = n_next;
     }
 
-    return has_dirty;
+    return rects->len > first;
 }
 
-static gboolean drd_encoding_manager_collect_dirty_rects(DrdEncodingManager *self, const GArray *dirty_flags,
-                                                         GArray *rects)
+/*
+ * 功能：把脏 tile 位图合并后的矩形写入 REGION16，供 Progressive 使用。
+ * 逻辑：先在 gfx_dirty_rects 中合并出最大矩形，再逐个并入 region；region16_union_rect 每次插入为线性开销，
+ *       合并后插入次数远少于脏 tile 数。
+ * 参数：self 管理器；region 输出区域。
+ * 外部接口：WinPR region16_union_rect。
+ */
+static gboolean drd_encoding_manager_collect_dirty_region(DrdEncodingManager *self, REGION16 *region)
 {
-    return drd_encoding_manager_collect_dirty_tiles(self, dirty_flags, NULL, rects);
+    GArray *rects = self->gfx_dirty_rects;
+
+    g_array_set_size(rects, 0);
+    if (!drd_encoding_manager_collect_dirty_rects(self, rects))
+    {
+        return FALSE;
+    }
+
+    for (guint i = 0; i < rects->len; ++i)
+    {
+        const RFX_RECT *rect = &g_array_index(rects, RFX_RECT, i);
+        const guint32 right = (guint32) rect->x + rect->width;
+        const guint32 bottom = (guint32) rect->y + rect->height;
+        RECTANGLE_16 region_rect;
+        WINPR_ASSERT(right <= UINT16_MAX);
+        WINPR_ASSERT(bottom <= UINT16_MAX);
+        region_rect.left = rect->x;
+        region_rect.top = rect->y;
+        region_rect.right = (UINT16) right;
+        region_rect.bottom = (UINT16) bottom;
+        region16_union_rect(region, region, &region_rect);
+    }
+
+    return TRUE;
 }
 
-static gboolean drd_encoding_manager_collect_dirty_region(DrdEncodingManager *self, const GArray *dirty_flags,
-                                                          REGION16 *region)
+/*
+ * 功能：把脏 tile 位图合并后的矩形写入 RECTANGLE_16 数组，供 AVC420 区域元数据使用。
+ * 逻辑：先在 gfx_dirty_rects 中合并出最大矩形，再逐个换算为左上/右下坐标追加到 regions。
+ * 参数：self 管理器；regions RECTANGLE_16 输出数组（调用方清空）。
+ * 外部接口：GLib g_array_append_val。
+ */
+static gboolean drd_encoding_manager_collect_region_rects(DrdEncodingManager *self, GArray *regions)
 {
-    return drd_encoding_manager_collect_dirty_tiles(self, dirty_flags, region, NULL);
+    GArray *rects = self->gfx_dirty_rects;
+
+    g_array_set_size(rects, 0);
+    if (!drd_encoding_manager_collect_dirty_rects(self, rects))
+    {
+        return FALSE;
+    }
+
+    for (guint i = 0; i < rects->len; ++i)
+    {
+        const RFX_RECT *rect = &g_array_index(rects, RFX_RECT, i);
+        const guint32 right = (guint32) rect->x + rect->width;
+        const guint32 bottom = (guint32) rect->y + rect->height;
+        WINPR_ASSERT(right <= UINT16_MAX);
+        WINPR_ASSERT(bottom <= UINT16_MAX);
+        RECTANGLE_16 region_rect = {rect->x, rect->y, (UINT16) right, (UINT16) bottom};
+        g_array_append_val(regions, region_rect);
+    }
+
+    return TRUE;
 }
 
 /*
- * 功能：单次遍历 tile 获取脏块分布并判定是否为大变化。
- * 逻辑：按 64x64 tile 计算 hash，对比历史 hash 后在差异 tile 上执行 memcmp，累计变化比例并写入脏块标记。
- * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长；threshold 判定阈值；dirty_flags 脏块标记数组；changed_tiles 输出变化 tile 数。
- * 外部接口：C 标准库 memcmp。
+ * 功能：把流水线中一帧的输入转换到 VAAPI 的 NV12 暂存帧。
+ * 逻辑：partial 为 TRUE 时暂存帧已是上一帧的转换结果，只逐 tile 行转换 job->changed_bitmap 中的连续变化段；
+ *       tile 边长 64，覆盖的 16x16 宏块与之对齐，其余宏块保持不变。否则整帧转换。tile 布局取提交时的快照，
+ *       渲染线程此时可能已在按新尺寸分析下一帧。
+ * 参数：self 管理器；job 流水线槽位；partial 是否只转换变化 tile。
+ * 外部接口：drd_nv12_convert；drd_encoding_manager_find_dirty_bit。
  */
-static gboolean drd_encoding_manager_analyze_tiles(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
-                                                   guint stride, gdouble threshold, GArray *dirty_flags,
-                                                   guint *changed_tiles)
+static void drd_vaapi_convert_nv12(DrdEncodingManager *self, const DrdVaapiJob *job, gboolean partial)
 {
-    if (self->gfx_tiles_x == 0 || self->gfx_tiles_y == 0 || self->gfx_diff_width == 0 || self->gfx_diff_height == 0)
+    AVFrame *frame = self->vaapi_sw_frame;
+    const guint8 *data = drd_frame_get_data(job->input, NULL);
+    const guint stride = drd_frame_get_stride(job->input);
+    const guint width = self->vaapi_width;
+    const guint height = self->vaapi_height;
+
+    if (!partial)
     {
-        if (changed_tiles != NULL)
-        {
-            *changed_tiles = 0;
-        }
-        return TRUE;
+        drd_nv12_convert(data, stride, width, height, frame->data[0], (guint) frame->linesize[0], frame->data[1],
+                         (guint) frame->linesize[1], 0, 0, width, height);
+        return;
     }
 
-    const guint total_tiles = self->gfx_tiles_x * self->gfx_tiles_y;
-    if (total_tiles == 0)
+    WINPR_ASSERT(job->tiles_x == (width + 63) / 64 && job->tiles_y == (height + 63) / 64);
+    WINPR_ASSERT(job->changed_bitmap->len == job->row_words * job->tiles_y);
+    for (guint row = 0; row < job->tiles_y; ++row)
     {
-        if (changed_tiles != NULL)
+        const guint64 *bits = &g_array_index(job->changed_bitmap, guint64, row * job->row_words);
+        const guint y = row * 64;
+        const guint tile_h = MIN(64u, height - y);
+
+        for (guint begin = drd_encoding_manager_find_dirty_bit(bits, job->tiles_x, 0, TRUE); begin < job->tiles_x;)
         {
-            *changed_tiles = 0;
+            const guint end = drd_encoding_manager_find_dirty_bit(bits, job->tiles_x, begin, FALSE);
+            const guint x = begin * 64;
+
+            drd_nv12_convert(data, stride, width, height, frame->data[0], (guint) frame->linesize[0], frame->data[1],
+                             (guint) frame->linesize[1], x, y, MIN(end * 64, width) - x, tile_h);
+            begin = drd_encoding_manager_find_dirty_bit(bits, job->tiles_x, end, TRUE);
         }
-        return TRUE;
     }
+}
+
+/*
+ * 功能：根据输入帧携带的损坏矩形准备差分提示。
+ * 逻辑：上一帧可比较且正是上一个输入帧、帧携带损坏信息、配置了全量扫描间隔且距上次全量扫描未满该间隔时启用提示：
+ *       把损坏矩形（裁剪到画面）覆盖的 tile 写入 gfx_damage_bitmap 并统计 tile 数；否则本帧全量扫描并重新计数。
+ *       hash 与逐像素复核照常执行，提示只决定检查哪些 tile，周期性全量扫描兜住损坏信息遗漏的变化。
+ * 参数：self 管理器；input 输入帧；usable 上一帧可比较且损坏信息相对它描述。
+ * 外部接口：drd_frame_has_damage/drd_frame_get_damage。
+ */
+static void drd_encoding_manager_prepare_damage_hint(DrdEncodingManager *self, DrdFrame *input, gboolean usable)
+{
+    self->gfx_damage_hint_active = FALSE;
+    self->gfx_damage_hint_tiles = 0;
 
-    if (dirty_flags != NULL)
+    if (!usable || self->gfx_damage_full_scan_interval == 0 ||
+        self->gfx_frames_since_full_scan >= self->gfx_damage_full_scan_interval || !drd_frame_has_damage(input))
     {
-        g_array_set_size(dirty_flags, total_tiles);
-        memset(dirty_flags->data, 0, dirty_flags->len * sizeof(gboolean));
+        self->gfx_frames_since_full_scan = 0;
+        return;
     }
 
-    guint local_changed_tiles = 0;
-    const gboolean force_dirty = previous == NULL;
+    guint n_rects = 0;
+    const DrdFrameRect *rects = drd_frame_get_damage(input, &n_rects);
+    memset(self->gfx_damage_bitmap->data, 0, self->gfx_damage_bitmap->len * sizeof(guint64));
 
-    for (guint y = 0; y < self->gfx_diff_height; y += 64)
+    for (guint i = 0; i < n_rects; ++i)
     {
-        const guint tile_h = MIN(64u, self->gfx_diff_height - y);
-        for (guint x = 0; x < self->gfx_diff_width; x += 64)
+        const DrdFrameRect *rect = &rects[i];
+        if (rect->width == 0 || rect->height == 0 || rect->x >= self->gfx_diff_width ||
+            rect->y >= self->gfx_diff_height)
         {
-            const guint tile_w = MIN(64u, self->gfx_diff_width - x);
-            const guint index = (y / 64) * self->gfx_tiles_x + (x / 64);
-            const guint64 hash = drd_gfx_hash_tile(data, stride, x, y, tile_w, tile_h);
-            const guint64 stored = g_array_index(self->gfx_tile_hashes, guint64, index);
-            gboolean different = force_dirty || stored != hash;
+            continue;
+        }
 
-            if (different && !force_dirty)
+        const guint right = rect->x + MIN(rect->width, self->gfx_diff_width - rect->x);
+        const guint bottom = rect->y + MIN(rect->height, self->gfx_diff_height - rect->y);
+        for (guint row = rect->y / 64; row < (bottom + 63) / 64; ++row)
+        {
+            guint64 *bits = &g_array_index(self->gfx_damage_bitmap, guint64, row * self->gfx_dirty_row_words);
+            for (guint column = rect->x / 64; column < (right + 63) / 64; ++column)
             {
-                different = FALSE;
-                for (guint row = 0; row < tile_h; ++row)
+                const guint64 mask = G_GUINT64_CONSTANT(1) << (column % 64);
+                if ((bits[column / 64] & mask) == 0)
                 {
-                    const guint offset = ((y + row) * stride) + x * 4;
-                    if (memcmp(previous + offset, data + offset, tile_w * 4) != 0)
-                    {
-                        different = TRUE;
-                        break;
-                    }
+                    bits[column / 64] |= mask;
+                    self->gfx_damage_hint_tiles++;
                 }
             }
-
-            if (dirty_flags != NULL)
+        }
+    }
+
+    self->gfx_damage_hint_active = TRUE;
+    self->gfx_frames_since_full_scan++;
+}
+
+/*
+ * 功能：分析单个 tile。
+ * 逻辑：计算 64x64 tile 的 hash 并写入待提交数组，与历史 hash 不同时逐像素复核；previous 为 NULL 时直接视为变化（本帧整幅编码）。
+ *       确认变化的 tile 再判断是否纯色，纯色时在纯色位图置位并记录颜色；非纯色 tile 通常在首行即可判定。
+ * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长；row/column tile 坐标。
+ * 外部接口：drd_tile_hash/drd_tile_equal/drd_tile_uniform（按 CPU 选择的 SIMD 内核）。
+ */
+static gboolean drd_encoding_manager_analyze_tile(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
+                                                  guint stride, guint row, guint column)
+{
+    const guint x = column * 64;
+    const guint y = row * 64;
+    const guint tile_w = MIN(64u, self->gfx_diff_width - x);
+    const guint tile_h = MIN(64u, self->gfx_diff_height - y);
+    const guint index = row * self->gfx_tiles_x + column;
+    const guint64 hash = drd_tile_hash(data, stride, x, y, tile_w, tile_h);
+    const guint64 stored = g_array_index(self->gfx_tile_hashes, guint64, index);
+    g_array_index(self->gfx_pending_hashes, guint64, index) = hash;
+
+    if (previous == NULL)
+    {
+        return TRUE;
+    }
+    if (stored == hash || drd_tile_equal(previous, data, stride, x, y, tile_w, tile_h))
+    {
+        return FALSE;
+    }
+
+    guint32 color = 0;
+    if (drd_tile_uniform(data, stride, x, y, tile_w, tile_h, &color))
+    {
+        g_array_index(self->gfx_solid_bitmap, guint64, row * self->gfx_dirty_row_words + column / 64) |=
+                G_GUINT64_CONSTANT(1) << (column % 64);
+        g_array_index(self->gfx_solid_colors, guint32, index) = color;
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：分析一个行带内的 tile。
+ * 逻辑：先清零该行的脏 tile 与纯色 tile 位图，再逐 tile 分析并置位变化 tile；启用损坏提示时先把该行历史 hash 原样复制到待提交数组，
+ *       只用 ctz 遍历提示位图中的 tile。位图按 tile 行对齐到 64 位字，各行带只写自己的 tile 下标与位图字，
+ *       历史 hash 只读，可在多个线程上同时执行。
+ * 参数：self 管理器；data 当前帧；previous 上一帧（NULL 表示全部视为变化）；stride 行步长；row_begin/row_end tile 行范围。
+ * 外部接口：drd_encoding_manager_analyze_tile/find_dirty_bit。
+ */
+static guint drd_encoding_manager_analyze_band(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
+                                               guint stride, guint row_begin, guint row_end)
+{
+    guint changed = 0;
+
+    for (guint row = row_begin; row < row_end; ++row)
+    {
+        const guint row_offset = row * self->gfx_dirty_row_words;
+        guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row_offset);
+        memset(bits, 0, self->gfx_dirty_row_words * sizeof(guint64));
+        memset(&g_array_index(self->gfx_solid_bitmap, guint64, row_offset), 0,
+               self->gfx_dirty_row_words * sizeof(guint64));
+
+        if (self->gfx_damage_hint_active)
+        {
+            const guint64 *hint = &g_array_index(self->gfx_damage_bitmap, guint64, row_offset);
+            memcpy(&g_array_index(self->gfx_pending_hashes, guint64, row * self->gfx_tiles_x),
+                   &g_array_index(self->gfx_tile_hashes, guint64, row * self->gfx_tiles_x),
+                   self->gfx_tiles_x * sizeof(guint64));
+            for (guint column = drd_encoding_manager_find_dirty_bit(hint, self->gfx_tiles_x, 0, TRUE);
+                 column < self->gfx_tiles_x;
+                 column = drd_encoding_manager_find_dirty_bit(hint, self->gfx_tiles_x, column + 1, TRUE))
+            {
+                if (drd_encoding_manager_analyze_tile(self, data, previous, stride, row, column))
+                {
+                    bits[column / 64] |= G_GUINT64_CONSTANT(1) << (column % 64);
+                    changed++;
+                }
+            }
+            continue;
+        }
+
+        for (guint column = 0; column < self->gfx_tiles_x; ++column)
+        {
+            if (drd_encoding_manager_analyze_tile(self, data, previous, stride, row, column))
             {
-                gboolean *flag = &g_array_index(dirty_flags, gboolean, index);
-                *flag = different;
+                bits[column / 64] |= G_GUINT64_CONSTANT(1) << (column % 64);
+                changed++;
             }
+        }
+    }
+
+    return changed;
+}
+
+/*
+ * 功能：线程池中执行一个行带的分析。
+ * 逻辑：分析完成后写回该带的变化数，持锁递减批次的待完成计数，最后一带完成时唤醒渲染线程。
+ * 参数：data 行带描述；user_data 未使用。
+ * 外部接口：GLib g_mutex_lock/g_cond_signal。
+ */
+static void drd_encoding_manager_analysis_worker(gpointer data, gpointer user_data)
+{
+    DrdGfxAnalysisBand *band = data;
+    DrdGfxAnalysisBatch *batch = band->batch;
+    (void) user_data;
+
+    band->changed = drd_encoding_manager_analyze_band(batch->manager, batch->data, batch->previous, batch->stride,
+                                                      band->row_begin, band->row_end);
+
+    g_mutex_lock(&batch->mutex);
+    if (--batch->pending == 0)
+    {
+        g_cond_signal(&batch->cond);
+    }
+    g_mutex_unlock(&batch->mutex);
+}
 
-            if (different)
+/*
+ * 功能：获取进程内共享的差分分析线程池。
+ * 逻辑：首次调用时按 CPU 核数创建独占线程池（线程常驻，避免每帧创建线程的延迟），渲染线程自己也处理一带，
+ *       因此工作线程数为核数减一且不超过最大行带数；单核或创建失败时返回 NULL，分析退回单线程。
+ * 参数：无。
+ * 外部接口：GLib g_once_init_enter/leave、g_get_num_processors、g_thread_pool_new；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ */
+static GThreadPool *drd_encoding_manager_get_analysis_pool(void)
+{
+    if (g_once_init_enter(&drd_gfx_analysis_pool_once))
+    {
+        const guint workers = MIN(g_get_num_processors(), DRD_GFX_ANALYSIS_MAX_BANDS) - 1;
+        if (workers > 0)
+        {
+            g_autoptr(GError) error = NULL;
+            drd_gfx_analysis_pool =
+                    g_thread_pool_new(drd_encoding_manager_analysis_worker, NULL, (gint) workers, TRUE, &error);
+            if (drd_gfx_analysis_pool == NULL)
+            {
+                DRD_LOG_WARNING("Failed to create tile analysis pool: %s", error != NULL ? error->message : "unknown");
+            }
+            else
             {
-                local_changed_tiles++;
+                DRD_LOG_MESSAGE("Tile analysis pool started with %u worker(s)", workers);
             }
         }
+        g_once_init_leave(&drd_gfx_analysis_pool_once, 1);
+    }
+    return drd_gfx_analysis_pool;
+}
+
+/*
+ * 功能：把 tile 分析拆成行带并行执行。
+ * 逻辑：tile 行均分为不超过 工作线程数+1 个行带，除第一带外推入共享线程池，第一带由渲染线程自己处理，随后等待全部行带完成；
+ *       各带写入互不重叠的 tile 下标与位图行，变化数按带序求和，结果与单线程完全一致。推入失败的行带就地执行。
+ * 参数：self 管理器；pool 共享线程池；data 当前帧；previous 上一帧；stride 行步长。
+ * 外部接口：GLib g_thread_pool_get_max_threads/g_thread_pool_push、g_mutex/g_cond。
+ */
+static guint drd_encoding_manager_analyze_parallel(DrdEncodingManager *self, GThreadPool *pool, const guint8 *data,
+                                                   const guint8 *previous, guint stride)
+{
+    DrdGfxAnalysisBatch batch = {
+            .manager = self,
+            .data = data,
+            .previous = previous,
+            .stride = stride,
+            .pending = 0,
+    };
+    DrdGfxAnalysisBand bands[DRD_GFX_ANALYSIS_MAX_BANDS];
+    const guint n_bands =
+            MIN(MIN((guint) g_thread_pool_get_max_threads(pool) + 1, DRD_GFX_ANALYSIS_MAX_BANDS), self->gfx_tiles_y);
+
+    g_mutex_init(&batch.mutex);
+    g_cond_init(&batch.cond);
+
+    for (guint i = 0; i < n_bands; ++i)
+    {
+        bands[i].batch = &batch;
+        bands[i].row_begin = self->gfx_tiles_y * i / n_bands;
+        bands[i].row_end = self->gfx_tiles_y * (i + 1) / n_bands;
+        bands[i].changed = 0;
+    }
+
+    g_mutex_lock(&batch.mutex);
+    batch.pending = n_bands - 1;
+    g_mutex_unlock(&batch.mutex);
+
+    for (guint i = 1; i < n_bands; ++i)
+    {
+        if (!g_thread_pool_push(pool, &bands[i], NULL))
+        {
+            drd_encoding_manager_analysis_worker(&bands[i], NULL);
+        }
+    }
+    bands[0].changed =
+            drd_encoding_manager_analyze_band(self, data, previous, stride, bands[0].row_begin, bands[0].row_end);
+
+    g_mutex_lock(&batch.mutex);
+    while (batch.pending > 0)
+    {
+        g_cond_wait(&batch.cond, &batch.mutex);
+    }
+    g_mutex_unlock(&batch.mutex);
+
+    g_cond_clear(&batch.cond);
+    g_mutex_clear(&batch.mutex);
+
+    guint changed = 0;
+    for (guint i = 0; i < n_bands; ++i)
+    {
+        changed += bands[i].changed;
+    }
+    return changed;
+}
+
+/*
+ * 功能：按变化 tile 数判定是否为大变化。
+ * 逻辑：变化 tile 占全部 tile 的比例达到配置阈值即为大变化。
+ * 参数：self 管理器；changed_tiles 仍需编码的 tile 数。
+ * 外部接口：无。
+ */
+static gboolean drd_encoding_manager_is_large_change(DrdEncodingManager *self, guint changed_tiles)
+{
+    return ((gdouble) changed_tiles / (gdouble) (self->gfx_tiles_x * self->gfx_tiles_y)) >=
+           self->gfx_large_change_threshold;
+}
+
+/*
+ * 功能：单次遍历 tile 获取脏块分布并判定是否为大变化。
+ * 逻辑：按 64x64 tile 计算 hash 并暂存到待提交数组（编码成功后直接提交，无需再算一遍），对比历史 hash 后在差异 tile 上逐像素复核，
+ *       累计变化比例并写入 gfx_dirty_bitmap；启用损坏提示时只分析提示 tile。待分析 tile 数达到 DRD_GFX_ANALYSIS_PARALLEL_MIN_TILES
+ *       且有共享线程池时按行带并行分析。
+ * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长；threshold 判定阈值；changed_tiles 输出变化 tile 数。
+ * 外部接口：drd_encoding_manager_analyze_band/analyze_parallel。
+ */
+static gboolean drd_encoding_manager_analyze_tiles(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
+                                                   guint stride, gdouble threshold, guint *changed_tiles)
+{
+    if (self->gfx_tiles_x == 0 || self->gfx_tiles_y == 0 || self->gfx_diff_width == 0 || self->gfx_diff_height == 0)
+    {
+        if (changed_tiles != NULL)
+        {
+            *changed_tiles = 0;
+        }
+        return TRUE;
+    }
+
+    const guint total_tiles = self->gfx_tiles_x * self->gfx_tiles_y;
+    if (total_tiles == 0)
+    {
+        if (changed_tiles != NULL)
+        {
+            *changed_tiles = 0;
+        }
+        return TRUE;
     }
 
+    const guint scan_tiles = self->gfx_damage_hint_active ? self->gfx_damage_hint_tiles : total_tiles;
+    GThreadPool *pool =
+            scan_tiles >= DRD_GFX_ANALYSIS_PARALLEL_MIN_TILES ? drd_encoding_manager_get_analysis_pool() : NULL;
+    const guint local_changed_tiles =
+            pool != NULL ? drd_encoding_manager_analyze_parallel(self, pool, data, previous, stride)
+                         : drd_encoding_manager_analyze_band(self, data, previous, stride, 0, self->gfx_tiles_y);
+
     if (changed_tiles != NULL)
     {
         *changed_tiles = local_changed_tiles;
@@ -1154,26 +1812,925 @@ static gboolean drd_encoding_manager_analyze_tiles(DrdEncodingManager *self, con
     return ((gdouble) local_changed_tiles / (gdouble) total_tiles) >= threshold;
 }
 
+/*
+ * 功能：按哈希排序上一帧行（列）哈希的比较函数。
+ * 逻辑：先比哈希再比位置，保证排序结果确定。
+ * 参数：a/b DrdGfxLineHash 指针。
+ * 外部接口：供 qsort 使用。
+ */
+static gint drd_gfx_line_hash_compare(gconstpointer a, gconstpointer b)
+{
+    const DrdGfxLineHash *left = a;
+    const DrdGfxLineHash *right = b;
+
+    if (left->hash != right->hash)
+    {
+        return left->hash < right->hash ? -1 : 1;
+    }
+    return left->index < right->index ? -1 : (left->index > right->index ? 1 : 0);
+}
+
+/*
+ * 功能：在两组行（列）哈希之间寻找整体位移。
+ * 逻辑：上一帧哈希排序后，当前帧每条发生变化的行在其中二分查找，只有唯一匹配（空白行等重复内容不参与）才为位移 i-j 投票；
+ *       取票数最多的位移，再找出在该位移下连续匹配的最长区间，区间长度与其中真正变化的行数都要达到下限。
+ * 参数：current/previous 当前帧/上一帧哈希；n 行数；shift 输出位移（当前行 = 上一帧行 + shift）；run_begin/run_end 输出当前帧区间。
+ * 外部接口：C qsort；GLib g_new/g_new0。
+ */
+static gboolean drd_encoding_manager_find_shift(const guint64 *current, const guint64 *previous, guint n, gint *shift,
+                                                guint *run_begin, guint *run_end)
+{
+    g_autofree DrdGfxLineHash *sorted = g_new(DrdGfxLineHash, n);
+    g_autofree guint *votes = g_new0(guint, 2 * n);
+
+    for (guint i = 0; i < n; ++i)
+    {
+        sorted[i].hash = previous[i];
+        sorted[i].index = i;
+    }
+    qsort(sorted, n, sizeof(DrdGfxLineHash), drd_gfx_line_hash_compare);
+
+    for (guint i = 0; i < n; ++i)
+    {
+        if (current[i] == previous[i])
+        {
+            continue;
+        }
+
+        guint low = 0;
+        guint high = n;
+        while (low < high)
+        {
+            const guint middle = low + (high - low) / 2;
+            if (sorted[middle].hash < current[i])
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        if (low >= n || sorted[low].hash != current[i] || (low + 1 < n && sorted[low + 1].hash == current[i]))
+        {
+            continue;
+        }
+        votes[i + n - sorted[low].index]++;
+    }
+
+    guint best_votes = 0;
+    gint best_shift = 0;
+    for (guint k = 0; k < 2 * n; ++k)
+    {
+        if (votes[k] > best_votes)
+        {
+            best_votes = votes[k];
+            best_shift = (gint) k - (gint) n;
+        }
+    }
+    if (best_shift == 0 || best_votes < DRD_GFX_MOVE_MIN_LINES / 8)
+    {
+        return FALSE;
+    }
+
+    const guint first = (guint) MAX(best_shift, 0);
+    const guint last = (guint) ((gint) n + MIN(best_shift, 0));
+    guint begin = first;
+    guint gain = 0;
+    guint best_begin = 0;
+    guint best_end = 0;
+    guint best_gain = 0;
+    for (guint i = first; i <= last; ++i)
+    {
+        if (i < last && current[i] == previous[(gint) i - best_shift])
+        {
+            gain += current[i] != previous[i];
+            continue;
+        }
+        if (i - begin > best_end - best_begin)
+        {
+            best_begin = begin;
+            best_end = i;
+            best_gain = gain;
+        }
+        begin = i + 1;
+        gain = 0;
+    }
+
+    if (best_end - best_begin < DRD_GFX_MOVE_MIN_LINES || best_gain < DRD_GFX_MOVE_MIN_LINES / 2)
+    {
+        return FALSE;
+    }
+
+    *shift = best_shift;
+    *run_begin = best_begin;
+    *run_end = best_end;
+    return TRUE;
+}
+
+/*
+ * 功能：比较当前帧矩形与上一帧平移后的同尺寸矩形。
+ * 逻辑：上一帧取 (x-dx, y-dy) 起点，调用逐像素比较内核；调用方保证两侧矩形都在画面内。
+ * 参数：previous 上一帧；data 当前帧；stride 行步长；x/y/width/height 当前帧矩形；dx/dy 位移。
+ * 外部接口：drd_tile_equal。
+ */
+static gboolean drd_encoding_manager_region_equal_shifted(const guint8 *previous, const guint8 *data, guint stride,
+                                                          guint x, guint y, guint width, guint height, gint dx,
+                                                          gint dy)
+{
+    const guint8 *source = previous + (gsize) ((gint) y - dy) * stride + (gsize) ((gint) x - dx) * 4;
+    const guint8 *target = data + (gsize) y * stride + (gsize) x * 4;
+    return drd_tile_equal(source, target, stride, 0, 0, width, height);
+}
+
+/*
+ * 功能：比较移动区域中的一条带。
+ * 逻辑：把“沿移动方向的行区间 × 垂直方向的一段”换算为矩形，与上一帧平移 shift 后的内容逐像素比较。
+ * 参数：previous 上一帧；data 当前帧；stride 行步长；vertical 是否上下移动；line_begin/lines 沿移动方向的区间；
+ *       begin/length 垂直方向的一段；shift 位移。
+ * 外部接口：drd_encoding_manager_region_equal_shifted。
+ */
+static gboolean drd_encoding_manager_move_strip_equal(const guint8 *previous, const guint8 *data, guint stride,
+                                                      gboolean vertical, guint line_begin, guint lines, guint begin,
+                                                      guint length, gint shift)
+{
+    if (vertical)
+    {
+        return drd_encoding_manager_region_equal_shifted(previous, data, stride, begin, line_begin, length, lines, 0,
+                                                         shift);
+    }
+    return drd_encoding_manager_region_equal_shifted(previous, data, stride, line_begin, begin, lines, length, shift,
+                                                     0);
+}
+
+/*
+ * 功能：在脏 tile 外接矩形内沿一个方向检测滚动。
+ * 逻辑：取外接矩形在垂直于移动方向上的中间一半作为窗口（避开滚动条、侧栏等随滚动变化的边缘），逐行（列）计算窗口哈希，
+ *       找出整体位移与连续匹配区间；窗口先逐像素复核，再按 tile 网格向两侧扩展到仍然匹配的最宽范围，结果写入待发送的移动。
+ * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长；x0/y0/x1/y1 脏 tile 外接矩形；vertical TRUE 检测上下滚动。
+ * 外部接口：drd_tile_hash；drd_encoding_manager_find_shift/region_equal_shifted。
+ */
+static gboolean drd_encoding_manager_detect_move_axis(DrdEncodingManager *self, const guint8 *data,
+                                                      const guint8 *previous, guint stride, guint x0, guint y0,
+                                                      guint x1, guint y1, gboolean vertical)
+{
+    const guint n = vertical ? y1 - y0 : x1 - x0;
+    const guint span_begin = vertical ? x0 : y0;
+    const guint span_end = vertical ? x1 : y1;
+    const guint span = span_end - span_begin;
+
+    if (n <= DRD_GFX_MOVE_MIN_LINES || span < 64)
+    {
+        return FALSE;
+    }
+
+    const guint window_begin = span_begin + span / 4;
+    const guint window_len = span / 2;
+    g_autofree guint64 *current = g_new(guint64, n);
+    g_autofree guint64 *before = g_new(guint64, n);
+    for (guint i = 0; i < n; ++i)
+    {
+        if (vertical)
+        {
+            current[i] = drd_tile_hash(data, stride, window_begin, y0 + i, window_len, 1);
+            before[i] = drd_tile_hash(previous, stride, window_begin, y0 + i, window_len, 1);
+        }
+        else
+        {
+            current[i] = drd_tile_hash(data, stride, x0 + i, window_begin, 1, window_len);
+            before[i] = drd_tile_hash(previous, stride, x0 + i, window_begin, 1, window_len);
+        }
+    }
+
+    gint shift = 0;
+    guint run_begin = 0;
+    guint run_end = 0;
+    if (!drd_encoding_manager_find_shift(current, before, n, &shift, &run_begin, &run_end))
+    {
+        return FALSE;
+    }
+
+    const guint line_begin = (vertical ? y0 : x0) + run_begin;
+    const guint lines = run_end - run_begin;
+    const gint dx = vertical ? 0 : shift;
+    const gint dy = vertical ? shift : 0;
+
+    if (!drd_encoding_manager_move_strip_equal(previous, data, stride, vertical, line_begin, lines, window_begin,
+                                               window_len, shift))
+    {
+        return FALSE;
+    }
+
+    guint low = window_begin;
+    guint high = window_begin + window_len;
+    while (low > span_begin)
+    {
+        const guint next = MAX(span_begin, ((low - 1) / 64) * 64);
+        if (!drd_encoding_manager_move_strip_equal(previous, data, stride, vertical, line_begin, lines, next,
+                                                   low - next, shift))
+        {
+            break;
+        }
+        low = next;
+    }
+    while (high < span_end)
+    {
+        const guint next = MIN(span_end, (high / 64 + 1) * 64);
+        if (!drd_encoding_manager_move_strip_equal(previous, data, stride, vertical, line_begin, lines, high,
+                                                   next - high, shift))
+        {
+            break;
+        }
+        high = next;
+    }
+
+    const guint dest_x = vertical ? low : line_begin;
+    const guint dest_y = vertical ? line_begin : low;
+    const guint width = vertical ? high - low : lines;
+    const guint height = vertical ? lines : high - low;
+
+    self->gfx_move_source.left = (UINT16) ((gint) dest_x - dx);
+    self->gfx_move_source.top = (UINT16) ((gint) dest_y - dy);
+    self->gfx_move_source.right = (UINT16) (self->gfx_move_source.left + width);
+    self->gfx_move_source.bottom = (UINT16) (self->gfx_move_source.top + height);
+    self->gfx_move_dest.x = (INT16) dest_x;
+    self->gfx_move_dest.y = (INT16) dest_y;
+    self->gfx_move_active = TRUE;
+    return TRUE;
+}
+
+/*
+ * 功能：检测上一帧到当前帧的滚动/区域移动。
+ * 逻辑：由脏 tile 位图求外接矩形，先检测上下滚动，再检测左右滚动；找到时记录待发送的 SurfaceToSurface 移动。
+ * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长。
+ * 外部接口：drd_encoding_manager_find_dirty_bit/detect_move_axis。
+ */
+static gboolean drd_encoding_manager_detect_move(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
+                                                 guint stride)
+{
+    guint row_min = G_MAXUINT;
+    guint row_max = 0;
+    guint column_min = G_MAXUINT;
+    guint column_max = 0;
+
+    for (guint row = 0; row < self->gfx_tiles_y; ++row)
+    {
+        const guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row * self->gfx_dirty_row_words);
+        const guint first = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, 0, TRUE);
+        if (first >= self->gfx_tiles_x)
+        {
+            continue;
+        }
+
+        guint last = first;
+        for (guint word = self->gfx_dirty_row_words; word-- > 0;)
+        {
+            if (bits[word] != 0)
+            {
+                last = word * 64 + 63 - (guint) __builtin_clzll(bits[word]);
+                break;
+            }
+        }
+        row_min = MIN(row_min, row);
+        row_max = row;
+        column_min = MIN(column_min, first);
+        column_max = MAX(column_max, last);
+    }
+
+    if (row_min == G_MAXUINT)
+    {
+        return FALSE;
+    }
+
+    const guint x0 = column_min * 64;
+    const guint y0 = row_min * 64;
+    const guint x1 = MIN((column_max + 1) * 64, self->gfx_diff_width);
+    const guint y1 = MIN((row_max + 1) * 64, self->gfx_diff_height);
+
+    return drd_encoding_manager_detect_move_axis(self, data, previous, stride, x0, y0, x1, y1, TRUE) ||
+           drd_encoding_manager_detect_move_axis(self, data, previous, stride, x0, y0, x1, y1, FALSE);
+}
+
+/*
+ * 功能：按待发送的移动修正脏 tile 位图。
+ * 逻辑：客户端执行 SurfaceToSurface 后，目标矩形内的内容已与当前帧一致（检测时逐像素确认），矩形外仍是上一帧；
+ *       因此与目标矩形相交的脏 tile 只需比较矩形外的部分（上下两条、左右两块），相同则清除脏标记。返回修正后的变化 tile 数。
+ * 参数：self 管理器；data 当前帧；previous 上一帧；stride 行步长。
+ * 外部接口：drd_tile_equal；drd_encoding_manager_find_dirty_bit。
+ */
+static guint drd_encoding_manager_apply_move(DrdEncodingManager *self, const guint8 *data, const guint8 *previous,
+                                             guint stride)
+{
+    const guint move_left = (guint) self->gfx_move_dest.x;
+    const guint move_top = (guint) self->gfx_move_dest.y;
+    const guint move_right = move_left + (self->gfx_move_source.right - self->gfx_move_source.left);
+    const guint move_bottom = move_top + (self->gfx_move_source.bottom - self->gfx_move_source.top);
+    guint changed = 0;
+
+    for (guint row = 0; row < self->gfx_tiles_y; ++row)
+    {
+        guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row * self->gfx_dirty_row_words);
+        const guint y = row * 64;
+        const guint bottom = MIN(y + 64, self->gfx_diff_height);
+
+        for (guint column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, 0, TRUE);
+             column < self->gfx_tiles_x;
+             column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, column + 1, TRUE))
+        {
+            const guint x = column * 64;
+            const guint right = MIN(x + 64, self->gfx_diff_width);
+            const guint inner_left = MAX(x, move_left);
+            const guint inner_right = MIN(right, move_right);
+            const guint inner_top = MAX(y, move_top);
+            const guint inner_bottom = MIN(bottom, move_bottom);
+
+            if (inner_left >= inner_right || inner_top >= inner_bottom ||
+                !drd_tile_equal(previous, data, stride, x, y, right - x, inner_top - y) ||
+                !drd_tile_equal(previous, data, stride, x, inner_bottom, right - x, bottom - inner_bottom) ||
+                !drd_tile_equal(previous, data, stride, x, inner_top, inner_left - x, inner_bottom - inner_top) ||
+                !drd_tile_equal(previous, data, stride, inner_right, inner_top, right - inner_right,
+                                inner_bottom - inner_top))
+            {
+                changed++;
+                continue;
+            }
+            bits[column / 64] &= ~(G_GUINT64_CONSTANT(1) << (column % 64));
+        }
+    }
+
+    return changed;
+}
+
+/*
+ * 功能：按颜色排序纯色矩形的比较函数。
+ * 逻辑：先比颜色再比位置，同色矩形相邻，可合并为一个 SolidFill PDU。
+ * 参数：a/b DrdGfxSolidFill 指针。
+ * 外部接口：供 g_array_sort 使用。
+ */
+static gint drd_gfx_solid_fill_compare(gconstpointer a, gconstpointer b)
+{
+    const DrdGfxSolidFill *left = a;
+    const DrdGfxSolidFill *right = b;
+
+    if (left->color != right->color)
+    {
+        return left->color < right->color ? -1 : 1;
+    }
+    if (left->rect.top != right->rect.top)
+    {
+        return left->rect.top < right->rect.top ? -1 : 1;
+    }
+    return left->rect.left < right->rect.left ? -1 : (left->rect.left > right->rect.left ? 1 : 0);
+}
+
+/*
+ * 功能：把剩余脏 tile 中的纯色 tile 合并为 SolidFill 矩形。
+ * 逻辑：逐 tile 行取出既脏又纯色、颜色相同的连续段；与上一行左右边界及颜色都相同的段向下延伸已有矩形，
+ *       否则新建矩形（两行的段都按 x 递增排列，双指针匹配）。合并后的 tile 从脏位图清除，矩形按颜色排序。
+ *       返回清除的 tile 数。
+ * 参数：self 管理器。
+ * 外部接口：drd_encoding_manager_find_dirty_bit；GLib g_array_append_val/g_array_sort。
+ */
+static guint drd_encoding_manager_collect_solid_fills(DrdEncodingManager *self)
+{
+    GArray *fills = self->gfx_solid_fills;
+
+    WINPR_ASSERT(self->gfx_tiles_x <= DRD_GFX_MAX_TILES_X);
+
+    /* 上一行/本行仍可向下延伸的矩形在 fills 中的下标；相邻纯色段颜色可能不同，一行最多 tiles_x 段 */
+    guint open_storage[DRD_GFX_MAX_TILES_X];
+    guint next_storage[DRD_GFX_MAX_TILES_X];
+    guint *open = open_storage;
+    guint *next = next_storage;
+    guint n_open = 0;
+    guint cleared = 0;
+
+    for (guint row = 0; row < self->gfx_tiles_y; ++row)
+    {
+        const guint row_offset = row * self->gfx_dirty_row_words;
+        guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row_offset);
+        const guint64 *solid = &g_array_index(self->gfx_solid_bitmap, guint64, row_offset);
+        const guint32 *colors = &g_array_index(self->gfx_solid_colors, guint32, row * self->gfx_tiles_x);
+        const guint y = row * 64;
+        const guint bottom = MIN(y + 64, self->gfx_diff_height);
+        guint n_next = 0;
+        guint candidate = 0;
+
+        for (guint column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, 0, TRUE);
+             column < self->gfx_tiles_x;)
+        {
+            if ((solid[column / 64] & (G_GUINT64_CONSTANT(1) << (column % 64))) == 0)
+            {
+                column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, column + 1, TRUE);
+                continue;
+            }
+
+            const guint32 color = colors[column];
+            guint end = column + 1;
+            while (end < self->gfx_tiles_x &&
+                   (bits[end / 64] & solid[end / 64] & (G_GUINT64_CONSTANT(1) << (end % 64))) != 0 &&
+                   colors[end] == color)
+            {
+                end++;
+            }
+            const UINT16 left = (UINT16) (column * 64);
+            const UINT16 right = (UINT16) MIN(end * 64, self->gfx_diff_width);
+
+            while (candidate < n_open && g_array_index(fills, DrdGfxSolidFill, open[candidate]).rect.left < left)
+            {
+                candidate++;
+            }
+
+            DrdGfxSolidFill *open_fill =
+                    candidate < n_open ? &g_array_index(fills, DrdGfxSolidFill, open[candidate]) : NULL;
+            if (open_fill != NULL && open_fill->rect.left == left && open_fill->rect.right == right &&
+                open_fill->color == color)
+            {
+                open_fill->rect.bottom = (UINT16) bottom;
+                next[n_next++] = open[candidate++];
+            }
+            else
+            {
+                DrdGfxSolidFill fill = {color, {left, (UINT16) y, right, (UINT16) bottom}};
+                g_array_append_val(fills, fill);
+                next[n_next++] = fills->len - 1;
+            }
+
+            for (guint i = column; i < end; ++i)
+            {
+                bits[i / 64] &= ~(G_GUINT64_CONSTANT(1) << (i % 64));
+            }
+            cleared += end - column;
+            column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, end, TRUE);
+        }
+
+        guint *swap = open;
+        open = next;
+        next = swap;
+        n_open = n_next;
+    }
+
+    g_array_sort(fills, drd_gfx_solid_fill_compare);
+    return cleared;
+}
+
+/*
+ * 功能：丢弃本帧计划的表面命令之外的操作。
+ * 逻辑：AVC444 与整幅更新的帧覆盖全部客户端内容，移动、纯色填充与缓存还原都会被覆盖，直接清除。
+ * 参数：self 管理器。
+ * 外部接口：GLib g_array_set_size。
+ */
+static void drd_encoding_manager_discard_frame_ops(DrdEncodingManager *self)
+{
+    self->gfx_move_active = FALSE;
+    g_array_set_size(self->gfx_solid_fills, 0);
+    g_array_set_size(self->gfx_cache_hits, 0);
+}
+
+/*
+ * 功能：计算 tile 的客户端缓存 key。
+ * 逻辑：tile hash 只描述像素内容，把宽高混入后边缘的窄 tile 不会命中同 hash 的整 tile。
+ * 参数：hash tile 内容 hash；width/height tile 尺寸。
+ * 外部接口：无。
+ */
+static guint64 drd_encoding_manager_tile_cache_key(guint64 hash, guint width, guint height)
+{
+    return hash ^ ((((guint64) width << 32) | height) * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15));
+}
+
+/*
+ * 功能：用客户端缓存还原脏 tile。
+ * 逻辑：逐个脏 tile 以本帧 hash 查询缓存，命中时记录 CacheToSurface 并清除脏标记，客户端复制后该 tile 与当前帧一致；
+ *       hash 为 0 的 tile 可能来自未提交的历史 hash，不参与复用。返回仍需编码的 tile 数。
+ * 参数：self 管理器。
+ * 外部接口：drd_gfx_cache_lookup；drd_encoding_manager_find_dirty_bit。
+ */
+static guint drd_encoding_manager_apply_cache_hits(DrdEncodingManager *self)
+{
+    guint changed = 0;
+
+    for (guint row = 0; row < self->gfx_tiles_y; ++row)
+    {
+        guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row * self->gfx_dirty_row_words);
+        const guint y = row * 64;
+
+        for (guint column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, 0, TRUE);
+             column < self->gfx_tiles_x;
+             column = drd_encoding_manager_find_dirty_bit(bits, self->gfx_tiles_x, column + 1, TRUE))
+        {
+            const guint x = column * 64;
+            const guint64 hash = g_array_index(self->gfx_pending_hashes, guint64, row * self->gfx_tiles_x + column);
+            const guint64 key = drd_encoding_manager_tile_cache_key(hash, MIN(64u, self->gfx_diff_width - x),
+                                                                    MIN(64u, self->gfx_diff_height - y));
+            const guint16 slot = hash != 0 ? drd_gfx_cache_lookup(self->gfx_cache, key) : 0;
+
+            if (slot == 0)
+            {
+                changed++;
+                continue;
+            }
+            DrdGfxCacheHit hit = {slot, {(UINT16) x, (UINT16) y}};
+            g_array_append_val(self->gfx_cache_hits, hit);
+            bits[column / 64] &= ~(G_GUINT64_CONSTANT(1) << (column % 64));
+        }
+    }
+
+    return changed;
+}
+
+/*
+ * 功能：为本帧编码的 tile 分配客户端缓存槽位。
+ * 逻辑：关键帧遍历全部 tile，否则只遍历剩余脏 tile；已缓存的内容只刷新 LRU 位置，其余分配槽位并记录 SurfaceToCache。
+ *       每帧最多写入容量的一半，保证同一帧写入的槽位不会被本帧后续写入替换。
+ * 参数：self 管理器；keyframe 本帧是否整幅编码。
+ * 外部接口：drd_gfx_cache_lookup/insert/get_capacity。
+ */
+static void drd_encoding_manager_plan_cache_stores(DrdEncodingManager *self, gboolean keyframe)
+{
+    const guint limit = drd_gfx_cache_get_capacity(self->gfx_cache) / 2;
+
+    for (guint row = 0; row < self->gfx_tiles_y && self->gfx_cache_stores->len < limit; ++row)
+    {
+        const guint64 *bits = &g_array_index(self->gfx_dirty_bitmap, guint64, row * self->gfx_dirty_row_words);
+        const guint y = row * 64;
+        const guint tile_h = MIN(64u, self->gfx_diff_height - y);
+
+        for (guint column = 0; column < self->gfx_tiles_x && self->gfx_cache_stores->len < limit; ++column)
+        {
+            if (!keyframe && (bits[column / 64] & (G_GUINT64_CONSTANT(1) << (column % 64))) == 0)
+            {
+                continue;
+            }
+
+            const guint x = column * 64;
+            const guint tile_w = MIN(64u, self->gfx_diff_width - x);
+            const guint64 hash = g_array_index(self->gfx_pending_hashes, guint64, row * self->gfx_tiles_x + column);
+            const guint64 key = drd_encoding_manager_tile_cache_key(hash, tile_w, tile_h);
+            if (hash == 0 || drd_gfx_cache_lookup(self->gfx_cache, key) != 0)
+            {
+                continue;
+            }
+
+            DrdGfxCacheStore store = {0};
+            store.key = key;
+            store.slot = drd_gfx_cache_insert(self->gfx_cache, key, &store.evict);
+            store.rect.left = (UINT16) x;
+            store.rect.top = (UINT16) y;
+            store.rect.right = (UINT16) (x + tile_w);
+            store.rect.bottom = (UINT16) (y + tile_h);
+            g_array_append_val(self->gfx_cache_stores, store);
+        }
+    }
+}
+
+/*
+ * 功能：撤销本帧计划的缓存写入。
+ * 逻辑：发送失败时客户端未必收到 SurfaceToCache，逐个让缓存忘记这些槽位的内容，之后先驱逐再复用。
+ * 参数：self 管理器。
+ * 外部接口：drd_gfx_cache_forget。
+ */
+static void drd_encoding_manager_drop_cache_stores(DrdEncodingManager *self)
+{
+    for (guint i = 0; i < self->gfx_cache_stores->len; ++i)
+    {
+        drd_gfx_cache_forget(self->gfx_cache, g_array_index(self->gfx_cache_stores, DrdGfxCacheStore, i).slot);
+    }
+    g_array_set_size(self->gfx_cache_stores, 0);
+}
+
+/*
+ * 功能：发送一帧 Rdpgfx 更新。
+ * 逻辑：没有移动、纯色填充与缓存操作时沿用 SurfaceFrameCommand 一次发出；否则依次发送 StartFrame、SurfaceToSurface、
+ *       各 CacheToSurface、按颜色分组的 SolidFill、SurfaceCommand（cmd 为 NULL 时省略）、各 EvictCacheEntry/SurfaceToCache
+ *       与 EndFrame，保证客户端先移动与还原，再叠加填充和新编码的内容，最后才把解码完成的 tile 写入缓存。
+ * 参数：self 管理器；context Rdpgfx 上下文；surface_id 目标 surface；cmd 表面命令，可为 NULL；start/end 帧起止 PDU。
+ * 外部接口：FreeRDP RdpgfxServerContext 回调。
+ */
+static UINT drd_encoding_manager_send_surface_frame(DrdEncodingManager *self, RdpgfxServerContext *context,
+                                                    guint16 surface_id, const RDPGFX_SURFACE_COMMAND *cmd,
+                                                    const RDPGFX_START_FRAME_PDU *start,
+                                                    const RDPGFX_END_FRAME_PDU *end)
+{
+    UINT rc = CHANNEL_RC_OK;
+
+    if (!self->gfx_move_active && self->gfx_solid_fills->len == 0 && self->gfx_cache_hits->len == 0 &&
+        self->gfx_cache_stores->len == 0)
+    {
+        IFCALLRET(context->SurfaceFrameCommand, rc, context, cmd, start, end);
+        return rc;
+    }
+
+    IFCALLRET(context->StartFrame, rc, context, start);
+    if (rc == CHANNEL_RC_OK && self->gfx_move_active)
+    {
+        RDPGFX_SURFACE_TO_SURFACE_PDU move = {0};
+        move.surfaceIdSrc = surface_id;
+        move.surfaceIdDest = surface_id;
+        move.rectSrc = self->gfx_move_source;
+        move.destPtsCount = 1;
+        move.destPts = &self->gfx_move_dest;
+        IFCALLRET(context->SurfaceToSurface, rc, context, &move);
+    }
+    for (guint i = 0; rc == CHANNEL_RC_OK && i < self->gfx_cache_hits->len; ++i)
+    {
+        DrdGfxCacheHit *hit = &g_array_index(self->gfx_cache_hits, DrdGfxCacheHit, i);
+        RDPGFX_CACHE_TO_SURFACE_PDU restore = {0};
+        restore.cacheSlot = hit->slot;
+        restore.surfaceId = surface_id;
+        restore.destPtsCount = 1;
+        restore.destPts = &hit->dest;
+        IFCALLRET(context->CacheToSurface, rc, context, &restore);
+    }
+    for (guint i = 0; rc == CHANNEL_RC_OK && i < self->gfx_solid_fills->len;)
+    {
+        const guint32 color = g_array_index(self->gfx_solid_fills, DrdGfxSolidFill, i).color;
+        g_array_set_size(self->gfx_solid_rects, 0);
+        for (; i < self->gfx_solid_fills->len && g_array_index(self->gfx_solid_fills, DrdGfxSolidFill, i).color == color;
+             ++i)
+        {
+            g_array_append_val(self->gfx_solid_rects, g_array_index(self->gfx_solid_fills, DrdGfxSolidFill, i).rect);
+        }
+
+        RDPGFX_SOLID_FILL_PDU fill = {0};
+        fill.surfaceId = surface_id;
+        fill.fillColor.B = (BYTE) (color & 0xFF);
+        fill.fillColor.G = (BYTE) ((color >> 8) & 0xFF);
+        fill.fillColor.R = (BYTE) ((color >> 16) & 0xFF);
+        fill.fillColor.XA = 0xFF;
+        fill.fillRectCount = (UINT16) self->gfx_solid_rects->len;
+        fill.fillRects = (RECTANGLE_16 *) self->gfx_solid_rects->data;
+        IFCALLRET(context->SolidFill, rc, context, &fill);
+    }
+    if (rc == CHANNEL_RC_OK && cmd != NULL)
+    {
+        IFCALLRET(context->SurfaceCommand, rc, context, cmd);
+    }
+    for (guint i = 0; rc == CHANNEL_RC_OK && i < self->gfx_cache_stores->len; ++i)
+    {
+        const DrdGfxCacheStore *store = &g_array_index(self->gfx_cache_stores, DrdGfxCacheStore, i);
+        if (store->evict)
+        {
+            RDPGFX_EVICT_CACHE_ENTRY_PDU evict = {0};
+            evict.cacheSlot = store->slot;
+            IFCALLRET(context->EvictCacheEntry, rc, context, &evict);
+        }
+        if (rc == CHANNEL_RC_OK)
+        {
+            RDPGFX_SURFACE_TO_CACHE_PDU save = {0};
+            save.surfaceId = surface_id;
+            save.cacheKey = store->key;
+            save.cacheSlot = store->slot;
+            save.rectSrc = store->rect;
+            IFCALLRET(context->SurfaceToCache, rc, context, &save);
+        }
+    }
+    if (rc == CHANNEL_RC_OK)
+    {
+        IFCALLRET(context->EndFrame, rc, context, end);
+    }
+    return rc;
+}
+
+/*
+ * 功能：发送不含表面命令的一帧。
+ * 逻辑：移动、纯色填充与缓存还原后已没有剩余脏 tile 时，只发送 StartFrame、SurfaceToSurface/CacheToSurface/SolidFill 与 EndFrame，
+ *       成功后客户端内容与当前帧一致，提交差分状态；发送失败时强制下一帧关键帧。
+ * 参数：self 管理器；context Rdpgfx 上下文；surface_id 目标 surface；start/end 帧起止 PDU；input 当前输入帧；error 错误输出。
+ * 外部接口：drd_encoding_manager_send_surface_frame/commit_gfx_diff_state。
+ */
+static gboolean drd_encoding_manager_send_ops_only(DrdEncodingManager *self, RdpgfxServerContext *context,
+                                                   guint16 surface_id, const RDPGFX_START_FRAME_PDU *start,
+                                                   const RDPGFX_END_FRAME_PDU *end, DrdFrame *input, GError **error)
+{
+    const UINT rc = drd_encoding_manager_send_surface_frame(self, context, surface_id, NULL, start, end);
+
+    if (rc != CHANNEL_RC_OK)
+    {
+        self->gfx_force_keyframe = TRUE;
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Rdpgfx frame without surface command failed with error %" PRIu32 "", rc);
+        return FALSE;
+    }
+    drd_encoding_manager_commit_gfx_diff_state(self, input);
+    return TRUE;
+}
+
 /*
  * 功能：生成符合 Rdpgfx 要求的 32 位时间戳。
- * 逻辑：获取本地时间，按小时/分钟/秒/毫秒编码到 32 位整数。
+ * 逻辑：获取本地时间，按小时/分钟/秒/毫秒编码到 32 位整数；用 localtime_r 而非 GDateTime，每帧不分配堆内存。
  * 参数：无。
- * 外部接口：GLib GDateTime API 获取时间。
+ * 外部接口：GLib g_get_real_time；C localtime_r。
  */
 static guint32 drd_rdp_graphics_pipeline_build_timestamp(void)
 {
-    guint32 timestamp = 0;
-    GDateTime *now = g_date_time_new_now_local();
+    const gint64 now_us = g_get_real_time();
+    const time_t seconds = (time_t) (now_us / G_USEC_PER_SEC);
+    struct tm local;
+
+    if (localtime_r(&seconds, &local) == NULL)
+    {
+        return 0;
+    }
+    return ((guint32) local.tm_hour << 22) | ((guint32) local.tm_min << 16) | ((guint32) local.tm_sec << 10) |
+           (guint32) ((now_us % G_USEC_PER_SEC) / 1000);
+}
+
+
+/*
+ * 功能：交换管理器与流水线槽位上的移动、纯色填充与缓存还原操作。
+ * 逻辑：提交时把本帧操作移入槽位；drd_encoding_manager_send_surface_frame 读取管理器上的操作，
+ *       发送槽位中的帧时换入、发送后换回，不影响管理器上正在计划的操作。
+ * 参数：self 管理器；job 流水线槽位。
+ * 外部接口：无。
+ */
+static void drd_vaapi_job_swap_ops(DrdEncodingManager *self, DrdVaapiJob *job)
+{
+    const gboolean move_active = self->gfx_move_active;
+    const RECTANGLE_16 move_source = self->gfx_move_source;
+    const RDPGFX_POINT16 move_dest = self->gfx_move_dest;
+    GArray *solid_fills = self->gfx_solid_fills;
+    GArray *cache_hits = self->gfx_cache_hits;
+
+    self->gfx_move_active = job->move_active;
+    self->gfx_move_source = job->move_source;
+    self->gfx_move_dest = job->move_dest;
+    self->gfx_solid_fills = job->solid_fills;
+    self->gfx_cache_hits = job->cache_hits;
+    job->move_active = move_active;
+    job->move_source = move_source;
+    job->move_dest = move_dest;
+    job->solid_fills = solid_fills;
+    job->cache_hits = cache_hits;
+}
+
+/*
+ * 功能：把本帧提交到 VAAPI 编码流水线。
+ * 逻辑：变化位图、更新区域与帧操作移入槽位，记录提交时上一帧与本帧的序号和 tile 布局后交给编码线程；差分状态随即前移，
+ *       下一帧相对本帧分析，编码或发送失败时由 drd_vaapi_pipeline_discard 强制关键帧恢复。
+ * 参数：self 管理器（流水线未满、编码器已准备）；input 本帧；diff_valid 本帧差分以上一帧为基准；
+ *       keyframe 是否整幅更新；cmd 表面命令模板。
+ * 外部接口：GLib g_thread_pool_new/g_thread_pool_push。
+ */
+static void drd_vaapi_pipeline_submit(DrdEncodingManager *self, DrdFrame *input, gboolean diff_valid,
+                                      gboolean keyframe, const RDPGFX_SURFACE_COMMAND *cmd)
+{
+    DrdVaapiJob *job =
+            &self->vaapi_jobs[(self->vaapi_job_head + self->vaapi_job_count) % DRD_VAAPI_PIPELINE_DEPTH];
+    GArray *array = NULL;
+
+    WINPR_ASSERT(self->vaapi_job_count < DRD_VAAPI_PIPELINE_DEPTH);
+    job->input = g_object_ref(input);
+    job->base_serial = diff_valid && self->gfx_previous_frame != NULL ? self->gfx_previous_serial : 0;
+    job->keyframe = keyframe;
+    job->tiles_x = self->gfx_tiles_x;
+    job->tiles_y = self->gfx_tiles_y;
+    job->row_words = self->gfx_dirty_row_words;
+    array = job->changed_bitmap;
+    job->changed_bitmap = self->gfx_changed_bitmap;
+    self->gfx_changed_bitmap = array;
+    array = job->region_rects;
+    job->region_rects = self->gfx_region_rects;
+    self->gfx_region_rects = array;
+    g_array_set_size(self->gfx_region_rects, 0);
+    drd_vaapi_job_swap_ops(self, job);
+    drd_encoding_manager_discard_frame_ops(self);
+    job->cmd = *cmd;
+
+    self->vaapi_job_count++;
+    drd_encoding_manager_commit_gfx_diff_state(self, input);
+    job->serial = self->gfx_previous_serial;
+    self->gfx_force_keyframe = FALSE;
+
+    if (self->vaapi_pool == NULL)
+    {
+        self->vaapi_pool = g_thread_pool_new(drd_vaapi_pipeline_worker, self, 1, FALSE, NULL);
+    }
+    g_thread_pool_push(self->vaapi_pool, job, NULL);
+}
+
+/*
+ * 功能：发送流水线中最早的一帧（须已完成）。
+ * 逻辑：编码失败时丢弃整条流水线（后续帧的更新区域相对失败帧描述）并强制关键帧，以 G_IO_ERROR_PENDING 返回；
+ *       失败不是“暂无输出”时还释放编码器，下一帧重新创建，创建失败则改走软件编码。成功时以本次调用的帧号发送，
+ *       元数据与帧操作取自槽位；发送失败同样丢弃流水线。每次调用最多发送一帧，与渲染线程逐帧递增的帧号一致。
+ * 参数：self 管理器；context Rdpgfx 上下文；surface_id 目标 surface；frame_id 帧号；h264 输出是否为 H264；error 错误输出。
+ * 外部接口：drd_encoding_manager_send_surface_frame/register_codec_result。
+ */
+static gboolean drd_vaapi_pipeline_send(DrdEncodingManager *self, RdpgfxServerContext *context, guint16 surface_id,
+                                        guint32 frame_id, gboolean *h264, GError **error)
+{
+    DrdVaapiJob *job = &self->vaapi_jobs[self->vaapi_job_head];
+    RDPGFX_SURFACE_COMMAND cmd = job->cmd;
+    RDPGFX_START_FRAME_PDU start = {0};
+    RDPGFX_END_FRAME_PDU end = {0};
+    UINT rc = CHANNEL_RC_OK;
+
+    if (job->error != NULL)
+    {
+        const gboolean pending = g_error_matches(job->error, G_IO_ERROR, G_IO_ERROR_PENDING);
+        if (!pending)
+        {
+            g_warning("VAAPI avc420 encode failed: %s", job->error->message);
+        }
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_PENDING, "VAAPI avc420 frame dropped: %s", job->error->message);
+        drd_vaapi_pipeline_discard(self);
+        if (!pending)
+        {
+            drd_vaapi_encoder_release(self);
+        }
+        return FALSE;
+    }
+
+    start.frameId = frame_id;
+    start.timestamp = drd_rdp_graphics_pipeline_build_timestamp();
+    end.frameId = frame_id;
+    drd_vaapi_job_swap_ops(self, job);
+    if (job->region_rects->len > 0)
+    {
+        drd_h264_fill_region_metablock(self, job->region_rects, &job->avc420.meta);
+        cmd.extra = (void *) &job->avc420;
+        rc = drd_encoding_manager_send_surface_frame(self, context, surface_id, &cmd, &start, &end);
+        /* 元数据引用区域数组的存储，不能交给 free_h264_metablock */
+        memset(&job->avc420.meta, 0, sizeof(job->avc420.meta));
+    }
+    else
+    {
+        rc = drd_encoding_manager_send_surface_frame(self, context, surface_id, NULL, &start, &end);
+    }
+    drd_vaapi_job_swap_ops(self, job);
+
+    if (rc != CHANNEL_RC_OK)
+    {
+        drd_vaapi_pipeline_discard(self);
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "SurfaceFrameCommand failed with error %" PRIu32 "", rc);
+        return FALSE;
+    }
+
+    *h264 = TRUE;
+    if (job->region_rects->len > 0)
+    {
+        drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_AVC, TRUE);
+    }
+    drd_vaapi_pipeline_pop(self);
+    return TRUE;
+}
 
-    if (now != NULL)
+/*
+ * 功能：本次调用尚未发送时，发送流水线中已编码完成的最早一帧。
+ * 逻辑：sent 为 TRUE 时直接成功；流水线为空或最早一帧仍在编码时以 G_IO_ERROR_PENDING 返回，不等待。
+ * 参数：self 管理器；sent 本次调用是否已发送一帧；其余同 drd_vaapi_pipeline_send。
+ * 外部接口：无。
+ */
+static gboolean drd_vaapi_pipeline_send_ready(DrdEncodingManager *self, gboolean sent, RdpgfxServerContext *context,
+                                              guint16 surface_id, guint32 frame_id, gboolean *h264, GError **error)
+{
+    if (sent)
+    {
+        return TRUE;
+    }
+    if (self->vaapi_job_count == 0 || !drd_vaapi_pipeline_oldest_done(self, FALSE))
     {
-        timestamp = ((guint32) g_date_time_get_hour(now) << 22) | ((guint32) g_date_time_get_minute(now) << 16) |
-                    ((guint32) g_date_time_get_second(now) << 10) |
-                    ((guint32) (g_date_time_get_microsecond(now) / 1000));
-        g_date_time_unref(now);
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "avc420 frame still encoding");
+        return FALSE;
     }
+    return drd_vaapi_pipeline_send(self, context, surface_id, frame_id, h264, error);
+}
+
+/*
+ * 功能：判断 VAAPI 流水线中是否还有未发送的帧。
+ * 逻辑：读取渲染线程维护的在途帧数。
+ * 参数：self 管理器。
+ * 外部接口：无。
+ */
+gboolean drd_encoding_manager_has_pending_gfx(DrdEncodingManager *self)
+{
+    g_return_val_if_fail(DRD_IS_ENCODING_MANAGER(self), FALSE);
+    return self->vaapi_job_count > 0;
+}
+
+/*
+ * 功能：没有新捕获帧时发送 VAAPI 流水线中最早的一帧。
+ * 逻辑：等待最早一帧编码完成后发送；流水线为空时以 G_IO_ERROR_PENDING 返回。
+ * 参数：self 管理器；context Rdpgfx 上下文；surface_id 目标 surface；frame_id 帧号；h264 输出是否为 H264；error 错误输出。
+ * 外部接口：drd_vaapi_pipeline_send。
+ */
+gboolean drd_encoding_manager_flush_gfx(DrdEncodingManager *self,
+                                        RdpgfxServerContext *context,
+                                        guint16 surface_id,
+                                        guint32 frame_id,
+                                        gboolean *h264,
+                                        GError **error)
+{
+    g_return_val_if_fail(DRD_IS_ENCODING_MANAGER(self), FALSE);
+    g_return_val_if_fail(context != NULL, FALSE);
 
-    return timestamp;
+    *h264 = FALSE;
+    if (self->vaapi_job_count == 0)
+    {
+        g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "no frame in VAAPI pipeline");
+        return FALSE;
+    }
+    drd_vaapi_pipeline_oldest_done(self, TRUE);
+    return drd_vaapi_pipeline_send(self, context, surface_id, frame_id, h264, error);
 }
 
 
@@ -1216,12 +2773,62 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
     *h264 = FALSE;
 
     drd_encoding_manager_prepare_gfx_diff_state(self, self->frame_width, self->frame_height, stride);
-    const guint8 *previous_frame =
-            (self->gfx_previous_frame->len == (gsize) stride * self->frame_height) ? self->gfx_previous_frame->data : NULL;
+    const guint8 *previous_frame = NULL;
+    if (self->gfx_previous_frame != NULL && drd_frame_get_stride(self->gfx_previous_frame) == stride &&
+        drd_frame_get_height(self->gfx_previous_frame) == self->frame_height)
+    {
+        previous_frame = drd_frame_get_data(self->gfx_previous_frame, NULL);
+    }
     gboolean success = FALSE;
-    GArray *dirty_flags = g_array_sized_new(FALSE, TRUE, sizeof(gboolean), self->gfx_tiles_x * self->gfx_tiles_y);
-    const gboolean large_change = drd_encoding_manager_analyze_tiles(
-            self, data, previous_frame, stride, self->gfx_large_change_threshold, dirty_flags, NULL);
+    /* 本帧成功提交前上一帧不再是上一个输入帧；没有任何变化时两者像素一致，提示依然有效 */
+    const gboolean damage_baseline = self->gfx_damage_baseline;
+    self->gfx_damage_baseline = FALSE;
+    drd_encoding_manager_prepare_damage_hint(self, input, previous_frame != NULL && damage_baseline);
+    guint changed_tiles = 0;
+    gboolean large_change = drd_encoding_manager_analyze_tiles(self, data, previous_frame, stride,
+                                                               self->gfx_large_change_threshold, &changed_tiles);
+    if (changed_tiles == 0 && previous_frame != NULL)
+    {
+        self->gfx_damage_baseline = damage_baseline || !self->gfx_damage_hint_active;
+    }
+    if (self->h264_hw_accel)
+    {
+        /* VAAPI 暂存帧要同步全部变化，包括随后由移动、纯色填充与缓存还原处理、不再编码的 tile */
+        g_array_set_size(self->gfx_changed_bitmap, self->gfx_dirty_bitmap->len);
+        memcpy(self->gfx_changed_bitmap->data, self->gfx_dirty_bitmap->data,
+               self->gfx_dirty_bitmap->len * sizeof(guint64));
+    }
+    /* 滚动时几乎所有 tile 都会变化，先让客户端移动已有内容，再按剩余变化判断是否为大变化 */
+    self->gfx_move_active = FALSE;
+    if (previous_frame != NULL && self->enable_diff && context->SurfaceToSurface != NULL &&
+        changed_tiles >= DRD_GFX_MOVE_MIN_TILES && drd_encoding_manager_detect_move(self, data, previous_frame, stride))
+    {
+        changed_tiles = drd_encoding_manager_apply_move(self, data, previous_frame, stride);
+        large_change = drd_encoding_manager_is_large_change(self, changed_tiles);
+    }
+    /* 打开/关闭窗口时露出的桌面背景与空白区域多为纯色 tile，以 SolidFill 填充，不再编码也不计入大变化 */
+    g_array_set_size(self->gfx_solid_fills, 0);
+    if (previous_frame != NULL && self->enable_diff && context->SolidFill != NULL && changed_tiles > 0)
+    {
+        changed_tiles -= drd_encoding_manager_collect_solid_fills(self);
+        large_change = drd_encoding_manager_is_large_change(self, changed_tiles);
+    }
+    /* 切回窗口、重开菜单时剩余变化 tile 往往仍在客户端缓存中，命中的 tile 只需复制，不计入大变化 */
+    g_array_set_size(self->gfx_cache_hits, 0);
+    g_array_set_size(self->gfx_cache_stores, 0);
+    const gboolean cache_active = self->gfx_cache != NULL && self->enable_diff && context->CacheToSurface != NULL &&
+                                  context->SurfaceToCache != NULL && context->EvictCacheEntry != NULL;
+    if (cache_active)
+    {
+        drd_gfx_cache_begin(self->gfx_cache, freerdp_settings_get_bool(settings, FreeRDP_GfxSmallCache)
+                                                     ? DRD_GFX_CACHE_SMALL_SLOTS
+                                                     : DRD_GFX_CACHE_SLOTS);
+        if (previous_frame != NULL && changed_tiles > 0)
+        {
+            changed_tiles = drd_encoding_manager_apply_cache_hits(self);
+            large_change = drd_encoding_manager_is_large_change(self, changed_tiles);
+        }
+    }
     gboolean use_avc444 = FALSE;
     gboolean use_avc420 = FALSE;
     gboolean use_progressive = FALSE;
@@ -1303,6 +2910,13 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         use_remotefx = gfx_remotefx && id != 0;
     }
 
+    /* 同步编码的帧不能越过流水线中尚未发送的帧：丢弃它们（强制关键帧），本帧相对它们计划的帧操作一并撤销 */
+    if (self->vaapi_job_count > 0 && !(use_avc420 && self->h264_hw_accel))
+    {
+        drd_vaapi_pipeline_discard(self);
+        drd_encoding_manager_discard_frame_ops(self);
+    }
+
     cmd_start.frameId = frame_id;
     cmd_start.timestamp = drd_rdp_graphics_pipeline_build_timestamp();
     cmd_end.frameId = cmd_start.frameId;
@@ -1325,6 +2939,8 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         RECTANGLE_16 regionRect = {0};
         BYTE version = gfx_avc444v2 ? 2 : 1;
         *h264 = TRUE;
+        /* AVC 每帧整幅更新，客户端移动、填充与缓存还原的内容会被整体覆盖 */
+        drd_encoding_manager_discard_frame_ops(self);
         WINPR_ASSERT(cmd.left <= UINT16_MAX);
         WINPR_ASSERT(cmd.top <= UINT16_MAX);
         WINPR_ASSERT(cmd.right <= UINT16_MAX);
@@ -1360,7 +2976,7 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
             avc444.cbAvc420EncodedBitstream1 = rdpgfx_estimate_h264_avc420(&avc444.bitstream[0]);
             cmd.codecId = gfx_avc444v2 ? RDPGFX_CODECID_AVC444v2 : RDPGFX_CODECID_AVC444;
             cmd.extra = (void *) &avc444;
-            IFCALLRET(context->SurfaceFrameCommand, if_error, context, &cmd, &cmd_start, &cmd_end);
+            if_error = drd_encoding_manager_send_surface_frame(self, context, surface_id, &cmd, &cmd_start, &cmd_end);
         }
         free_h264_metablock(&avc444.bitstream[0].meta);
         free_h264_metablock(&avc444.bitstream[1].meta);
@@ -1372,8 +2988,7 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         }
         if (rc > 0)
         {
-            drd_encoding_manager_store_previous_frame(self, data, stride, self->frame_height);
-            drd_encoding_manager_update_tile_hashes(self, data, stride);
+            drd_encoding_manager_commit_gfx_diff_state(self, input);
             drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_AVC, TRUE);
         }
     }
@@ -1382,8 +2997,9 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         INT32 rc = 0;
         RDPGFX_AVC420_BITMAP_STREAM avc420 = {0};
         RECTANGLE_16 regionRect;
-        g_autoptr(GByteArray) vaapi_bitstream = NULL;
-        gboolean use_vaapi = FALSE;
+        GArray *regions = self->gfx_region_rects;
+        g_autoptr(GError) vaapi_error = NULL;
+        gboolean sent = FALSE;
         *h264 = TRUE;
         if (!drd_encoder_prepare(self, FREERDP_CODEC_AVC420, settings))
         {
@@ -1395,68 +3011,104 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         regionRect.right = (UINT16) cmd.right;
         regionRect.bottom = (UINT16) cmd.bottom;
 
-        if (self->h264_hw_accel)
+        /* 流水线已满时先等最早一帧编码完成并发送以腾出槽位；它编码失败时流水线已清空并强制关键帧，本帧照常处理 */
+        if (self->h264_hw_accel && self->vaapi_job_count == DRD_VAAPI_PIPELINE_DEPTH)
         {
-            if (drd_vaapi_encode_avc420(self, data, stride, &regionRect, &avc420, &vaapi_bitstream, error))
-            {
-                DRD_LOG_MESSAGE("VAAPI avc420 encode");
-                rc = 1;
-                use_vaapi = TRUE;
-            }
-            else
+            drd_vaapi_pipeline_oldest_done(self, TRUE);
+            sent = drd_vaapi_pipeline_send(self, context, surface_id, frame_id, h264, &vaapi_error);
+            if (!sent && !g_error_matches(vaapi_error, G_IO_ERROR, G_IO_ERROR_PENDING))
             {
-                if (error != NULL && *error != NULL && g_error_matches(*error, G_IO_ERROR, G_IO_ERROR_PENDING))
-                {
-                    goto out;
-                }
-                g_clear_error(error);
-                g_warning("VAAPI avc420 encode failed, fallback to software");
+                g_propagate_error(error, g_steal_pointer(&vaapi_error));
+                goto out;
             }
+            g_clear_error(&vaapi_error);
+        }
+        /* 硬件编码在编码线程上进行，本帧提交后即返回；编码器不可用时本帧改走软件编码 */
+        const gboolean use_vaapi = self->h264_hw_accel && drd_vaapi_encoder_prepare(self, &vaapi_error);
+        if (self->h264_hw_accel && !use_vaapi)
+        {
+            g_warning("VAAPI avc420 encoder unavailable, fallback to software: %s", vaapi_error->message);
+        }
+        if (sent && !use_vaapi)
+        {
+            /* 本次调用的帧号已用于流水线中的帧，本帧留给下一次调用按关键帧编码 */
+            success = TRUE;
+            goto out;
         }
 
-        if (!use_vaapi)
+        /*
+         * 元数据只上报脏 tile 合并出的矩形，客户端只更新这些区域，未变化的宏块由编码器按跳过处理；
+         * 移动、纯色填充与缓存还原在 SurfaceCommand 之前照常发送。需要整幅同步时退回全帧区域。
+         */
+        const gboolean full_frame = self->gfx_force_keyframe || !self->enable_diff;
+        g_array_set_size(regions, 0);
+        if (full_frame)
+        {
+            drd_encoding_manager_discard_frame_ops(self);
+            g_array_append_val(regions, regionRect);
+        }
+        else if (!drd_encoding_manager_collect_region_rects(self, regions))
         {
-            rc = avc420_compress(self->h264, data, cmd.format, stride, self->frame_width, self->frame_height, &regionRect,
-                                 &avc420.data, &avc420.length, &avc420.meta);
-            if (rc < 0)
+            const gboolean has_ops =
+                    self->gfx_move_active || self->gfx_solid_fills->len > 0 || self->gfx_cache_hits->len > 0;
+            if (!has_ops && use_vaapi)
+            {
+                success = drd_vaapi_pipeline_send_ready(self, sent, context, surface_id, frame_id, h264, error);
+                goto out;
+            }
+            if (!has_ops)
             {
-                g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "avc420_compress failed");
+                g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "not exist dirty region");
                 goto out;
             }
-            if (rc == 0)
+            /* 硬件编码时只有帧操作的一帧也进入流水线，保持与在途帧的发送顺序 */
+            if (!use_vaapi)
             {
-                free_h264_metablock(&avc420.meta);
-                g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "no avc420 frame produced");
+                success = drd_encoding_manager_send_ops_only(self, context, surface_id, &cmd_start, &cmd_end, input,
+                                                             error);
                 goto out;
             }
         }
-        /* rc > 0 means new data */
-        if (rc > 0)
+
+        if (use_vaapi)
         {
             cmd.codecId = RDPGFX_CODECID_AVC420;
-            cmd.extra = (void *) &avc420;
-
-            IFCALLRET(context->SurfaceFrameCommand, if_error, context, &cmd, &cmd_start, &cmd_end);
+            drd_vaapi_pipeline_submit(self, input, previous_frame != NULL, full_frame, &cmd);
+            success = drd_vaapi_pipeline_send_ready(self, sent, context, surface_id, frame_id, h264, error);
+            goto out;
         }
-        free_h264_metablock(&avc420.meta);
 
-        if (if_error)
+        rc = avc420_compress(self->h264, data, cmd.format, stride, self->frame_width, self->frame_height, &regionRect,
+                             &avc420.data, &avc420.length, &avc420.meta);
+        if (rc < 0)
         {
-            g_autofree gchar *err_msg = g_strdup_printf("SurfaceFrameCommand failed with error %" PRIu32 "", if_error);
-            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, err_msg);
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "avc420_compress failed");
             goto out;
         }
-        if (rc > 0)
+        /* FreeRDP 的元数据按整幅或自身的 YUV 比对给出，换成与差分状态一致的更新矩形 */
+        free_h264_metablock(&avc420.meta);
+        if (rc == 0)
         {
-            drd_encoding_manager_store_previous_frame(self, data, stride, self->frame_height);
-            drd_encoding_manager_update_tile_hashes(self, data, stride);
-            drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_AVC, TRUE);
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "no avc420 frame produced");
+            goto out;
         }
+        drd_h264_fill_region_metablock(self, regions, &avc420.meta);
+        cmd.codecId = RDPGFX_CODECID_AVC420;
+        cmd.extra = (void *) &avc420;
+        if_error = drd_encoding_manager_send_surface_frame(self, context, surface_id, &cmd, &cmd_start, &cmd_end);
+        /* 元数据引用区域数组的存储，不能交给 free_h264_metablock */
+        memset(&avc420.meta, 0, sizeof(avc420.meta));
 
-        if (use_vaapi)
+        if (if_error)
         {
-            g_clear_pointer(&vaapi_bitstream, g_byte_array_unref);
+            g_autofree gchar *err_msg = g_strdup_printf("SurfaceFrameCommand failed with error %" PRIu32 "", if_error);
+            self->gfx_force_keyframe = TRUE;
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, err_msg);
+            goto out;
         }
+        drd_encoding_manager_commit_gfx_diff_state(self, input);
+        drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_AVC, TRUE);
+        self->gfx_force_keyframe = FALSE;
     }
     else if (use_progressive)
     {
@@ -1484,6 +3136,7 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         if (keyframe_encode)
         {
             DRD_LOG_MESSAGE("frame key refresh");
+            drd_encoding_manager_discard_frame_ops(self);
             memset(self->gfx_tile_hashes->data, 0, self->gfx_tile_hashes->len * sizeof(guint64));
             regionRect.left = (UINT16) cmd.left;
             regionRect.top = (UINT16) cmd.top;
@@ -1491,9 +3144,15 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
             regionRect.bottom = (UINT16) cmd.bottom;
             region16_union_rect(&region, &region, &regionRect);
         }
-        else if (!drd_encoding_manager_collect_dirty_region(self, dirty_flags, &region))
+        else if (!drd_encoding_manager_collect_dirty_region(self, &region))
         {
             region16_uninit(&region);
+            if (self->gfx_move_active || self->gfx_solid_fills->len > 0 || self->gfx_cache_hits->len > 0)
+            {
+                success = drd_encoding_manager_send_ops_only(self, context, surface_id, &cmd_start, &cmd_end, input,
+                                                             error);
+                goto out;
+            }
             g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "not exist dirty region");
             goto out;
         }
@@ -1510,21 +3169,25 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
         if (rc > 0)
         {
             cmd.codecId = RDPGFX_CODECID_CAPROGRESSIVE;
+            if (cache_active)
+            {
+                drd_encoding_manager_plan_cache_stores(self, keyframe_encode);
+            }
 
-            IFCALLRET(context->SurfaceFrameCommand, if_error, context, &cmd, &cmd_start, &cmd_end);
+            if_error = drd_encoding_manager_send_surface_frame(self, context, surface_id, &cmd, &cmd_start, &cmd_end);
         }
 
         if (if_error)
         {
             g_autofree gchar *err_msg = g_strdup_printf("SurfaceFrameCommand failed with error %" PRIu32 "", if_error);
+            drd_encoding_manager_drop_cache_stores(self);
             self->gfx_force_keyframe = TRUE;
             g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, err_msg);
             goto out;
         }
         if (rc > 0)
         {
-            drd_encoding_manager_store_previous_frame(self, data, stride, self->frame_height);
-            drd_encoding_manager_update_tile_hashes(self, data, stride);
+            drd_encoding_manager_commit_gfx_diff_state(self, input);
             drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_NON_AVC, keyframe_encode);
             self->gfx_force_keyframe = FALSE;
         }
@@ -1555,14 +3218,21 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
 
         if (keyframe_encode)
         {
+            drd_encoding_manager_discard_frame_ops(self);
             memset(self->gfx_tile_hashes->data, 0, self->gfx_tile_hashes->len * sizeof(guint64));
             RFX_RECT full = {0, 0, (UINT16) self->frame_width, (UINT16) self->frame_height};
             g_array_append_val(rects, full);
         }
-        else if (!drd_encoding_manager_collect_dirty_rects(self, dirty_flags, rects))
+        else if (!drd_encoding_manager_collect_dirty_rects(self, rects))
         {
-            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "not exist dirty region");
             Stream_Free(s, TRUE);
+            if (self->gfx_move_active || self->gfx_solid_fills->len > 0 || self->gfx_cache_hits->len > 0)
+            {
+                success = drd_encoding_manager_send_ops_only(self, context, surface_id, &cmd_start, &cmd_end, input,
+                                                             error);
+                goto out;
+            }
+            g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PENDING, "not exist dirty region");
             goto out;
         }
 
@@ -1584,22 +3254,26 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
             cmd.codecId = RDPGFX_CODECID_CAVIDEO;
             cmd.data = Stream_Buffer(s);
             cmd.length = (UINT32) pos;
+            if (cache_active)
+            {
+                drd_encoding_manager_plan_cache_stores(self, keyframe_encode);
+            }
 
-            IFCALLRET(context->SurfaceFrameCommand, if_error, context, &cmd, &cmd_start, &cmd_end);
+            if_error = drd_encoding_manager_send_surface_frame(self, context, surface_id, &cmd, &cmd_start, &cmd_end);
         }
 
         Stream_Free(s, TRUE);
         if (if_error)
         {
             g_autofree gchar *err_msg = g_strdup_printf("SurfaceFrameCommand failed with error %" PRIu32 "", if_error);
+            drd_encoding_manager_drop_cache_stores(self);
             self->gfx_force_keyframe = TRUE;
             g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, err_msg);
             goto out;
         }
         if (rc > 0)
         {
-            drd_encoding_manager_store_previous_frame(self, data, stride, self->frame_height);
-            drd_encoding_manager_update_tile_hashes(self, data, stride);
+            drd_encoding_manager_commit_gfx_diff_state(self, input);
             drd_encoding_manager_register_codec_result(self, DRD_ENCODING_CODEC_CLASS_NON_AVC, keyframe_encode);
             self->gfx_force_keyframe = FALSE;
         }
@@ -1611,11 +3285,6 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self, rdpSe
     success = TRUE;
 
 out:
-    if (dirty_flags != NULL)
-    {
-        g_array_free(dirty_flags, TRUE);
-    }
-
     return success;
 }
 
@@ -1646,7 +3315,7 @@ gboolean drd_encoding_manager_encode_surface_bit(DrdEncodingManager *self, rdpCo
 
 /*
  * 功能：请求下一个编码产生关键帧。
- * 逻辑：置关键帧标记，供 RFX/Progressive 编码路径读取。
+ * 逻辑：置关键帧标记，供 RFX/Progressive 编码路径读取；AVC420 据此上报整幅区域。
  * 参数：self 管理器实例。
  * 外部接口：无。
  */
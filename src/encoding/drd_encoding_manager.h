@@ -6,6 +6,7 @@
 #include <freerdp/server/rdpgfx.h>
 
 #include "core/drd_encoding_options.h"
+#include "encoding/drd_gfx_cache.h"
 #include "utils/drd_frame.h"
 
 G_BEGIN_DECLS
@@ -25,6 +26,16 @@ gboolean drd_encoding_manager_prepare(DrdEncodingManager *self,
                                        const DrdEncodingOptions *options,
                                        GError **error);
 void drd_encoding_manager_reset(DrdEncodingManager *self);
+
+/**
+ * drd_encoding_manager_set_gfx_cache:
+ * @self: the encoder of one surface
+ * @cache: (nullable): client tile cache shared by every surface of the graphics channel
+ *
+ * Progressive/RemoteFX frames restore dirty tiles found in @cache with
+ * CacheToSurface and store newly encoded tiles with SurfaceToCache.
+ */
+void drd_encoding_manager_set_gfx_cache(DrdEncodingManager *self, DrdGfxCache *cache);
 gboolean drd_encoding_manager_refresh_interval_reached( DrdEncodingManager *self);
 gboolean drd_encoding_manager_has_avc_to_non_avc_transition( DrdEncodingManager *self);
 guint drd_encoding_manager_get_refresh_timeout_ms( DrdEncodingManager *self);
@@ -38,6 +49,39 @@ gboolean drd_encoding_manager_encode_surface_gfx(DrdEncodingManager *self,
                                                  gboolean *h264,
                                                  gboolean auto_switch,
                                                  GError **error);
+
+/**
+ * drd_encoding_manager_has_pending_gfx:
+ * @self: the encoder of one surface
+ *
+ * With VAAPI, AVC420 frames are encoded on a worker thread and
+ * drd_encoding_manager_encode_surface_gfx() sends at most one finished
+ * frame per call, so submitted frames may still wait to be sent.
+ *
+ * Returns: %TRUE when submitted frames have not been sent yet
+ */
+gboolean drd_encoding_manager_has_pending_gfx(DrdEncodingManager *self);
+
+/**
+ * drd_encoding_manager_flush_gfx:
+ * @self: the encoder of one surface
+ * @context: Rdpgfx context
+ * @surface_id: the surface of @self
+ * @frame_id: frame id of the sent frame
+ * @h264: (out): whether the sent frame used H.264
+ * @error: return location for a #GError
+ *
+ * Waits for the oldest submitted frame and sends it. Used when no new
+ * frame was captured.
+ *
+ * Returns: %TRUE when a frame was sent; %G_IO_ERROR_PENDING when none is pending
+ */
+gboolean drd_encoding_manager_flush_gfx(DrdEncodingManager *self,
+                                        RdpgfxServerContext *context,
+                                        guint16 surface_id,
+                                        guint32 frame_id,
+                                        gboolean *h264,
+                                        GError **error);
 gboolean drd_encoding_manager_encode_cached_frame_gfx(DrdEncodingManager *self,
                                                      rdpSettings *settings,
                                                      RdpgfxServerContext *context,
@@ -0,0 +1,634 @@
+#include "encoding/drd_frame_scaler.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DRD_FRAME_SCALER_HAVE_AVX2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define DRD_FRAME_SCALER_HAVE_NEON 1
+#endif
+
+#include "utils/drd_log.h"
+
+#define DRD_FRAME_SCALER_BYTES_PER_PIXEL 4
+/* 单个输出缓冲累计的过期矩形超过该数量时改为整帧同步 */
+#define DRD_FRAME_SCALER_MAX_STALE_RECTS 256
+/* 插值权重为 8 位定点，256 表示 1.0 */
+#define DRD_FRAME_SCALER_WEIGHT_ONE 256
+
+typedef void (*DrdFrameScalerBlendFunc)(guint8 *dst, const guint8 *row_a, const guint8 *row_b, gsize n, guint weight);
+
+typedef struct
+{
+    DrdFrameScaler *scaler;
+    guint8 *data;
+    gboolean in_use;
+    GArray *stale;
+    gboolean stale_full;
+} DrdFrameScalerBuffer;
+
+struct _DrdFrameScaler
+{
+    GObject parent_instance;
+
+    guint width;
+    guint height;
+    guint src_width;
+    guint src_height;
+    /* 每个目标列/行对应的源坐标与指向下一像素的插值权重 */
+    guint32 *x_index;
+    guint8 *x_weight;
+    guint32 *y_index;
+    guint8 *y_weight;
+    guint8 *row; /* 竖直插值后的源行暂存 */
+    gboolean output_valid;
+    GArray *rects;
+    /* 输出缓冲环：latest 为最近输出的缓冲，新缓冲从它同步过期矩形；in_use 受 mutex 保护 */
+    GMutex mutex;
+    DrdFrameScalerBuffer *buffers;
+    guint n_buffers;
+    gint latest;
+    gsize frame_size;
+};
+
+G_DEFINE_TYPE(DrdFrameScaler, drd_frame_scaler, G_TYPE_OBJECT)
+
+static DrdFrameScalerBlendFunc drd_frame_scaler_blend_rows = NULL;
+static const gchar *drd_frame_scaler_kernel_name = "scalar";
+
+/*
+ * 功能：按权重混合两行字节（通用实现）。
+ * 逻辑：逐字节计算 (a * (256 - w) + b * w) >> 8，也用于 SIMD 实现的尾部。
+ * 参数：dst 输出；row_a/row_b 上下两行；n 字节数；weight 下一行权重（1..255）。
+ * 外部接口：无。
+ */
+static void
+drd_frame_scaler_blend_rows_scalar(guint8 *dst, const guint8 *row_a, const guint8 *row_b, gsize n, guint weight)
+{
+    const guint weight_a = DRD_FRAME_SCALER_WEIGHT_ONE - weight;
+    for (gsize i = 0; i < n; i++)
+    {
+        dst[i] = (guint8) ((row_a[i] * weight_a + row_b[i] * weight) >> 8);
+    }
+}
+
+#ifdef DRD_FRAME_SCALER_HAVE_AVX2
+/*
+ * 功能：按权重混合两行字节（AVX2）。
+ * 逻辑：每次 32 字节，扩展为 16 位后乘权重相加再右移 8 位，打包回 8 位（unpack/pack 均在 128 位通道内，顺序保持一致）。
+ * 参数：同通用实现。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static void
+drd_frame_scaler_blend_rows_avx2(guint8 *dst, const guint8 *row_a, const guint8 *row_b, gsize n, guint weight)
+{
+    const __m256i weight_a = _mm256_set1_epi16((short) (DRD_FRAME_SCALER_WEIGHT_ONE - weight));
+    const __m256i weight_b = _mm256_set1_epi16((short) weight);
+    const __m256i zero = _mm256_setzero_si256();
+    gsize i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i a = _mm256_loadu_si256((const __m256i *) (row_a + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i *) (row_b + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), weight_a),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), weight_b));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), weight_a),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), weight_b));
+        lo = _mm256_srli_epi16(lo, 8);
+        hi = _mm256_srli_epi16(hi, 8);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    drd_frame_scaler_blend_rows_scalar(dst + i, row_a + i, row_b + i, n - i, weight);
+}
+#endif
+
+#ifdef DRD_FRAME_SCALER_HAVE_NEON
+/*
+ * 功能：按权重混合两行字节（NEON）。
+ * 逻辑：每次 16 字节，用 vmull/vmlal 做 8×8→16 位乘加，窄化右移 8 位后写回。
+ * 参数：同通用实现。
+ * 外部接口：NEON intrinsics。
+ */
+static void
+drd_frame_scaler_blend_rows_neon(guint8 *dst, const guint8 *row_a, const guint8 *row_b, gsize n, guint weight)
+{
+    const uint8x8_t weight_a = vdup_n_u8((uint8_t) (DRD_FRAME_SCALER_WEIGHT_ONE - weight));
+    const uint8x8_t weight_b = vdup_n_u8((uint8_t) weight);
+    gsize i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        const uint8x16_t a = vld1q_u8(row_a + i);
+        const uint8x16_t b = vld1q_u8(row_b + i);
+        uint16x8_t lo = vmull_u8(vget_low_u8(a), weight_a);
+        uint16x8_t hi = vmull_u8(vget_high_u8(a), weight_a);
+        lo = vmlal_u8(lo, vget_low_u8(b), weight_b);
+        hi = vmlal_u8(hi, vget_high_u8(b), weight_b);
+        vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+    drd_frame_scaler_blend_rows_scalar(dst + i, row_a + i, row_b + i, n - i, weight);
+}
+#endif
+
+/*
+ * 功能：按权重混合左右两个 BGRA 像素。
+ * 逻辑：SWAR，把 B/R 与 G/A 分别放在 16 位通道里同时乘加，权重和为 256 时各通道不会溢出。
+ * 参数：p 左像素；q 右像素；weight 右像素权重（1..255）。
+ * 外部接口：无。
+ */
+static inline guint32
+drd_frame_scaler_lerp_pixel(guint32 p, guint32 q, guint weight)
+{
+    const guint32 weight_p = DRD_FRAME_SCALER_WEIGHT_ONE - weight;
+    const guint32 rb = (((p & 0x00FF00FFu) * weight_p + (q & 0x00FF00FFu) * weight) >> 8) & 0x00FF00FFu;
+    const guint32 ga = (((p >> 8) & 0x00FF00FFu) * weight_p + ((q >> 8) & 0x00FF00FFu) * weight) & 0xFF00FF00u;
+    return rb | ga;
+}
+
+/*
+ * 功能：释放缩放表与输出缓冲环。
+ * 逻辑：输出帧持有缩放器引用，finalize 时所有缓冲都已归还；释放各数组与缓冲后交由父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_free/g_array_unref/g_mutex_clear。
+ */
+static void
+drd_frame_scaler_finalize(GObject *object)
+{
+    DrdFrameScaler *self = DRD_FRAME_SCALER(object);
+
+    g_clear_pointer(&self->x_index, g_free);
+    g_clear_pointer(&self->x_weight, g_free);
+    g_clear_pointer(&self->y_index, g_free);
+    g_clear_pointer(&self->y_weight, g_free);
+    g_clear_pointer(&self->row, g_free);
+    g_clear_pointer(&self->rects, g_array_unref);
+    for (guint i = 0; i < self->n_buffers; i++)
+    {
+        g_free(self->buffers[i].data);
+        g_clear_pointer(&self->buffers[i].stale, g_array_unref);
+    }
+    g_clear_pointer(&self->buffers, g_free);
+    g_mutex_clear(&self->mutex);
+    G_OBJECT_CLASS(drd_frame_scaler_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：挂载 finalize 并选择行混合实现。
+ * 逻辑：x86 上 CPU 支持 AVX2 时使用 AVX2 实现，ARM 上使用 NEON，其余平台使用通用实现；类初始化只执行一次。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统；GCC __builtin_cpu_supports。
+ */
+static void
+drd_frame_scaler_class_init(DrdFrameScalerClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = drd_frame_scaler_finalize;
+
+    drd_frame_scaler_blend_rows = drd_frame_scaler_blend_rows_scalar;
+#if defined(DRD_FRAME_SCALER_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        drd_frame_scaler_blend_rows = drd_frame_scaler_blend_rows_avx2;
+        drd_frame_scaler_kernel_name = "avx2";
+    }
+#elif defined(DRD_FRAME_SCALER_HAVE_NEON)
+    drd_frame_scaler_blend_rows = drd_frame_scaler_blend_rows_neon;
+    drd_frame_scaler_kernel_name = "neon";
+#endif
+}
+
+/*
+ * 功能：初始化实例字段。
+ * 逻辑：创建矩形数组与互斥锁，源尺寸在首帧时确定，输出缓冲在创建时按流尺寸分配。
+ * 参数：self 缩放器。
+ * 外部接口：GLib g_array_new/g_mutex_init。
+ */
+static void
+drd_frame_scaler_init(DrdFrameScaler *self)
+{
+    self->rects = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+    g_mutex_init(&self->mutex);
+    self->latest = -1;
+    self->output_valid = FALSE;
+}
+
+/*
+ * 功能：创建输出为指定流尺寸的缩放器。
+ * 逻辑：记录目标尺寸，按下游持有的输出帧数分配输出缓冲环，各缓冲初始为整帧过期。
+ * 参数：width/height 流尺寸；n_buffers 输出缓冲数，至少 2。
+ * 外部接口：GLib g_object_new/g_new0/g_malloc/g_array_new。
+ */
+DrdFrameScaler *
+drd_frame_scaler_new(guint width, guint height, guint n_buffers)
+{
+    g_return_val_if_fail(width > 0 && height > 0, NULL);
+    g_return_val_if_fail(n_buffers >= 2, NULL);
+
+    DrdFrameScaler *self = g_object_new(DRD_TYPE_FRAME_SCALER, NULL);
+    self->width = width;
+    self->height = height;
+    self->frame_size = (gsize) width * height * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+    self->n_buffers = n_buffers;
+    self->buffers = g_new0(DrdFrameScalerBuffer, n_buffers);
+    for (guint i = 0; i < n_buffers; i++)
+    {
+        DrdFrameScalerBuffer *buffer = &self->buffers[i];
+        buffer->scaler = self;
+        buffer->data = g_malloc(self->frame_size);
+        buffer->stale = g_array_new(FALSE, FALSE, sizeof(DrdFrameRect));
+        buffer->stale_full = TRUE;
+    }
+    return self;
+}
+
+/*
+ * 功能：获取输出流宽度。
+ * 逻辑：类型检查后返回 width。
+ * 参数：self 缩放器。
+ * 外部接口：无。
+ */
+guint
+drd_frame_scaler_get_width(DrdFrameScaler *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_SCALER(self), 0);
+    return self->width;
+}
+
+/*
+ * 功能：获取输出流高度。
+ * 逻辑：类型检查后返回 height。
+ * 参数：self 缩放器。
+ * 外部接口：无。
+ */
+guint
+drd_frame_scaler_get_height(DrdFrameScaler *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_SCALER(self), 0);
+    return self->height;
+}
+
+/*
+ * 功能：返回当前使用的行混合实现名称，用于日志。
+ * 逻辑：确保类已初始化（实现在类初始化时选定）后返回名称。
+ * 参数：无。
+ * 外部接口：GLib g_type_class_ref/g_type_class_unref。
+ */
+const gchar *
+drd_frame_scaler_get_kernel_name(void)
+{
+    g_type_class_unref(g_type_class_ref(DRD_TYPE_FRAME_SCALER));
+    return drd_frame_scaler_kernel_name;
+}
+
+/*
+ * 功能：使下一帧整帧缩放。
+ * 逻辑：标记上一帧输出无效，用于会话重新开始或关键帧前。
+ * 参数：self 缩放器。
+ * 外部接口：无。
+ */
+void
+drd_frame_scaler_reset(DrdFrameScaler *self)
+{
+    g_return_if_fail(DRD_IS_FRAME_SCALER(self));
+    self->output_valid = FALSE;
+}
+
+/*
+ * 功能：生成一个方向上的双线性采样表。
+ * 逻辑：目标像素中心映射回源坐标 (d + 0.5) * src / dst - 0.5，取 8 位小数作为指向下一像素的权重；越界时钳到最后一个像素且权重为 0。
+ *       缩小一半时权重恒为 128，即 2×2 盒式平均。
+ * 参数：src 源长度；dst 目标长度；index 输出源坐标；weight 输出权重。
+ * 外部接口：无。
+ */
+static void
+drd_frame_scaler_build_axis(guint src, guint dst, guint32 *index, guint8 *weight)
+{
+    for (guint d = 0; d < dst; d++)
+    {
+        gint64 pos = ((gint64) (2 * d + 1) * src * DRD_FRAME_SCALER_WEIGHT_ONE) / (2 * (gint64) dst) -
+                     DRD_FRAME_SCALER_WEIGHT_ONE / 2;
+        if (pos < 0)
+        {
+            pos = 0;
+        }
+        guint32 i = (guint32) (pos / DRD_FRAME_SCALER_WEIGHT_ONE);
+        guint w = (guint) (pos % DRD_FRAME_SCALER_WEIGHT_ONE);
+        if (i + 1 >= src)
+        {
+            i = src - 1;
+            w = 0;
+        }
+        index[d] = i;
+        weight[d] = (guint8) w;
+    }
+}
+
+/*
+ * 功能：按源尺寸准备采样表与行暂存。
+ * 逻辑：尺寸未变时直接返回；否则重建两个方向的采样表、按源宽度分配行暂存，并使上一帧输出失效。
+ * 参数：self 缩放器；src_width/src_height 源帧尺寸。
+ * 外部接口：GLib g_renew/g_realloc。
+ */
+static void
+drd_frame_scaler_configure(DrdFrameScaler *self, guint src_width, guint src_height)
+{
+    if (self->src_width == src_width && self->src_height == src_height)
+    {
+        return;
+    }
+
+    self->x_index = g_renew(guint32, self->x_index, self->width);
+    self->x_weight = g_renew(guint8, self->x_weight, self->width);
+    self->y_index = g_renew(guint32, self->y_index, self->height);
+    self->y_weight = g_renew(guint8, self->y_weight, self->height);
+    self->row = g_realloc(self->row, (gsize) src_width * DRD_FRAME_SCALER_BYTES_PER_PIXEL);
+    drd_frame_scaler_build_axis(src_width, self->width, self->x_index, self->x_weight);
+    drd_frame_scaler_build_axis(src_height, self->height, self->y_index, self->y_weight);
+    self->src_width = src_width;
+    self->src_height = src_height;
+    self->output_valid = FALSE;
+    DRD_LOG_MESSAGE("Frame scaler %ux%u -> %ux%u (%s)", src_width, src_height, self->width, self->height,
+                    drd_frame_scaler_kernel_name);
+}
+
+/*
+ * 功能：把源损坏矩形映射为需要重新采样的目标矩形。
+ * 逻辑：按比例换算边界后向外扩展（采样核跨两个源像素，放大时一个源像素覆盖多个目标像素），并钳到目标尺寸。
+ * 参数：self 缩放器；src 源矩形；out 目标矩形。
+ * 外部接口：无。
+ */
+static gboolean
+drd_frame_scaler_map_rect(DrdFrameScaler *self, const DrdFrameRect *src, DrdFrameRect *out)
+{
+    const guint margin_x = self->width / self->src_width + 2;
+    const guint margin_y = self->height / self->src_height + 2;
+    const guint64 x0 = (guint64) src->x * self->width / self->src_width;
+    const guint64 y0 = (guint64) src->y * self->height / self->src_height;
+    const guint64 x1 = ((guint64) (src->x + src->width) * self->width + self->src_width - 1) / self->src_width;
+    const guint64 y1 = ((guint64) (src->y + src->height) * self->height + self->src_height - 1) / self->src_height;
+
+    out->x = x0 > margin_x ? (guint) x0 - margin_x : 0;
+    out->y = y0 > margin_y ? (guint) y0 - margin_y : 0;
+    const guint right = (guint) MIN(x1 + margin_x, (guint64) self->width);
+    const guint bottom = (guint) MIN(y1 + margin_y, (guint64) self->height);
+    if (right <= out->x || bottom <= out->y)
+    {
+        return FALSE;
+    }
+    out->width = right - out->x;
+    out->height = bottom - out->y;
+    return TRUE;
+}
+
+/*
+ * 功能：重新采样输出缓冲上的一个目标矩形。
+ * 逻辑：逐目标行先竖直插值（SIMD 行混合，仅覆盖该矩形用到的源列区间；权重为 0 时直接引用源行），再水平插值（SWAR）写入输出缓冲。
+ * 参数：self 缩放器；src 源像素；src_stride 源行距；dst 流尺寸的输出缓冲；rect 目标矩形。
+ * 外部接口：drd_frame_scaler_blend_rows 选定的实现。
+ */
+static void
+drd_frame_scaler_scale_rect(DrdFrameScaler *self,
+                            const guint8 *src,
+                            guint src_stride,
+                            guint8 *dst,
+                            const DrdFrameRect *rect)
+{
+    const guint span_start = self->x_index[rect->x];
+    const guint span_end = MIN(self->x_index[rect->x + rect->width - 1] + 1, self->src_width - 1);
+    const gsize span_bytes = (gsize) (span_end - span_start + 1) * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+    const gsize dst_stride = (gsize) self->width * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+
+    for (guint dy = rect->y; dy < rect->y + rect->height; dy++)
+    {
+        const guint sy = self->y_index[dy];
+        const guint wy = self->y_weight[dy];
+        const guint8 *row_a = src + (gsize) sy * src_stride + (gsize) span_start * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+        const guint32 *row = (const guint32 *) row_a;
+        if (wy != 0)
+        {
+            drd_frame_scaler_blend_rows(self->row, row_a, row_a + src_stride, span_bytes, wy);
+            row = (const guint32 *) self->row;
+        }
+
+        guint32 *out = (guint32 *) (dst + (gsize) dy * dst_stride) + rect->x;
+        for (guint dx = rect->x; dx < rect->x + rect->width; dx++)
+        {
+            const guint sx = self->x_index[dx] - span_start;
+            const guint wx = self->x_weight[dx];
+            *out++ = wx == 0 ? row[sx] : drd_frame_scaler_lerp_pixel(row[sx], row[sx + 1], wx);
+        }
+    }
+}
+
+/*
+ * 功能：领取一个可写的输出缓冲。
+ * 逻辑：持锁从最近输出的缓冲之后轮询，跳过最近输出的缓冲（作为同步来源）与仍被帧引用的缓冲，领取后标记占用。
+ * 参数：self 缩放器。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ * 返回：缓冲索引，全部被占用时返回 -1。
+ */
+static gint
+drd_frame_scaler_acquire_buffer(DrdFrameScaler *self)
+{
+    gint result = -1;
+    g_mutex_lock(&self->mutex);
+    for (guint i = 1; i <= self->n_buffers; i++)
+    {
+        const guint index = (guint) (self->latest + (gint) i) % self->n_buffers;
+        if ((gint) index == self->latest || self->buffers[index].in_use)
+        {
+            continue;
+        }
+        self->buffers[index].in_use = TRUE;
+        result = (gint) index;
+        break;
+    }
+    g_mutex_unlock(&self->mutex);
+    return result;
+}
+
+/*
+ * 功能：把最近输出的内容同步到领取的缓冲。
+ * 逻辑：整帧过期时整帧拷贝，否则只逐行拷贝该缓冲上次输出以来累计的过期矩形。
+ * 参数：self 缩放器；target 领取的缓冲。
+ * 外部接口：C 库 memcpy。
+ */
+static void
+drd_frame_scaler_sync_buffer(DrdFrameScaler *self, DrdFrameScalerBuffer *target)
+{
+    if (self->latest < 0 || target == &self->buffers[self->latest])
+    {
+        return;
+    }
+
+    const guint8 *src = self->buffers[self->latest].data;
+    if (target->stale_full)
+    {
+        memcpy(target->data, src, self->frame_size);
+        return;
+    }
+
+    const gsize stride = (gsize) self->width * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+    for (guint i = 0; i < target->stale->len; i++)
+    {
+        const DrdFrameRect *rect = &g_array_index(target->stale, DrdFrameRect, i);
+        const gsize offset = (gsize) rect->y * stride + (gsize) rect->x * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+        const gsize row_bytes = (gsize) rect->width * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+        for (guint row = 0; row < rect->height; row++)
+        {
+            memcpy(target->data + offset + row * stride, src + offset + row * stride, row_bytes);
+        }
+    }
+}
+
+/*
+ * 功能：把写好的缓冲记为最近输出。
+ * 逻辑：其余缓冲追加本帧重新采样的矩形为过期区域（整帧采样或累计过多时改为整帧过期）；本缓冲过期信息清空；更新 latest。
+ * 参数：self 缩放器；index 缓冲索引；full 本帧是否整帧采样。
+ * 外部接口：GLib g_array_append_vals。
+ */
+static void
+drd_frame_scaler_publish_buffer(DrdFrameScaler *self, gint index, gboolean full)
+{
+    for (guint i = 0; i < self->n_buffers; i++)
+    {
+        DrdFrameScalerBuffer *other = &self->buffers[i];
+        if ((gint) i == index || other->stale_full)
+        {
+            continue;
+        }
+
+        if (full || other->stale->len + self->rects->len > DRD_FRAME_SCALER_MAX_STALE_RECTS)
+        {
+            g_array_set_size(other->stale, 0);
+            other->stale_full = TRUE;
+            continue;
+        }
+
+        g_array_append_vals(other->stale, self->rects->data, self->rects->len);
+    }
+
+    g_array_set_size(self->buffers[index].stale, 0);
+    self->buffers[index].stale_full = FALSE;
+    self->latest = index;
+}
+
+/*
+ * 功能：输出帧销毁时归还缓冲。
+ * 逻辑：持锁清除占用标记，并释放帧持有的缩放器引用。
+ * 参数：frame 被销毁的帧；user_data 缓冲指针。
+ * 外部接口：GLib g_mutex_lock/unlock/g_object_unref。
+ */
+static void
+drd_frame_scaler_release_frame(DrdFrame *frame, gpointer user_data)
+{
+    DrdFrameScalerBuffer *buffer = user_data;
+    DrdFrameScaler *self = buffer->scaler;
+
+    g_mutex_lock(&self->mutex);
+    buffer->in_use = FALSE;
+    g_mutex_unlock(&self->mutex);
+
+    g_object_unref(self);
+}
+
+/*
+ * 功能：把桌面尺寸的帧缩放为流尺寸的帧。
+ * 逻辑：按源尺寸准备采样表；上一帧输出无效或帧不带损坏信息时整帧采样，否则只重新采样损坏矩形映射出的目标矩形；
+ *       从输出缓冲环领取一个缓冲，先只同步它的过期矩形，再把本帧的目标矩形直接采样进去，输出帧引用该缓冲并附带映射后的损坏矩形与原帧的显示器信息。
+ *       缓冲全部被下游持有时退回整帧采样到独立分配的帧，并使下一帧也整帧采样。
+ * 参数：self 缩放器；frame 捕获帧。
+ * 外部接口：drd_frame_get_data/get_damage/get_origin、drd_frame_set_damage/set_monitor；drd_frame_new/drd_frame_configure/drd_frame_wrap_data/drd_frame_ensure_capacity。
+ */
+DrdFrame *
+drd_frame_scaler_process(DrdFrameScaler *self, DrdFrame *frame)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_SCALER(self), NULL);
+    g_return_val_if_fail(DRD_IS_FRAME(frame), NULL);
+
+    const guint src_width = drd_frame_get_width(frame);
+    const guint src_height = drd_frame_get_height(frame);
+    const guint src_stride = drd_frame_get_stride(frame);
+    gsize src_size = 0;
+    const guint8 *src = drd_frame_get_data(frame, &src_size);
+    g_return_val_if_fail(src != NULL && src_width > 0 && src_height > 0, NULL);
+    g_return_val_if_fail(src_size >= (gsize) src_stride * src_height, NULL);
+
+    drd_frame_scaler_configure(self, src_width, src_height);
+
+    const guint stride = self->width * DRD_FRAME_SCALER_BYTES_PER_PIXEL;
+    DrdFrame *scaled = drd_frame_new();
+    drd_frame_configure(scaled, self->width, self->height, stride, drd_frame_get_timestamp(frame));
+
+    const gint index = drd_frame_scaler_acquire_buffer(self);
+    gboolean full = !self->output_valid || !drd_frame_has_damage(frame) || index < 0;
+    g_array_set_size(self->rects, 0);
+    if (full)
+    {
+        const DrdFrameRect rect = {0, 0, self->width, self->height};
+        g_array_append_val(self->rects, rect);
+    }
+    else
+    {
+        guint n_damage = 0;
+        const DrdFrameRect *damage = drd_frame_get_damage(frame, &n_damage);
+        for (guint i = 0; i < n_damage; i++)
+        {
+            DrdFrameRect rect;
+            if (drd_frame_scaler_map_rect(self, &damage[i], &rect))
+            {
+                g_array_append_val(self->rects, rect);
+            }
+        }
+    }
+
+    guint8 *dst = NULL;
+    if (index < 0)
+    {
+        DRD_LOG_WARNING("Frame scaler: all %u output buffers held downstream, scaling into a standalone frame",
+                        self->n_buffers);
+        dst = drd_frame_ensure_capacity(scaled, self->frame_size);
+    }
+    else
+    {
+        DrdFrameScalerBuffer *buffer = &self->buffers[index];
+        if (!full)
+        {
+            drd_frame_scaler_sync_buffer(self, buffer);
+        }
+        dst = buffer->data;
+    }
+
+    for (guint i = 0; i < self->rects->len; i++)
+    {
+        drd_frame_scaler_scale_rect(self, src, src_stride, dst, &g_array_index(self->rects, DrdFrameRect, i));
+    }
+
+    if (index < 0)
+    {
+        /* 独立帧不在缓冲环中，环里最近的输出缺少本帧内容 */
+        self->output_valid = FALSE;
+    }
+    else
+    {
+        drd_frame_scaler_publish_buffer(self, index, full);
+        drd_frame_wrap_data(scaled, dst, self->frame_size, drd_frame_scaler_release_frame, &self->buffers[index]);
+        g_object_ref(self);
+        self->output_valid = TRUE;
+    }
+
+    if (!full)
+    {
+        drd_frame_set_damage(scaled, (const DrdFrameRect *) self->rects->data, self->rects->len);
+    }
+
+    gint origin_x = 0;
+    gint origin_y = 0;
+    drd_frame_get_origin(frame, &origin_x, &origin_y);
+    drd_frame_set_monitor(scaled, drd_frame_get_monitor(frame), origin_x, origin_y);
+    return scaled;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glib-object.h>
+
+#include "utils/drd_frame.h"
+
+G_BEGIN_DECLS
+
+#define DRD_TYPE_FRAME_SCALER (drd_frame_scaler_get_type())
+G_DECLARE_FINAL_TYPE(DrdFrameScaler, drd_frame_scaler, DRD, FRAME_SCALER, GObject)
+
+/**
+ * drd_frame_scaler_new:
+ * @width: stream width in pixels
+ * @height: stream height in pixels
+ * @n_buffers: number of output buffers, at least 2; one more than the
+ *   scaled frames held downstream across process calls
+ *
+ * Returns: (transfer full): a scaler producing @width x @height frames.
+ */
+DrdFrameScaler *drd_frame_scaler_new(guint width, guint height, guint n_buffers);
+
+guint drd_frame_scaler_get_width(DrdFrameScaler *self);
+guint drd_frame_scaler_get_height(DrdFrameScaler *self);
+const gchar *drd_frame_scaler_get_kernel_name(void);
+
+/**
+ * drd_frame_scaler_process:
+ * @self: the scaler
+ * @frame: captured frame in desktop geometry
+ *
+ * Resamples only the damaged parts of @frame into one of the scaler's
+ * stream-sized output buffers, after bringing that buffer up to date by
+ * copying just the areas changed since it was last used. The returned frame
+ * references the buffer until it is finalized, and its damage is mapped to
+ * stream coordinates. The first frame and frames of a new size are scaled in
+ * full.
+ *
+ * Returns: (transfer full): the stream-sized frame.
+ */
+DrdFrame *drd_frame_scaler_process(DrdFrameScaler *self, DrdFrame *frame);
+void drd_frame_scaler_reset(DrdFrameScaler *self);
+
+G_END_DECLS
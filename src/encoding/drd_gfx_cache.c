@@ -0,0 +1,286 @@
+#include "encoding/drd_gfx_cache.h"
+
+#define DRD_GFX_CACHE_NONE G_MAXUINT
+
+typedef struct
+{
+    guint64 key;
+    guint prev; /* 更近使用的槽位 */
+    guint next; /* 更久未用的槽位 */
+    gboolean keyed; /* key 有效且登记在索引表中 */
+} DrdGfxCacheEntry;
+
+struct _DrdGfxCache
+{
+    GObject parent_instance;
+
+    /*
+     * entries 下标即客户端槽位号减 1；used 之前的槽位都已写过客户端，按 LRU 链表串起（head 最近使用、tail 最久未用），
+     * 之后的槽位从未使用，插入时优先分配且无需驱逐。index 以 entries[i].key 的地址为键，值为下标加 1。
+     */
+    DrdGfxCacheEntry *entries;
+    guint capacity;
+    guint used;
+    guint head;
+    guint tail;
+    GHashTable *index;
+    gint reset_pending;
+};
+
+G_DEFINE_TYPE(DrdGfxCache, drd_gfx_cache, G_TYPE_OBJECT)
+
+/*
+ * 功能：释放槽位数组与索引表。
+ * 逻辑：先销毁引用槽位 key 的索引表，再释放槽位数组，最后调用父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_hash_table_unref/g_free。
+ */
+static void
+drd_gfx_cache_finalize(GObject *object)
+{
+    DrdGfxCache *self = DRD_GFX_CACHE(object);
+    g_clear_pointer(&self->index, g_hash_table_unref);
+    g_clear_pointer(&self->entries, g_free);
+    G_OBJECT_CLASS(drd_gfx_cache_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：挂载 finalize。
+ * 逻辑：设置 GObjectClass 回调。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_gfx_cache_class_init(DrdGfxCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = drd_gfx_cache_finalize;
+}
+
+/*
+ * 功能：初始化空缓存。
+ * 逻辑：创建 64 位 key 的索引表，容量为 0，首次 begin 时按协商容量分配槽位。
+ * 参数：self 缓存实例。
+ * 外部接口：GLib g_hash_table_new。
+ */
+static void
+drd_gfx_cache_init(DrdGfxCache *self)
+{
+    self->index = g_hash_table_new(g_int64_hash, g_int64_equal);
+    self->head = DRD_GFX_CACHE_NONE;
+    self->tail = DRD_GFX_CACHE_NONE;
+}
+
+/*
+ * 功能：创建客户端 tile 缓存的服务端镜像。
+ * 逻辑：调用 g_object_new 分配实例。
+ * 参数：无。
+ * 外部接口：GLib g_object_new。
+ */
+DrdGfxCache *
+drd_gfx_cache_new(void)
+{
+    return g_object_new(DRD_TYPE_GFX_CACHE, NULL);
+}
+
+/*
+ * 功能：请求清空缓存。
+ * 逻辑：只原子置位待重置标志，由编码线程在下一次 begin 时清空，避免与正在编码的帧竞争。
+ * 参数：self 缓存实例。
+ * 外部接口：GLib g_atomic_int_set。
+ */
+void
+drd_gfx_cache_invalidate(DrdGfxCache *self)
+{
+    g_return_if_fail(DRD_IS_GFX_CACHE(self));
+    g_atomic_int_set(&self->reset_pending, TRUE);
+}
+
+/*
+ * 功能：在一帧使用缓存前应用重置与容量变化。
+ * 逻辑：有待重置标志或容量变化时清空索引表并按新容量重新分配槽位，此后所有槽位视为客户端上未使用。
+ * 参数：self 缓存实例；capacity 客户端可容纳的槽位数。
+ * 外部接口：GLib g_atomic_int_exchange/g_hash_table_remove_all/g_renew。
+ */
+void
+drd_gfx_cache_begin(DrdGfxCache *self, guint capacity)
+{
+    g_return_if_fail(DRD_IS_GFX_CACHE(self));
+
+    capacity = MIN(capacity, (guint) G_MAXUINT16);
+    if (!g_atomic_int_exchange(&self->reset_pending, FALSE) && capacity == self->capacity)
+    {
+        return;
+    }
+
+    g_hash_table_remove_all(self->index);
+    self->entries = g_renew(DrdGfxCacheEntry, self->entries, MAX(capacity, 1));
+    self->capacity = capacity;
+    self->used = 0;
+    self->head = DRD_GFX_CACHE_NONE;
+    self->tail = DRD_GFX_CACHE_NONE;
+}
+
+/*
+ * 功能：读取当前槽位容量。
+ * 逻辑：返回最近一次 begin 应用的容量。
+ * 参数：self 缓存实例。
+ * 外部接口：无。
+ */
+guint
+drd_gfx_cache_get_capacity(DrdGfxCache *self)
+{
+    g_return_val_if_fail(DRD_IS_GFX_CACHE(self), 0);
+    return self->capacity;
+}
+
+/*
+ * 功能：把槽位从 LRU 链表中摘下。
+ * 逻辑：修正前后槽位的指针，并在槽位位于两端时更新 head/tail。
+ * 参数：self 缓存实例；index 槽位下标。
+ * 外部接口：无。
+ */
+static void
+drd_gfx_cache_unlink(DrdGfxCache *self, guint index)
+{
+    DrdGfxCacheEntry *entry = &self->entries[index];
+
+    if (entry->prev != DRD_GFX_CACHE_NONE)
+    {
+        self->entries[entry->prev].next = entry->next;
+    }
+    else
+    {
+        self->head = entry->next;
+    }
+    if (entry->next != DRD_GFX_CACHE_NONE)
+    {
+        self->entries[entry->next].prev = entry->prev;
+    }
+    else
+    {
+        self->tail = entry->prev;
+    }
+}
+
+/*
+ * 功能：把槽位挂到 LRU 链表的一端。
+ * 逻辑：front 为 TRUE 时挂到 head 作为最近使用，否则挂到 tail 作为下一个被替换的槽位。
+ * 参数：self 缓存实例；index 槽位下标；front 挂载位置。
+ * 外部接口：无。
+ */
+static void
+drd_gfx_cache_link(DrdGfxCache *self, guint index, gboolean front)
+{
+    DrdGfxCacheEntry *entry = &self->entries[index];
+
+    if (front)
+    {
+        entry->prev = DRD_GFX_CACHE_NONE;
+        entry->next = self->head;
+        if (self->head != DRD_GFX_CACHE_NONE)
+        {
+            self->entries[self->head].prev = index;
+        }
+        self->head = index;
+        if (self->tail == DRD_GFX_CACHE_NONE)
+        {
+            self->tail = index;
+        }
+        return;
+    }
+
+    entry->next = DRD_GFX_CACHE_NONE;
+    entry->prev = self->tail;
+    if (self->tail != DRD_GFX_CACHE_NONE)
+    {
+        self->entries[self->tail].next = index;
+    }
+    self->tail = index;
+    if (self->head == DRD_GFX_CACHE_NONE)
+    {
+        self->head = index;
+    }
+}
+
+/*
+ * 功能：按内容 key 查找客户端槽位。
+ * 逻辑：索引表命中时把槽位移到 LRU 链表头部并返回槽位号，未命中返回 0。
+ * 参数：self 缓存实例；key tile 内容 key。
+ * 外部接口：GLib g_hash_table_lookup。
+ */
+guint16
+drd_gfx_cache_lookup(DrdGfxCache *self, guint64 key)
+{
+    g_return_val_if_fail(DRD_IS_GFX_CACHE(self), 0);
+
+    const guint value = GPOINTER_TO_UINT(g_hash_table_lookup(self->index, &key));
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    drd_gfx_cache_unlink(self, value - 1);
+    drd_gfx_cache_link(self, value - 1, TRUE);
+    return (guint16) value;
+}
+
+/*
+ * 功能：为新内容分配客户端槽位。
+ * 逻辑：优先使用从未写过的槽位；全部用过后取 LRU 链表尾部的槽位，从索引表移除其旧 key 并要求调用方先驱逐；
+ *       写入新 key、登记索引并移到链表头部。
+ * 参数：self 缓存实例；key 尚未缓存的 tile 内容 key；evict 输出是否需要先发送驱逐。
+ * 外部接口：GLib g_hash_table_insert/g_hash_table_remove。
+ */
+guint16
+drd_gfx_cache_insert(DrdGfxCache *self, guint64 key, gboolean *evict)
+{
+    g_return_val_if_fail(DRD_IS_GFX_CACHE(self), 0);
+    g_return_val_if_fail(self->capacity > 0, 0);
+
+    guint index = 0;
+    *evict = FALSE;
+    if (self->used < self->capacity)
+    {
+        index = self->used++;
+    }
+    else
+    {
+        index = self->tail;
+        drd_gfx_cache_unlink(self, index);
+        if (self->entries[index].keyed)
+        {
+            g_hash_table_remove(self->index, &self->entries[index].key);
+        }
+        *evict = TRUE;
+    }
+
+    DrdGfxCacheEntry *entry = &self->entries[index];
+    entry->key = key;
+    entry->keyed = TRUE;
+    g_hash_table_insert(self->index, &entry->key, GUINT_TO_POINTER(index + 1));
+    drd_gfx_cache_link(self, index, TRUE);
+    return (guint16) (index + 1);
+}
+
+/*
+ * 功能：丢弃一个可能未写入客户端的槽位内容。
+ * 逻辑：从索引表移除其 key，槽位仍视为已占用并移到链表尾部，下次插入时先被驱逐再复用。
+ * 参数：self 缓存实例；slot 槽位号。
+ * 外部接口：GLib g_hash_table_remove。
+ */
+void
+drd_gfx_cache_forget(DrdGfxCache *self, guint16 slot)
+{
+    g_return_if_fail(DRD_IS_GFX_CACHE(self));
+    g_return_if_fail(slot > 0 && slot <= self->used);
+
+    const guint index = slot - 1;
+    if (self->entries[index].keyed)
+    {
+        g_hash_table_remove(self->index, &self->entries[index].key);
+        self->entries[index].keyed = FALSE;
+    }
+    drd_gfx_cache_unlink(self, index);
+    drd_gfx_cache_link(self, index, FALSE);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/* 每个缓存槽位按一个 64x64 的 32 位 tile 计 16KB */
+#define DRD_GFX_CACHE_TILE_BYTES (64 * 64 * 4)
+/* 客户端缓存总量为 100MB，声明 SmallCache 时为 16MB */
+#define DRD_GFX_CACHE_SLOTS ((100 * 1024 * 1024) / DRD_GFX_CACHE_TILE_BYTES)
+#define DRD_GFX_CACHE_SMALL_SLOTS ((16 * 1024 * 1024) / DRD_GFX_CACHE_TILE_BYTES)
+
+#define DRD_TYPE_GFX_CACHE (drd_gfx_cache_get_type())
+G_DECLARE_FINAL_TYPE(DrdGfxCache, drd_gfx_cache, DRD, GFX_CACHE, GObject)
+
+DrdGfxCache *drd_gfx_cache_new(void);
+
+/**
+ * drd_gfx_cache_invalidate:
+ * @self: the cache
+ *
+ * Marks the client cache as empty, e.g. after the graphics channel was
+ * (re)opened. Safe to call from any thread; the table is cleared by the next
+ * drd_gfx_cache_begin() on the encoding thread.
+ */
+void drd_gfx_cache_invalidate(DrdGfxCache *self);
+
+/**
+ * drd_gfx_cache_begin:
+ * @self: the cache
+ * @capacity: slots the client can hold, see %DRD_GFX_CACHE_SLOTS
+ *
+ * Applies a pending invalidation or capacity change before a frame uses the
+ * cache. All other calls must come from the same (encoding) thread.
+ */
+void drd_gfx_cache_begin(DrdGfxCache *self, guint capacity);
+guint drd_gfx_cache_get_capacity(DrdGfxCache *self);
+
+/**
+ * drd_gfx_cache_lookup:
+ * @self: the cache
+ * @key: tile content key
+ *
+ * Returns: the 1-based client cache slot holding @key and marks it most
+ * recently used, or 0 when @key is not cached
+ */
+guint16 drd_gfx_cache_lookup(DrdGfxCache *self, guint64 key);
+
+/**
+ * drd_gfx_cache_insert:
+ * @self: the cache
+ * @key: tile content key, not yet cached
+ * @evict: (out): %TRUE when the slot still holds an older entry on the client
+ *   that must be evicted before it is written
+ *
+ * Picks a never used slot or the least recently used one for @key.
+ *
+ * Returns: the 1-based client cache slot
+ */
+guint16 drd_gfx_cache_insert(DrdGfxCache *self, guint64 key, gboolean *evict);
+
+/**
+ * drd_gfx_cache_forget:
+ * @self: the cache
+ * @slot: slot returned by drd_gfx_cache_insert()
+ *
+ * Drops the key of a slot whose SurfaceToCache may not have reached the
+ * client. The slot stays occupied, is reused first and evicted before reuse.
+ */
+void drd_gfx_cache_forget(DrdGfxCache *self, guint16 slot);
+
+G_END_DECLS
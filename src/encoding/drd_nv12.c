@@ -0,0 +1,412 @@
+#include "encoding/drd_nv12.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DRD_NV12_HAVE_AVX2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define DRD_NV12_HAVE_NEON 1
+#endif
+
+#include "utils/drd_log.h"
+
+/* BT.601 有限范围 8 位定点系数：Y = (66R + 129G + 25B + 128) >> 8 + 16 */
+#define DRD_NV12_Y_R 66
+#define DRD_NV12_Y_G 129
+#define DRD_NV12_Y_B 25
+/* U = (-38R - 74G + 112B) >> 8 + 128，V = (112R - 94G - 18B) >> 8 + 128 */
+#define DRD_NV12_U_R 38
+#define DRD_NV12_U_G 74
+#define DRD_NV12_V_G 94
+#define DRD_NV12_V_B 18
+#define DRD_NV12_UV_MAX 112
+/* 舍入 128 与偏移 128 << 8 合并，保证移位前恒为正数，SIMD 可用无符号移位 */
+#define DRD_NV12_UV_BIAS (128 + (128 << 8))
+/* SIMD 内核每次处理的像素数（8 个色度样本） */
+#define DRD_NV12_BLOCK 16
+/* 自检缓冲：覆盖两个整块与非整块的行尾 */
+#define DRD_NV12_CHECK_PAIRS 21
+#define DRD_NV12_CHECK_ROWS 4
+
+typedef void (*DrdNv12RowsFunc)(const guint8 *row0,
+                                const guint8 *row1,
+                                guint8 *y0,
+                                guint8 *y1,
+                                guint8 *uv,
+                                guint pairs);
+
+static gsize drd_nv12_init_once = 0;
+static DrdNv12RowsFunc drd_nv12_rows_impl = NULL;
+static const gchar *drd_nv12_kernel_name = "scalar";
+
+/*
+ * 功能：计算一个像素的亮度。
+ * 逻辑：BT.601 有限范围定点公式，结果落在 16..235。
+ * 参数：px BGRX 像素。
+ * 外部接口：无。
+ */
+static inline guint8
+drd_nv12_luma(const guint8 *px)
+{
+    return (guint8) (((DRD_NV12_Y_R * px[2] + DRD_NV12_Y_G * px[1] + DRD_NV12_Y_B * px[0] + 128) >> 8) + 16);
+}
+
+/*
+ * 功能：由 2x2 像素块的通道和计算一个 UV 样本。
+ * 逻辑：通道和四舍五入取平均后套用 BT.601 有限范围定点公式；先加偏移再减负项，运算全程为正。
+ * 参数：b/g/r 四个像素的通道和；uv 输出的 U、V 两个字节。
+ * 外部接口：无。
+ */
+static inline void
+drd_nv12_chroma(guint b, guint g, guint r, guint8 *uv)
+{
+    b = (b + 2) >> 2;
+    g = (g + 2) >> 2;
+    r = (r + 2) >> 2;
+    uv[0] = (guint8) ((DRD_NV12_UV_MAX * b + DRD_NV12_UV_BIAS - DRD_NV12_U_G * g - DRD_NV12_U_R * r) >> 8);
+    uv[1] = (guint8) ((DRD_NV12_UV_MAX * r + DRD_NV12_UV_BIAS - DRD_NV12_V_G * g - DRD_NV12_V_B * b) >> 8);
+}
+
+/*
+ * 功能：转换两行中的若干像素对（通用实现，也是 SIMD 内核的参考）。
+ * 逻辑：每个像素对输出上下两行各两个亮度与一个 UV 样本；row1 与 row0 相同、y1 与 y0 相同时即奇数末行。
+ * 参数：row0/row1 两行 BGRX 像素；y0/y1 两行亮度输出；uv 色度输出；pairs 像素对数。
+ * 外部接口：无。
+ */
+static void
+drd_nv12_rows_scalar(const guint8 *row0, const guint8 *row1, guint8 *y0, guint8 *y1, guint8 *uv, guint pairs)
+{
+    for (guint i = 0; i < pairs; ++i)
+    {
+        const guint8 *a = row0 + (gsize) i * 8;
+        const guint8 *b = row1 + (gsize) i * 8;
+
+        y0[i * 2] = drd_nv12_luma(a);
+        y0[i * 2 + 1] = drd_nv12_luma(a + 4);
+        y1[i * 2] = drd_nv12_luma(b);
+        y1[i * 2 + 1] = drd_nv12_luma(b + 4);
+        drd_nv12_chroma(a[0] + a[4] + b[0] + b[4], a[1] + a[5] + b[1] + b[5], a[2] + a[6] + b[2] + b[6],
+                        uv + (gsize) i * 2);
+    }
+}
+
+#ifdef DRD_NV12_HAVE_AVX2
+/*
+ * 功能：计算 8 个像素的亮度加权和（AVX2）。
+ * 逻辑：字节零扩展为 16 位后与 (B, G, R, X) 系数 madd，每像素得到两个 32 位部分和，hadd 后按像素顺序排列。
+ * 参数：px 8 个 BGRX 像素；coeff 亮度系数。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static inline __m256i
+drd_nv12_luma_sum_avx2(__m256i px, __m256i coeff)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), coeff);
+    const __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), coeff);
+    return _mm256_hadd_epi32(lo, hi);
+}
+
+/*
+ * 功能：输出 16 个像素的亮度（AVX2）。
+ * 逻辑：两组 8 像素加权和加舍入后右移 8 位再加 16，两次饱和打包并按 64 位重排恢复像素顺序。
+ * 参数：a/b 前后 8 个像素；coeff 亮度系数；dst 16 字节输出。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static inline void
+drd_nv12_luma_store_avx2(__m256i a, __m256i b, __m256i coeff, guint8 *dst)
+{
+    const __m256i round = _mm256_set1_epi32(128);
+    const __m256i offset = _mm256_set1_epi32(16);
+    __m256i ya = _mm256_add_epi32(_mm256_srli_epi32(_mm256_add_epi32(drd_nv12_luma_sum_avx2(a, coeff), round), 8),
+                                  offset);
+    __m256i yb = _mm256_add_epi32(_mm256_srli_epi32(_mm256_add_epi32(drd_nv12_luma_sum_avx2(b, coeff), round), 8),
+                                  offset);
+    __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(ya, yb), _MM_SHUFFLE(3, 1, 2, 0));
+    __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i *) dst, _mm256_castsi256_si128(bytes));
+}
+
+/*
+ * 功能：求 8 个像素与下一行对应像素组成的 4 个 2x2 块的通道平均（AVX2）。
+ * 逻辑：两行零扩展后相加，再把相邻像素的 64 位半部相加，按块顺序排成 4 个 (B, G, R, X) 16 位组，四舍五入取平均。
+ * 参数：top/bottom 上下两行各 8 个像素。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static inline __m256i
+drd_nv12_block_average_avx2(__m256i top, __m256i bottom)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+    __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+    lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+    hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+    const __m256i sums = _mm256_unpacklo_epi64(lo, hi);
+    return _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(2)), 2);
+}
+
+/*
+ * 功能：转换两行中的若干像素对（AVX2）。
+ * 逻辑：每次处理两行各 16 个像素：亮度按像素加权，色度先求 2x2 平均再对 U、V 系数 madd，
+ *       交错打包为 UVUV 后重排恢复顺序；不足 16 个像素的行尾交给通用实现。
+ * 参数：同通用实现。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static void
+drd_nv12_rows_avx2(const guint8 *row0, const guint8 *row1, guint8 *y0, guint8 *y1, guint8 *uv, guint pairs)
+{
+    const __m256i luma = _mm256_setr_epi16(DRD_NV12_Y_B, DRD_NV12_Y_G, DRD_NV12_Y_R, 0, DRD_NV12_Y_B, DRD_NV12_Y_G,
+                                           DRD_NV12_Y_R, 0, DRD_NV12_Y_B, DRD_NV12_Y_G, DRD_NV12_Y_R, 0,
+                                           DRD_NV12_Y_B, DRD_NV12_Y_G, DRD_NV12_Y_R, 0);
+    const __m256i coeff_u = _mm256_setr_epi16(DRD_NV12_UV_MAX, -DRD_NV12_U_G, -DRD_NV12_U_R, 0, DRD_NV12_UV_MAX,
+                                              -DRD_NV12_U_G, -DRD_NV12_U_R, 0, DRD_NV12_UV_MAX, -DRD_NV12_U_G,
+                                              -DRD_NV12_U_R, 0, DRD_NV12_UV_MAX, -DRD_NV12_U_G, -DRD_NV12_U_R, 0);
+    const __m256i coeff_v = _mm256_setr_epi16(-DRD_NV12_V_B, -DRD_NV12_V_G, DRD_NV12_UV_MAX, 0, -DRD_NV12_V_B,
+                                              -DRD_NV12_V_G, DRD_NV12_UV_MAX, 0, -DRD_NV12_V_B, -DRD_NV12_V_G,
+                                              DRD_NV12_UV_MAX, 0, -DRD_NV12_V_B, -DRD_NV12_V_G, DRD_NV12_UV_MAX, 0);
+    const __m256i bias = _mm256_set1_epi32(DRD_NV12_UV_BIAS);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    guint i = 0;
+
+    for (; i + DRD_NV12_BLOCK / 2 <= pairs; i += DRD_NV12_BLOCK / 2)
+    {
+        const __m256i a0 = _mm256_loadu_si256((const __m256i *) (row0 + (gsize) i * 8));
+        const __m256i b0 = _mm256_loadu_si256((const __m256i *) (row0 + (gsize) i * 8 + 32));
+        const __m256i a1 = _mm256_loadu_si256((const __m256i *) (row1 + (gsize) i * 8));
+        const __m256i b1 = _mm256_loadu_si256((const __m256i *) (row1 + (gsize) i * 8 + 32));
+
+        drd_nv12_luma_store_avx2(a0, b0, luma, y0 + (gsize) i * 2);
+        drd_nv12_luma_store_avx2(a1, b1, luma, y1 + (gsize) i * 2);
+
+        const __m256i avg_a = drd_nv12_block_average_avx2(a0, a1);
+        const __m256i avg_b = drd_nv12_block_average_avx2(b0, b1);
+        __m256i u = _mm256_hadd_epi32(_mm256_madd_epi16(avg_a, coeff_u), _mm256_madd_epi16(avg_b, coeff_u));
+        __m256i v = _mm256_hadd_epi32(_mm256_madd_epi16(avg_a, coeff_v), _mm256_madd_epi16(avg_b, coeff_v));
+        u = _mm256_srli_epi32(_mm256_add_epi32(u, bias), 8);
+        v = _mm256_srli_epi32(_mm256_add_epi32(v, bias), 8);
+        const __m256i words = _mm256_packus_epi32(_mm256_unpacklo_epi32(u, v), _mm256_unpackhi_epi32(u, v));
+        const __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), order);
+        _mm_storeu_si128((__m128i *) (uv + (gsize) i * 2), _mm256_castsi256_si128(bytes));
+    }
+
+    if (i < pairs)
+    {
+        drd_nv12_rows_scalar(row0 + (gsize) i * 8, row1 + (gsize) i * 8, y0 + (gsize) i * 2, y1 + (gsize) i * 2,
+                             uv + (gsize) i * 2, pairs - i);
+    }
+}
+#endif
+
+#ifdef DRD_NV12_HAVE_NEON
+/*
+ * 功能：输出 8 个像素的亮度（NEON）。
+ * 逻辑：16 位无符号乘加（最大 56100 不溢出），加舍入后窄化右移 8 位再加 16。
+ * 参数：b/g/r 8 个像素的通道。
+ * 外部接口：NEON intrinsics。
+ */
+static inline uint8x8_t
+drd_nv12_luma_neon(uint8x8_t b, uint8x8_t g, uint8x8_t r)
+{
+    uint16x8_t sum = vmull_u8(r, vdup_n_u8(DRD_NV12_Y_R));
+    sum = vmlal_u8(sum, g, vdup_n_u8(DRD_NV12_Y_G));
+    sum = vmlal_u8(sum, b, vdup_n_u8(DRD_NV12_Y_B));
+    return vadd_u8(vshrn_n_u16(vaddq_u16(sum, vdupq_n_u16(128)), 8), vdup_n_u8(16));
+}
+
+/*
+ * 功能：转换两行中的若干像素对（NEON）。
+ * 逻辑：每次以 vld4 解交错两行各 16 个像素；亮度逐像素计算，色度以 vpaddl/vpadal 求 2x2 通道和后取平均，
+ *       在 16 位上按模运算套用公式（结果恒在 0..65535 内，与通用实现一致），vst2 交错写出 UV；行尾交给通用实现。
+ * 参数：同通用实现。
+ * 外部接口：NEON intrinsics。
+ */
+static void
+drd_nv12_rows_neon(const guint8 *row0, const guint8 *row1, guint8 *y0, guint8 *y1, guint8 *uv, guint pairs)
+{
+    const uint16x8_t two = vdupq_n_u16(2);
+    const uint16x8_t bias = vdupq_n_u16(DRD_NV12_UV_BIAS);
+    guint i = 0;
+
+    for (; i + DRD_NV12_BLOCK / 2 <= pairs; i += DRD_NV12_BLOCK / 2)
+    {
+        const uint8x16x4_t top = vld4q_u8(row0 + (gsize) i * 8);
+        const uint8x16x4_t bottom = vld4q_u8(row1 + (gsize) i * 8);
+
+        vst1q_u8(y0 + (gsize) i * 2,
+                 vcombine_u8(drd_nv12_luma_neon(vget_low_u8(top.val[0]), vget_low_u8(top.val[1]),
+                                                vget_low_u8(top.val[2])),
+                             drd_nv12_luma_neon(vget_high_u8(top.val[0]), vget_high_u8(top.val[1]),
+                                                vget_high_u8(top.val[2]))));
+        vst1q_u8(y1 + (gsize) i * 2,
+                 vcombine_u8(drd_nv12_luma_neon(vget_low_u8(bottom.val[0]), vget_low_u8(bottom.val[1]),
+                                                vget_low_u8(bottom.val[2])),
+                             drd_nv12_luma_neon(vget_high_u8(bottom.val[0]), vget_high_u8(bottom.val[1]),
+                                                vget_high_u8(bottom.val[2]))));
+
+        const uint16x8_t b = vshrq_n_u16(vaddq_u16(vpadalq_u8(vpaddlq_u8(top.val[0]), bottom.val[0]), two), 2);
+        const uint16x8_t g = vshrq_n_u16(vaddq_u16(vpadalq_u8(vpaddlq_u8(top.val[1]), bottom.val[1]), two), 2);
+        const uint16x8_t r = vshrq_n_u16(vaddq_u16(vpadalq_u8(vpaddlq_u8(top.val[2]), bottom.val[2]), two), 2);
+        uint16x8_t u = vmlaq_n_u16(bias, b, DRD_NV12_UV_MAX);
+        u = vmlsq_n_u16(u, g, DRD_NV12_U_G);
+        u = vmlsq_n_u16(u, r, DRD_NV12_U_R);
+        uint16x8_t v = vmlaq_n_u16(bias, r, DRD_NV12_UV_MAX);
+        v = vmlsq_n_u16(v, g, DRD_NV12_V_G);
+        v = vmlsq_n_u16(v, b, DRD_NV12_V_B);
+        const uint8x8x2_t chroma = {{vshrn_n_u16(u, 8), vshrn_n_u16(v, 8)}};
+        vst2_u8(uv + (gsize) i * 2, chroma);
+    }
+
+    if (i < pairs)
+    {
+        drd_nv12_rows_scalar(row0 + (gsize) i * 8, row1 + (gsize) i * 8, y0 + (gsize) i * 2, y1 + (gsize) i * 2,
+                             uv + (gsize) i * 2, pairs - i);
+    }
+}
+#endif
+
+/*
+ * 功能：校验选中的内核与通用实现逐字节一致。
+ * 逻辑：首行填全 0/全 255 交替的极值像素，其余行填伪随机像素，两行一组比较亮度与色度输出；
+ *       像素对数覆盖两个整块与非整块的行尾。
+ * 参数：rows 待校验的内核。
+ * 外部接口：GLib g_malloc/g_free；C 标准库 memcmp。
+ */
+static gboolean
+drd_nv12_self_check(DrdNv12RowsFunc rows)
+{
+    const gsize row_bytes = DRD_NV12_CHECK_PAIRS * 8;
+    const gsize out_bytes = DRD_NV12_CHECK_PAIRS * 2;
+    guint8 *src = g_malloc(row_bytes * DRD_NV12_CHECK_ROWS);
+    guint8 *expected = g_malloc(out_bytes * 3);
+    guint8 *actual = g_malloc(out_bytes * 3);
+    guint32 state = 0x2468ACE1u;
+
+    for (gsize i = 0; i < row_bytes * DRD_NV12_CHECK_ROWS; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        src[i] = i < row_bytes ? (((i / 4) % 3 == 0) ? 0x00 : 0xFF) : (guint8) (state >> 24);
+    }
+
+    gboolean ok = TRUE;
+    for (guint row = 0; row + 1 < DRD_NV12_CHECK_ROWS && ok; row += 2)
+    {
+        const guint8 *row0 = src + row * row_bytes;
+        const guint8 *row1 = row0 + row_bytes;
+
+        drd_nv12_rows_scalar(row0, row1, expected, expected + out_bytes, expected + out_bytes * 2, DRD_NV12_CHECK_PAIRS);
+        rows(row0, row1, actual, actual + out_bytes, actual + out_bytes * 2, DRD_NV12_CHECK_PAIRS);
+        ok = memcmp(expected, actual, out_bytes * 3) == 0;
+    }
+
+    g_free(actual);
+    g_free(expected);
+    g_free(src);
+    return ok;
+}
+
+/*
+ * 功能：选择颜色转换内核。
+ * 逻辑：x86 上支持 AVX2 时使用 AVX2，ARM 上使用 NEON，其余使用通用实现；SIMD 内核需通过自检，
+ *       否则回退通用实现并告警。只执行一次。
+ * 参数：无。
+ * 外部接口：GLib g_once_init_enter/leave；GCC __builtin_cpu_supports；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ */
+static void
+drd_nv12_ensure_kernels(void)
+{
+    if (!g_once_init_enter(&drd_nv12_init_once))
+    {
+        return;
+    }
+
+    DrdNv12RowsFunc rows = drd_nv12_rows_scalar;
+    const gchar *name = "scalar";
+#if defined(DRD_NV12_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        rows = drd_nv12_rows_avx2;
+        name = "avx2";
+    }
+#elif defined(DRD_NV12_HAVE_NEON)
+    rows = drd_nv12_rows_neon;
+    name = "neon";
+#endif
+
+    if (rows != drd_nv12_rows_scalar && !drd_nv12_self_check(rows))
+    {
+        DRD_LOG_WARNING("NV12 kernel %s disagrees with the scalar kernel, falling back to scalar", name);
+        rows = drd_nv12_rows_scalar;
+        name = "scalar";
+    }
+
+    drd_nv12_rows_impl = rows;
+    drd_nv12_kernel_name = name;
+    DRD_LOG_MESSAGE("NV12 conversion kernel: %s", name);
+    g_once_init_leave(&drd_nv12_init_once, 1);
+}
+
+/*
+ * 功能：返回当前使用的内核名称，用于日志。
+ * 逻辑：确保内核已选定后返回名称。
+ * 参数：无。
+ * 外部接口：drd_nv12_ensure_kernels。
+ */
+const gchar *
+drd_nv12_get_kernel_name(void)
+{
+    drd_nv12_ensure_kernels();
+    return drd_nv12_kernel_name;
+}
+
+/*
+ * 功能：把帧的一个区域转换为 NV12。
+ * 逻辑：按两行一组调用选中的内核转换偶数个像素；帧底部的奇数末行与自身配对（亮度写两遍同一行），
+ *       帧右侧的奇数末列由通用实现与自身配对后只写出该列亮度。
+ * 参数：src 源帧；src_stride 源行跨度；frame_width/frame_height 帧尺寸；dst_y/y_stride 亮度平面；
+ *       dst_uv/uv_stride 色度平面；x/y/width/height 区域（x、y 为偶数）。
+ * 外部接口：drd_nv12_ensure_kernels。
+ */
+void
+drd_nv12_convert(const guint8 *src,
+                 guint src_stride,
+                 guint frame_width,
+                 guint frame_height,
+                 guint8 *dst_y,
+                 guint y_stride,
+                 guint8 *dst_uv,
+                 guint uv_stride,
+                 guint x,
+                 guint y,
+                 guint width,
+                 guint height)
+{
+    g_return_if_fail(src != NULL && dst_y != NULL && dst_uv != NULL);
+    g_return_if_fail((x % 2) == 0 && (y % 2) == 0);
+    g_return_if_fail(x + width <= frame_width && y + height <= frame_height);
+
+    drd_nv12_ensure_kernels();
+
+    const guint pairs = width / 2;
+    for (guint row = y; row < y + height; row += 2)
+    {
+        const gboolean last = row + 1 >= frame_height;
+        const guint8 *row0 = src + (gsize) row * src_stride + (gsize) x * 4;
+        const guint8 *row1 = last ? row0 : row0 + src_stride;
+        guint8 *y0 = dst_y + (gsize) row * y_stride + x;
+        guint8 *y1 = last ? y0 : y0 + y_stride;
+        guint8 *uv = dst_uv + (gsize) (row / 2) * uv_stride + x;
+
+        drd_nv12_rows_impl(row0, row1, y0, y1, uv, pairs);
+        if ((width % 2) != 0)
+        {
+            const guint8 *a = row0 + (gsize) pairs * 8;
+            const guint8 *b = row1 + (gsize) pairs * 8;
+
+            y0[pairs * 2] = drd_nv12_luma(a);
+            y1[pairs * 2] = drd_nv12_luma(b);
+            drd_nv12_chroma(a[0] * 2 + b[0] * 2, a[1] * 2 + b[1] * 2, a[2] * 2 + b[2] * 2, uv + (gsize) pairs * 2);
+        }
+    }
+}
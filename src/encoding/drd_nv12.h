@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * BGRX → NV12 颜色转换：BT.601 有限范围定点公式，按 CPU 在首次使用时选择 AVX2/NEON 或通用实现，
+ * 各实现逐字节一致，可以只转换变化区域并与此前转换的其余部分拼接。
+ */
+const gchar *drd_nv12_get_kernel_name(void);
+
+/**
+ * drd_nv12_convert:
+ * @src: BGRX frame
+ * @src_stride: bytes per row of @src
+ * @frame_width: frame width in pixels
+ * @frame_height: frame height in pixels
+ * @dst_y: luma plane of the NV12 destination
+ * @y_stride: bytes per row of @dst_y
+ * @dst_uv: interleaved chroma plane of the NV12 destination
+ * @uv_stride: bytes per row of @dst_uv
+ * @x: region left edge in pixels, must be even
+ * @y: region top edge in pixels, must be even
+ * @width: region width in pixels
+ * @height: region height in pixels
+ *
+ * Converts one region of the frame and leaves the rest of the destination
+ * untouched. Each chroma sample averages a 2x2 pixel block; an odd last
+ * column or row at the frame edge is paired with itself. The right and
+ * bottom region edges must be even unless they are the frame edges, so that
+ * converting several regions gives the same bytes as converting the frame.
+ */
+void drd_nv12_convert(const guint8 *src,
+                      guint src_stride,
+                      guint frame_width,
+                      guint frame_height,
+                      guint8 *dst_y,
+                      guint y_stride,
+                      guint8 *dst_uv,
+                      guint uv_stride,
+                      guint x,
+                      guint y,
+                      guint width,
+                      guint height);
+
+G_END_DECLS
@@ -0,0 +1,735 @@
+#include "encoding/drd_tile_hash.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DRD_TILE_HASH_HAVE_AVX2 1
+#define DRD_TILE_HASH_HAVE_SSE42 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define DRD_TILE_HASH_HAVE_NEON 1
+#endif
+
+#include "utils/drd_log.h"
+
+/* 每个哈希通道每步吞入一个 32 位像素，8 个通道对应一次 AVX2 加载 */
+#define DRD_TILE_HASH_LANES 8
+#define DRD_TILE_HASH_PRIME1 0x9E3779B1u
+#define DRD_TILE_HASH_PRIME2 0x85EBCA77u
+#define DRD_TILE_HASH_PRIME3 0xC2B2AE3Du
+#define DRD_TILE_HASH_PRIME5 0x165667B1u
+/* 自检缓冲：覆盖整 tile、窄边缘 tile 与非 8 像素对齐的行尾 */
+#define DRD_TILE_HASH_CHECK_WIDTH 72
+#define DRD_TILE_HASH_CHECK_HEIGHT 66
+#define DRD_TILE_HASH_CHECK_STRIDE (DRD_TILE_HASH_CHECK_WIDTH * 4 + 32)
+/* BGRX 像素按内存顺序读成 32 位后 B/G/R 三个字节的掩码，X 字节不参与纯色判断 */
+#define DRD_TILE_RGB_MASK GUINT32_TO_LE(0x00FFFFFFu)
+
+typedef guint64 (*DrdTileHashFunc)(const guint8 *data, guint stride, guint x, guint y, guint width, guint height);
+typedef gboolean (*DrdTileEqualFunc)(const guint8 *a,
+                                     const guint8 *b,
+                                     guint stride,
+                                     guint x,
+                                     guint y,
+                                     guint width,
+                                     guint height);
+typedef gboolean (*DrdTileUniformFunc)(const guint8 *data,
+                                       guint stride,
+                                       guint x,
+                                       guint y,
+                                       guint width,
+                                       guint height,
+                                       guint32 *color);
+
+static const guint32 drd_tile_hash_seeds[DRD_TILE_HASH_LANES] = {
+    DRD_TILE_HASH_PRIME5 * 1u, DRD_TILE_HASH_PRIME5 * 2u, DRD_TILE_HASH_PRIME5 * 3u, DRD_TILE_HASH_PRIME5 * 4u,
+    DRD_TILE_HASH_PRIME5 * 5u, DRD_TILE_HASH_PRIME5 * 6u, DRD_TILE_HASH_PRIME5 * 7u, DRD_TILE_HASH_PRIME5 * 8u,
+};
+
+static gsize drd_tile_hash_init_once = 0;
+static DrdTileHashFunc drd_tile_hash_impl = NULL;
+static DrdTileEqualFunc drd_tile_equal_impl = NULL;
+static DrdTileUniformFunc drd_tile_uniform_impl = NULL;
+static const gchar *drd_tile_hash_kernel_name = "scalar";
+
+/*
+ * 功能：32 位循环左移。
+ * 逻辑：左移与互补右移按位或。
+ * 参数：value 原值；shift 位数（1..31）。
+ * 外部接口：无。
+ */
+static inline guint32
+drd_tile_hash_rotl32(guint32 value, guint shift)
+{
+    return (value << shift) | (value >> (32 - shift));
+}
+
+/*
+ * 功能：把一个像素混入一个哈希通道。
+ * 逻辑：xxHash32 的 round：acc += input * PRIME2，循环左移 13 位后乘 PRIME1；只用 32 位乘法，SIMD 上可整向量执行。
+ * 参数：acc 通道状态；input 像素值（小端 32 位）。
+ * 外部接口：无。
+ */
+static inline guint32
+drd_tile_hash_round(guint32 acc, guint32 input)
+{
+    acc += input * DRD_TILE_HASH_PRIME2;
+    acc = drd_tile_hash_rotl32(acc, 13);
+    return acc * DRD_TILE_HASH_PRIME1;
+}
+
+/*
+ * 功能：把行尾不足 8 个的像素依次混入 0..n-1 号通道。
+ * 逻辑：与整块处理相同的“行内第 i 个像素进入 i mod 8 号通道”规则，各实现共用以保证结果一致。
+ * 参数：lanes 通道状态；row 行尾首像素；n 像素数（<8）。
+ * 外部接口：C 标准库 memcpy。
+ */
+static void
+drd_tile_hash_tail(guint32 *lanes, const guint8 *row, guint n)
+{
+    for (guint i = 0; i < n; ++i)
+    {
+        guint32 word;
+        memcpy(&word, row + (gsize) i * 4, sizeof(word));
+        lanes[i] = drd_tile_hash_round(lanes[i], word);
+    }
+}
+
+/*
+ * 功能：xxHash32 末尾雪崩。
+ * 逻辑：移位异或与两次乘法打散各比特。
+ * 参数：h 待处理值。
+ * 外部接口：无。
+ */
+static inline guint32
+drd_tile_hash_avalanche(guint32 h)
+{
+    h ^= h >> 15;
+    h *= DRD_TILE_HASH_PRIME2;
+    h ^= h >> 13;
+    h *= DRD_TILE_HASH_PRIME3;
+    h ^= h >> 16;
+    return h;
+}
+
+/*
+ * 功能：把 8 个通道折叠为 64 位哈希。
+ * 逻辑：0..3 号与 4..7 号通道分别按 xxHash32 的循环移位求和得到低/高 32 位，混入 tile 宽高后各自雪崩。
+ * 参数：lanes 通道状态；width/height tile 尺寸。
+ * 外部接口：无。
+ */
+static guint64
+drd_tile_hash_finalize(const guint32 *lanes, guint width, guint height)
+{
+    guint32 lo = drd_tile_hash_rotl32(lanes[0], 1) + drd_tile_hash_rotl32(lanes[1], 7) +
+                 drd_tile_hash_rotl32(lanes[2], 12) + drd_tile_hash_rotl32(lanes[3], 18);
+    guint32 hi = drd_tile_hash_rotl32(lanes[4], 1) + drd_tile_hash_rotl32(lanes[5], 7) +
+                 drd_tile_hash_rotl32(lanes[6], 12) + drd_tile_hash_rotl32(lanes[7], 18);
+
+    lo = drd_tile_hash_avalanche(lo + width * DRD_TILE_HASH_PRIME5);
+    hi = drd_tile_hash_avalanche(hi + height * DRD_TILE_HASH_PRIME5);
+    return ((guint64) hi << 32) | lo;
+}
+
+/*
+ * 功能：计算 tile 哈希（通用实现）。
+ * 逻辑：逐行把每 8 个像素分别混入 8 个通道，行尾不足 8 个的像素进入前几个通道，最后折叠为 64 位。
+ * 参数：data 帧缓冲；stride 行步长；x/y 左上角；width/height tile 尺寸。
+ * 外部接口：C 标准库 memcpy。
+ */
+static guint64
+drd_tile_hash_scalar(const guint8 *data, guint stride, guint x, guint y, guint width, guint height)
+{
+    guint32 lanes[DRD_TILE_HASH_LANES];
+    memcpy(lanes, drd_tile_hash_seeds, sizeof(lanes));
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        guint i = 0;
+        for (; i + DRD_TILE_HASH_LANES <= width; i += DRD_TILE_HASH_LANES)
+        {
+            for (guint lane = 0; lane < DRD_TILE_HASH_LANES; ++lane)
+            {
+                guint32 word;
+                memcpy(&word, ptr + (gsize) (i + lane) * 4, sizeof(word));
+                lanes[lane] = drd_tile_hash_round(lanes[lane], word);
+            }
+        }
+        drd_tile_hash_tail(lanes, ptr + (gsize) i * 4, width - i);
+    }
+
+    return drd_tile_hash_finalize(lanes, width, height);
+}
+
+/*
+ * 功能：比较两帧同一 tile 的像素（通用实现）。
+ * 逻辑：逐行 memcmp，遇到差异立即返回。
+ * 参数：a/b 两帧；stride 行步长；x/y 左上角；width/height tile 尺寸。
+ * 外部接口：C 标准库 memcmp。
+ */
+static gboolean
+drd_tile_equal_scalar(const guint8 *a, const guint8 *b, guint stride, guint x, guint y, guint width, guint height)
+{
+    for (guint row = 0; row < height; ++row)
+    {
+        const gsize offset = (gsize) (y + row) * stride + (gsize) x * 4;
+        if (memcmp(a + offset, b + offset, (gsize) width * 4) != 0)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：判断一段像素的颜色是否都与参考像素相同。
+ * 逻辑：逐像素异或后只看 B/G/R 字节；SIMD 实现的行尾也调用它。
+ * 参数：row 首像素；n 像素数；reference 参考像素（按内存顺序读出）。
+ * 外部接口：C 标准库 memcpy。
+ */
+static gboolean
+drd_tile_uniform_tail(const guint8 *row, guint n, guint32 reference)
+{
+    for (guint i = 0; i < n; ++i)
+    {
+        guint32 word;
+        memcpy(&word, row + (gsize) i * 4, sizeof(word));
+        if (((word ^ reference) & DRD_TILE_RGB_MASK) != 0)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：判断 tile 是否为纯色（通用实现）。
+ * 逻辑：以左上角像素为参考逐行比较 B/G/R，遇到不同颜色立即返回；纯色时输出 0x00RRGGBB。
+ * 参数：data 帧缓冲；stride 行步长；x/y 左上角；width/height tile 尺寸；color 输出颜色。
+ * 外部接口：C 标准库 memcpy。
+ */
+static gboolean
+drd_tile_uniform_scalar(const guint8 *data, guint stride, guint x, guint y, guint width, guint height, guint32 *color)
+{
+    guint32 reference;
+    memcpy(&reference, data + (gsize) y * stride + (gsize) x * 4, sizeof(reference));
+
+    for (guint row = 0; row < height; ++row)
+    {
+        if (!drd_tile_uniform_tail(data + (gsize) (y + row) * stride + (gsize) x * 4, width, reference))
+        {
+            return FALSE;
+        }
+    }
+    *color = GUINT32_FROM_LE(reference) & 0x00FFFFFFu;
+    return TRUE;
+}
+
+#ifdef DRD_TILE_HASH_HAVE_AVX2
+/*
+ * 功能：计算 tile 哈希（AVX2）。
+ * 逻辑：8 个通道放在一个 256 位寄存器里，每次加载 8 个像素整向量执行 round；行尾落回通用尾部处理后重新加载。
+ * 参数：同通用实现。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static guint64
+drd_tile_hash_avx2(const guint8 *data, guint stride, guint x, guint y, guint width, guint height)
+{
+    const __m256i prime1 = _mm256_set1_epi32((int) DRD_TILE_HASH_PRIME1);
+    const __m256i prime2 = _mm256_set1_epi32((int) DRD_TILE_HASH_PRIME2);
+    __m256i acc = _mm256_loadu_si256((const __m256i *) drd_tile_hash_seeds);
+    guint32 lanes[DRD_TILE_HASH_LANES];
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        guint i = 0;
+        for (; i + DRD_TILE_HASH_LANES <= width; i += DRD_TILE_HASH_LANES)
+        {
+            const __m256i input = _mm256_loadu_si256((const __m256i *) (ptr + (gsize) i * 4));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(input, prime2));
+            acc = _mm256_or_si256(_mm256_slli_epi32(acc, 13), _mm256_srli_epi32(acc, 19));
+            acc = _mm256_mullo_epi32(acc, prime1);
+        }
+        if (i < width)
+        {
+            _mm256_storeu_si256((__m256i *) lanes, acc);
+            drd_tile_hash_tail(lanes, ptr + (gsize) i * 4, width - i);
+            acc = _mm256_loadu_si256((const __m256i *) lanes);
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    return drd_tile_hash_finalize(lanes, width, height);
+}
+
+/*
+ * 功能：比较两帧同一 tile 的像素（AVX2）。
+ * 逻辑：每行以 32 字节为单位异或并累积按位或，行末 testz 判断，有差异立即返回；行尾不足 32 字节用 memcmp。
+ * 参数：同通用实现。
+ * 外部接口：AVX2 intrinsics；C 标准库 memcmp。
+ */
+__attribute__((target("avx2"))) static gboolean
+drd_tile_equal_avx2(const guint8 *a, const guint8 *b, guint stride, guint x, guint y, guint width, guint height)
+{
+    const gsize row_bytes = (gsize) width * 4;
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const gsize offset = (gsize) (y + row) * stride + (gsize) x * 4;
+        const guint8 *pa = a + offset;
+        const guint8 *pb = b + offset;
+        __m256i diff = _mm256_setzero_si256();
+        gsize i = 0;
+        for (; i + 32 <= row_bytes; i += 32)
+        {
+            const __m256i va = _mm256_loadu_si256((const __m256i *) (pa + i));
+            const __m256i vb = _mm256_loadu_si256((const __m256i *) (pb + i));
+            diff = _mm256_or_si256(diff, _mm256_xor_si256(va, vb));
+        }
+        if (!_mm256_testz_si256(diff, diff) || (i < row_bytes && memcmp(pa + i, pb + i, row_bytes - i) != 0))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：判断 tile 是否为纯色（AVX2）。
+ * 逻辑：参考像素广播到整向量，每行以 8 个像素为单位异或并累积按位或，行末用 testz 只检查 B/G/R 字节；行尾用通用比较。
+ * 参数：同通用实现。
+ * 外部接口：AVX2 intrinsics。
+ */
+__attribute__((target("avx2"))) static gboolean
+drd_tile_uniform_avx2(const guint8 *data, guint stride, guint x, guint y, guint width, guint height, guint32 *color)
+{
+    guint32 reference;
+    memcpy(&reference, data + (gsize) y * stride + (gsize) x * 4, sizeof(reference));
+    const __m256i expected = _mm256_set1_epi32((int) reference);
+    const __m256i mask = _mm256_set1_epi32((int) DRD_TILE_RGB_MASK);
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        __m256i diff = _mm256_setzero_si256();
+        guint i = 0;
+        for (; i + 8 <= width; i += 8)
+        {
+            diff = _mm256_or_si256(diff, _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (ptr + (gsize) i * 4)),
+                                                          expected));
+        }
+        if (!_mm256_testz_si256(diff, mask) || !drd_tile_uniform_tail(ptr + (gsize) i * 4, width - i, reference))
+        {
+            return FALSE;
+        }
+    }
+    *color = GUINT32_FROM_LE(reference) & 0x00FFFFFFu;
+    return TRUE;
+}
+#endif
+
+#ifdef DRD_TILE_HASH_HAVE_SSE42
+/*
+ * 功能：计算 tile 哈希（SSE4.2）。
+ * 逻辑：8 个通道拆成两个 128 位寄存器，每次加载 8 个像素分两半执行 round（pmulld 来自 SSE4.1）。
+ * 参数：同通用实现。
+ * 外部接口：SSE4.1/SSE4.2 intrinsics。
+ */
+__attribute__((target("sse4.2"))) static guint64
+drd_tile_hash_sse42(const guint8 *data, guint stride, guint x, guint y, guint width, guint height)
+{
+    const __m128i prime1 = _mm_set1_epi32((int) DRD_TILE_HASH_PRIME1);
+    const __m128i prime2 = _mm_set1_epi32((int) DRD_TILE_HASH_PRIME2);
+    __m128i acc_lo = _mm_loadu_si128((const __m128i *) drd_tile_hash_seeds);
+    __m128i acc_hi = _mm_loadu_si128((const __m128i *) (drd_tile_hash_seeds + 4));
+    guint32 lanes[DRD_TILE_HASH_LANES];
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        guint i = 0;
+        for (; i + DRD_TILE_HASH_LANES <= width; i += DRD_TILE_HASH_LANES)
+        {
+            const __m128i input_lo = _mm_loadu_si128((const __m128i *) (ptr + (gsize) i * 4));
+            const __m128i input_hi = _mm_loadu_si128((const __m128i *) (ptr + (gsize) i * 4 + 16));
+            acc_lo = _mm_add_epi32(acc_lo, _mm_mullo_epi32(input_lo, prime2));
+            acc_hi = _mm_add_epi32(acc_hi, _mm_mullo_epi32(input_hi, prime2));
+            acc_lo = _mm_or_si128(_mm_slli_epi32(acc_lo, 13), _mm_srli_epi32(acc_lo, 19));
+            acc_hi = _mm_or_si128(_mm_slli_epi32(acc_hi, 13), _mm_srli_epi32(acc_hi, 19));
+            acc_lo = _mm_mullo_epi32(acc_lo, prime1);
+            acc_hi = _mm_mullo_epi32(acc_hi, prime1);
+        }
+        if (i < width)
+        {
+            _mm_storeu_si128((__m128i *) lanes, acc_lo);
+            _mm_storeu_si128((__m128i *) (lanes + 4), acc_hi);
+            drd_tile_hash_tail(lanes, ptr + (gsize) i * 4, width - i);
+            acc_lo = _mm_loadu_si128((const __m128i *) lanes);
+            acc_hi = _mm_loadu_si128((const __m128i *) (lanes + 4));
+        }
+    }
+
+    _mm_storeu_si128((__m128i *) lanes, acc_lo);
+    _mm_storeu_si128((__m128i *) (lanes + 4), acc_hi);
+    return drd_tile_hash_finalize(lanes, width, height);
+}
+
+/*
+ * 功能：比较两帧同一 tile 的像素（SSE4.2）。
+ * 逻辑：每行以 16 字节为单位异或并累积按位或，行末 ptest 判断，有差异立即返回；行尾用 memcmp。
+ * 参数：同通用实现。
+ * 外部接口：SSE4.1 intrinsics；C 标准库 memcmp。
+ */
+__attribute__((target("sse4.2"))) static gboolean
+drd_tile_equal_sse42(const guint8 *a, const guint8 *b, guint stride, guint x, guint y, guint width, guint height)
+{
+    const gsize row_bytes = (gsize) width * 4;
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const gsize offset = (gsize) (y + row) * stride + (gsize) x * 4;
+        const guint8 *pa = a + offset;
+        const guint8 *pb = b + offset;
+        __m128i diff = _mm_setzero_si128();
+        gsize i = 0;
+        for (; i + 16 <= row_bytes; i += 16)
+        {
+            const __m128i va = _mm_loadu_si128((const __m128i *) (pa + i));
+            const __m128i vb = _mm_loadu_si128((const __m128i *) (pb + i));
+            diff = _mm_or_si128(diff, _mm_xor_si128(va, vb));
+        }
+        if (!_mm_testz_si128(diff, diff) || (i < row_bytes && memcmp(pa + i, pb + i, row_bytes - i) != 0))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：判断 tile 是否为纯色（SSE4.2）。
+ * 逻辑：每行以 4 个像素为单位与广播的参考像素异或并累积按位或，行末用 ptest 只检查 B/G/R 字节；行尾用通用比较。
+ * 参数：同通用实现。
+ * 外部接口：SSE4.1 intrinsics。
+ */
+__attribute__((target("sse4.2"))) static gboolean
+drd_tile_uniform_sse42(const guint8 *data, guint stride, guint x, guint y, guint width, guint height, guint32 *color)
+{
+    guint32 reference;
+    memcpy(&reference, data + (gsize) y * stride + (gsize) x * 4, sizeof(reference));
+    const __m128i expected = _mm_set1_epi32((int) reference);
+    const __m128i mask = _mm_set1_epi32((int) DRD_TILE_RGB_MASK);
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        __m128i diff = _mm_setzero_si128();
+        guint i = 0;
+        for (; i + 4 <= width; i += 4)
+        {
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128((const __m128i *) (ptr + (gsize) i * 4)), expected));
+        }
+        if (!_mm_testz_si128(diff, mask) || !drd_tile_uniform_tail(ptr + (gsize) i * 4, width - i, reference))
+        {
+            return FALSE;
+        }
+    }
+    *color = GUINT32_FROM_LE(reference) & 0x00FFFFFFu;
+    return TRUE;
+}
+#endif
+
+#ifdef DRD_TILE_HASH_HAVE_NEON
+/*
+ * 功能：计算 tile 哈希（NEON）。
+ * 逻辑：8 个通道拆成两个 128 位寄存器，vmlaq 完成乘加，vsri 拼出循环左移。
+ * 参数：同通用实现。
+ * 外部接口：NEON intrinsics。
+ */
+static guint64
+drd_tile_hash_neon(const guint8 *data, guint stride, guint x, guint y, guint width, guint height)
+{
+    const uint32x4_t prime1 = vdupq_n_u32(DRD_TILE_HASH_PRIME1);
+    const uint32x4_t prime2 = vdupq_n_u32(DRD_TILE_HASH_PRIME2);
+    uint32x4_t acc_lo = vld1q_u32(drd_tile_hash_seeds);
+    uint32x4_t acc_hi = vld1q_u32(drd_tile_hash_seeds + 4);
+    guint32 lanes[DRD_TILE_HASH_LANES];
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        guint i = 0;
+        for (; i + DRD_TILE_HASH_LANES <= width; i += DRD_TILE_HASH_LANES)
+        {
+            const uint32x4_t input_lo = vreinterpretq_u32_u8(vld1q_u8(ptr + (gsize) i * 4));
+            const uint32x4_t input_hi = vreinterpretq_u32_u8(vld1q_u8(ptr + (gsize) i * 4 + 16));
+            acc_lo = vmlaq_u32(acc_lo, input_lo, prime2);
+            acc_hi = vmlaq_u32(acc_hi, input_hi, prime2);
+            acc_lo = vsriq_n_u32(vshlq_n_u32(acc_lo, 13), acc_lo, 19);
+            acc_hi = vsriq_n_u32(vshlq_n_u32(acc_hi, 13), acc_hi, 19);
+            acc_lo = vmulq_u32(acc_lo, prime1);
+            acc_hi = vmulq_u32(acc_hi, prime1);
+        }
+        if (i < width)
+        {
+            vst1q_u32(lanes, acc_lo);
+            vst1q_u32(lanes + 4, acc_hi);
+            drd_tile_hash_tail(lanes, ptr + (gsize) i * 4, width - i);
+            acc_lo = vld1q_u32(lanes);
+            acc_hi = vld1q_u32(lanes + 4);
+        }
+    }
+
+    vst1q_u32(lanes, acc_lo);
+    vst1q_u32(lanes + 4, acc_hi);
+    return drd_tile_hash_finalize(lanes, width, height);
+}
+
+/*
+ * 功能：比较两帧同一 tile 的像素（NEON）。
+ * 逻辑：每行以 16 字节为单位异或并累积按位或，行末把两个 64 位半部相或判断；行尾用 memcmp。
+ * 参数：同通用实现。
+ * 外部接口：NEON intrinsics；C 标准库 memcmp。
+ */
+static gboolean
+drd_tile_equal_neon(const guint8 *a, const guint8 *b, guint stride, guint x, guint y, guint width, guint height)
+{
+    const gsize row_bytes = (gsize) width * 4;
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const gsize offset = (gsize) (y + row) * stride + (gsize) x * 4;
+        const guint8 *pa = a + offset;
+        const guint8 *pb = b + offset;
+        uint8x16_t diff = vdupq_n_u8(0);
+        gsize i = 0;
+        for (; i + 16 <= row_bytes; i += 16)
+        {
+            diff = vorrq_u8(diff, veorq_u8(vld1q_u8(pa + i), vld1q_u8(pb + i)));
+        }
+        const uint64x2_t folded = vreinterpretq_u64_u8(diff);
+        if ((vgetq_lane_u64(folded, 0) | vgetq_lane_u64(folded, 1)) != 0 ||
+            (i < row_bytes && memcmp(pa + i, pb + i, row_bytes - i) != 0))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：判断 tile 是否为纯色（NEON）。
+ * 逻辑：每行以 4 个像素为单位与广播的参考像素异或并累积按位或，行末屏蔽 X 字节后把两个 64 位半部相或判断；行尾用通用比较。
+ * 参数：同通用实现。
+ * 外部接口：NEON intrinsics。
+ */
+static gboolean
+drd_tile_uniform_neon(const guint8 *data, guint stride, guint x, guint y, guint width, guint height, guint32 *color)
+{
+    guint32 reference;
+    memcpy(&reference, data + (gsize) y * stride + (gsize) x * 4, sizeof(reference));
+    const uint32x4_t expected = vdupq_n_u32(reference);
+    const uint32x4_t mask = vdupq_n_u32(DRD_TILE_RGB_MASK);
+
+    for (guint row = 0; row < height; ++row)
+    {
+        const guint8 *ptr = data + (gsize) (y + row) * stride + (gsize) x * 4;
+        uint32x4_t diff = vdupq_n_u32(0);
+        guint i = 0;
+        for (; i + 4 <= width; i += 4)
+        {
+            diff = vorrq_u32(diff, veorq_u32(vreinterpretq_u32_u8(vld1q_u8(ptr + (gsize) i * 4)), expected));
+        }
+        const uint64x2_t folded = vreinterpretq_u64_u32(vandq_u32(diff, mask));
+        if ((vgetq_lane_u64(folded, 0) | vgetq_lane_u64(folded, 1)) != 0 ||
+            !drd_tile_uniform_tail(ptr + (gsize) i * 4, width - i, reference))
+        {
+            return FALSE;
+        }
+    }
+    *color = GUINT32_FROM_LE(reference) & 0x00FFFFFFu;
+    return TRUE;
+}
+#endif
+
+/*
+ * 功能：校验选中的内核与通用实现逐位一致。
+ * 逻辑：用伪随机像素填充带行尾填充的缓冲，对整 tile、窄边缘 tile 与非对齐小块比较哈希；
+ *       再用副本验证相等判断，并改动单个字节验证不等判断；最后把副本填成只有 X 字节不同的纯色，
+ *       验证纯色判断与输出颜色，并改动最后一个像素的颜色验证非纯色判断。
+ * 参数：hash/equal/uniform 待校验的内核。
+ * 外部接口：GLib g_malloc/g_free；C 标准库 memcpy。
+ */
+static gboolean
+drd_tile_hash_self_check(DrdTileHashFunc hash, DrdTileEqualFunc equal, DrdTileUniformFunc uniform)
+{
+    static const guint tiles[][4] = {
+        {0, 0, 64, 64},
+        {64, 0, 8, DRD_TILE_HASH_CHECK_HEIGHT},
+        {3, 1, 13, 5},
+        {0, 64, 64, 2},
+    };
+    const gsize size = (gsize) DRD_TILE_HASH_CHECK_STRIDE * DRD_TILE_HASH_CHECK_HEIGHT;
+    guint8 *a = g_malloc(size);
+    guint32 state = 0x12345678u;
+    for (gsize i = 0; i < size; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        a[i] = (guint8) (state >> 24);
+    }
+    guint8 *b = g_malloc(size);
+    memcpy(b, a, size);
+
+    gboolean ok = TRUE;
+    for (guint t = 0; t < G_N_ELEMENTS(tiles) && ok; ++t)
+    {
+        const guint *tile = tiles[t];
+        const gsize last = (gsize) (tile[1] + tile[3] - 1) * DRD_TILE_HASH_CHECK_STRIDE +
+                           (gsize) (tile[0] + tile[2] - 1) * 4 + 3;
+
+        ok = hash(a, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3]) ==
+             drd_tile_hash_scalar(a, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3]);
+        ok = ok && equal(a, b, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3]);
+        b[last] ^= 0x01;
+        ok = ok && !equal(a, b, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3]);
+        b[last] ^= 0x01;
+    }
+
+    for (gsize i = 0; i < size; i += 4)
+    {
+        b[i] = 0x12;
+        b[i + 1] = 0x34;
+        b[i + 2] = 0x56;
+        b[i + 3] = a[i + 3];
+    }
+    for (guint t = 0; t < G_N_ELEMENTS(tiles) && ok; ++t)
+    {
+        const guint *tile = tiles[t];
+        const gsize last = (gsize) (tile[1] + tile[3] - 1) * DRD_TILE_HASH_CHECK_STRIDE +
+                           (gsize) (tile[0] + tile[2] - 1) * 4 + 1;
+        guint32 color = 0;
+
+        ok = uniform(b, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3], &color) && color == 0x563412u;
+        b[last] ^= 0x01;
+        ok = ok && !uniform(b, DRD_TILE_HASH_CHECK_STRIDE, tile[0], tile[1], tile[2], tile[3], &color);
+        b[last] ^= 0x01;
+    }
+
+    g_free(b);
+    g_free(a);
+    return ok;
+}
+
+/*
+ * 功能：选择哈希与比较内核。
+ * 逻辑：x86 上依次尝试 AVX2、SSE4.2，ARM 上使用 NEON，其余平台使用通用实现；选中的 SIMD 内核需通过自检，
+ *       否则回退通用实现并告警。只执行一次。
+ * 参数：无。
+ * 外部接口：GLib g_once_init_enter/leave；GCC __builtin_cpu_supports；日志 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
+ */
+static void
+drd_tile_hash_ensure_kernels(void)
+{
+    if (!g_once_init_enter(&drd_tile_hash_init_once))
+    {
+        return;
+    }
+
+    DrdTileHashFunc hash = drd_tile_hash_scalar;
+    DrdTileEqualFunc equal = drd_tile_equal_scalar;
+    DrdTileUniformFunc uniform = drd_tile_uniform_scalar;
+    const gchar *name = "scalar";
+#if defined(DRD_TILE_HASH_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        hash = drd_tile_hash_avx2;
+        equal = drd_tile_equal_avx2;
+        uniform = drd_tile_uniform_avx2;
+        name = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse4.2"))
+    {
+        hash = drd_tile_hash_sse42;
+        equal = drd_tile_equal_sse42;
+        uniform = drd_tile_uniform_sse42;
+        name = "sse4.2";
+    }
+#elif defined(DRD_TILE_HASH_HAVE_NEON)
+    hash = drd_tile_hash_neon;
+    equal = drd_tile_equal_neon;
+    uniform = drd_tile_uniform_neon;
+    name = "neon";
+#endif
+
+    if (hash != drd_tile_hash_scalar && !drd_tile_hash_self_check(hash, equal, uniform))
+    {
+        DRD_LOG_WARNING("Tile hash kernel %s disagrees with the scalar kernel, falling back to scalar", name);
+        hash = drd_tile_hash_scalar;
+        equal = drd_tile_equal_scalar;
+        uniform = drd_tile_uniform_scalar;
+        name = "scalar";
+    }
+
+    drd_tile_hash_impl = hash;
+    drd_tile_equal_impl = equal;
+    drd_tile_uniform_impl = uniform;
+    drd_tile_hash_kernel_name = name;
+    DRD_LOG_MESSAGE("Tile diff kernels: %s", name);
+    g_once_init_leave(&drd_tile_hash_init_once, 1);
+}
+
+/*
+ * 功能：返回当前使用的内核名称，用于日志。
+ * 逻辑：确保内核已选定后返回名称。
+ * 参数：无。
+ * 外部接口：drd_tile_hash_ensure_kernels。
+ */
+const gchar *
+drd_tile_hash_get_kernel_name(void)
+{
+    drd_tile_hash_ensure_kernels();
+    return drd_tile_hash_kernel_name;
+}
+
+/*
+ * 功能：计算 tile 哈希。
+ * 逻辑：确保内核已选定后调用选中的实现。
+ * 参数：data 帧缓冲；stride 行步长；x/y 左上角；width/height tile 尺寸。
+ * 外部接口：drd_tile_hash_ensure_kernels。
+ */
+guint64
+drd_tile_hash(const guint8 *data, guint stride, guint x, guint y, guint width, guint height)
+{
+    drd_tile_hash_ensure_kernels();
+    return drd_tile_hash_impl(data, stride, x, y, width, height);
+}
+
+/*
+ * 功能：比较两帧同一 tile 的像素。
+ * 逻辑：确保内核已选定后调用选中的实现。
+ * 参数：a/b 两帧；stride 行步长；x/y 左上角；width/height tile 尺寸。
+ * 外部接口：drd_tile_hash_ensure_kernels。
+ */
+gboolean
+drd_tile_equal(const guint8 *a, const guint8 *b, guint stride, guint x, guint y, guint width, guint height)
+{
+    drd_tile_hash_ensure_kernels();
+    return drd_tile_equal_impl(a, b, stride, x, y, width, height);
+}
+
+/*
+ * 功能：判断 tile 是否为纯色。
+ * 逻辑：确保内核已选定后调用选中的实现。
+ * 参数：data 帧缓冲；stride 行步长；x/y 左上角；width/height tile 尺寸；color 输出颜色。
+ * 外部接口：drd_tile_hash_ensure_kernels。
+ */
+gboolean
+drd_tile_uniform(const guint8 *data, guint stride, guint x, guint y, guint width, guint height, guint32 *color)
+{
+    drd_tile_hash_ensure_kernels();
+    return drd_tile_uniform_impl(data, stride, x, y, width, height, color);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Tile 差分内核：哈希、逐像素比较与纯色判断按 CPU 在首次使用时选择 AVX2/SSE4.2/NEON 或通用实现，
+ * 各实现的哈希结果逐位一致，可与历史哈希直接比较。
+ */
+const gchar *drd_tile_hash_get_kernel_name(void);
+
+/**
+ * drd_tile_hash:
+ * @data: BGRX frame
+ * @stride: bytes per row of @data
+ * @x: tile left edge in pixels
+ * @y: tile top edge in pixels
+ * @width: tile width in pixels
+ * @height: tile height in pixels
+ *
+ * Hashes one tile with eight xxHash32-style lanes, one 32-bit pixel per lane
+ * step. Every kernel returns the same value for the same pixels.
+ *
+ * Returns: the 64-bit tile hash
+ */
+guint64 drd_tile_hash(const guint8 *data, guint stride, guint x, guint y, guint width, guint height);
+
+/**
+ * drd_tile_equal:
+ * @a: first frame
+ * @b: second frame with the same geometry and @stride
+ * @stride: bytes per row of both frames
+ * @x: tile left edge in pixels
+ * @y: tile top edge in pixels
+ * @width: tile width in pixels
+ * @height: tile height in pixels
+ *
+ * Returns: %TRUE when the tile has identical pixels in both frames
+ */
+gboolean drd_tile_equal(const guint8 *a,
+                        const guint8 *b,
+                        guint stride,
+                        guint x,
+                        guint y,
+                        guint width,
+                        guint height);
+
+/**
+ * drd_tile_uniform:
+ * @data: BGRX frame
+ * @stride: bytes per row of @data
+ * @x: tile left edge in pixels
+ * @y: tile top edge in pixels
+ * @width: tile width in pixels
+ * @height: tile height in pixels
+ * @color: (out): the tile color as 0x00RRGGBB, set only when %TRUE is returned
+ *
+ * The X byte is ignored, so a tile whose pixels only differ there is still uniform.
+ *
+ * Returns: %TRUE when every pixel of the tile has the same color
+ */
+gboolean drd_tile_uniform(const guint8 *data,
+                          guint stride,
+                          guint x,
+                          guint y,
+                          guint width,
+                          guint height,
+                          guint32 *color);
+
+G_END_DECLS
@@ -10,6 +10,8 @@ struct _DrdInputDispatcher
 
     DrdX11Input *backend;
     gboolean active;
+    gint pointer_events; /* 客户端指针事件计数，供光标同步判断客户端是否在移动指针 */
+    gint input_events;   /* 客户端键盘与指针事件总数，供采集节奏判断输入活动 */
 };
 
 G_DEFINE_TYPE(DrdInputDispatcher, drd_input_dispatcher, G_TYPE_OBJECT)
@@ -116,11 +118,24 @@ drd_input_dispatcher_update_desktop_size(DrdInputDispatcher *self, guint width,
     drd_x11_input_update_desktop_size(self->backend, width, height);
 }
 
+/*
+ * 功能：设置流画面对应的桌面区域。
+ * 逻辑：转发到 X11 后端；窗口共享时为窗口矩形，宽高为 0 表示整个桌面。
+ * 参数：self 分发器；x/y 区域原点；width/height 区域尺寸。
+ * 外部接口：drd_x11_input_set_capture_area。
+ */
+void
+drd_input_dispatcher_set_capture_area(DrdInputDispatcher *self, gint x, gint y, guint width, guint height)
+{
+    g_return_if_fail(DRD_IS_INPUT_DISPATCHER(self));
+    drd_x11_input_set_capture_area(self->backend, x, y, width, height);
+}
+
 /*
  * 功能：分发键盘扫描码事件。
- * 逻辑：直接调用 X11 后端注入键盘事件。
+ * 逻辑：累加输入事件计数后调用 X11 后端注入键盘事件。
  * 参数：self 分发器；flags RDP 键盘标志；scancode 扫描码；error 错误输出。
- * 外部接口：drd_x11_input_inject_keyboard（基于 X11 XTest/FreeRDP 键盘映射）。
+ * 外部接口：drd_x11_input_inject_keyboard（基于 X11 XTest/FreeRDP 键盘映射）；GLib g_atomic_int_inc。
  */
 gboolean
 drd_input_dispatcher_handle_keyboard(DrdInputDispatcher *self,
@@ -129,14 +144,15 @@ drd_input_dispatcher_handle_keyboard(DrdInputDispatcher *self,
                                      GError **error)
 {
     g_return_val_if_fail(DRD_IS_INPUT_DISPATCHER(self), FALSE);
+    g_atomic_int_inc(&self->input_events);
     return drd_x11_input_inject_keyboard(self->backend, flags, scancode, error);
 }
 
 /*
  * 功能：分发 Unicode 键盘事件。
- * 逻辑：调用 X11 后端将 Unicode 注入为键盘事件。
+ * 逻辑：累加输入事件计数后调用 X11 后端将 Unicode 注入为键盘事件。
  * 参数：self 分发器；flags RDP 标志；codepoint Unicode 码点；error 错误输出。
- * 外部接口：drd_x11_input_inject_unicode（使用 XKeysymToKeycode/XTest）。
+ * 外部接口：drd_x11_input_inject_unicode（使用 XKeysymToKeycode/XTest）；GLib g_atomic_int_inc。
  */
 gboolean
 drd_input_dispatcher_handle_unicode(DrdInputDispatcher *self,
@@ -145,14 +161,15 @@ drd_input_dispatcher_handle_unicode(DrdInputDispatcher *self,
                                     GError **error)
 {
     g_return_val_if_fail(DRD_IS_INPUT_DISPATCHER(self), FALSE);
+    g_atomic_int_inc(&self->input_events);
     return drd_x11_input_inject_unicode(self->backend, flags, codepoint, error);
 }
 
 /*
  * 功能：分发指针事件。
- * 逻辑：调用 X11 后端注入移动/按键/滚轮事件。
+ * 逻辑：累加指针与输入事件计数后调用 X11 后端注入移动/按键/滚轮事件。
  * 参数：self 分发器；flags RDP 指针标志；x/y 流坐标；error 错误输出。
- * 外部接口：drd_x11_input_inject_pointer（XTestFakeMotion/ButtonEvent 等）。
+ * 外部接口：drd_x11_input_inject_pointer（XTestFakeMotion/ButtonEvent 等）；GLib g_atomic_int_inc。
  */
 gboolean
 drd_input_dispatcher_handle_pointer(DrdInputDispatcher *self,
@@ -162,9 +179,37 @@ drd_input_dispatcher_handle_pointer(DrdInputDispatcher *self,
                                     GError **error)
 {
     g_return_val_if_fail(DRD_IS_INPUT_DISPATCHER(self), FALSE);
+    g_atomic_int_inc(&self->pointer_events);
+    g_atomic_int_inc(&self->input_events);
     return drd_x11_input_inject_pointer(self->backend, flags, x, y, error);
 }
 
+/*
+ * 功能：读取客户端指针事件累计数。
+ * 逻辑：原子读取计数，调用方比较前后两次取值判断期间是否有指针输入。
+ * 参数：self 分发器。
+ * 外部接口：GLib g_atomic_int_get。
+ */
+guint
+drd_input_dispatcher_get_pointer_event_count(DrdInputDispatcher *self)
+{
+    g_return_val_if_fail(DRD_IS_INPUT_DISPATCHER(self), 0);
+    return (guint) g_atomic_int_get(&self->pointer_events);
+}
+
+/*
+ * 功能：读取客户端键盘与指针事件累计数。
+ * 逻辑：原子读取计数，调用方比较前后两次取值判断期间是否有任何输入。
+ * 参数：self 分发器。
+ * 外部接口：GLib g_atomic_int_get。
+ */
+guint
+drd_input_dispatcher_get_input_event_count(DrdInputDispatcher *self)
+{
+    g_return_val_if_fail(DRD_IS_INPUT_DISPATCHER(self), 0);
+    return (guint) g_atomic_int_get(&self->input_events);
+}
+
 /*
  * 功能：刷新输入缓冲占位接口。
  * 逻辑：当前无缓冲行为，保持接口对称性。
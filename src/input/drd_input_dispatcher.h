@@ -12,6 +12,7 @@ DrdInputDispatcher *drd_input_dispatcher_new(void);
 gboolean drd_input_dispatcher_start(DrdInputDispatcher *self, guint width, guint height, GError **error);
 void drd_input_dispatcher_stop(DrdInputDispatcher *self);
 void drd_input_dispatcher_update_desktop_size(DrdInputDispatcher *self, guint width, guint height);
+void drd_input_dispatcher_set_capture_area(DrdInputDispatcher *self, gint x, gint y, guint width, guint height);
 
 gboolean drd_input_dispatcher_handle_keyboard(DrdInputDispatcher *self,
                                                guint16 flags,
@@ -26,6 +27,8 @@ gboolean drd_input_dispatcher_handle_pointer(DrdInputDispatcher *self,
                                               guint16 x,
                                               guint16 y,
                                               GError **error);
+guint drd_input_dispatcher_get_pointer_event_count(DrdInputDispatcher *self);
+guint drd_input_dispatcher_get_input_event_count(DrdInputDispatcher *self);
 
 void drd_input_dispatcher_flush(DrdInputDispatcher *self);
 
@@ -33,6 +33,11 @@ struct _DrdX11Input
     guint16 keycode_cache[DRD_X11_KEYCODE_CACHE_SIZE];
     gdouble stream_to_desktop_scale_x;
     gdouble stream_to_desktop_scale_y;
+    /* 流对应的桌面区域（窗口共享时为窗口矩形），宽高为 0 表示整个桌面 */
+    gint area_x;
+    gint area_y;
+    guint area_width;
+    guint area_height;
 };
 
 G_DEFINE_TYPE(DrdX11Input, drd_x11_input, G_TYPE_OBJECT)
@@ -53,6 +58,8 @@ static guint16 drd_x11_input_resolve_keycode(DrdX11Input *self,
 
 static void drd_x11_input_refresh_pointer_scale(DrdX11Input *self);
 
+static void drd_x11_input_get_area_size(DrdX11Input *self, guint32 *out_width, guint32 *out_height);
+
 static KeySym drd_x11_input_keysym_from_codepoint(gunichar codepoint);
 
 /*
@@ -105,6 +112,10 @@ drd_x11_input_init(DrdX11Input *self)
     drd_x11_input_reset_keycode_cache(self);
     self->stream_to_desktop_scale_x = 1.0;
     self->stream_to_desktop_scale_y = 1.0;
+    self->area_x = 0;
+    self->area_y = 0;
+    self->area_width = 0;
+    self->area_height = 0;
 }
 
 /*
@@ -281,6 +292,27 @@ drd_x11_input_update_desktop_size(DrdX11Input *self, guint width, guint height)
     g_mutex_unlock(&self->lock);
 }
 
+/*
+ * 功能：设置流画面对应的桌面区域。
+ * 逻辑：持锁记录区域原点与尺寸并刷新缩放因子；宽高为 0 时恢复为整个桌面。窗口共享时指针坐标映射到窗口矩形内并被限制在其中。
+ * 参数：self 输入实例；x/y 区域在根窗口中的原点；width/height 区域尺寸。
+ * 外部接口：内部 drd_x11_input_refresh_pointer_scale；GLib g_mutex。
+ */
+void
+drd_x11_input_set_capture_area(DrdX11Input *self, gint x, gint y, guint width, guint height)
+{
+    g_return_if_fail(DRD_IS_X11_INPUT(self));
+
+    g_mutex_lock(&self->lock);
+    const gboolean whole_desktop = width == 0 || height == 0;
+    self->area_x = whole_desktop ? 0 : x;
+    self->area_y = whole_desktop ? 0 : y;
+    self->area_width = whole_desktop ? 0 : width;
+    self->area_height = whole_desktop ? 0 : height;
+    drd_x11_input_refresh_pointer_scale(self);
+    g_mutex_unlock(&self->lock);
+}
+
 /*
  * 功能：校验输入注入器是否处于运行状态。
  * 逻辑：检查 running 与 display；未运行时设置错误。
@@ -420,7 +452,7 @@ drd_x11_input_pointer_button(guint16 flags, guint16 mask, int button_id)
 
 /*
  * 功能：注入指针移动/按键/滚轮事件。
- * 逻辑：持锁检查运行态；按流/桌面尺寸计算缩放与裁剪后的坐标；根据标志注入移动、按键与滚轮事件，最后刷新 X11 输出。
+ * 逻辑：持锁检查运行态；按流/捕获区域尺寸计算缩放与裁剪后的坐标并加上区域原点；根据标志注入移动、按键与滚轮事件，最后刷新 X11 输出。
  * 参数：self 输入实例；flags RDP 指针标志；x/y 流坐标；error 错误输出。
  * 外部接口：XTestFakeMotionEvent/XTestFakeButtonEvent/XFlush；依赖 GLib MAX 宏；日志 DRD_LOG_DEBUG。
  */
@@ -442,8 +474,9 @@ drd_x11_input_inject_pointer(DrdX11Input *self,
 
     const guint32 stream_width = MAX(self->stream_width, 1u);
     const guint32 stream_height = MAX(self->stream_height, 1u);
-    const guint32 desktop_width = MAX(self->desktop_width, 1u);
-    const guint32 desktop_height = MAX(self->desktop_height, 1u);
+    guint32 desktop_width = 1;
+    guint32 desktop_height = 1;
+    drd_x11_input_get_area_size(self, &desktop_width, &desktop_height);
 
     const guint16 max_stream_x = (guint16)(stream_width > 0 ? stream_width - 1 : 0);
     const guint16 max_stream_y = (guint16)(stream_height > 0 ? stream_height - 1 : 0);
@@ -470,6 +503,8 @@ drd_x11_input_inject_pointer(DrdX11Input *self,
         }
         target_y = (guint16) scaled;
     }
+    target_x = (guint16) CLAMP((gint) target_x + self->area_x, 0, G_MAXUINT16);
+    target_y = (guint16) CLAMP((gint) target_y + self->area_y, 0, G_MAXUINT16);
 
     if (flags & PTR_FLAGS_MOVE)
     {
@@ -741,9 +776,22 @@ drd_x11_input_resolve_keycode(DrdX11Input *self,
     return cached;
 }
 
+/*
+ * 功能：读取流画面对应的桌面区域尺寸。
+ * 逻辑：设置了捕获区域时返回区域尺寸，否则返回桌面尺寸；结果至少为 1，避免除零。
+ * 参数：self 输入实例；out_width/out_height 输出尺寸。
+ * 外部接口：无。
+ */
+static void
+drd_x11_input_get_area_size(DrdX11Input *self, guint32 *out_width, guint32 *out_height)
+{
+    *out_width = MAX(self->area_width > 0 ? self->area_width : self->desktop_width, 1u);
+    *out_height = MAX(self->area_height > 0 ? self->area_height : self->desktop_height, 1u);
+}
+
 /*
  * 功能：刷新流坐标到桌面坐标的缩放因子。
- * 逻辑：根据流尺寸与桌面尺寸计算 x/y 缩放，避免除零。
+ * 逻辑：根据流尺寸与捕获区域（默认整个桌面）尺寸计算 x/y 缩放，避免除零。
  * 参数：self 输入实例。
  * 外部接口：无。
  */
@@ -752,8 +800,9 @@ drd_x11_input_refresh_pointer_scale(DrdX11Input *self)
 {
     const guint32 stream_width = self->stream_width > 0 ? self->stream_width : 1u;
     const guint32 stream_height = self->stream_height > 0 ? self->stream_height : 1u;
-    const guint32 desktop_width = self->desktop_width > 0 ? self->desktop_width : 1u;
-    const guint32 desktop_height = self->desktop_height > 0 ? self->desktop_height : 1u;
+    guint32 desktop_width = 1;
+    guint32 desktop_height = 1;
+    drd_x11_input_get_area_size(self, &desktop_width, &desktop_height);
 
     self->stream_to_desktop_scale_x =
             (stream_width == desktop_width)
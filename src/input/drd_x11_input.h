@@ -15,6 +15,7 @@ gboolean drd_x11_input_start(DrdX11Input *self, GError **error);
 void drd_x11_input_stop(DrdX11Input *self);
 
 void drd_x11_input_update_desktop_size(DrdX11Input *self, guint width, guint height);
+void drd_x11_input_set_capture_area(DrdX11Input *self, gint x, gint y, guint width, guint height);
 
 gboolean drd_x11_input_inject_keyboard(DrdX11Input *self, guint16 flags, guint8 scancode, GError **error);
 gboolean drd_x11_input_inject_unicode(DrdX11Input *self, guint16 flags, guint16 codepoint, GError **error);
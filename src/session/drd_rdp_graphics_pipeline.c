@@ -25,6 +25,7 @@ struct _DrdRdpGraphicsPipeline
     gboolean surface_ready;
 
     guint16 surface_id;
+    guint surface_count; /* 多显示器流时每个显示器一个 surface，编号从 surface_id 连续递增 */
     guint32 codec_context_id;
     guint32 next_frame_id;
     gint outstanding_frames;
@@ -90,11 +91,51 @@ drd_rdp_graphics_pipeline_build_timestamp(void)
     return timestamp;
 }
 
+/*
+ * 功能：为单个显示器创建 surface 并映射到输出坐标。
+ * 逻辑：依次发送 CreateSurface 与 MapSurfaceToOutput，surface 尺寸与映射原点取自显示器布局。
+ * 参数：self 图形管线；surface_id surface 编号；monitor 显示器布局。
+ * 外部接口：调用 RdpgfxServerContext 的 CreateSurface/MapSurfaceToOutput 函数（FreeRDP）。
+ */
+static gboolean
+drd_rdp_graphics_pipeline_create_surface_locked(DrdRdpGraphicsPipeline *self,
+                                                guint16 surface_id,
+                                                const DrdMonitorInfo *monitor)
+{
+    RDPGFX_CREATE_SURFACE_PDU create = {0};
+    create.surfaceId = surface_id;
+    create.width = (UINT16) monitor->width;
+    create.height = (UINT16) monitor->height;
+    create.pixelFormat = GFX_PIXEL_FORMAT_XRGB_8888;
+
+    if (!self->rdpgfx_context->CreateSurface ||
+        self->rdpgfx_context->CreateSurface(self->rdpgfx_context, &create) != CHANNEL_RC_OK)
+    {
+        DRD_LOG_WARNING("Graphics pipeline failed to create surface %u", surface_id);
+        return FALSE;
+    }
+
+    RDPGFX_MAP_SURFACE_TO_OUTPUT_PDU map = {0};
+    map.surfaceId = surface_id;
+    map.outputOriginX = (UINT32) monitor->x;
+    map.outputOriginY = (UINT32) monitor->y;
+    map.reserved = 0;
+    if (!self->rdpgfx_context->MapSurfaceToOutput ||
+        self->rdpgfx_context->MapSurfaceToOutput(self->rdpgfx_context, &map) != CHANNEL_RC_OK)
+    {
+        DRD_LOG_WARNING("Graphics pipeline failed to map surface %u to output",
+                        surface_id);
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /*
  * 功能：在持有锁的情况下重置 Rdpgfx surface 与上下文。
- * 逻辑：发送 ResetGraphics、CreateSurface、MapSurfaceToOutput 三个 PDU，重置帧计数、背压与标志位。
+ * 逻辑：读取 runtime 的流尺寸与显示器布局；发送携带显示器定义的 ResetGraphics，再为每个显示器创建 surface（编号从 surface_id 连续递增）
+ *       并映射到其桌面原点，单流时只创建一个覆盖整个桌面的 surface；最后重置帧计数、背压与标志位。
  * 参数：self 图形管线。
- * 外部接口：调用 RdpgfxServerContext 的 ResetGraphics/CreateSurface/MapSurfaceToOutput 函数，
+ * 外部接口：drd_server_runtime_get_stream_size/get_monitors 读取尺寸与布局；调用 RdpgfxServerContext 的 ResetGraphics/CreateSurface/MapSurfaceToOutput 函数，
  *           这些接口由 FreeRDP 提供。
  */
 static gboolean
@@ -107,11 +148,48 @@ drd_rdp_graphics_pipeline_reset_locked(DrdRdpGraphicsPipeline *self)
         return TRUE;
     }
 
+    guint n_monitors = 0;
+    const DrdMonitorInfo *monitors = NULL;
+    if (self->runtime != NULL)
+    {
+        /* 管线可能早于会话激活创建，以激活后确定的流尺寸为准 */
+        guint stream_width = 0;
+        guint stream_height = 0;
+        drd_server_runtime_get_stream_size(self->runtime, &stream_width, &stream_height);
+        if (stream_width > 0 && stream_height > 0)
+        {
+            self->width = (guint16) stream_width;
+            self->height = (guint16) stream_height;
+        }
+        monitors = drd_server_runtime_get_monitors(self->runtime, &n_monitors);
+    }
+    const DrdMonitorInfo desktop = {0, 0, self->width, self->height, TRUE};
+    if (monitors == NULL || n_monitors == 0)
+    {
+        monitors = &desktop;
+        n_monitors = 1;
+    }
+
+    g_autofree MONITOR_DEF *monitor_defs = NULL;
     RDPGFX_RESET_GRAPHICS_PDU reset = {0};
     reset.width = self->width;
     reset.height = self->height;
     reset.monitorCount = 0;
     reset.monitorDefArray = NULL;
+    if (n_monitors > 1)
+    {
+        monitor_defs = g_new0(MONITOR_DEF, n_monitors);
+        for (guint i = 0; i < n_monitors; i++)
+        {
+            monitor_defs[i].left = monitors[i].x;
+            monitor_defs[i].top = monitors[i].y;
+            monitor_defs[i].right = monitors[i].x + (gint) monitors[i].width - 1;
+            monitor_defs[i].bottom = monitors[i].y + (gint) monitors[i].height - 1;
+            monitor_defs[i].flags = monitors[i].primary ? MONITOR_PRIMARY : 0;
+        }
+        reset.monitorCount = n_monitors;
+        reset.monitorDefArray = monitor_defs;
+    }
 
     if (!self->rdpgfx_context->ResetGraphics ||
         self->rdpgfx_context->ResetGraphics(self->rdpgfx_context, &reset) != CHANNEL_RC_OK)
@@ -120,30 +198,13 @@ drd_rdp_graphics_pipeline_reset_locked(DrdRdpGraphicsPipeline *self)
         return FALSE;
     }
 
-    RDPGFX_CREATE_SURFACE_PDU create = {0};
-    create.surfaceId = self->surface_id;
-    create.width = self->width;
-    create.height = self->height;
-    create.pixelFormat = GFX_PIXEL_FORMAT_XRGB_8888;
-
-    if (!self->rdpgfx_context->CreateSurface ||
-        self->rdpgfx_context->CreateSurface(self->rdpgfx_context, &create) != CHANNEL_RC_OK)
+    for (guint i = 0; i < n_monitors; i++)
     {
-        DRD_LOG_WARNING("Graphics pipeline failed to create surface %u", self->surface_id);
-        return FALSE;
-    }
-
-    RDPGFX_MAP_SURFACE_TO_OUTPUT_PDU map = {0};
-    map.surfaceId = self->surface_id;
-    map.outputOriginX = 0;
-    map.outputOriginY = 0;
-    map.reserved = 0;
-    if (!self->rdpgfx_context->MapSurfaceToOutput ||
-        self->rdpgfx_context->MapSurfaceToOutput(self->rdpgfx_context, &map) != CHANNEL_RC_OK)
-    {
-        DRD_LOG_WARNING("Graphics pipeline failed to map surface %u to output",
-                        self->surface_id);
-        return FALSE;
+        if (!drd_rdp_graphics_pipeline_create_surface_locked(self, (guint16) (self->surface_id + i), &monitors[i]))
+        {
+            return FALSE;
+        }
+        self->surface_count = i + 1;
     }
 
     self->next_frame_id = 1;
@@ -157,7 +218,7 @@ drd_rdp_graphics_pipeline_reset_locked(DrdRdpGraphicsPipeline *self)
 
 /*
  * 功能：释放 Rdpgfx 管线持有的上下文与 surface。
- * 逻辑：若 surface 已创建则发送 DeleteSurface；若通道已打开则调用 Close；最后交给父类 dispose。
+ * 逻辑：若 surface 已创建则对每个已创建的 surface 发送 DeleteSurface；若通道已打开则调用 Close；最后交给父类 dispose。
  * 参数：object GObject 指针。
  * 外部接口：调用 RdpgfxServerContext->DeleteSurface/Close（FreeRDP）关闭资源。
  */
@@ -170,9 +231,13 @@ drd_rdp_graphics_pipeline_dispose(GObject *object)
     {
         if (self->surface_ready && self->rdpgfx_context->DeleteSurface)
         {
-            RDPGFX_DELETE_SURFACE_PDU del = {0};
-            del.surfaceId = self->surface_id;
-            self->rdpgfx_context->DeleteSurface(self->rdpgfx_context, &del);
+            for (guint i = 0; i < self->surface_count; i++)
+            {
+                RDPGFX_DELETE_SURFACE_PDU del = {0};
+                del.surfaceId = (UINT16) (self->surface_id + i);
+                self->rdpgfx_context->DeleteSurface(self->rdpgfx_context, &del);
+            }
+            self->surface_count = 0;
             self->surface_ready = FALSE;
             g_cond_broadcast(&self->capacity_cond);
         }
@@ -217,6 +282,7 @@ drd_rdp_graphics_pipeline_init(DrdRdpGraphicsPipeline *self)
     g_mutex_init(&self->lock);
     g_cond_init(&self->capacity_cond);
     self->surface_id = 1;
+    self->surface_count = 0;
     self->codec_context_id = 1;
     self->next_frame_id = 1;
     self->max_outstanding_frames = 3;
@@ -639,6 +705,8 @@ static UINT shadow_client_rdpgfx_caps_advertise(RdpgfxServerContext* context,
     h264 = drd_runtime_encoder_prepare(self->runtime, FREERDP_CODEC_AVC420 | FREERDP_CODEC_AVC444, clientSettings);
     DRD_LOG_MESSAGE("h264 support: %d", h264);
     drd_server_runtime_request_keyframe(self->runtime);
+    /* 新打开的通道上客户端缓存为空 */
+    drd_server_runtime_reset_gfx_cache(self->runtime);
 
 	if (shadow_client_caps_test_version(self,context,h264, capsAdvertise->capsSets,
 	                                    capsAdvertise->capsSetCount, RDPGFX_CAPVERSION_107, &rc))
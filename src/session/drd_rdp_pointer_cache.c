@@ -0,0 +1,343 @@
+#include "session/drd_rdp_pointer_cache.h"
+
+#include <freerdp/pointer.h>
+#include <freerdp/update.h>
+
+#include <string.h>
+
+#include "utils/drd_log.h"
+
+/* 普通指针 PDU 的最大边长，超出部分裁掉 */
+#define DRD_RDP_POINTER_MAX_SIZE 96
+
+typedef struct
+{
+    guint32 serial;
+    guint64 last_used;
+    gboolean valid;
+} DrdRdpPointerCacheEntry;
+
+struct _DrdRdpPointerCache
+{
+    GObject parent_instance;
+
+    DrdRdpPointerCacheEntry *entries;
+    guint capacity;
+    guint64 clock;
+
+    guint64 shape_generation;
+    gboolean hidden;
+    gboolean has_position;
+    gint last_x;
+    gint last_y;
+
+    /* 桌面到客户端流的坐标比例，流经服务端缩放时不为 1 */
+    guint desktop_width;
+    guint desktop_height;
+    guint stream_width;
+    guint stream_height;
+    /* 捕获画面在根窗口中的原点，窗口共享时为窗口左上角 */
+    gint origin_x;
+    gint origin_y;
+};
+
+G_DEFINE_TYPE(DrdRdpPointerCache, drd_rdp_pointer_cache, G_TYPE_OBJECT)
+
+/*
+ * 功能：释放缓存槽位数组。
+ * 逻辑：释放 entries 后调用父类 finalize。
+ * 参数：object 基类指针。
+ * 外部接口：GLib g_free。
+ */
+static void
+drd_rdp_pointer_cache_finalize(GObject *object)
+{
+    DrdRdpPointerCache *self = DRD_RDP_POINTER_CACHE(object);
+    g_clear_pointer(&self->entries, g_free);
+    G_OBJECT_CLASS(drd_rdp_pointer_cache_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：挂载 finalize。
+ * 逻辑：设置 GObjectClass 回调。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_rdp_pointer_cache_class_init(DrdRdpPointerCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = drd_rdp_pointer_cache_finalize;
+}
+
+/*
+ * 功能：初始化实例字段。
+ * 逻辑：无额外状态，容量在 new 中设置。
+ * 参数：self 指针缓存。
+ * 外部接口：无。
+ */
+static void
+drd_rdp_pointer_cache_init(DrdRdpPointerCache *self)
+{
+    (void) self;
+}
+
+/*
+ * 功能：创建与客户端指针缓存对应的 LRU 表。
+ * 逻辑：按协商得到的缓存容量分配槽位（为 0 时每次都以 0 号槽位发送新指针）。
+ * 参数：capacity 客户端指针缓存槽位数。
+ * 外部接口：GLib g_object_new/g_new0。
+ */
+DrdRdpPointerCache *
+drd_rdp_pointer_cache_new(guint capacity)
+{
+    DrdRdpPointerCache *self = g_object_new(DRD_TYPE_RDP_POINTER_CACHE, NULL);
+    self->capacity = capacity;
+    self->entries = g_new0(DrdRdpPointerCacheEntry, MAX(capacity, 1));
+    return self;
+}
+
+/*
+ * 功能：清空缓存与已发送状态。
+ * 逻辑：所有槽位置为无效，重置形状代数与位置，使下一次同步重新发送当前指针。
+ * 参数：self 指针缓存。
+ * 外部接口：C 库 memset。
+ */
+void
+drd_rdp_pointer_cache_reset(DrdRdpPointerCache *self)
+{
+    g_return_if_fail(DRD_IS_RDP_POINTER_CACHE(self));
+
+    memset(self->entries, 0, sizeof(DrdRdpPointerCacheEntry) * MAX(self->capacity, 1));
+    self->clock = 0;
+    self->shape_generation = 0;
+    self->hidden = FALSE;
+    self->has_position = FALSE;
+}
+
+/*
+ * 功能：设置桌面坐标到客户端流坐标的比例。
+ * 逻辑：记录两组尺寸，任一为 0 时视为不缩放；服务器主动移动指针时按比例换算位置。
+ * 参数：self 指针缓存；desktop_width/desktop_height 桌面尺寸；stream_width/stream_height 流尺寸。
+ * 外部接口：无。
+ */
+void
+drd_rdp_pointer_cache_set_scale(DrdRdpPointerCache *self,
+                                guint desktop_width,
+                                guint desktop_height,
+                                guint stream_width,
+                                guint stream_height)
+{
+    g_return_if_fail(DRD_IS_RDP_POINTER_CACHE(self));
+
+    self->desktop_width = desktop_width;
+    self->desktop_height = desktop_height;
+    self->stream_width = stream_width;
+    self->stream_height = stream_height;
+}
+
+/*
+ * 功能：设置捕获画面在根窗口中的原点。
+ * 逻辑：记录原点，光标位置先减去原点再换算为流坐标；整屏捕获时为 (0, 0)。
+ * 参数：self 指针缓存；x/y 捕获画面原点。
+ * 外部接口：无。
+ */
+void
+drd_rdp_pointer_cache_set_origin(DrdRdpPointerCache *self, gint x, gint y)
+{
+    g_return_if_fail(DRD_IS_RDP_POINTER_CACHE(self));
+
+    self->origin_x = x;
+    self->origin_y = y;
+}
+
+/*
+ * 功能：按光标序列号查找或分配缓存槽位。
+ * 逻辑：命中时刷新使用时间并返回 TRUE；未命中时选择空槽位或最久未用槽位写入序列号并返回 FALSE。
+ * 参数：self 指针缓存；serial XFixes 光标序列号；out_index 输出槽位编号。
+ * 外部接口：无。
+ */
+static gboolean
+drd_rdp_pointer_cache_lookup(DrdRdpPointerCache *self, guint32 serial, guint *out_index)
+{
+    const guint capacity = MAX(self->capacity, 1);
+    guint victim = 0;
+
+    self->clock++;
+    for (guint i = 0; i < capacity; i++)
+    {
+        DrdRdpPointerCacheEntry *entry = &self->entries[i];
+        if (self->capacity > 0 && entry->valid && entry->serial == serial)
+        {
+            entry->last_used = self->clock;
+            *out_index = i;
+            return TRUE;
+        }
+        if (!entry->valid)
+        {
+            if (self->entries[victim].valid)
+            {
+                victim = i;
+            }
+        }
+        else if (self->entries[victim].valid && entry->last_used < self->entries[victim].last_used)
+        {
+            victim = i;
+        }
+    }
+
+    self->entries[victim].serial = serial;
+    self->entries[victim].last_used = self->clock;
+    self->entries[victim].valid = TRUE;
+    *out_index = victim;
+    return FALSE;
+}
+
+/*
+ * 功能：发送新的 32 位彩色指针并写入客户端缓存槽位。
+ * 逻辑：尺寸裁剪到 96×96；XOR 掩码按 RDP 要求自下而上排列 BGRA 像素，AND 掩码全 0（透明度由 alpha 表示），行长按 2 字节对齐。
+ * 参数：context 对端上下文；shape 光标形状；cache_index 缓存槽位。
+ * 外部接口：FreeRDP rdpPointerUpdate::PointerNew。
+ */
+static gboolean
+drd_rdp_pointer_cache_send_new(rdpContext *context, DrdCursorShape *shape, guint cache_index)
+{
+    rdpPointerUpdate *pointer = context->update->pointer;
+    if (pointer == NULL || pointer->PointerNew == NULL)
+    {
+        return FALSE;
+    }
+
+    const guint width = MIN(shape->width, DRD_RDP_POINTER_MAX_SIZE);
+    const guint height = MIN(shape->height, DRD_RDP_POINTER_MAX_SIZE);
+    const gsize xor_stride = (gsize) width * 4;
+    const gsize and_stride = (((gsize) width + 15) / 16) * 2;
+    g_autofree guint8 *xor_mask = g_malloc((gsize) height * xor_stride);
+    g_autofree guint8 *and_mask = g_malloc0((gsize) height * and_stride);
+
+    gsize pixels_size = 0;
+    const guint8 *pixels = g_bytes_get_data(shape->pixels, &pixels_size);
+    const gsize src_stride = (gsize) shape->width * 4;
+    for (guint row = 0; row < height; row++)
+    {
+        memcpy(xor_mask + (gsize) (height - 1 - row) * xor_stride, pixels + (gsize) row * src_stride, xor_stride);
+    }
+
+    POINTER_NEW_UPDATE update = {0};
+    update.xorBpp = 32;
+    update.colorPtrAttr.cacheIndex = cache_index;
+    update.colorPtrAttr.hotSpotX = MIN(shape->hotspot_x, width > 0 ? width - 1 : 0);
+    update.colorPtrAttr.hotSpotY = MIN(shape->hotspot_y, height > 0 ? height - 1 : 0);
+    update.colorPtrAttr.width = width;
+    update.colorPtrAttr.height = height;
+    update.colorPtrAttr.lengthXorMask = (UINT32) (height * xor_stride);
+    update.colorPtrAttr.xorMaskData = xor_mask;
+    update.colorPtrAttr.lengthAndMask = (UINT32) (height * and_stride);
+    update.colorPtrAttr.andMaskData = and_mask;
+    return pointer->PointerNew(context, &update);
+}
+
+/*
+ * 功能：把光标形状同步到客户端。
+ * 逻辑：隐藏光标发送 SYSPTR_NULL；否则按序列号查 LRU，命中发送 PointerCached，未命中发送 PointerNew 写入淘汰槽位。
+ * 参数：self 指针缓存；context 对端上下文；shape 光标形状。
+ * 外部接口：FreeRDP rdpPointerUpdate::PointerSystem/PointerCached。
+ */
+static gboolean
+drd_rdp_pointer_cache_send_shape(DrdRdpPointerCache *self, rdpContext *context, DrdCursorShape *shape)
+{
+    rdpPointerUpdate *pointer = context->update->pointer;
+    if (pointer == NULL)
+    {
+        return FALSE;
+    }
+
+    if (shape->hidden || shape->width == 0 || shape->height == 0)
+    {
+        if (self->hidden)
+        {
+            return TRUE;
+        }
+        POINTER_SYSTEM_UPDATE system = {0};
+        system.type = SYSPTR_NULL;
+        self->hidden = TRUE;
+        return pointer->PointerSystem != NULL && pointer->PointerSystem(context, &system);
+    }
+
+    self->hidden = FALSE;
+    guint cache_index = 0;
+    if (drd_rdp_pointer_cache_lookup(self, shape->serial, &cache_index) && pointer->PointerCached != NULL)
+    {
+        POINTER_CACHED_UPDATE cached = {0};
+        cached.cacheIndex = cache_index;
+        return pointer->PointerCached(context, &cached);
+    }
+    return drd_rdp_pointer_cache_send_new(context, shape, cache_index);
+}
+
+/*
+ * 功能：同步光标形状与服务器侧移动的光标位置。
+ * 逻辑：形状代数变化时发送形状更新；光标位置减去捕获原点后与上次比较，变化且客户端未在移动指针（例如应用主动移动指针）时按流比例换算并限制在画面内后发送 PointerPosition，
+ *       客户端自身移动时只记录位置以避免回弹。
+ * 参数：self 指针缓存；context 对端上下文；cursor 光标跟踪器；client_driving 客户端是否正在移动指针。
+ * 外部接口：drd_x11_cursor_get_shape/get_position；FreeRDP rdpPointerUpdate::PointerPosition；日志 DRD_LOG_WARNING。
+ */
+gboolean
+drd_rdp_pointer_cache_sync(DrdRdpPointerCache *self,
+                           rdpContext *context,
+                           DrdX11Cursor *cursor,
+                           gboolean client_driving)
+{
+    g_return_val_if_fail(DRD_IS_RDP_POINTER_CACHE(self), FALSE);
+    g_return_val_if_fail(context != NULL && context->update != NULL, FALSE);
+    g_return_val_if_fail(DRD_IS_X11_CURSOR(cursor), FALSE);
+
+    g_autoptr(DrdCursorShape) shape = drd_x11_cursor_get_shape(cursor, &self->shape_generation);
+    if (shape != NULL && !drd_rdp_pointer_cache_send_shape(self, context, shape))
+    {
+        DRD_LOG_WARNING("Failed to send pointer shape update (serial=%u)", shape->serial);
+        return FALSE;
+    }
+
+    gint x = 0;
+    gint y = 0;
+    if (!drd_x11_cursor_get_position(cursor, &x, &y))
+    {
+        return TRUE;
+    }
+    x -= self->origin_x;
+    y -= self->origin_y;
+    if (self->has_position && x == self->last_x && y == self->last_y)
+    {
+        return TRUE;
+    }
+
+    const gboolean first = !self->has_position;
+    self->has_position = TRUE;
+    self->last_x = x;
+    self->last_y = y;
+    if (first || client_driving || self->hidden)
+    {
+        return TRUE;
+    }
+
+    rdpPointerUpdate *pointer = context->update->pointer;
+    if (pointer == NULL || pointer->PointerPosition == NULL)
+    {
+        return TRUE;
+    }
+    if (self->desktop_width > 0 && self->desktop_height > 0 && self->stream_width > 0 && self->stream_height > 0)
+    {
+        x = (gint) ((gint64) x * self->stream_width / self->desktop_width);
+        y = (gint) ((gint64) y * self->stream_height / self->desktop_height);
+    }
+    if (self->stream_width > 0 && self->stream_height > 0)
+    {
+        x = MIN(x, (gint) self->stream_width - 1);
+        y = MIN(y, (gint) self->stream_height - 1);
+    }
+    POINTER_POSITION_UPDATE position = {0};
+    position.xPos = (UINT32) MAX(x, 0);
+    position.yPos = (UINT32) MAX(y, 0);
+    return pointer->PointerPosition(context, &position);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glib-object.h>
+
+#include <freerdp/freerdp.h>
+
+#include "capture/drd_x11_cursor.h"
+
+G_BEGIN_DECLS
+
+#define DRD_TYPE_RDP_POINTER_CACHE (drd_rdp_pointer_cache_get_type())
+G_DECLARE_FINAL_TYPE(DrdRdpPointerCache, drd_rdp_pointer_cache, DRD, RDP_POINTER_CACHE, GObject)
+
+DrdRdpPointerCache *drd_rdp_pointer_cache_new(guint capacity);
+
+void drd_rdp_pointer_cache_reset(DrdRdpPointerCache *self);
+void drd_rdp_pointer_cache_set_scale(DrdRdpPointerCache *self,
+                                     guint desktop_width,
+                                     guint desktop_height,
+                                     guint stream_width,
+                                     guint stream_height);
+void drd_rdp_pointer_cache_set_origin(DrdRdpPointerCache *self, gint x, gint y);
+
+/**
+ * drd_rdp_pointer_cache_sync:
+ * @self: the per-session pointer cache
+ * @context: peer context used to send pointer updates
+ * @cursor: cursor tracker
+ * @client_driving: %TRUE while the client is moving the pointer itself
+ *
+ * Sends a pointer new/cached/system update when the cursor shape changed and a
+ * pointer position update when the server moved the pointer on its own.
+ */
+gboolean drd_rdp_pointer_cache_sync(DrdRdpPointerCache *self,
+                                    rdpContext *context,
+                                    DrdX11Cursor *cursor,
+                                    gboolean client_driving);
+
+G_END_DECLS
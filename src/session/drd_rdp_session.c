@@ -22,10 +22,14 @@
 #include "core/drd_server_runtime.h"
 #include "security/drd_pam_auth.h"
 #include "session/drd_rdp_graphics_pipeline.h"
+#include "session/drd_rdp_pointer_cache.h"
 #include "utils/drd_capture_metrics.h"
 #include "utils/drd_log.h"
 
 #define ELEMENT_TYPE_CERTIFICATE 32
+/* 客户端最近一次指针输入后的该时长内视为客户端在移动指针，不回送位置更新 */
+#define DRD_RDP_SESSION_POINTER_CLIENT_HOLD_US (250 * 1000)
+#define DRD_RDP_SESSION_POINTER_CACHE_MAX 100
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(rdpCertificate, freerdp_certificate_free)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(rdpRedirection, redirection_free)
@@ -66,6 +70,10 @@ struct _DrdRdpSession
 
     guint refresh_timeout_source; /* avc 切换时的全量帧定时器 */
     gint refresh_timeout_due; /* 定时器到期后由渲染线程消费 */
+
+    DrdRdpPointerCache *pointer_cache; /* 客户端指针缓存的 LRU 镜像，仅渲染线程访问 */
+    guint pointer_event_count;
+    gint64 last_client_pointer_us;
 };
 
 G_DEFINE_TYPE(DrdRdpSession, drd_rdp_session, G_TYPE_OBJECT)
@@ -103,6 +111,8 @@ static gboolean drd_rdp_session_on_refresh_timeout(gpointer user_data);
 static void drd_rdp_session_cancel_refresh_timer(DrdRdpSession *self);
 static void drd_rdp_session_update_refresh_timer_state(DrdRdpSession *self);
 
+static void drd_rdp_session_sync_pointer(DrdRdpSession *self);
+
 /*
  * 功能：释放会话持有的线程与资源，防止 FreeRDP peer 悬挂。
  * 逻辑：停止事件线程与渲染管线，等待 VCM 线程结束；若 peer context 仍存在则交由 FreeRDP 管理；
@@ -130,6 +140,7 @@ static void drd_rdp_session_dispose(GObject *object)
         self->peer = NULL;
     }
 
+    g_clear_object(&self->pointer_cache);
     g_clear_object(&self->runtime);
     g_clear_pointer(&self->pam_auth, drd_pam_auth_close);
 
@@ -202,6 +213,9 @@ static void drd_rdp_session_init(DrdRdpSession *self)
     self->congestion_permanent_disabled = FALSE;
     self->refresh_timeout_source = 0;
     g_atomic_int_set(&self->refresh_timeout_due, 0);
+    self->pointer_cache = NULL;
+    self->pointer_event_count = 0;
+    self->last_client_pointer_us = 0;
 }
 
 /*
@@ -419,7 +433,7 @@ BOOL drd_rdp_session_post_connect(DrdRdpSession *self)
 /*
  * 功能：执行 RDP 会话激活，启动编码/渲染流程。
  * 逻辑：被动模式直接标记激活；否则校验客户端桌面尺寸、获取编码配置并准备 runtime 流；
- *       若需要触发关键帧请求，刷新 payload 上限，启动渲染线程并更新状态。
+ *       若需要触发关键帧请求，刷新 payload 上限，按协商的 PointerCacheSize 创建指针缓存，启动渲染线程并更新状态。
  * 参数：self 会话。
  * 外部接口：调用 drd_server_runtime_* 访问编码流水，使用 FreeRDP settings 更新桌面尺寸，
  *           日志采用 DRD_LOG_MESSAGE/DRD_LOG_WARNING。
@@ -486,6 +500,22 @@ BOOL drd_rdp_session_activate(DrdRdpSession *self)
 
     drd_rdp_session_refresh_surface_payload_limit(self);
 
+    if (self->pointer_cache == NULL && self->peer->context->settings != NULL)
+    {
+        const guint32 pointer_cache_size = MIN(freerdp_settings_get_uint32(self->peer->context->settings,
+                                                                           FreeRDP_PointerCacheSize),
+                                               DRD_RDP_SESSION_POINTER_CACHE_MAX);
+        self->pointer_cache = drd_rdp_pointer_cache_new(pointer_cache_size);
+    }
+    if (self->pointer_cache != NULL)
+    {
+        guint stream_width = 0;
+        guint stream_height = 0;
+        drd_server_runtime_get_stream_size(self->runtime, &stream_width, &stream_height);
+        drd_rdp_pointer_cache_set_scale(self->pointer_cache, encoding_opts.width, encoding_opts.height, stream_width,
+                                        stream_height);
+    }
+
     drd_rdp_session_set_peer_state(self, "activated");
     self->is_activated = TRUE;
     if (!drd_rdp_session_start_render_thread(self))
@@ -1086,12 +1116,13 @@ static gpointer drd_rdp_session_vcm_thread(gpointer user_data)
 }
 
 /*
- * 功能：强制客户端桌面分辨率匹配服务器编码分辨率。
- * 逻辑：读取 runtime 编码宽高与客户端设置；若客户端不支持 DesktopResize 且尺寸不符则拒绝；
- *       否则更新 FreeRDP 设置并调用 DesktopResize 回调同步。
+ * 功能：协调客户端桌面分辨率与服务器编码分辨率。
+ * 逻辑：读取 runtime 编码宽高与客户端设置；客户端不支持 DesktopResize，或开启 scale_to_client 且客户端面积更小时，
+ *       把流尺寸设为客户端尺寸，由服务端缩放后编码；流已按其他尺寸运行而客户端又不支持 DesktopResize 时拒绝；
+ *       其余情况清除流尺寸（流已运行时沿用其尺寸），更新 FreeRDP 设置并调用 DesktopResize 回调同步。
  * 参数：self 会话。
  * 外部接口：freerdp_settings_get_uint32/get_bool 读取设置，freerdp_settings_set_uint32 写入；
- *           调用 rdpUpdate->DesktopResize 通知客户端。
+ *           drd_server_runtime_set_stream_size/get_stream_size 设置流尺寸；调用 rdpUpdate->DesktopResize 通知客户端。
  */
 static gboolean drd_rdp_session_enforce_peer_desktop_size(DrdRdpSession *self)
 {
@@ -1115,8 +1146,8 @@ static gboolean drd_rdp_session_enforce_peer_desktop_size(DrdRdpSession *self)
         return TRUE;
     }
 
-    const guint32 desired_width = encoding_opts.width;
-    const guint32 desired_height = encoding_opts.height;
+    guint desired_width = encoding_opts.width;
+    guint desired_height = encoding_opts.height;
     const guint32 client_width = freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
     const guint32 client_height = freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
     const gboolean client_allows_resize = freerdp_settings_get_bool(settings, FreeRDP_DesktopResize);
@@ -1124,11 +1155,37 @@ static gboolean drd_rdp_session_enforce_peer_desktop_size(DrdRdpSession *self)
     DRD_LOG_MESSAGE("Session %s peer geometry %ux%u, server requires %ux%u", self->peer_address, client_width,
                     client_height, desired_width, desired_height);
 
-    if (!client_allows_resize && (client_width != desired_width || client_height != desired_height))
+    const gboolean size_differs = client_width != desired_width || client_height != desired_height;
+    const gboolean client_smaller =
+            (guint64) client_width * client_height < (guint64) desired_width * desired_height;
+    if (size_differs && client_width > 0 && client_height > 0 &&
+        (!client_allows_resize || (encoding_opts.scale_to_client && client_smaller)))
     {
-        DRD_LOG_WARNING("Session %s client did not advertise DesktopResize, cannot override %ux%u with %ux%u",
-                        self->peer_address, client_width, client_height, desired_width, desired_height);
-        return FALSE;
+        if (drd_server_runtime_set_stream_size(self->runtime, client_width, client_height))
+        {
+            DRD_LOG_MESSAGE("Session %s streams desktop %ux%u scaled to client geometry %ux%u", self->peer_address,
+                            desired_width, desired_height, client_width, client_height);
+            return TRUE;
+        }
+        if (!client_allows_resize)
+        {
+            DRD_LOG_WARNING("Session %s client did not advertise DesktopResize and the running stream cannot be "
+                            "scaled to %ux%u",
+                            self->peer_address, client_width, client_height);
+            return FALSE;
+        }
+    }
+
+    if (!drd_server_runtime_set_stream_size(self->runtime, 0, 0))
+    {
+        /* 流已按缩放尺寸运行：客户端跟随当前流尺寸 */
+        drd_server_runtime_get_stream_size(self->runtime, &desired_width, &desired_height);
+        if (!client_allows_resize && (client_width != desired_width || client_height != desired_height))
+        {
+            DRD_LOG_WARNING("Session %s client did not advertise DesktopResize, cannot override %ux%u with %ux%u",
+                            self->peer_address, client_width, client_height, desired_width, desired_height);
+            return FALSE;
+        }
     }
 
     gboolean updated = FALSE;
@@ -1224,6 +1281,7 @@ static gpointer drd_rdp_session_render_thread(gpointer user_data)
             g_usleep(1000);
             continue;
         }
+        drd_rdp_session_sync_pointer(self);
         g_autoptr(GError) error = NULL;
         gboolean sent = FALSE;
         DrdFrameTransport transport = drd_server_runtime_get_transport(self->runtime);
@@ -1398,12 +1456,47 @@ static gpointer drd_rdp_session_render_thread(gpointer user_data)
     return NULL;
 }
 
+/*
+ * 功能：把服务器光标同步为 RDP 指针更新。
+ * 逻辑：光标跟踪未运行时直接返回（光标保留在画面内）；比较输入分发器的指针事件计数判断客户端是否正在移动指针，
+ *       同步捕获原点（窗口共享时光标位置相对窗口）后交由指针缓存发送形状（新建/缓存/隐藏）与服务器主动移动时的位置更新。
+ * 参数：self 会话。
+ * 外部接口：drd_server_runtime_get_cursor/get_input/get_capture_origin、drd_input_dispatcher_get_pointer_event_count、drd_rdp_pointer_cache_set_origin/sync。
+ */
+static void drd_rdp_session_sync_pointer(DrdRdpSession *self)
+{
+    if (self->pointer_cache == NULL || self->peer == NULL || self->peer->context == NULL)
+    {
+        return;
+    }
+
+    DrdX11Cursor *cursor = drd_server_runtime_get_cursor(self->runtime);
+    if (cursor == NULL || !drd_x11_cursor_is_running(cursor))
+    {
+        return;
+    }
+
+    const gint64 now = g_get_monotonic_time();
+    const guint pointer_events = drd_input_dispatcher_get_pointer_event_count(drd_server_runtime_get_input(self->runtime));
+    if (pointer_events != self->pointer_event_count)
+    {
+        self->pointer_event_count = pointer_events;
+        self->last_client_pointer_us = now;
+    }
+    const gboolean client_driving = now - self->last_client_pointer_us < DRD_RDP_SESSION_POINTER_CLIENT_HOLD_US;
+    gint origin_x = 0;
+    gint origin_y = 0;
+    drd_server_runtime_get_capture_origin(self->runtime, &origin_x, &origin_y);
+    drd_rdp_pointer_cache_set_origin(self->pointer_cache, origin_x, origin_y);
+    drd_rdp_pointer_cache_sync(self->pointer_cache, self->peer->context, cursor, client_driving);
+}
+
 /*
  * 功能：按需创建 Rdpgfx 图形管线，前提是编码模式为 RFX 且 VCM/peer/runtime 就绪。
  * 逻辑：若已存在管线或条件不足直接返回；读取编码配置，确认模式为 RFX 后调用
  *       drd_rdp_graphics_pipeline_new 创建管线并记录。
  * 参数：self 会话。
- * 外部接口：drd_server_runtime_get_encoding_options 读取配置，
+ * 外部接口：drd_server_runtime_get_encoding_options 读取配置，drd_server_runtime_get_stream_size 取得表面尺寸，
  *           drd_rdp_graphics_pipeline_new 创建 FreeRDP Rdpgfx 上下文。
  */
 static void drd_rdp_session_maybe_init_graphics(DrdRdpSession *self)
@@ -1428,8 +1521,11 @@ static void drd_rdp_session_maybe_init_graphics(DrdRdpSession *self)
         return;
     }
 
+    guint stream_width = 0;
+    guint stream_height = 0;
+    drd_server_runtime_get_stream_size(self->runtime, &stream_width, &stream_height);
     DrdRdpGraphicsPipeline *pipeline = drd_rdp_graphics_pipeline_new(
-            self->peer, self->vcm, self->runtime, (guint16) encoding_opts.width, (guint16) encoding_opts.height);
+            self->peer, self->vcm, self->runtime, (guint16) stream_width, (guint16) stream_height);
     if (pipeline == NULL)
     {
         DRD_LOG_WARNING("Session %s failed to allocate graphics pipeline", self->peer_address);
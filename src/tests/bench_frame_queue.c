@@ -0,0 +1,418 @@
+/*
+ * 帧队列交接基准：一个生产者线程与一个消费者线程分别驱动旧的互斥锁/条件变量环形队列与当前的无锁信箱队列，
+ * 报告推入到取出的交接延迟分布与丢帧数。旧实现按替换前的逻辑精简保留在本文件中，只用于对比。
+ *
+ * 用法：bench-frame-queue [每个场景的帧数]
+ */
+#include <stdlib.h>
+
+#include "utils/drd_frame_queue.h"
+
+#define BENCH_DEFAULT_FRAMES 4000
+#define BENCH_WAIT_TIMEOUT_US (100 * 1000)
+
+/* 替换前的队列深度：环形缓冲最多缓存的帧数 */
+#define BENCH_MUTEX_QUEUE_DEPTH 3
+
+/* 替换前的队列：互斥锁保护的环形缓冲，满时丢弃同一显示器最旧的帧，推入时广播条件变量 */
+typedef struct
+{
+    GMutex mutex;
+    GCond cond;
+    DrdFrame *frames[BENCH_MUTEX_QUEUE_DEPTH];
+    guint head;
+    guint tail;
+    guint size;
+    gboolean running;
+    guint64 dropped_frames;
+} BenchMutexQueue;
+
+typedef struct
+{
+    const gchar *name;
+    gpointer (*create)(void);
+    void (*push)(gpointer queue, DrdFrame *frame);
+    gboolean (*wait)(gpointer queue, gint64 timeout_us, DrdFrame **out_frame);
+    void (*stop)(gpointer queue);
+    guint64 (*get_dropped)(gpointer queue);
+    void (*destroy)(gpointer queue);
+} BenchQueueOps;
+
+typedef struct
+{
+    const gchar *name;
+    gint64 produce_interval_us; /* 生产者推帧间隔，0 为连续推入 */
+    gint64 consume_work_us;     /* 消费者每帧模拟的编码与发送耗时 */
+} BenchScenario;
+
+typedef struct
+{
+    const BenchQueueOps *ops;
+    const BenchScenario *scenario;
+    gpointer queue;
+    guint n_frames;
+    gint producer_done;
+    gint64 *latencies;
+    guint n_latencies;
+} BenchRun;
+
+/*
+ * 功能：创建旧实现的队列。
+ * 逻辑：分配结构并初始化锁、条件变量与运行标志。
+ * 参数：无。
+ * 外部接口：GLib g_new0/g_mutex_init/g_cond_init。
+ */
+static gpointer
+bench_mutex_queue_create(void)
+{
+    BenchMutexQueue *self = g_new0(BenchMutexQueue, 1);
+    g_mutex_init(&self->mutex);
+    g_cond_init(&self->cond);
+    self->running = TRUE;
+    return self;
+}
+
+/*
+ * 功能：按旧实现推入一帧。
+ * 逻辑：持锁；满容量时移除同一显示器的最旧帧（不存在时移除头部帧）并顺移补位，写入尾部后广播条件。
+ * 参数：queue 旧队列；frame 待推入帧。
+ * 外部接口：GLib g_cond_broadcast/g_clear_object。
+ */
+static void
+bench_mutex_queue_push(gpointer queue, DrdFrame *frame)
+{
+    BenchMutexQueue *self = queue;
+
+    g_mutex_lock(&self->mutex);
+    if (!self->running)
+    {
+        g_mutex_unlock(&self->mutex);
+        return;
+    }
+
+    if (self->size == BENCH_MUTEX_QUEUE_DEPTH)
+    {
+        const guint monitor = drd_frame_get_monitor(frame);
+        guint victim = 0;
+        for (guint i = 0; i < self->size; ++i)
+        {
+            if (drd_frame_get_monitor(self->frames[(self->head + i) % BENCH_MUTEX_QUEUE_DEPTH]) == monitor)
+            {
+                victim = i;
+                break;
+            }
+        }
+
+        g_clear_object(&self->frames[(self->head + victim) % BENCH_MUTEX_QUEUE_DEPTH]);
+        for (guint i = victim; i > 0; --i)
+        {
+            self->frames[(self->head + i) % BENCH_MUTEX_QUEUE_DEPTH] =
+                    self->frames[(self->head + i - 1) % BENCH_MUTEX_QUEUE_DEPTH];
+        }
+        self->frames[self->head] = NULL;
+        self->head = (self->head + 1) % BENCH_MUTEX_QUEUE_DEPTH;
+        self->size--;
+        self->dropped_frames++;
+    }
+
+    self->frames[self->tail] = g_object_ref(frame);
+    self->tail = (self->tail + 1) % BENCH_MUTEX_QUEUE_DEPTH;
+    self->size++;
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->mutex);
+}
+
+/*
+ * 功能：按旧实现等待并取出头部帧。
+ * 逻辑：持锁在条件变量上等待到有帧、超时或停止，取出最旧的帧。
+ * 参数：queue 旧队列；timeout_us 超时（微秒）；out_frame 输出帧。
+ * 外部接口：GLib g_cond_wait_until/g_get_monotonic_time。
+ */
+static gboolean
+bench_mutex_queue_wait(gpointer queue, gint64 timeout_us, DrdFrame **out_frame)
+{
+    BenchMutexQueue *self = queue;
+    gboolean result = FALSE;
+
+    g_mutex_lock(&self->mutex);
+    const gint64 deadline = g_get_monotonic_time() + timeout_us;
+    while (self->running && self->size == 0)
+    {
+        if (!g_cond_wait_until(&self->cond, &self->mutex, deadline))
+        {
+            break;
+        }
+    }
+
+    if (self->running && self->size > 0)
+    {
+        *out_frame = self->frames[self->head];
+        self->frames[self->head] = NULL;
+        self->head = (self->head + 1) % BENCH_MUTEX_QUEUE_DEPTH;
+        self->size--;
+        result = TRUE;
+    }
+    g_mutex_unlock(&self->mutex);
+    return result;
+}
+
+/*
+ * 功能：停止旧队列并唤醒消费者。
+ * 逻辑：持锁清除运行标志并广播条件。
+ * 参数：queue 旧队列。
+ * 外部接口：GLib g_cond_broadcast。
+ */
+static void
+bench_mutex_queue_stop(gpointer queue)
+{
+    BenchMutexQueue *self = queue;
+
+    g_mutex_lock(&self->mutex);
+    self->running = FALSE;
+    g_cond_broadcast(&self->cond);
+    g_mutex_unlock(&self->mutex);
+}
+
+static guint64
+bench_mutex_queue_get_dropped(gpointer queue)
+{
+    BenchMutexQueue *self = queue;
+
+    g_mutex_lock(&self->mutex);
+    const guint64 dropped = self->dropped_frames;
+    g_mutex_unlock(&self->mutex);
+    return dropped;
+}
+
+/*
+ * 功能：释放旧队列。
+ * 逻辑：释放残留帧引用后清理锁与条件变量。
+ * 参数：queue 旧队列。
+ * 外部接口：GLib g_clear_object/g_free。
+ */
+static void
+bench_mutex_queue_destroy(gpointer queue)
+{
+    BenchMutexQueue *self = queue;
+
+    for (guint i = 0; i < BENCH_MUTEX_QUEUE_DEPTH; ++i)
+    {
+        g_clear_object(&self->frames[i]);
+    }
+    g_mutex_clear(&self->mutex);
+    g_cond_clear(&self->cond);
+    g_free(self);
+}
+
+static gpointer
+bench_mailbox_queue_create(void)
+{
+    return drd_frame_queue_new();
+}
+
+static void
+bench_mailbox_queue_push(gpointer queue, DrdFrame *frame)
+{
+    drd_frame_queue_push(queue, frame);
+}
+
+static gboolean
+bench_mailbox_queue_wait(gpointer queue, gint64 timeout_us, DrdFrame **out_frame)
+{
+    return drd_frame_queue_wait(queue, timeout_us, out_frame);
+}
+
+static void
+bench_mailbox_queue_stop(gpointer queue)
+{
+    drd_frame_queue_stop(queue);
+}
+
+static guint64
+bench_mailbox_queue_get_dropped(gpointer queue)
+{
+    return drd_frame_queue_get_dropped_frames(queue);
+}
+
+static void
+bench_mailbox_queue_destroy(gpointer queue)
+{
+    g_object_unref(queue);
+}
+
+static const BenchQueueOps bench_queues[] = {
+    {"mutex-ring", bench_mutex_queue_create, bench_mutex_queue_push, bench_mutex_queue_wait, bench_mutex_queue_stop,
+     bench_mutex_queue_get_dropped, bench_mutex_queue_destroy},
+    {"mailbox", bench_mailbox_queue_create, bench_mailbox_queue_push, bench_mailbox_queue_wait,
+     bench_mailbox_queue_stop, bench_mailbox_queue_get_dropped, bench_mailbox_queue_destroy},
+};
+
+/*
+ * paced：消费者快于生产者，测量唤醒交接延迟；
+ * overload：消费者慢于生产者，测量丢帧与交付帧的陈旧程度；
+ * burst：生产者连续推入，测量高竞争下的交接开销。
+ */
+static const BenchScenario bench_scenarios[] = {
+    {"paced", 1000, 200},
+    {"overload", 250, 1000},
+    {"burst", 0, 20},
+};
+
+/*
+ * 功能：忙等指定时长，模拟消费者的编码耗时。
+ * 逻辑：自旋读取单调时钟，避免睡眠粒度掩盖交接延迟。
+ * 参数：duration_us 时长（微秒）。
+ * 外部接口：GLib g_get_monotonic_time。
+ */
+static void
+bench_spin(gint64 duration_us)
+{
+    const gint64 end = g_get_monotonic_time() + duration_us;
+    while (g_get_monotonic_time() < end)
+    {
+    }
+}
+
+/*
+ * 功能：生产者线程主体。
+ * 逻辑：按场景间隔创建帧（间隔从上一次推帧算起），推入前把单调时钟写入帧时间戳；推完后置位完成标志并停止队列。
+ * 参数：user_data BenchRun。
+ * 外部接口：drd_frame_new/drd_frame_configure；GLib g_usleep/g_atomic_int_set。
+ */
+static gpointer
+bench_producer(gpointer user_data)
+{
+    BenchRun *run = user_data;
+    gint64 last_push = g_get_monotonic_time();
+
+    for (guint i = 0; i < run->n_frames; ++i)
+    {
+        if (run->scenario->produce_interval_us > 0)
+        {
+            /* 间隔从上一次推帧算起，睡过头时不补推，避免背靠背推帧被计为丢帧 */
+            const gint64 remaining = last_push + run->scenario->produce_interval_us - g_get_monotonic_time();
+            if (remaining > 0)
+            {
+                g_usleep((gulong) remaining);
+            }
+        }
+
+        DrdFrame *frame = drd_frame_new();
+        drd_frame_set_monitor(frame, 0, 0, 0);
+        last_push = g_get_monotonic_time();
+        drd_frame_configure(frame, 64, 64, 64 * 4, (guint64) last_push);
+        run->ops->push(run->queue, frame);
+        g_object_unref(frame);
+    }
+
+    /* 给消费者时间取走最后一帧，再停止队列 */
+    g_usleep((gulong) (run->scenario->consume_work_us * 4 + 1000));
+    g_atomic_int_set(&run->producer_done, TRUE);
+    run->ops->stop(run->queue);
+    return NULL;
+}
+
+/*
+ * 功能：消费者线程主体。
+ * 逻辑：循环等待帧，记录取出时刻与帧时间戳之差，再忙等模拟编码；队列停止后返回。
+ * 参数：user_data BenchRun。
+ * 外部接口：drd_frame_get_timestamp；GLib g_get_monotonic_time。
+ */
+static gpointer
+bench_consumer(gpointer user_data)
+{
+    BenchRun *run = user_data;
+
+    while (!g_atomic_int_get(&run->producer_done))
+    {
+        DrdFrame *frame = NULL;
+        if (!run->ops->wait(run->queue, BENCH_WAIT_TIMEOUT_US, &frame))
+        {
+            continue;
+        }
+
+        const gint64 now = g_get_monotonic_time();
+        if (run->n_latencies < run->n_frames)
+        {
+            run->latencies[run->n_latencies++] = now - (gint64) drd_frame_get_timestamp(frame);
+        }
+        g_object_unref(frame);
+        bench_spin(run->scenario->consume_work_us);
+    }
+    return NULL;
+}
+
+static int
+bench_compare_latency(const void *a, const void *b)
+{
+    const gint64 x = *(const gint64 *) a;
+    const gint64 y = *(const gint64 *) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * 功能：在一个场景下运行一种队列实现并打印结果。
+ * 逻辑：启动生产者与消费者线程，等待结束后对延迟排序，输出交付数、丢帧数与平均/中位/p99/最大延迟。
+ * 参数：ops 队列实现；scenario 场景；n_frames 推入帧数。
+ * 外部接口：GLib g_thread_new/g_thread_join；C qsort。
+ */
+static void
+bench_run(const BenchQueueOps *ops, const BenchScenario *scenario, guint n_frames)
+{
+    BenchRun run = {0};
+    run.ops = ops;
+    run.scenario = scenario;
+    run.queue = ops->create();
+    run.n_frames = n_frames;
+    run.latencies = g_new0(gint64, n_frames);
+
+    GThread *consumer = g_thread_new("bench-consumer", bench_consumer, &run);
+    GThread *producer = g_thread_new("bench-producer", bench_producer, &run);
+    g_thread_join(producer);
+    g_thread_join(consumer);
+
+    gint64 sum = 0;
+    gint64 p50 = 0;
+    gint64 p99 = 0;
+    gint64 max = 0;
+    if (run.n_latencies > 0)
+    {
+        qsort(run.latencies, run.n_latencies, sizeof(gint64), bench_compare_latency);
+        for (guint i = 0; i < run.n_latencies; ++i)
+        {
+            sum += run.latencies[i];
+        }
+        p50 = run.latencies[run.n_latencies / 2];
+        p99 = run.latencies[MIN(run.n_latencies - 1, (guint) ((guint64) run.n_latencies * 99 / 100))];
+        max = run.latencies[run.n_latencies - 1];
+    }
+
+    g_print("%-9s %-10s %8u %10u %8" G_GUINT64_FORMAT " %9.1f %8" G_GINT64_FORMAT " %8" G_GINT64_FORMAT
+            " %8" G_GINT64_FORMAT "\n",
+            scenario->name, ops->name, n_frames, run.n_latencies, ops->get_dropped(run.queue),
+            run.n_latencies > 0 ? (gdouble) sum / run.n_latencies : 0.0, p50, p99, max);
+
+    ops->destroy(run.queue);
+    g_free(run.latencies);
+}
+
+int
+main(int argc, char **argv)
+{
+    guint n_frames = BENCH_DEFAULT_FRAMES;
+    if (argc > 1)
+    {
+        n_frames = (guint) MAX(strtoul(argv[1], NULL, 10), 1ul);
+    }
+
+    g_print("%-9s %-10s %8s %10s %8s %9s %8s %8s %8s\n", "scenario", "queue", "pushed", "delivered", "dropped",
+            "mean(us)", "p50(us)", "p99(us)", "max(us)");
+    for (guint s = 0; s < G_N_ELEMENTS(bench_scenarios); ++s)
+    {
+        for (guint q = 0; q < G_N_ELEMENTS(bench_queues); ++q)
+        {
+            bench_run(&bench_queues[q], &bench_scenarios[s], n_frames);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * 编码循环分配测试：软件 AVC420 路径上的稳态帧（差分分析、区域元数据、时间戳与发送）不分配堆内存。
+ * GLib 2.46 起 g_mem_set_vtable 不再生效，因此直接以计数版 malloc 族替换 glibc 分配器，统计计数窗口内全部线程的分配次数。
+ * FreeRDP 的 avc420_compress 经链接器 --wrap 换成返回固定码流的桩，其内部分配不属于本模块；Rdpgfx 上下文只提供空的 SurfaceFrameCommand。
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "encoding/drd_encoding_manager.h"
+
+#define TEST_FRAME_WIDTH 320
+#define TEST_FRAME_HEIGHT 192
+#define TEST_FRAME_STRIDE (TEST_FRAME_WIDTH * 4)
+#define TEST_WARMUP_FRAMES 8
+#define TEST_STEADY_FRAMES 64
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n_members, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+static gint test_counting = FALSE;
+static gint test_allocations = 0;
+static guint test_surface_commands = 0;
+static guint8 test_bitstream[64];
+
+/*
+ * 功能：在计数窗口内累计一次分配。
+ * 逻辑：只做原子读写，不调用任何可能再次分配的函数。
+ * 参数：无。
+ * 外部接口：GLib g_atomic_int_get/g_atomic_int_inc。
+ */
+static void
+test_note_allocation(void)
+{
+    if (g_atomic_int_get(&test_counting))
+    {
+        g_atomic_int_inc(&test_allocations);
+    }
+}
+
+void *
+malloc(size_t size)
+{
+    test_note_allocation();
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t n_members, size_t size)
+{
+    test_note_allocation();
+    return __libc_calloc(n_members, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    test_note_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+void *
+memalign(size_t alignment, size_t size)
+{
+    test_note_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size)
+{
+    test_note_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int
+posix_memalign(void **out, size_t alignment, size_t size)
+{
+    test_note_allocation();
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr == NULL)
+    {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void
+free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+/*
+ * 功能：替代 FreeRDP 软件 H264 编码的桩。
+ * 逻辑：返回静态码流与空元数据，编码管理器随后用自己的区域元数据替换。
+ * 参数：同 avc420_compress。
+ * 外部接口：链接参数 -Wl,--wrap=avc420_compress。
+ */
+INT32
+__wrap_avc420_compress(H264_CONTEXT *h264, const BYTE *pSrcData, DWORD SrcFormat, UINT32 nSrcStep, UINT32 nSrcWidth,
+                       UINT32 nSrcHeight, const RECTANGLE_16 *regionRect, BYTE **ppDstData, UINT32 *pDstSize,
+                       RDPGFX_H264_METABLOCK *meta)
+{
+    *ppDstData = test_bitstream;
+    *pDstSize = sizeof(test_bitstream);
+    memset(meta, 0, sizeof(*meta));
+    return 1;
+}
+
+static UINT
+test_surface_frame_command(RdpgfxServerContext *context, const RDPGFX_SURFACE_COMMAND *cmd,
+                           const RDPGFX_START_FRAME_PDU *start, const RDPGFX_END_FRAME_PDU *end)
+{
+    test_surface_commands++;
+    return CHANNEL_RC_OK;
+}
+
+/*
+ * 功能：创建测试帧。
+ * 逻辑：填充按坐标变化的图案，避免纯色 tile；invert 为 TRUE 时把一个 tile 内的方块取反，作为两帧之间的变化。
+ * 参数：invert 是否取反方块；timestamp 帧时间戳。
+ * 外部接口：drd_frame_new/drd_frame_configure/drd_frame_ensure_capacity。
+ */
+static DrdFrame *
+test_frame_new(gboolean invert, guint64 timestamp)
+{
+    DrdFrame *frame = drd_frame_new();
+    drd_frame_configure(frame, TEST_FRAME_WIDTH, TEST_FRAME_HEIGHT, TEST_FRAME_STRIDE, timestamp);
+    guint8 *data = drd_frame_ensure_capacity(frame, (gsize) TEST_FRAME_STRIDE * TEST_FRAME_HEIGHT);
+
+    for (guint y = 0; y < TEST_FRAME_HEIGHT; ++y)
+    {
+        for (guint x = 0; x < TEST_FRAME_WIDTH; ++x)
+        {
+            guint8 *px = data + (gsize) y * TEST_FRAME_STRIDE + x * 4;
+            const gboolean block = invert && x >= 70 && x < 118 && y >= 70 && y < 118;
+            px[0] = (guint8) (block ? ~(x * 3) : x * 3);
+            px[1] = (guint8) (block ? ~(y * 5) : y * 5);
+            px[2] = (guint8) (block ? ~(x ^ y) : x ^ y);
+            px[3] = 0xFF;
+        }
+    }
+    return frame;
+}
+
+/*
+ * 功能：预热后在计数窗口内编码稳态帧并检查分配次数。
+ * 逻辑：预热帧让持久数组、编码器上下文与时区数据就位；计数窗口内不调用任何测试断言，失败在窗口结束后统一检查，
+ *       断言分配次数为 0、每帧都成功发送。
+ * 参数：manager 已编码过首帧的管理器；settings/context 会话设置与 Rdpgfx 上下文；frames 交替编码的两帧；frame_id 下一帧号。
+ * 外部接口：drd_encoding_manager_encode_surface_gfx。
+ */
+static void
+test_encode_steady_state(DrdEncodingManager *manager, rdpSettings *settings, RdpgfxServerContext *context,
+                         DrdFrame **frames, guint32 frame_id)
+{
+    gboolean h264 = FALSE;
+
+    for (guint i = 1; i < TEST_WARMUP_FRAMES; ++i)
+    {
+        g_autoptr(GError) error = NULL;
+        g_assert_true(drd_encoding_manager_encode_surface_gfx(manager, settings, context, 1, frames[i % 2], frame_id++,
+                                                              &h264, FALSE, &error));
+    }
+
+    const guint commands_before = test_surface_commands;
+    guint failures = 0;
+    g_atomic_int_set(&test_allocations, 0);
+    g_atomic_int_set(&test_counting, TRUE);
+    for (guint i = 0; i < TEST_STEADY_FRAMES; ++i)
+    {
+        if (!drd_encoding_manager_encode_surface_gfx(manager, settings, context, 1, frames[i % 2], frame_id++, &h264,
+                                                     FALSE, NULL))
+        {
+            failures++;
+        }
+    }
+    g_atomic_int_set(&test_counting, FALSE);
+
+    g_assert_cmpuint(failures, ==, 0);
+    g_assert_cmpuint(test_surface_commands - commands_before, ==, TEST_STEADY_FRAMES);
+    g_assert_cmpint(g_atomic_int_get(&test_allocations), ==, 0);
+}
+
+/*
+ * 功能：验证软件 AVC420 稳态帧零分配。
+ * 逻辑：准备 H264 模式、关闭硬件加速的编码管理器，首帧为关键帧；随后交替编码两帧检查稳态分配。
+ *       FreeRDP 没有可用的 H264 编码后端时首帧失败，跳过测试。
+ * 参数：无。
+ * 外部接口：drd_encoding_manager_prepare/encode_surface_gfx；FreeRDP freerdp_settings_*。
+ */
+static void
+test_software_avc420_steady_state(void)
+{
+    g_autoptr(GError) error = NULL;
+    DrdEncodingManager *manager = drd_encoding_manager_new();
+    RdpgfxServerContext context;
+    DrdFrame *frames[2] = {test_frame_new(FALSE, 1), test_frame_new(TRUE, 2)};
+    rdpSettings *settings = freerdp_settings_new(0);
+    gboolean h264 = FALSE;
+
+    g_assert_nonnull(settings);
+    g_assert_true(freerdp_settings_set_bool(settings, FreeRDP_GfxH264, TRUE));
+    g_assert_true(freerdp_settings_set_bool(settings, FreeRDP_GfxAVC444, FALSE));
+    g_assert_true(freerdp_settings_set_bool(settings, FreeRDP_GfxAVC444v2, FALSE));
+    g_assert_true(freerdp_settings_set_bool(settings, FreeRDP_GfxProgressive, FALSE));
+    g_assert_true(freerdp_settings_set_bool(settings, FreeRDP_RemoteFxCodec, FALSE));
+
+    memset(&context, 0, sizeof(context));
+    context.SurfaceFrameCommand = test_surface_frame_command;
+
+    const DrdEncodingOptions options = {
+        .width = TEST_FRAME_WIDTH,
+        .height = TEST_FRAME_HEIGHT,
+        .mode = DRD_ENCODING_MODE_H264,
+        .enable_frame_diff = TRUE,
+        .h264_bitrate = DRD_H264_DEFAULT_BITRATE,
+        .h264_framerate = DRD_H264_DEFAULT_FRAMERATE,
+        .h264_qp = DRD_H264_DEFAULT_QP,
+        .h264_hw_accel = FALSE,
+        .h264_vm_support = FALSE,
+        .gfx_large_change_threshold = DRD_GFX_DEFAULT_LARGE_CHANGE_THRESHOLD,
+        .gfx_progressive_refresh_interval = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_INTERVAL,
+        .gfx_progressive_refresh_timeout_ms = DRD_GFX_DEFAULT_PROGRESSIVE_REFRESH_TIMEOUT_MS,
+        .gfx_damage_full_scan_interval = DRD_GFX_DEFAULT_DAMAGE_FULL_SCAN_INTERVAL,
+        .scale_to_client = FALSE,
+    };
+    g_assert_true(drd_encoding_manager_prepare(manager, &options, &error));
+
+    guint32 frame_id = 0;
+    if (drd_encoding_manager_encode_surface_gfx(manager, settings, &context, 1, frames[0], frame_id++, &h264, FALSE,
+                                                &error))
+    {
+        g_assert_true(h264);
+        test_encode_steady_state(manager, settings, &context, frames, frame_id);
+    }
+    else
+    {
+        g_test_skip(error->message);
+    }
+
+    freerdp_settings_free(settings);
+    g_object_unref(frames[0]);
+    g_object_unref(frames[1]);
+    g_object_unref(manager);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/encoding/software-avc420-no-steady-state-allocations", test_software_avc420_steady_state);
+    return g_test_run();
+}
@@ -0,0 +1,299 @@
+/*
+ * 帧缩放测试：按公式逐字节计算的参考结果校验每个编译进来且当前 CPU 支持的行混合内核，
+ * 覆盖 SIMD 宽度前后的长度与非对齐地址；并验证只重新采样损坏区域、输出缓冲只同步过期矩形后的输出
+ * 与整帧缩放逐字节一致，包括下游持有全部输出缓冲时的退回路径。
+ * 直接包含实现文件以切换内核。
+ */
+#include "encoding/drd_frame_scaler.c"
+
+/* 行尾多留的字节，混合后必须保持哨兵值 */
+#define TEST_ROW_PADDING 40
+#define TEST_SENTINEL 0xA5
+#define TEST_SEED 0x5ca1e0u
+#define TEST_SRC_WIDTH 333
+#define TEST_SRC_HEIGHT 217
+#define TEST_BUFFERS 3
+
+typedef struct
+{
+    const gchar *name;
+    DrdFrameScalerBlendFunc blend;
+} TestKernel;
+
+static const gsize test_lengths[] = {0, 1, 3, 4, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000, 4097};
+static const guint test_weights[] = {1, 2, 64, 127, 128, 129, 200, 254, 255};
+static const guint test_stream_sizes[][2] = {{200, 120}, {166, 108}, {500, 301}};
+
+static TestKernel test_kernels[3];
+static guint test_n_kernels = 0;
+
+/*
+ * 功能：收集待测内核。
+ * 逻辑：通用实现总是参与，按编译条件与 CPU 特性加入 AVX2、NEON 内核。
+ * 参数：无。
+ * 外部接口：GCC __builtin_cpu_supports。
+ */
+static void
+test_collect_kernels(void)
+{
+    test_kernels[test_n_kernels++] = (TestKernel) {"scalar", drd_frame_scaler_blend_rows_scalar};
+#if defined(DRD_FRAME_SCALER_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        test_kernels[test_n_kernels++] = (TestKernel) {"avx2", drd_frame_scaler_blend_rows_avx2};
+    }
+#elif defined(DRD_FRAME_SCALER_HAVE_NEON)
+    test_kernels[test_n_kernels++] = (TestKernel) {"neon", drd_frame_scaler_blend_rows_neon};
+#endif
+}
+
+static void
+test_fill_random(guint8 *data, gsize size, GRand *rand)
+{
+    for (gsize i = 0; i < size; ++i)
+    {
+        data[i] = (guint8) g_rand_int(rand);
+    }
+}
+
+/*
+ * 功能：行混合与参考公式一致。
+ * 逻辑：每个内核、每个长度与权重，以 0..3 字节的偏移制造非对齐地址，逐字节比较 (a * (256 - w) + b * w) >> 8，
+ *       并检查输出之后的字节保持哨兵值。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_blend_rows(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED);
+    const gsize capacity = test_lengths[G_N_ELEMENTS(test_lengths) - 1] + TEST_ROW_PADDING;
+    guint8 *row_a = g_malloc(capacity);
+    guint8 *row_b = g_malloc(capacity);
+    guint8 *dst = g_malloc(capacity);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        for (guint l = 0; l < G_N_ELEMENTS(test_lengths); ++l)
+        {
+            for (guint w = 0; w < G_N_ELEMENTS(test_weights); ++w)
+            {
+                const gsize n = test_lengths[l];
+                const guint weight = test_weights[w];
+                const gsize offset = (l + w) % 4;
+                test_fill_random(row_a, capacity, rand);
+                test_fill_random(row_b, capacity, rand);
+                memset(dst, TEST_SENTINEL, capacity);
+
+                test_kernels[k].blend(dst + offset, row_a + offset, row_b + offset, n, weight);
+
+                for (gsize i = 0; i < n; ++i)
+                {
+                    const guint8 expected = (guint8) ((row_a[offset + i] * (256 - weight) +
+                                                       row_b[offset + i] * weight) >> 8);
+                    if (dst[offset + i] != expected)
+                    {
+                        g_test_message("%s: length %" G_GSIZE_FORMAT " weight %u differs at byte %" G_GSIZE_FORMAT,
+                                       test_kernels[k].name, n, weight, i);
+                        g_assert_cmpuint(dst[offset + i], ==, expected);
+                    }
+                }
+                for (gsize i = offset + n; i < capacity; ++i)
+                {
+                    g_assert_cmpuint(dst[i], ==, TEST_SENTINEL);
+                }
+            }
+        }
+    }
+
+    g_free(dst);
+    g_free(row_b);
+    g_free(row_a);
+    g_rand_free(rand);
+}
+
+/*
+ * 功能：创建引用测试源像素的帧。
+ * 逻辑：配置桌面尺寸后包装源像素，n_damage 为 0 时不带损坏信息（按整帧处理）。
+ * 参数：src 源像素；damage/n_damage 损坏矩形。
+ * 外部接口：drd_frame_new/drd_frame_configure/drd_frame_wrap_data/drd_frame_set_damage。
+ */
+static DrdFrame *
+test_source_frame(const guint8 *src, const DrdFrameRect *damage, guint n_damage)
+{
+    DrdFrame *frame = drd_frame_new();
+    drd_frame_configure(frame, TEST_SRC_WIDTH, TEST_SRC_HEIGHT, TEST_SRC_WIDTH * 4, 0);
+    drd_frame_wrap_data(frame, src, (gsize) TEST_SRC_WIDTH * 4 * TEST_SRC_HEIGHT, NULL, NULL);
+    if (n_damage > 0)
+    {
+        drd_frame_set_damage(frame, damage, n_damage);
+    }
+    return frame;
+}
+
+/*
+ * 功能：比较增量缩放的输出与同一源整帧缩放的结果。
+ * 逻辑：用新建的缩放器整帧缩放源像素作为参考，逐字节比较。
+ * 参数：scaled 增量输出；src 源像素；width/height 流尺寸；what 用于断言信息。
+ * 外部接口：drd_frame_scaler_new/drd_frame_scaler_process；GLib GTest。
+ */
+static void
+test_assert_matches_full(DrdFrame *scaled, const guint8 *src, guint width, guint height, const gchar *what)
+{
+    g_autoptr(DrdFrameScaler) reference = drd_frame_scaler_new(width, height, 2);
+    g_autoptr(DrdFrame) source = test_source_frame(src, NULL, 0);
+    g_autoptr(DrdFrame) expected = drd_frame_scaler_process(reference, source);
+
+    gsize size = 0;
+    gsize expected_size = 0;
+    const guint8 *data = drd_frame_get_data(scaled, &size);
+    const guint8 *expected_data = drd_frame_get_data(expected, &expected_size);
+    g_assert_cmpuint(size, ==, expected_size);
+    for (gsize i = 0; i < size; ++i)
+    {
+        if (data[i] != expected_data[i])
+        {
+            g_test_message("%s: %ux%u differs at row %" G_GSIZE_FORMAT " col %" G_GSIZE_FORMAT, what, width, height,
+                           i / ((gsize) width * 4), i % ((gsize) width * 4) / 4);
+            g_assert_cmpuint(data[i], ==, expected_data[i]);
+        }
+    }
+}
+
+/*
+ * 功能：只重新采样损坏区域的输出与整帧缩放一致。
+ * 逻辑：先整帧缩放一帧，随后每帧把若干随机矩形的源像素换成新内容并作为损坏信息传入；下游持有最近的
+ *       TEST_BUFFERS - 1 个输出帧（模拟编码器），输出缓冲轮换时只同步过期矩形，每帧都与整帧缩放逐字节比较。
+ * 参数：无。
+ * 外部接口：drd_frame_scaler_new/drd_frame_scaler_process；GLib GTest。
+ */
+static void
+test_damage_matches_full(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED + 1);
+    const gsize src_size = (gsize) TEST_SRC_WIDTH * 4 * TEST_SRC_HEIGHT;
+    guint8 *src = g_malloc(src_size);
+
+    for (guint s = 0; s < G_N_ELEMENTS(test_stream_sizes); ++s)
+    {
+        const guint width = test_stream_sizes[s][0];
+        const guint height = test_stream_sizes[s][1];
+        g_autoptr(DrdFrameScaler) scaler = drd_frame_scaler_new(width, height, TEST_BUFFERS);
+        DrdFrame *held[TEST_BUFFERS - 1] = {NULL};
+
+        test_fill_random(src, src_size, rand);
+        for (guint n = 0; n < 48; ++n)
+        {
+            DrdFrameRect damage[4];
+            const guint n_damage = n == 0 ? 0 : (guint) g_rand_int_range(rand, 1, G_N_ELEMENTS(damage) + 1);
+            for (guint d = 0; d < n_damage; ++d)
+            {
+                DrdFrameRect *rect = &damage[d];
+                rect->x = (guint) g_rand_int_range(rand, 0, TEST_SRC_WIDTH);
+                rect->y = (guint) g_rand_int_range(rand, 0, TEST_SRC_HEIGHT);
+                rect->width = (guint) g_rand_int_range(rand, 1, (gint32) MIN(TEST_SRC_WIDTH - rect->x, 64u) + 1);
+                rect->height = (guint) g_rand_int_range(rand, 1, (gint32) MIN(TEST_SRC_HEIGHT - rect->y, 64u) + 1);
+                for (guint row = rect->y; row < rect->y + rect->height; ++row)
+                {
+                    test_fill_random(src + (gsize) row * TEST_SRC_WIDTH * 4 + (gsize) rect->x * 4,
+                                     (gsize) rect->width * 4, rand);
+                }
+            }
+
+            g_autoptr(DrdFrame) source = test_source_frame(src, damage, n_damage);
+            DrdFrame *scaled = drd_frame_scaler_process(scaler, source);
+            g_assert_nonnull(scaled);
+            g_assert_cmpuint(drd_frame_get_width(scaled), ==, width);
+            g_assert_cmpuint(drd_frame_get_height(scaled), ==, height);
+            test_assert_matches_full(scaled, src, width, height, "damage");
+
+            g_clear_object(&held[n % G_N_ELEMENTS(held)]);
+            held[n % G_N_ELEMENTS(held)] = scaled;
+        }
+
+        for (guint i = 0; i < G_N_ELEMENTS(held); ++i)
+        {
+            g_clear_object(&held[i]);
+        }
+    }
+
+    g_free(src);
+    g_rand_free(rand);
+}
+
+/*
+ * 功能：下游持有全部输出缓冲时输出仍然正确。
+ * 逻辑：持有 TEST_BUFFERS 个输出帧后继续缩放带损坏信息的帧，应退回独立帧并与整帧缩放一致；
+ *       释放后重新使用缓冲环，结果同样一致。退回路径会告警，本用例内告警不视为致命。
+ * 参数：无。
+ * 外部接口：drd_frame_scaler_new/drd_frame_scaler_process；GLib g_log_set_always_fatal、GTest。
+ */
+static void
+test_buffers_exhausted(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED + 2);
+    const gsize src_size = (gsize) TEST_SRC_WIDTH * 4 * TEST_SRC_HEIGHT;
+    guint8 *src = g_malloc(src_size);
+    const guint width = test_stream_sizes[0][0];
+    const guint height = test_stream_sizes[0][1];
+    g_autoptr(DrdFrameScaler) scaler = drd_frame_scaler_new(width, height, TEST_BUFFERS);
+    DrdFrame *held[TEST_BUFFERS + 2] = {NULL};
+    const GLogLevelFlags fatal = g_log_set_always_fatal(G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+
+    test_fill_random(src, src_size, rand);
+    for (guint n = 0; n < G_N_ELEMENTS(held) + 1; ++n)
+    {
+        const DrdFrameRect damage = {(n * 37) % (TEST_SRC_WIDTH - 40), (n * 23) % (TEST_SRC_HEIGHT - 30), 40, 30};
+        for (guint row = damage.y; row < damage.y + damage.height; ++row)
+        {
+            test_fill_random(src + (gsize) row * TEST_SRC_WIDTH * 4 + (gsize) damage.x * 4, (gsize) damage.width * 4,
+                             rand);
+        }
+
+        g_autoptr(DrdFrame) source = test_source_frame(src, &damage, n == 0 ? 0 : 1);
+        DrdFrame *scaled = drd_frame_scaler_process(scaler, source);
+        test_assert_matches_full(scaled, src, width, height, "exhausted");
+        if (n < G_N_ELEMENTS(held))
+        {
+            held[n] = scaled;
+            continue;
+        }
+
+        g_object_unref(scaled);
+        for (guint i = 0; i < G_N_ELEMENTS(held); ++i)
+        {
+            g_clear_object(&held[i]);
+        }
+    }
+
+    /* 退回后的第一帧整帧采样，之后恢复只同步过期矩形 */
+    for (guint n = 0; n < TEST_BUFFERS; ++n)
+    {
+        const DrdFrameRect damage = {5 + n * 50, 5 + n * 30, 20, 20};
+        test_fill_random(src + (gsize) (damage.y + 5) * TEST_SRC_WIDTH * 4 + (gsize) (damage.x + 5) * 4, 40, rand);
+        g_autoptr(DrdFrame) source = test_source_frame(src, &damage, 1);
+        g_autoptr(DrdFrame) scaled = drd_frame_scaler_process(scaler, source);
+        test_assert_matches_full(scaled, src, width, height, "released");
+    }
+
+    g_log_set_always_fatal(fatal);
+    g_free(src);
+    g_rand_free(rand);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    test_collect_kernels();
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        g_test_message("Frame scaler kernel under test: %s", test_kernels[k].name);
+    }
+
+    g_test_add_func("/frame-scaler/blend-rows", test_blend_rows);
+    g_test_add_func("/frame-scaler/damage-matches-full", test_damage_matches_full);
+    g_test_add_func("/frame-scaler/buffers-exhausted", test_buffers_exhausted);
+    return g_test_run();
+}
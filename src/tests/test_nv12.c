@@ -0,0 +1,363 @@
+/*
+ * BGRX→NV12 转换测试：按公式逐像素计算的参考结果校验每个编译进来且当前 CPU 支持的内核，
+ * 覆盖奇数帧宽高与帧边缘的奇数尺寸区域，并验证分块转换与整帧转换逐字节一致、区域外字节保持不变。
+ * 直接包含实现文件以切换内核。
+ */
+#include "encoding/drd_nv12.c"
+
+/* 目标平面行尾多留的字节，转换后必须保持哨兵值 */
+#define TEST_PLANE_PADDING 24
+#define TEST_SENTINEL 0xA5
+#define TEST_SEED 0x0e1f2a3bu
+
+typedef struct
+{
+    const gchar *name;
+    DrdNv12RowsFunc rows;
+} TestKernel;
+
+typedef struct
+{
+    guint width;
+    guint height;
+    guint src_stride;
+    guint y_stride;
+    guint uv_stride;
+    guint8 *src;
+    guint8 *y;
+    guint8 *uv;
+} TestFrame;
+
+static const guint test_sizes[][2] = {
+    {1, 1}, {2, 2}, {3, 5}, {7, 3}, {16, 2}, {17, 9}, {33, 31}, {64, 64}, {65, 65}, {127, 66}, {200, 137}, {257, 129},
+};
+
+static TestKernel test_kernels[3];
+static guint test_n_kernels = 0;
+
+/*
+ * 功能：收集待测内核。
+ * 逻辑：通用实现总是参与，按编译条件与 CPU 特性加入 AVX2、NEON 内核。
+ * 参数：无。
+ * 外部接口：GCC __builtin_cpu_supports。
+ */
+static void
+test_collect_kernels(void)
+{
+    test_kernels[test_n_kernels++] = (TestKernel) {"scalar", drd_nv12_rows_scalar};
+#if defined(DRD_NV12_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        test_kernels[test_n_kernels++] = (TestKernel) {"avx2", drd_nv12_rows_avx2};
+    }
+#elif defined(DRD_NV12_HAVE_NEON)
+    test_kernels[test_n_kernels++] = (TestKernel) {"neon", drd_nv12_rows_neon};
+#endif
+}
+
+/*
+ * 功能：让 drd_nv12_convert 使用指定内核。
+ * 逻辑：先完成一次正常的内核选择，再覆盖选中的实现。
+ * 参数：kernel 待测内核。
+ * 外部接口：drd_nv12_get_kernel_name。
+ */
+static void
+test_use_kernel(const TestKernel *kernel)
+{
+    drd_nv12_get_kernel_name();
+    drd_nv12_rows_impl = kernel->rows;
+}
+
+/*
+ * 功能：分配测试帧，源像素随机，目标平面填哨兵值。
+ * 逻辑：源行跨度与目标行跨度都带额外字节；约八分之一的像素取通道全 0 或全 255 的极值。
+ * 参数：frame 输出；width/height 帧尺寸；rand 随机源。
+ * 外部接口：GLib g_malloc/g_rand_int。
+ */
+static void
+test_frame_init(TestFrame *frame, guint width, guint height, GRand *rand)
+{
+    frame->width = width;
+    frame->height = height;
+    frame->src_stride = width * 4 + 20;
+    frame->y_stride = width + TEST_PLANE_PADDING;
+    frame->uv_stride = (width + 1) / 2 * 2 + TEST_PLANE_PADDING;
+    frame->src = g_malloc((gsize) frame->src_stride * height);
+    frame->y = g_malloc((gsize) frame->y_stride * height);
+    frame->uv = g_malloc((gsize) frame->uv_stride * ((height + 1) / 2));
+
+    for (gsize i = 0; i < (gsize) frame->src_stride * height; i += 4)
+    {
+        const guint32 value = g_rand_int(rand);
+        const guint extreme = g_rand_int(rand) % 16;
+        for (guint c = 0; c < 4; ++c)
+        {
+            frame->src[i + c] = extreme == 0 ? 0x00 : extreme == 1 ? 0xFF : (guint8) (value >> (c * 8));
+        }
+    }
+    memset(frame->y, TEST_SENTINEL, (gsize) frame->y_stride * height);
+    memset(frame->uv, TEST_SENTINEL, (gsize) frame->uv_stride * ((height + 1) / 2));
+}
+
+static void
+test_frame_clear(TestFrame *frame)
+{
+    g_free(frame->src);
+    g_free(frame->y);
+    g_free(frame->uv);
+}
+
+static guint8 *
+test_copy_plane(const guint8 *plane, gsize size)
+{
+    guint8 *copy = g_malloc(size);
+    memcpy(copy, plane, size);
+    return copy;
+}
+
+/*
+ * 功能：按公式逐像素计算 NV12 参考结果。
+ * 逻辑：亮度逐像素计算；每个色度样本取 2x2 块的通道和，帧右侧或底部不足两列（行）时该列（行）与自身配对，
+ *       通道和四舍五入取平均后套用 BT.601 有限范围公式。不依赖任何内核。
+ * 参数：frame 测试帧；y/uv 输出平面，行跨度同 frame。
+ * 外部接口：无。
+ */
+static void
+test_reference_convert(const TestFrame *frame, guint8 *y, guint8 *uv)
+{
+    for (guint row = 0; row < frame->height; ++row)
+    {
+        for (guint col = 0; col < frame->width; ++col)
+        {
+            const guint8 *px = frame->src + (gsize) row * frame->src_stride + (gsize) col * 4;
+            y[(gsize) row * frame->y_stride + col] =
+                    (guint8) (((66 * px[2] + 129 * px[1] + 25 * px[0] + 128) >> 8) + 16);
+        }
+    }
+
+    for (guint cy = 0; cy < (frame->height + 1) / 2; ++cy)
+    {
+        for (guint cx = 0; cx < (frame->width + 1) / 2; ++cx)
+        {
+            const guint xs[2] = {cx * 2, MIN(cx * 2 + 1, frame->width - 1)};
+            const guint ys[2] = {cy * 2, MIN(cy * 2 + 1, frame->height - 1)};
+            gint sum[3] = {0, 0, 0};
+            for (guint j = 0; j < 2; ++j)
+            {
+                for (guint i = 0; i < 2; ++i)
+                {
+                    const guint8 *px = frame->src + (gsize) ys[j] * frame->src_stride + (gsize) xs[i] * 4;
+                    for (guint c = 0; c < 3; ++c)
+                    {
+                        sum[c] += px[c];
+                    }
+                }
+            }
+            const gint b = (sum[0] + 2) >> 2;
+            const gint g = (sum[1] + 2) >> 2;
+            const gint r = (sum[2] + 2) >> 2;
+            guint8 *out = uv + (gsize) cy * frame->uv_stride + (gsize) cx * 2;
+            /* 加 128 << 8 使移位前为正，等价于 floor((值 + 128) / 256) + 128 */
+            out[0] = (guint8) ((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+            out[1] = (guint8) ((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+        }
+    }
+}
+
+/*
+ * 功能：转换帧的一个区域。
+ * 逻辑：转发给 drd_nv12_convert。
+ * 参数：frame 测试帧；x/y/width/height 区域。
+ * 外部接口：drd_nv12_convert。
+ */
+static void
+test_convert(TestFrame *frame, guint x, guint y, guint width, guint height)
+{
+    drd_nv12_convert(frame->src, frame->src_stride, frame->width, frame->height, frame->y, frame->y_stride, frame->uv,
+                     frame->uv_stride, x, y, width, height);
+}
+
+/*
+ * 功能：比较测试帧的两个平面与期望平面，包括行尾哨兵。
+ * 逻辑：逐字节比较，失败时给出首个不同字节所在的行与列。
+ * 参数：frame 测试帧；y/uv 期望平面；what 用于断言信息。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_assert_planes(const TestFrame *frame, const guint8 *y, const guint8 *uv, const gchar *what)
+{
+    const gsize y_size = (gsize) frame->y_stride * frame->height;
+    const gsize uv_size = (gsize) frame->uv_stride * ((frame->height + 1) / 2);
+
+    for (gsize i = 0; i < y_size; ++i)
+    {
+        if (frame->y[i] != y[i])
+        {
+            g_test_message("%s: %ux%u luma differs at row %" G_GSIZE_FORMAT " col %" G_GSIZE_FORMAT, what,
+                           frame->width, frame->height, i / frame->y_stride, i % frame->y_stride);
+            g_assert_cmpuint(frame->y[i], ==, y[i]);
+        }
+    }
+    for (gsize i = 0; i < uv_size; ++i)
+    {
+        if (frame->uv[i] != uv[i])
+        {
+            g_test_message("%s: %ux%u chroma differs at row %" G_GSIZE_FORMAT " byte %" G_GSIZE_FORMAT, what,
+                           frame->width, frame->height, i / frame->uv_stride, i % frame->uv_stride);
+            g_assert_cmpuint(frame->uv[i], ==, uv[i]);
+        }
+    }
+}
+
+/*
+ * 功能：整帧转换与参考结果一致。
+ * 逻辑：每个内核、每种帧尺寸各转换一次整帧，行尾哨兵保持不变。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_full_frame(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        test_use_kernel(&test_kernels[k]);
+        for (guint s = 0; s < G_N_ELEMENTS(test_sizes); ++s)
+        {
+            TestFrame frame;
+            test_frame_init(&frame, test_sizes[s][0], test_sizes[s][1], rand);
+            guint8 *y = test_copy_plane(frame.y, (gsize) frame.y_stride * frame.height);
+            guint8 *uv = test_copy_plane(frame.uv, (gsize) frame.uv_stride * ((frame.height + 1) / 2));
+
+            test_reference_convert(&frame, y, uv);
+            test_convert(&frame, 0, 0, frame.width, frame.height);
+            test_assert_planes(&frame, y, uv, test_kernels[k].name);
+
+            g_free(uv);
+            g_free(y);
+            test_frame_clear(&frame);
+        }
+    }
+
+    g_rand_free(rand);
+}
+
+/*
+ * 功能：按 64 像素 tile 分块转换与整帧转换逐字节一致。
+ * 逻辑：目标平面先填哨兵，再逐 tile 转换整帧，右侧与底部的 tile 尺寸随帧尺寸为奇数；结果应与参考整帧相同。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_tiles_match_frame(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED + 1);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        test_use_kernel(&test_kernels[k]);
+        for (guint s = 0; s < G_N_ELEMENTS(test_sizes); ++s)
+        {
+            TestFrame frame;
+            test_frame_init(&frame, test_sizes[s][0], test_sizes[s][1], rand);
+            guint8 *y = test_copy_plane(frame.y, (gsize) frame.y_stride * frame.height);
+            guint8 *uv = test_copy_plane(frame.uv, (gsize) frame.uv_stride * ((frame.height + 1) / 2));
+
+            test_reference_convert(&frame, y, uv);
+            for (guint ty = 0; ty < frame.height; ty += 64)
+            {
+                for (guint tx = 0; tx < frame.width; tx += 64)
+                {
+                    test_convert(&frame, tx, ty, MIN(64u, frame.width - tx), MIN(64u, frame.height - ty));
+                }
+            }
+            test_assert_planes(&frame, y, uv, test_kernels[k].name);
+
+            g_free(uv);
+            g_free(y);
+            test_frame_clear(&frame);
+        }
+    }
+
+    g_rand_free(rand);
+}
+
+/*
+ * 功能：只转换变化区域后与整帧转换新帧的结果一致。
+ * 逻辑：先整帧转换旧帧，再把随机区域（偶数起点，宽高为偶数或延伸到帧边缘）的源像素换成新内容，
+ *       只转换该区域；结果应与新帧的参考整帧相同，即区域外的字节保持不变。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_region_update(void)
+{
+    GRand *rand = g_rand_new_with_seed(TEST_SEED + 2);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        test_use_kernel(&test_kernels[k]);
+        for (guint s = 0; s < G_N_ELEMENTS(test_sizes); ++s)
+        {
+            TestFrame frame;
+            test_frame_init(&frame, test_sizes[s][0], test_sizes[s][1], rand);
+            guint8 *y = g_malloc((gsize) frame.y_stride * frame.height);
+            guint8 *uv = g_malloc((gsize) frame.uv_stride * ((frame.height + 1) / 2));
+            test_convert(&frame, 0, 0, frame.width, frame.height);
+
+            for (guint n = 0; n < 32; ++n)
+            {
+                const guint x = (guint) g_rand_int_range(rand, 0, (gint32) (frame.width + 1) / 2) * 2;
+                const guint top = (guint) g_rand_int_range(rand, 0, (gint32) (frame.height + 1) / 2) * 2;
+                guint width = (guint) g_rand_int_range(rand, 1, (gint32) (frame.width - x + 1));
+                guint height = (guint) g_rand_int_range(rand, 1, (gint32) (frame.height - top + 1));
+                if (x + width < frame.width && width % 2 != 0)
+                {
+                    width++;
+                }
+                if (top + height < frame.height && height % 2 != 0)
+                {
+                    height++;
+                }
+
+                for (guint row = top; row < top + height; ++row)
+                {
+                    guint8 *px = frame.src + (gsize) row * frame.src_stride + (gsize) x * 4;
+                    for (gsize i = 0; i < (gsize) width * 4; ++i)
+                    {
+                        px[i] = (guint8) g_rand_int(rand);
+                    }
+                }
+                memcpy(y, frame.y, (gsize) frame.y_stride * frame.height);
+                memcpy(uv, frame.uv, (gsize) frame.uv_stride * ((frame.height + 1) / 2));
+                test_reference_convert(&frame, y, uv);
+                test_convert(&frame, x, top, width, height);
+                test_assert_planes(&frame, y, uv, test_kernels[k].name);
+            }
+
+            g_free(uv);
+            g_free(y);
+            test_frame_clear(&frame);
+        }
+    }
+
+    g_rand_free(rand);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    test_collect_kernels();
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        g_test_message("NV12 kernel under test: %s", test_kernels[k].name);
+    }
+
+    g_test_add_func("/nv12/full-frame", test_full_frame);
+    g_test_add_func("/nv12/tiles-match-frame", test_tiles_match_frame);
+    g_test_add_func("/nv12/region-update", test_region_update);
+    return g_test_run();
+}
@@ -0,0 +1,299 @@
+/*
+ * tile 差分内核一致性测试：编译进来且当前 CPU 支持的每个 SIMD 内核以及运行时分派入口，
+ * 都与通用实现逐位比较哈希、相等与纯色判断。直接包含实现文件以访问各内核。
+ */
+#include "encoding/drd_tile_hash.c"
+
+/* 帧宽高不是 64 的倍数，行跨度带非 32 字节对齐的行尾填充，缓冲起点错开 4 字节 */
+#define TEST_FRAME_WIDTH 200
+#define TEST_FRAME_HEIGHT 136
+#define TEST_FRAME_STRIDE (TEST_FRAME_WIDTH * 4 + 12)
+#define TEST_FRAME_SIZE ((gsize) TEST_FRAME_STRIDE * TEST_FRAME_HEIGHT)
+#define TEST_RANDOM_TILES 20000
+#define TEST_SEED 0x5eed7113u
+
+typedef struct
+{
+    const gchar *name;
+    DrdTileHashFunc hash;
+    DrdTileEqualFunc equal;
+    DrdTileUniformFunc uniform;
+} TestKernel;
+
+typedef struct
+{
+    guint8 *storage;
+    guint8 *a;
+    guint8 *b;
+    GRand *rand;
+} TestFixture;
+
+static TestKernel test_kernels[4];
+static guint test_n_kernels = 0;
+
+/*
+ * 功能：收集待测内核。
+ * 逻辑：按编译条件与 CPU 特性加入 AVX2、SSE4.2、NEON 内核，最后加入运行时分派入口。
+ * 参数：无。
+ * 外部接口：GCC __builtin_cpu_supports。
+ */
+static void
+test_collect_kernels(void)
+{
+#if defined(DRD_TILE_HASH_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        test_kernels[test_n_kernels++] =
+                (TestKernel) {"avx2", drd_tile_hash_avx2, drd_tile_equal_avx2, drd_tile_uniform_avx2};
+    }
+#endif
+#if defined(DRD_TILE_HASH_HAVE_SSE42)
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        test_kernels[test_n_kernels++] =
+                (TestKernel) {"sse4.2", drd_tile_hash_sse42, drd_tile_equal_sse42, drd_tile_uniform_sse42};
+    }
+#endif
+#if defined(DRD_TILE_HASH_HAVE_NEON)
+    test_kernels[test_n_kernels++] =
+            (TestKernel) {"neon", drd_tile_hash_neon, drd_tile_equal_neon, drd_tile_uniform_neon};
+#endif
+    test_kernels[test_n_kernels++] = (TestKernel) {"dispatch", drd_tile_hash, drd_tile_equal, drd_tile_uniform};
+}
+
+/*
+ * 功能：准备两份相同的伪随机帧。
+ * 逻辑：固定种子填充 a，b 为 a 的副本；两帧共用一块存储并错开 4 字节起点。
+ * 参数：fixture 测试数据。
+ * 外部接口：GLib g_rand_new_with_seed/g_malloc。
+ */
+static void
+test_fixture_init(TestFixture *fixture)
+{
+    fixture->rand = g_rand_new_with_seed(TEST_SEED);
+    fixture->storage = g_malloc(TEST_FRAME_SIZE * 2 + 4);
+    fixture->a = fixture->storage + 4;
+    fixture->b = fixture->a + TEST_FRAME_SIZE;
+    for (gsize i = 0; i < TEST_FRAME_SIZE; ++i)
+    {
+        fixture->a[i] = (guint8) g_rand_int(fixture->rand);
+    }
+    memcpy(fixture->b, fixture->a, TEST_FRAME_SIZE);
+}
+
+static void
+test_fixture_clear(TestFixture *fixture)
+{
+    g_rand_free(fixture->rand);
+    g_free(fixture->storage);
+}
+
+/*
+ * 功能：随机选取帧内的一个 tile。
+ * 逻辑：宽高在 1..64 内均匀分布，四分之一的 tile 贴右下边缘。
+ * 参数：rand 随机源；tile 输出 x、y、宽、高。
+ * 外部接口：GLib g_rand_int_range。
+ */
+static void
+test_random_tile(GRand *rand, guint tile[4])
+{
+    tile[2] = (guint) g_rand_int_range(rand, 1, 65);
+    tile[3] = (guint) g_rand_int_range(rand, 1, 65);
+    if (g_rand_int_range(rand, 0, 4) == 0)
+    {
+        tile[0] = TEST_FRAME_WIDTH - tile[2];
+        tile[1] = TEST_FRAME_HEIGHT - tile[3];
+        return;
+    }
+    tile[0] = (guint) g_rand_int_range(rand, 0, (gint32) (TEST_FRAME_WIDTH - tile[2] + 1));
+    tile[1] = (guint) g_rand_int_range(rand, 0, (gint32) (TEST_FRAME_HEIGHT - tile[3] + 1));
+}
+
+/*
+ * 功能：tile 内某个像素某个字节的偏移。
+ * 逻辑：按行跨度与像素宽度换算。
+ * 参数：tile 区域；px/py tile 内坐标；channel 字节序号（3 为 X 字节）。
+ * 外部接口：无。
+ */
+static gsize
+test_offset(const guint tile[4], guint px, guint py, guint channel)
+{
+    return (gsize) (tile[1] + py) * TEST_FRAME_STRIDE + (gsize) (tile[0] + px) * 4 + channel;
+}
+
+/*
+ * 功能：全部 1..64 尺寸的 tile 哈希与通用实现一致。
+ * 逻辑：每种宽高各在左上角、右下边缘与一个随机位置计算，覆盖整 8 像素块与各种行尾通道数。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_hash_all_sizes(void)
+{
+    TestFixture fixture;
+    test_fixture_init(&fixture);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        const TestKernel *kernel = &test_kernels[k];
+        for (guint width = 1; width <= 64; ++width)
+        {
+            for (guint height = 1; height <= 64; ++height)
+            {
+                const guint origins[3][2] = {
+                    {0, 0},
+                    {TEST_FRAME_WIDTH - width, TEST_FRAME_HEIGHT - height},
+                    {(guint) g_rand_int_range(fixture.rand, 0, (gint32) (TEST_FRAME_WIDTH - width + 1)),
+                     (guint) g_rand_int_range(fixture.rand, 0, (gint32) (TEST_FRAME_HEIGHT - height + 1))},
+                };
+                for (guint o = 0; o < G_N_ELEMENTS(origins); ++o)
+                {
+                    const guint x = origins[o][0];
+                    const guint y = origins[o][1];
+                    g_assert_cmphex(kernel->hash(fixture.a, TEST_FRAME_STRIDE, x, y, width, height), ==,
+                                    drd_tile_hash_scalar(fixture.a, TEST_FRAME_STRIDE, x, y, width, height));
+                }
+            }
+        }
+    }
+
+    test_fixture_clear(&fixture);
+}
+
+/*
+ * 功能：随机 tile 的相等判断与通用实现一致。
+ * 逻辑：副本相等；改动 tile 内随机像素的任一字节（含只改 X 字节）后不等，且改动后的哈希仍与通用实现一致；
+ *       改动 tile 右侧或下方紧邻的像素后仍相等。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_equal_random(void)
+{
+    TestFixture fixture;
+    test_fixture_init(&fixture);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        const TestKernel *kernel = &test_kernels[k];
+        for (guint n = 0; n < TEST_RANDOM_TILES; ++n)
+        {
+            guint tile[4];
+            test_random_tile(fixture.rand, tile);
+            const guint x = tile[0], y = tile[1], width = tile[2], height = tile[3];
+
+            g_assert_true(kernel->equal(fixture.a, fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+
+            const gsize inside = test_offset(tile, (guint) g_rand_int_range(fixture.rand, 0, (gint32) width),
+                                             (guint) g_rand_int_range(fixture.rand, 0, (gint32) height),
+                                             n % 2 == 0 ? 3 : (guint) g_rand_int_range(fixture.rand, 0, 3));
+            fixture.b[inside] ^= (guint8) g_rand_int_range(fixture.rand, 1, 256);
+            g_assert_false(kernel->equal(fixture.a, fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+            g_assert_false(drd_tile_equal_scalar(fixture.a, fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+            g_assert_cmphex(kernel->hash(fixture.b, TEST_FRAME_STRIDE, x, y, width, height), ==,
+                            drd_tile_hash_scalar(fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+            fixture.b[inside] = fixture.a[inside];
+
+            if (x + width < TEST_FRAME_WIDTH)
+            {
+                const gsize right = test_offset(tile, width, height - 1, 0);
+                fixture.b[right] ^= 0xFF;
+                g_assert_true(kernel->equal(fixture.a, fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+                fixture.b[right] = fixture.a[right];
+            }
+            if (y + height < TEST_FRAME_HEIGHT)
+            {
+                const gsize below = test_offset(tile, width - 1, height, 1);
+                fixture.b[below] ^= 0xFF;
+                g_assert_true(kernel->equal(fixture.a, fixture.b, TEST_FRAME_STRIDE, x, y, width, height));
+                fixture.b[below] = fixture.a[below];
+            }
+        }
+    }
+
+    test_fixture_clear(&fixture);
+}
+
+/*
+ * 功能：随机 tile 的纯色判断与通用实现一致。
+ * 逻辑：随机像素的 tile 两者结论相同；把 tile 填成同一颜色且 X 字节各不相同时判为纯色并输出相同颜色；
+ *       再改动随机像素的一个颜色字节后判为非纯色。
+ * 参数：无。
+ * 外部接口：GLib GTest。
+ */
+static void
+test_uniform_random(void)
+{
+    TestFixture fixture;
+    test_fixture_init(&fixture);
+
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        const TestKernel *kernel = &test_kernels[k];
+        for (guint n = 0; n < TEST_RANDOM_TILES; ++n)
+        {
+            guint tile[4];
+            test_random_tile(fixture.rand, tile);
+            const guint x = tile[0], y = tile[1], width = tile[2], height = tile[3];
+            guint32 color = 0;
+            guint32 expected = 0;
+
+            g_assert_cmpint(kernel->uniform(fixture.a, TEST_FRAME_STRIDE, x, y, width, height, &color), ==,
+                            drd_tile_uniform_scalar(fixture.a, TEST_FRAME_STRIDE, x, y, width, height, &expected));
+
+            const guint32 rgb = g_rand_int(fixture.rand) & 0x00FFFFFFu;
+            for (guint py = 0; py < height; ++py)
+            {
+                for (guint px = 0; px < width; ++px)
+                {
+                    guint8 *pixel = fixture.b + test_offset(tile, px, py, 0);
+                    pixel[0] = (guint8) rgb;
+                    pixel[1] = (guint8) (rgb >> 8);
+                    pixel[2] = (guint8) (rgb >> 16);
+                    pixel[3] = (guint8) g_rand_int(fixture.rand);
+                }
+            }
+            color = 0;
+            g_assert_true(kernel->uniform(fixture.b, TEST_FRAME_STRIDE, x, y, width, height, &color));
+            g_assert_cmphex(color, ==, rgb);
+
+            if (width * height > 1)
+            {
+                const gsize changed = test_offset(tile, (guint) g_rand_int_range(fixture.rand, 0, (gint32) width),
+                                                  (guint) g_rand_int_range(fixture.rand, 0, (gint32) height),
+                                                  (guint) g_rand_int_range(fixture.rand, 0, 3));
+                const guint8 saved = fixture.b[changed];
+                fixture.b[changed] ^= (guint8) g_rand_int_range(fixture.rand, 1, 256);
+                /* 改到的若是参考像素，其余像素整体成为“不同颜色” */
+                g_assert_false(kernel->uniform(fixture.b, TEST_FRAME_STRIDE, x, y, width, height, &color));
+                g_assert_false(drd_tile_uniform_scalar(fixture.b, TEST_FRAME_STRIDE, x, y, width, height, &color));
+                fixture.b[changed] = saved;
+            }
+
+            for (guint py = 0; py < height; ++py)
+            {
+                memcpy(fixture.b + test_offset(tile, 0, py, 0), fixture.a + test_offset(tile, 0, py, 0),
+                       (gsize) width * 4);
+            }
+        }
+    }
+
+    test_fixture_clear(&fixture);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    test_collect_kernels();
+    for (guint k = 0; k < test_n_kernels; ++k)
+    {
+        g_test_message("tile hash kernel under test: %s", test_kernels[k].name);
+    }
+
+    g_test_add_func("/tile-hash/hash-all-sizes", test_hash_all_sizes);
+    g_test_add_func("/tile-hash/equal-random", test_equal_random);
+    g_test_add_func("/tile-hash/uniform-random", test_uniform_random);
+    return g_test_run();
+}
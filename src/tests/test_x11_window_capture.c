@@ -0,0 +1,426 @@
+/*
+ * X11 窗口捕获集成测试：在真实 X 服务器上创建窗口，依次覆盖首帧、增量损坏、尺寸变化、取消映射/重新映射，
+ * 以及读回在途时窗口被调整尺寸或销毁。需要服务器提供 Composite 0.2、DAMAGE、XFIXES 与 MIT-SHM（Xvfb 默认满足），
+ * 打不开显示时跳过。窗口销毁与读回失败按设计输出警告，因此只把 CRITICAL 设为致命。
+ */
+#include <X11/Xlib.h>
+
+#include <gio/gio.h>
+
+#include "capture/drd_x11_window_capture.h"
+#include "utils/drd_frame_queue.h"
+
+#define TEST_WINDOW_WIDTH 320
+#define TEST_WINDOW_HEIGHT 240
+#define TEST_BACKGROUND 0x202020
+#define TEST_FRAME_TIMEOUT_US (2 * G_USEC_PER_SEC)
+#define TEST_QUIET_US (300 * 1000)
+#define TEST_CHURN_ROUNDS 60
+#define TEST_CHURN_RECTS 24
+/* 最新帧、正在写入的一帧、信箱中的一帧，以及测试同时持有的两帧（已检查的帧与 test_settle 手中的一帧） */
+#define TEST_FRAME_SLOTS 5
+
+typedef struct
+{
+    Display *display;
+    Window window;
+    GC gc;
+    DrdFrameQueue *queue;
+    DrdX11WindowCapture *capture;
+} TestFixture;
+
+/*
+ * 功能：创建测试窗口并启动窗口捕获。
+ * 逻辑：打开测试自己的 X 连接，创建带背景色的顶层窗口并映射、同步；捕获使用同一显示、画布取窗口尺寸。
+ *       打不开显示时标记跳过并返回 FALSE。
+ * 参数：fixture 测试夹具。
+ * 外部接口：X11 XOpenDisplay/XCreateSimpleWindow/XMapWindow/XSync；drd_frame_queue_new；drd_x11_window_capture_new/start。
+ */
+static gboolean
+test_fixture_setup(TestFixture *fixture)
+{
+    g_autoptr(GError) error = NULL;
+
+    memset(fixture, 0, sizeof(*fixture));
+    fixture->display = XOpenDisplay(NULL);
+    if (fixture->display == NULL)
+    {
+        g_test_skip("no X display available");
+        return FALSE;
+    }
+
+    const int screen = DefaultScreen(fixture->display);
+    fixture->window = XCreateSimpleWindow(fixture->display, RootWindow(fixture->display, screen), 40, 30, TEST_WINDOW_WIDTH,
+                                          TEST_WINDOW_HEIGHT, 0, 0, TEST_BACKGROUND);
+    fixture->gc = XCreateGC(fixture->display, fixture->window, 0, NULL);
+    XMapWindow(fixture->display, fixture->window);
+    XSync(fixture->display, False);
+
+    fixture->queue = drd_frame_queue_new();
+    fixture->capture = drd_x11_window_capture_new(fixture->queue, (guint32) fixture->window);
+    g_assert_true(drd_x11_window_capture_start(fixture->capture, NULL, 0, 0, TEST_FRAME_SLOTS, &error));
+    g_assert_no_error(error);
+    return TRUE;
+}
+
+/*
+ * 功能：停止捕获并释放测试资源。
+ * 逻辑：先停止捕获（线程 join 与服务器资源回收），再释放队列并关闭测试连接；窗口已被测试销毁时 window 为 None。
+ * 参数：fixture 测试夹具。
+ * 外部接口：drd_x11_window_capture_stop；X11 XDestroyWindow/XFreeGC/XCloseDisplay。
+ */
+static void
+test_fixture_teardown(TestFixture *fixture)
+{
+    drd_x11_window_capture_stop(fixture->capture);
+    g_assert_false(drd_x11_window_capture_is_running(fixture->capture));
+    g_clear_object(&fixture->capture);
+    g_clear_object(&fixture->queue);
+
+    XFreeGC(fixture->display, fixture->gc);
+    if (fixture->window != None)
+    {
+        XDestroyWindow(fixture->display, fixture->window);
+    }
+    XCloseDisplay(fixture->display);
+}
+
+/*
+ * 功能：在窗口内填充矩形并立即发送请求。
+ * 逻辑：设置前景色后 XFillRectangle，XFlush 不等待服务器处理。
+ * 参数：fixture 测试夹具；x/y/width/height 矩形；pixel 颜色。
+ * 外部接口：X11 XSetForeground/XFillRectangle/XFlush。
+ */
+static void
+test_fill(TestFixture *fixture, gint x, gint y, guint width, guint height, gulong pixel)
+{
+    XSetForeground(fixture->display, fixture->gc, pixel);
+    XFillRectangle(fixture->display, fixture->window, fixture->gc, x, y, width, height);
+    XFlush(fixture->display);
+}
+
+/*
+ * 功能：等待下一帧。
+ * 逻辑：按输入活跃上报，避免空闲退避拉长抓帧间隔；超时返回 NULL。
+ * 参数：fixture 测试夹具；timeout_us 超时。
+ * 外部接口：drd_frame_queue_note_input_activity；drd_frame_queue_wait。
+ */
+static DrdFrame *
+test_wait_frame(TestFixture *fixture, gint64 timeout_us)
+{
+    DrdFrame *frame = NULL;
+
+    drd_frame_queue_note_input_activity(fixture->queue);
+    if (!drd_frame_queue_wait(fixture->queue, timeout_us, &frame))
+    {
+        return NULL;
+    }
+    return frame;
+}
+
+/*
+ * 功能：取走在途帧直到安静一段时间，返回最后一帧。
+ * 逻辑：首帧最多等待 TEST_FRAME_TIMEOUT_US（慢速服务器上多矩形读回可能仍在回收），之后超过 TEST_QUIET_US 没有新帧即结束；
+ *       较早的帧直接释放。
+ * 参数：fixture 测试夹具。
+ * 外部接口：test_wait_frame；GLib g_object_unref。
+ */
+static DrdFrame *
+test_settle(TestFixture *fixture)
+{
+    DrdFrame *last = NULL;
+    DrdFrame *frame = NULL;
+    gint64 timeout_us = TEST_FRAME_TIMEOUT_US;
+
+    while ((frame = test_wait_frame(fixture, timeout_us)) != NULL)
+    {
+        timeout_us = TEST_QUIET_US;
+        g_clear_object(&last);
+        last = frame;
+    }
+    return last;
+}
+
+/*
+ * 功能：释放不需要检查的帧。
+ * 逻辑：帧可能为 NULL（等待超时），非空时释放引用，使槽位回到帧环。
+ * 参数：frame 帧或 NULL。
+ * 外部接口：GLib g_object_unref。
+ */
+static void
+test_discard(DrdFrame *frame)
+{
+    if (frame != NULL)
+    {
+        g_object_unref(frame);
+    }
+}
+
+/*
+ * 功能：读取帧中一个像素的 RGB 值。
+ * 逻辑：32 位 ZPixmap 像素按小端读取并去掉填充字节。
+ * 参数：frame 帧；x/y 坐标。
+ * 外部接口：drd_frame_get_data/get_stride。
+ */
+static guint32
+test_pixel(DrdFrame *frame, guint x, guint y)
+{
+    const guint8 *data = drd_frame_get_data(frame, NULL);
+    const guint8 *px = data + (gsize) y * drd_frame_get_stride(frame) + (gsize) x * 4;
+    return ((guint32) px[0] | ((guint32) px[1] << 8) | ((guint32) px[2] << 16)) & 0xFFFFFF;
+}
+
+/*
+ * 功能：检查帧的损坏矩形是否覆盖给定区域。
+ * 逻辑：逐像素检查区域内每一点都落在某个损坏矩形内。
+ * 参数：frame 帧；x/y/width/height 区域。
+ * 外部接口：drd_frame_get_damage。
+ */
+static gboolean
+test_damage_covers(DrdFrame *frame, guint x, guint y, guint width, guint height)
+{
+    guint n_rects = 0;
+    const DrdFrameRect *rects = drd_frame_get_damage(frame, &n_rects);
+
+    for (guint py = y; py < y + height; py++)
+    {
+        for (guint px = x; px < x + width; px++)
+        {
+            gboolean covered = FALSE;
+            for (guint i = 0; i < n_rects && !covered; i++)
+            {
+                covered = px >= rects[i].x && px < rects[i].x + rects[i].width && py >= rects[i].y &&
+                          py < rects[i].y + rects[i].height;
+            }
+            if (!covered)
+            {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：在窗口里散布小矩形，制造多矩形读回。
+ * 逻辑：TEST_CHURN_RECTS 个 4x4 方块按轮次错开位置与颜色，总面积远低于整窗读回阈值，捕获走暂存段的逐矩形读回。
+ * 参数：fixture 测试夹具；round 轮次；width/height 当前窗口尺寸。
+ * 外部接口：test_fill。
+ */
+static void
+test_churn(TestFixture *fixture, guint round, guint width, guint height)
+{
+    for (guint i = 0; i < TEST_CHURN_RECTS; i++)
+    {
+        const guint x = (i * 37 + round * 11) % (width - 4);
+        const guint y = (i * 53 + round * 7) % (height - 4);
+        test_fill(fixture, (gint) x, (gint) y, 4, 4, (round + i) & 1 ? 0xFF0000 : 0x0000FF);
+    }
+}
+
+/*
+ * 功能：验证首帧与增量损坏帧。
+ * 逻辑：静止窗口启动捕获后应得到整帧背景色；填充一个矩形后得到带损坏矩形的增量帧，矩形内为新颜色、其余像素保持背景。
+ * 参数：无。
+ * 外部接口：drd_x11_window_capture_*；drd_frame_get_width/height/has_damage/get_origin。
+ */
+static void
+test_initial_and_damage(void)
+{
+    TestFixture fixture;
+    if (!test_fixture_setup(&fixture))
+    {
+        return;
+    }
+
+    g_autoptr(DrdFrame) first = test_wait_frame(&fixture, TEST_FRAME_TIMEOUT_US);
+    g_assert_nonnull(first);
+    g_assert_cmpuint(drd_frame_get_width(first), ==, TEST_WINDOW_WIDTH);
+    g_assert_cmpuint(drd_frame_get_height(first), ==, TEST_WINDOW_HEIGHT);
+    g_assert_false(drd_frame_has_damage(first));
+    g_assert_cmphex(test_pixel(first, 0, 0), ==, TEST_BACKGROUND);
+    g_assert_cmphex(test_pixel(first, TEST_WINDOW_WIDTH - 1, TEST_WINDOW_HEIGHT - 1), ==, TEST_BACKGROUND);
+
+    gint origin_x = 0;
+    gint origin_y = 0;
+    drd_frame_get_origin(first, &origin_x, &origin_y);
+    g_assert_cmpint(origin_x, ==, 40);
+    g_assert_cmpint(origin_y, ==, 30);
+
+    test_fill(&fixture, 30, 40, 20, 10, 0x00FF00);
+    g_autoptr(DrdFrame) update = test_settle(&fixture);
+    g_assert_nonnull(update);
+    g_assert_true(drd_frame_has_damage(update));
+    g_assert_true(test_damage_covers(update, 30, 40, 20, 10));
+    g_assert_cmphex(test_pixel(update, 35, 45), ==, 0x00FF00);
+    g_assert_cmphex(test_pixel(update, 29, 45), ==, TEST_BACKGROUND);
+    g_assert_cmphex(test_pixel(update, 200, 200), ==, TEST_BACKGROUND);
+
+    test_fixture_teardown(&fixture);
+}
+
+/*
+ * 功能：验证窗口尺寸变化。
+ * 逻辑：缩小后整帧重发，窗口外区域为黑色，随后的绘制仍能捕获（pixmap 已重新命名）；放大超过画布时按画布裁剪。
+ * 参数：无。
+ * 外部接口：X11 XResizeWindow；drd_x11_window_capture_*。
+ */
+static void
+test_resize(void)
+{
+    TestFixture fixture;
+    if (!test_fixture_setup(&fixture))
+    {
+        return;
+    }
+    test_discard(test_wait_frame(&fixture, TEST_FRAME_TIMEOUT_US));
+
+    XResizeWindow(fixture.display, fixture.window, 200, 160);
+    XSync(fixture.display, False);
+    test_fill(&fixture, 190, 150, 10, 10, 0xFFFF00);
+    g_autoptr(DrdFrame) shrunk = test_settle(&fixture);
+    g_assert_nonnull(shrunk);
+    g_assert_cmpuint(drd_frame_get_width(shrunk), ==, TEST_WINDOW_WIDTH);
+    g_assert_cmphex(test_pixel(shrunk, 10, 10), ==, TEST_BACKGROUND);
+    g_assert_cmphex(test_pixel(shrunk, 195, 155), ==, 0xFFFF00);
+    g_assert_cmphex(test_pixel(shrunk, 200, 10), ==, 0);
+    g_assert_cmphex(test_pixel(shrunk, 10, 160), ==, 0);
+    g_assert_cmphex(test_pixel(shrunk, TEST_WINDOW_WIDTH - 1, TEST_WINDOW_HEIGHT - 1), ==, 0);
+
+    XResizeWindow(fixture.display, fixture.window, TEST_WINDOW_WIDTH + 80, TEST_WINDOW_HEIGHT + 40);
+    XSync(fixture.display, False);
+    test_fill(&fixture, TEST_WINDOW_WIDTH - 10, TEST_WINDOW_HEIGHT - 10, 60, 40, 0x00FFFF);
+    g_autoptr(DrdFrame) grown = test_settle(&fixture);
+    g_assert_nonnull(grown);
+    g_assert_cmpuint(drd_frame_get_width(grown), ==, TEST_WINDOW_WIDTH);
+    g_assert_cmpuint(drd_frame_get_height(grown), ==, TEST_WINDOW_HEIGHT);
+    g_assert_cmphex(test_pixel(grown, 200, 10), ==, TEST_BACKGROUND);
+    g_assert_cmphex(test_pixel(grown, TEST_WINDOW_WIDTH - 1, TEST_WINDOW_HEIGHT - 1), ==, 0x00FFFF);
+
+    test_fixture_teardown(&fixture);
+}
+
+/*
+ * 功能：验证取消映射与重新映射。
+ * 逻辑：取消映射后即使继续绘制也不出帧；重新映射后窗口获得新的后备存储，整帧重发并反映映射后的绘制。
+ * 参数：无。
+ * 外部接口：X11 XUnmapWindow/XMapWindow；drd_x11_window_capture_*。
+ */
+static void
+test_unmap_map(void)
+{
+    TestFixture fixture;
+    if (!test_fixture_setup(&fixture))
+    {
+        return;
+    }
+    test_discard(test_wait_frame(&fixture, TEST_FRAME_TIMEOUT_US));
+
+    XUnmapWindow(fixture.display, fixture.window);
+    XSync(fixture.display, False);
+    test_fill(&fixture, 0, 0, 50, 50, 0xFF00FF);
+    g_autoptr(DrdFrame) hidden = test_settle(&fixture);
+    g_assert_null(hidden);
+
+    XMapWindow(fixture.display, fixture.window);
+    XSync(fixture.display, False);
+    test_fill(&fixture, 100, 100, 16, 16, 0xFF00FF);
+    g_autoptr(DrdFrame) shown = test_settle(&fixture);
+    g_assert_nonnull(shown);
+    g_assert_cmphex(test_pixel(shown, 108, 108), ==, 0xFF00FF);
+    g_assert_cmphex(test_pixel(shown, 10, 10), ==, TEST_BACKGROUND);
+
+    test_fixture_teardown(&fixture);
+}
+
+/*
+ * 功能：验证读回在途时窗口反复调整尺寸。
+ * 逻辑：每轮散布小矩形后在两种尺寸间切换，读回可能越过刚缩小的后备存储而失败并重试；
+ *       最后停在第三种尺寸并整窗填色，安静后的最后一帧必须与最终窗口内容一致。
+ * 参数：无。
+ * 外部接口：X11 XResizeWindow；drd_x11_window_capture_*。
+ */
+static void
+test_resize_during_readback(void)
+{
+    TestFixture fixture;
+    if (!test_fixture_setup(&fixture))
+    {
+        return;
+    }
+
+    for (guint round = 0; round < TEST_CHURN_ROUNDS; round++)
+    {
+        const guint width = round & 1 ? 200 : TEST_WINDOW_WIDTH;
+        const guint height = round & 1 ? 160 : TEST_WINDOW_HEIGHT;
+        test_churn(&fixture, round, width, height);
+        XResizeWindow(fixture.display, fixture.window, width, height);
+        XFlush(fixture.display);
+        test_discard(test_wait_frame(&fixture, 2000));
+    }
+
+    XResizeWindow(fixture.display, fixture.window, 260, 200);
+    XSync(fixture.display, False);
+    test_fill(&fixture, 0, 0, 260, 200, 0x123456);
+    g_autoptr(DrdFrame) last = test_settle(&fixture);
+    g_assert_nonnull(last);
+    g_assert_cmphex(test_pixel(last, 0, 0), ==, 0x123456);
+    g_assert_cmphex(test_pixel(last, 259, 199), ==, 0x123456);
+    g_assert_cmphex(test_pixel(last, 260, 10), ==, 0);
+    g_assert_cmphex(test_pixel(last, 10, 200), ==, 0);
+
+    test_fixture_teardown(&fixture);
+}
+
+/*
+ * 功能：验证读回在途时窗口被销毁。
+ * 逻辑：持续散布小矩形让捕获不断发出多矩形读回，随即销毁窗口；捕获线程应转入空闲、不再出帧，
+ *       stop 能正常回收（Damage 与重定向已随窗口释放），之后查询窗口尺寸报告 NOT_FOUND。
+ * 参数：无。
+ * 外部接口：X11 XDestroyWindow；drd_x11_window_capture_*。
+ */
+static void
+test_destroy_during_readback(void)
+{
+    g_autoptr(GError) error = NULL;
+    TestFixture fixture;
+    if (!test_fixture_setup(&fixture))
+    {
+        return;
+    }
+
+    for (guint round = 0; round < TEST_CHURN_ROUNDS; round++)
+    {
+        test_churn(&fixture, round, TEST_WINDOW_WIDTH, TEST_WINDOW_HEIGHT);
+        test_discard(test_wait_frame(&fixture, 2000));
+    }
+    XDestroyWindow(fixture.display, fixture.window);
+    XSync(fixture.display, False);
+    fixture.window = None;
+
+    test_discard(test_settle(&fixture));
+    g_assert_true(drd_x11_window_capture_is_running(fixture.capture));
+    g_autoptr(DrdFrame) after = test_wait_frame(&fixture, TEST_QUIET_US);
+    g_assert_null(after);
+
+    guint width = 0;
+    guint height = 0;
+    g_assert_false(drd_x11_window_capture_get_window_size(fixture.capture, NULL, &width, &height, &error));
+    g_assert_true(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND));
+
+    test_fixture_teardown(&fixture);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_log_set_always_fatal(G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+
+    g_test_add_func("/x11-window-capture/initial-and-damage", test_initial_and_damage);
+    g_test_add_func("/x11-window-capture/resize", test_resize);
+    g_test_add_func("/x11-window-capture/unmap-map", test_unmap_map);
+    g_test_add_func("/x11-window-capture/resize-during-readback", test_resize_during_readback);
+    g_test_add_func("/x11-window-capture/destroy-during-readback", test_destroy_during_readback);
+    return g_test_run();
+}
@@ -652,7 +652,7 @@ drd_peer_disconnected(freerdp_peer *client)
 
 /*
  * 功能：校验客户端能力并确保 DRDYNVC/桌面尺寸配置满足要求。
- * 逻辑：读取客户端桌面尺寸与 DesktopResize 能力；确认 VCM 加入 DRDYNVC；不符合条件则拒绝。
+ * 逻辑：读取客户端桌面尺寸与 DesktopResize 能力；确认 VCM 加入 DRDYNVC，否则拒绝；不支持 DesktopResize 的客户端放行，由会话激活时改为服务端缩放。
  * 参数：client peer。
  * 外部接口：freerdp_settings_get_uint32/get_bool 读取能力，DRDYNVC/WTS API 检查通道。
  */
@@ -691,15 +691,11 @@ drd_peer_capabilities(freerdp_peer *client)
 
     if (!desktop_resize)
     {
-        if (ctx != NULL && ctx->session != NULL)
-        {
-            drd_rdp_session_set_peer_state(ctx->session, "desktop-resize-unsupported");
-        }
-        DRD_LOG_WARNING("Peer %s disabled DesktopResize capability (client %ux%u), rejecting connection",
+        /* 无法下发 DesktopResize：会话激活时改为服务端缩放到客户端分辨率 */
+        DRD_LOG_MESSAGE("Peer %s disabled DesktopResize capability (client %ux%u), stream will be scaled",
                         client->hostname,
                         client_width,
                         client_height);
-        return FALSE;
     }
 
     if (ctx != NULL && ctx->listener != NULL)
@@ -707,8 +703,9 @@ drd_peer_capabilities(freerdp_peer *client)
         drd_rdp_listener_update_system_encoding(ctx->listener, client_width, client_height);
     }
 
-    DRD_LOG_MESSAGE("Peer %s capabilities accepted with DesktopResize enabled (%ux%u requested)",
+    DRD_LOG_MESSAGE("Peer %s capabilities accepted (DesktopResize=%s, %ux%u requested)",
                     client->hostname,
+                    desktop_resize ? "enabled" : "disabled",
                     client_width,
                     client_height);
     return TRUE;
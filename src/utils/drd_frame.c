@@ -7,6 +7,14 @@ struct _DrdFrame
     GObject parent_instance;
 
     GByteArray *pixels;
+    const guint8 *external_data;
+    gsize external_size;
+    DrdFrameReleaseFunc release;
+    gpointer release_data;
+    GArray *damage;
+    guint monitor;
+    gint origin_x;
+    gint origin_y;
     guint width;
     guint height;
     guint stride;
@@ -16,16 +24,28 @@ struct _DrdFrame
 G_DEFINE_TYPE(DrdFrame, drd_frame, G_TYPE_OBJECT)
 
 /*
- * 功能：释放帧对象持有的像素缓冲。
- * 逻辑：清理 GByteArray 引用后交由父类 dispose。
+ * 功能：释放帧对象持有的像素缓冲与损坏区域。
+ * 逻辑：若包装了外部存储则调用一次释放回调归还；清理 GByteArray/GArray 引用后交由父类 dispose。
  * 参数：object 基类指针，期望为 DrdFrame。
- * 外部接口：GLib g_clear_pointer/g_byte_array_unref。
+ * 外部接口：GLib g_clear_pointer/g_byte_array_unref；DrdFrameReleaseFunc 回调。
  */
 static void
 drd_frame_dispose(GObject *object)
 {
     DrdFrame *self = DRD_FRAME(object);
+    DrdFrameReleaseFunc release = self->release;
+
+    self->release = NULL;
+    self->external_data = NULL;
+    self->external_size = 0;
+    if (release != NULL)
+    {
+        release(self, self->release_data);
+    }
+    self->release_data = NULL;
+
     g_clear_pointer(&self->pixels, g_byte_array_unref);
+    g_clear_pointer(&self->damage, g_array_unref);
     G_OBJECT_CLASS(drd_frame_parent_class)->dispose(object);
 }
 
@@ -44,14 +64,14 @@ drd_frame_class_init(DrdFrameClass *klass)
 
 /*
  * 功能：初始化帧对象。
- * 逻辑：创建像素缓存数组。
+ * 逻辑：像素缓存延迟到 ensure_capacity 时创建，包装外部存储的帧无需分配。
  * 参数：self 帧实例。
- * 外部接口：GLib g_byte_array_new。
+ * 外部接口：无。
  */
 static void
 drd_frame_init(DrdFrame *self)
 {
-    self->pixels = g_byte_array_new();
+    self->pixels = NULL;
 }
 
 /*
@@ -141,14 +161,20 @@ drd_frame_get_timestamp(DrdFrame *self)
 
 /*
  * 功能：确保像素缓冲容量并返回可写指针。
- * 逻辑：若当前长度与期望不同则调整 GByteArray 大小，然后返回内部数据指针。
+ * 逻辑：包装外部存储的帧不可写；按需创建 GByteArray，若当前长度与期望不同则调整大小，然后返回内部数据指针。
  * 参数：self 帧实例；size 需要的字节数。
- * 外部接口：GLib g_byte_array_set_size。
+ * 外部接口：GLib g_byte_array_sized_new/g_byte_array_set_size。
  */
 guint8 *
 drd_frame_ensure_capacity(DrdFrame *self, gsize size)
 {
     g_return_val_if_fail(DRD_IS_FRAME(self), NULL);
+    g_return_val_if_fail(self->external_data == NULL, NULL);
+
+    if (self->pixels == NULL)
+    {
+        self->pixels = g_byte_array_sized_new((guint) size);
+    }
 
     if (self->pixels->len != size)
     {
@@ -160,7 +186,7 @@ drd_frame_ensure_capacity(DrdFrame *self, gsize size)
 
 /*
  * 功能：获取像素数据指针与长度。
- * 逻辑：可选写入长度后返回内部数据常量指针。
+ * 逻辑：优先返回包装的外部存储；否则返回内部缓冲，尚未分配时返回 NULL 与长度 0。
  * 参数：self 帧实例；size 输出长度可选。
  * 外部接口：无。
  */
@@ -169,10 +195,253 @@ drd_frame_get_data(DrdFrame *self, gsize *size)
 {
     g_return_val_if_fail(DRD_IS_FRAME(self), NULL);
 
+    if (self->external_data != NULL)
+    {
+        if (size != NULL)
+        {
+            *size = self->external_size;
+        }
+        return self->external_data;
+    }
+
     if (size != NULL)
     {
-        *size = self->pixels->len;
+        *size = self->pixels != NULL ? self->pixels->len : 0;
     }
 
-    return self->pixels->data;
+    return self->pixels != NULL ? self->pixels->data : NULL;
+}
+
+/*
+ * 功能：让帧引用外部像素存储而非自有缓冲。
+ * 逻辑：释放已有内部缓冲，记录外部指针、长度与释放回调；同一帧只允许包装一次。
+ * 参数：self 帧实例；data 外部存储；size 字节数；release 帧销毁时的回调；user_data 回调参数。
+ * 外部接口：GLib g_clear_pointer/g_byte_array_unref。
+ */
+void
+drd_frame_wrap_data(DrdFrame *self,
+                    const guint8 *data,
+                    gsize size,
+                    DrdFrameReleaseFunc release,
+                    gpointer user_data)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    g_return_if_fail(data != NULL);
+    g_return_if_fail(self->external_data == NULL && self->release == NULL);
+
+    g_clear_pointer(&self->pixels, g_byte_array_unref);
+    self->external_data = data;
+    self->external_size = size;
+    self->release = release;
+    self->release_data = user_data;
+}
+
+/*
+ * 功能：记录帧相对上一帧的损坏矩形列表。
+ * 逻辑：按需创建 GArray，清空后拷贝传入矩形；n_rects 为 0 表示画面无变化。
+ * 参数：self 帧实例；rects 矩形数组；n_rects 矩形数量。
+ * 外部接口：GLib g_array_sized_new/g_array_set_size/g_array_append_vals。
+ */
+void
+drd_frame_set_damage(DrdFrame *self, const DrdFrameRect *rects, guint n_rects)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    g_return_if_fail(rects != NULL || n_rects == 0);
+
+    if (self->damage == NULL)
+    {
+        self->damage = g_array_sized_new(FALSE, FALSE, sizeof(DrdFrameRect), MAX(n_rects, 1));
+    }
+
+    g_array_set_size(self->damage, 0);
+    if (n_rects > 0)
+    {
+        g_array_append_vals(self->damage, rects, n_rects);
+    }
+}
+
+/*
+ * 功能：清除损坏信息，使帧回退为整帧更新语义。
+ * 逻辑：释放损坏矩形数组。
+ * 参数：self 帧实例。
+ * 外部接口：GLib g_clear_pointer/g_array_unref。
+ */
+void
+drd_frame_clear_damage(DrdFrame *self)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    g_clear_pointer(&self->damage, g_array_unref);
+}
+
+/*
+ * 功能：把被丢弃帧的损坏并入替代它的帧。
+ * 逻辑：任一帧为整帧更新时结果为整帧；否则追加旧帧矩形，超过 DRD_FRAME_MAX_DAMAGE_RECTS 时合并为外接矩形，
+ *       使消费者取到的帧总是覆盖自上次取帧以来的全部变化。
+ * 参数：self 新帧；older 被丢弃的旧帧。
+ * 外部接口：GLib g_array_append_vals/g_array_set_size。
+ */
+void
+drd_frame_merge_damage(DrdFrame *self, DrdFrame *older)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    g_return_if_fail(DRD_IS_FRAME(older));
+
+    if (self->damage == NULL)
+    {
+        return;
+    }
+    if (older->damage == NULL)
+    {
+        drd_frame_clear_damage(self);
+        return;
+    }
+    if (older->damage->len == 0)
+    {
+        return;
+    }
+
+    g_array_append_vals(self->damage, older->damage->data, older->damage->len);
+    if (self->damage->len <= DRD_FRAME_MAX_DAMAGE_RECTS)
+    {
+        return;
+    }
+
+    guint x0 = G_MAXUINT;
+    guint y0 = G_MAXUINT;
+    guint x1 = 0;
+    guint y1 = 0;
+    for (guint i = 0; i < self->damage->len; i++)
+    {
+        const DrdFrameRect *rect = &g_array_index(self->damage, DrdFrameRect, i);
+        x0 = MIN(x0, rect->x);
+        y0 = MIN(y0, rect->y);
+        x1 = MAX(x1, rect->x + rect->width);
+        y1 = MAX(y1, rect->y + rect->height);
+    }
+    const DrdFrameRect bounds = {x0, y0, x1 - x0, y1 - y0};
+    g_array_set_size(self->damage, 1);
+    g_array_index(self->damage, DrdFrameRect, 0) = bounds;
+}
+
+/*
+ * 功能：判断帧是否携带损坏信息。
+ * 逻辑：损坏数组存在即视为携带；否则调用方需按整帧处理。
+ * 参数：self 帧实例。
+ * 外部接口：无。
+ */
+gboolean
+drd_frame_has_damage(DrdFrame *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME(self), FALSE);
+    return self->damage != NULL;
+}
+
+/*
+ * 功能：获取损坏矩形列表。
+ * 逻辑：未携带损坏信息时返回 NULL 且数量为 0；否则返回内部数组指针。
+ * 参数：self 帧实例；n_rects 输出矩形数量，可选。
+ * 外部接口：无。
+ */
+const DrdFrameRect *
+drd_frame_get_damage(DrdFrame *self, guint *n_rects)
+{
+    g_return_val_if_fail(DRD_IS_FRAME(self), NULL);
+
+    if (self->damage == NULL)
+    {
+        if (n_rects != NULL)
+        {
+            *n_rects = 0;
+        }
+        return NULL;
+    }
+
+    if (n_rects != NULL)
+    {
+        *n_rects = self->damage->len;
+    }
+    return (const DrdFrameRect *) self->damage->data;
+}
+
+/*
+ * 功能：让帧接管外部预分配的像素缓冲。
+ * 逻辑：替换内部 GByteArray 为传入缓冲（转移所有权），记录释放回调；回调在 dispose 中先于缓冲释放执行，可取回缓冲复用。
+ * 参数：self 帧实例；pixels 像素缓冲；release 帧销毁时回调；user_data 回调参数。
+ * 外部接口：GLib g_clear_pointer/g_byte_array_unref。
+ */
+void
+drd_frame_adopt_pixels(DrdFrame *self,
+                       GByteArray *pixels,
+                       DrdFrameReleaseFunc release,
+                       gpointer user_data)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    g_return_if_fail(pixels != NULL);
+    g_return_if_fail(self->external_data == NULL && self->release == NULL);
+
+    g_clear_pointer(&self->pixels, g_byte_array_unref);
+    self->pixels = pixels;
+    self->release = release;
+    self->release_data = user_data;
+}
+
+/*
+ * 功能：取走帧持有的像素缓冲。
+ * 逻辑：返回内部 GByteArray 并置空，调用方获得所有权；供回收器在释放回调中复用缓冲。
+ * 参数：self 帧实例。
+ * 外部接口：GLib g_steal_pointer。
+ */
+GByteArray *
+drd_frame_steal_pixels(DrdFrame *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME(self), NULL);
+    return g_steal_pointer(&self->pixels);
+}
+
+/*
+ * 功能：标记帧所属的显示器及其在桌面上的原点。
+ * 逻辑：类型检查后写入显示器索引与原点坐标。
+ * 参数：self 帧实例；index 显示器索引；origin_x/origin_y 显示器原点。
+ * 外部接口：无。
+ */
+void
+drd_frame_set_monitor(DrdFrame *self, guint index, gint origin_x, gint origin_y)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    self->monitor = index;
+    self->origin_x = origin_x;
+    self->origin_y = origin_y;
+}
+
+/*
+ * 功能：获取帧所属的显示器索引。
+ * 逻辑：类型检查后返回索引，未标记的帧为 0。
+ * 参数：self 帧实例。
+ * 外部接口：无。
+ */
+guint
+drd_frame_get_monitor(DrdFrame *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME(self), 0);
+    return self->monitor;
+}
+
+/*
+ * 功能：获取帧所属显示器在桌面上的原点。
+ * 逻辑：类型检查后写出原点坐标，参数可为 NULL。
+ * 参数：self 帧实例；origin_x/origin_y 输出原点。
+ * 外部接口：无。
+ */
+void
+drd_frame_get_origin(DrdFrame *self, gint *origin_x, gint *origin_y)
+{
+    g_return_if_fail(DRD_IS_FRAME(self));
+    if (origin_x != NULL)
+    {
+        *origin_x = self->origin_x;
+    }
+    if (origin_y != NULL)
+    {
+        *origin_y = self->origin_y;
+    }
 }
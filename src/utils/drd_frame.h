@@ -4,9 +4,22 @@
 
 G_BEGIN_DECLS
 
+typedef struct
+{
+    guint x;
+    guint y;
+    guint width;
+    guint height;
+} DrdFrameRect;
+
+/* 合并丢弃帧的损坏后矩形数超过该值时退化为外接矩形 */
+#define DRD_FRAME_MAX_DAMAGE_RECTS 256
+
 #define DRD_TYPE_FRAME (drd_frame_get_type())
 G_DECLARE_FINAL_TYPE(DrdFrame, drd_frame, DRD, FRAME, GObject)
 
+typedef void (*DrdFrameReleaseFunc)(DrdFrame *frame, gpointer user_data);
+
 DrdFrame *drd_frame_new(void);
 
 void drd_frame_configure(DrdFrame *self,
@@ -32,4 +45,77 @@ guint8 *drd_frame_ensure_capacity(DrdFrame *self, gsize size);
 
 const guint8 *drd_frame_get_data(DrdFrame *self, gsize *size);
 
+/**
+ * drd_frame_wrap_data:
+ * @self: the frame
+ * @data: externally owned pixel storage
+ * @size: byte size of @data
+ * @release: called once when the frame is disposed
+ * @user_data: data passed to @release
+ *
+ * Makes the frame reference @data instead of its own buffer. The owner must
+ * keep @data valid and unmodified until @release runs.
+ */
+void drd_frame_wrap_data(DrdFrame *self,
+                         const guint8 *data,
+                         gsize size,
+                         DrdFrameReleaseFunc release,
+                         gpointer user_data);
+
+/**
+ * drd_frame_adopt_pixels:
+ * @self: the frame
+ * @pixels: (transfer full): buffer to use as the frame storage
+ * @release: called once when the frame is disposed, before @pixels is freed
+ * @user_data: data passed to @release
+ *
+ * Lets a recycler hand a pre-sized buffer to the frame; @release may take it
+ * back with drd_frame_steal_pixels().
+ */
+void drd_frame_adopt_pixels(DrdFrame *self,
+                            GByteArray *pixels,
+                            DrdFrameReleaseFunc release,
+                            gpointer user_data);
+GByteArray *drd_frame_steal_pixels(DrdFrame *self);
+
+/**
+ * drd_frame_set_damage:
+ * @self: the frame
+ * @rects: damaged rectangles in frame coordinates
+ * @n_rects: number of rectangles
+ *
+ * Records which parts of the frame changed since the previous capture.
+ * A frame without damage information is treated as fully damaged.
+ */
+void drd_frame_set_damage(DrdFrame *self, const DrdFrameRect *rects, guint n_rects);
+void drd_frame_clear_damage(DrdFrame *self);
+
+/**
+ * drd_frame_merge_damage:
+ * @self: the frame that replaces @older
+ * @older: a frame that was dropped before anyone consumed it
+ *
+ * Adds the damage of @older to @self so that @self describes every change
+ * since the last consumed frame. If either frame is fully damaged, @self
+ * becomes fully damaged. Once more than %DRD_FRAME_MAX_DAMAGE_RECTS
+ * rectangles accumulate, they collapse to their bounding box.
+ */
+void drd_frame_merge_damage(DrdFrame *self, DrdFrame *older);
+gboolean drd_frame_has_damage(DrdFrame *self);
+const DrdFrameRect *drd_frame_get_damage(DrdFrame *self, guint *n_rects);
+
+/**
+ * drd_frame_set_monitor:
+ * @self: the frame
+ * @index: monitor index within the capture layout
+ * @origin_x: monitor origin on the desktop
+ * @origin_y: monitor origin on the desktop
+ *
+ * Tags a per-monitor frame. Frames from a single-stream capture stay on
+ * monitor 0 at the desktop origin.
+ */
+void drd_frame_set_monitor(DrdFrame *self, guint index, gint origin_x, gint origin_y);
+guint drd_frame_get_monitor(DrdFrame *self);
+void drd_frame_get_origin(DrdFrame *self, gint *origin_x, gint *origin_y);
+
 G_END_DECLS
@@ -0,0 +1,243 @@
+#include "utils/drd_frame_pool.h"
+
+struct _DrdFramePool
+{
+    GObject parent_instance;
+
+    GMutex mutex;
+    GHashTable *buckets;
+    guint max_free;
+    guint64 hits;
+    guint64 misses;
+};
+
+G_DEFINE_TYPE(DrdFramePool, drd_frame_pool, G_TYPE_OBJECT)
+
+/*
+ * 功能：把帧几何打包为哈希键。
+ * 逻辑：宽高各占 16 位、stride 占低 32 位，RDP 桌面尺寸不超过 16 位范围。
+ * 参数：width/height/stride 帧几何。
+ * 外部接口：无。
+ */
+static guint64
+drd_frame_pool_make_key(guint width, guint height, guint stride)
+{
+    return ((guint64) (width & 0xFFFF) << 48) | ((guint64) (height & 0xFFFF) << 32) | (guint64) stride;
+}
+
+/*
+ * 功能：释放某一几何下缓存的全部缓冲。
+ * 逻辑：作为哈希表 value 析构函数，逐个 unref 后释放指针数组。
+ * 参数：data GPtrArray 指针。
+ * 外部接口：GLib g_ptr_array_unref（元素析构为 g_byte_array_unref）。
+ */
+static void
+drd_frame_pool_bucket_free(gpointer data)
+{
+    g_ptr_array_unref((GPtrArray *) data);
+}
+
+/*
+ * 功能：释放缓冲池持有的缓冲与锁。
+ * 逻辑：销毁哈希表（连带所有空闲缓冲），清理互斥锁后交由父类 finalize。
+ * 参数：object 基类指针，期望为 DrdFramePool。
+ * 外部接口：GLib g_hash_table_destroy/g_mutex_clear。
+ */
+static void
+drd_frame_pool_finalize(GObject *object)
+{
+    DrdFramePool *self = DRD_FRAME_POOL(object);
+
+    g_clear_pointer(&self->buckets, g_hash_table_destroy);
+    g_mutex_clear(&self->mutex);
+    G_OBJECT_CLASS(drd_frame_pool_parent_class)->finalize(object);
+}
+
+/*
+ * 功能：绑定类级别析构回调。
+ * 逻辑：将自定义 finalize 挂载到 GObjectClass。
+ * 参数：klass 类结构。
+ * 外部接口：GLib 类型系统。
+ */
+static void
+drd_frame_pool_class_init(DrdFramePoolClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->finalize = drd_frame_pool_finalize;
+}
+
+/*
+ * 功能：初始化缓冲池。
+ * 逻辑：初始化互斥锁，创建以几何为键的空闲缓冲哈希表。
+ * 参数：self 缓冲池实例。
+ * 外部接口：GLib g_mutex_init/g_hash_table_new_full。
+ */
+static void
+drd_frame_pool_init(DrdFramePool *self)
+{
+    g_mutex_init(&self->mutex);
+    self->buckets = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, drd_frame_pool_bucket_free);
+    self->max_free = DRD_FRAME_POOL_DEFAULT_MAX_FREE;
+}
+
+/*
+ * 功能：创建帧缓冲池。
+ * 逻辑：记录每种几何最多保留的空闲缓冲数量，0 使用默认值。
+ * 参数：max_free 每种几何保留的空闲缓冲上限。
+ * 外部接口：GLib g_object_new。
+ */
+DrdFramePool *
+drd_frame_pool_new(guint max_free)
+{
+    DrdFramePool *self = g_object_new(DRD_TYPE_FRAME_POOL, NULL);
+    if (max_free > 0)
+    {
+        self->max_free = max_free;
+    }
+    return self;
+}
+
+/*
+ * 功能：获取几何对应的空闲缓冲桶（需持锁调用）。
+ * 逻辑：查表命中直接返回；否则按需创建空桶并插入。
+ * 参数：self 缓冲池；key 几何键；create 未命中时是否创建。
+ * 外部接口：GLib g_hash_table_lookup/g_hash_table_insert/g_ptr_array_new_with_free_func。
+ */
+static GPtrArray *
+drd_frame_pool_lookup_bucket_locked(DrdFramePool *self, guint64 key, gboolean create)
+{
+    const gint64 lookup_key = (gint64) key;
+    GPtrArray *bucket = g_hash_table_lookup(self->buckets, &lookup_key);
+    if (bucket == NULL && create)
+    {
+        gint64 *stored_key = g_new(gint64, 1);
+        *stored_key = (gint64) key;
+        bucket = g_ptr_array_new_with_free_func((GDestroyNotify) g_byte_array_unref);
+        g_hash_table_insert(self->buckets, stored_key, bucket);
+    }
+    return bucket;
+}
+
+/*
+ * 功能：帧销毁时回收其像素缓冲。
+ * 逻辑：从帧取走缓冲；持锁放回对应几何的桶，桶已满或已被 trim 时直接释放；最后释放帧持有的池引用。
+ * 参数：frame 被销毁的帧；user_data 缓冲池。
+ * 外部接口：drd_frame_steal_pixels/drd_frame_get_*；GLib g_ptr_array_add/g_byte_array_unref/g_object_unref。
+ */
+static void
+drd_frame_pool_release_frame(DrdFrame *frame, gpointer user_data)
+{
+    DrdFramePool *self = DRD_FRAME_POOL(user_data);
+    GByteArray *pixels = drd_frame_steal_pixels(frame);
+    const guint64 key = drd_frame_pool_make_key(drd_frame_get_width(frame), drd_frame_get_height(frame),
+                                                drd_frame_get_stride(frame));
+
+    if (pixels != NULL)
+    {
+        g_mutex_lock(&self->mutex);
+        GPtrArray *bucket = drd_frame_pool_lookup_bucket_locked(self, key, FALSE);
+        if (bucket != NULL && bucket->len < self->max_free)
+        {
+            g_ptr_array_add(bucket, pixels);
+            pixels = NULL;
+        }
+        g_mutex_unlock(&self->mutex);
+    }
+
+    if (pixels != NULL)
+    {
+        g_byte_array_unref(pixels);
+    }
+    g_object_unref(self);
+}
+
+/*
+ * 功能：从池中取出预分配缓冲并构造帧。
+ * 逻辑：持锁查找同几何的空闲缓冲，命中计 hit 并复用，未命中计 miss 并分配；帧接管缓冲并持有池引用，销毁时缓冲回到池中。
+ * 参数：self 缓冲池；width/height/stride 帧几何；timestamp 时间戳。
+ * 外部接口：drd_frame_new/drd_frame_configure/drd_frame_adopt_pixels；GLib g_ptr_array_steal_index_fast/g_byte_array_sized_new。
+ */
+DrdFrame *
+drd_frame_pool_acquire(DrdFramePool *self, guint width, guint height, guint stride, guint64 timestamp)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_POOL(self), NULL);
+    g_return_val_if_fail(stride > 0 && height > 0, NULL);
+
+    const guint64 key = drd_frame_pool_make_key(width, height, stride);
+    const gsize size = (gsize) stride * (gsize) height;
+    GByteArray *pixels = NULL;
+
+    g_mutex_lock(&self->mutex);
+    GPtrArray *bucket = drd_frame_pool_lookup_bucket_locked(self, key, TRUE);
+    if (bucket->len > 0)
+    {
+        pixels = g_ptr_array_steal_index_fast(bucket, bucket->len - 1);
+        self->hits++;
+    }
+    else
+    {
+        self->misses++;
+    }
+    g_mutex_unlock(&self->mutex);
+
+    if (pixels == NULL)
+    {
+        pixels = g_byte_array_sized_new((guint) size);
+        g_byte_array_set_size(pixels, (guint) size);
+    }
+
+    DrdFrame *frame = drd_frame_new();
+    drd_frame_configure(frame, width, height, stride, timestamp);
+    drd_frame_adopt_pixels(frame, pixels, drd_frame_pool_release_frame, g_object_ref(self));
+    return frame;
+}
+
+/*
+ * 功能：丢弃池中所有空闲缓冲。
+ * 逻辑：持锁清空哈希表；仍被帧持有的缓冲在归还时因找不到桶而直接释放。
+ * 参数：self 缓冲池。
+ * 外部接口：GLib g_hash_table_remove_all。
+ */
+void
+drd_frame_pool_trim(DrdFramePool *self)
+{
+    g_return_if_fail(DRD_IS_FRAME_POOL(self));
+
+    g_mutex_lock(&self->mutex);
+    g_hash_table_remove_all(self->buckets);
+    g_mutex_unlock(&self->mutex);
+}
+
+/*
+ * 功能：获取缓冲复用命中次数。
+ * 逻辑：持锁读取累计 hit。
+ * 参数：self 缓冲池。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+guint64
+drd_frame_pool_get_hits(DrdFramePool *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_POOL(self), 0);
+
+    g_mutex_lock(&self->mutex);
+    const guint64 hits = self->hits;
+    g_mutex_unlock(&self->mutex);
+    return hits;
+}
+
+/*
+ * 功能：获取缓冲分配未命中次数。
+ * 逻辑：持锁读取累计 miss。
+ * 参数：self 缓冲池。
+ * 外部接口：GLib g_mutex_lock/unlock。
+ */
+guint64
+drd_frame_pool_get_misses(DrdFramePool *self)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_POOL(self), 0);
+
+    g_mutex_lock(&self->mutex);
+    const guint64 misses = self->misses;
+    g_mutex_unlock(&self->mutex);
+    return misses;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glib-object.h>
+
+#include "utils/drd_frame.h"
+
+#define DRD_FRAME_POOL_DEFAULT_MAX_FREE 4
+
+G_BEGIN_DECLS
+
+#define DRD_TYPE_FRAME_POOL (drd_frame_pool_get_type())
+G_DECLARE_FINAL_TYPE(DrdFramePool, drd_frame_pool, DRD, FRAME_POOL, GObject)
+
+DrdFramePool *drd_frame_pool_new(guint max_free);
+
+/**
+ * drd_frame_pool_acquire:
+ * @self: the pool
+ * @width: frame width in pixels
+ * @height: frame height in pixels
+ * @stride: bytes per row
+ * @timestamp: frame timestamp
+ *
+ * Returns a configured frame whose buffer holds exactly stride * height
+ * bytes. The buffer is recycled into the pool when the frame is finalized.
+ */
+DrdFrame *drd_frame_pool_acquire(DrdFramePool *self,
+                                 guint width,
+                                 guint height,
+                                 guint stride,
+                                 guint64 timestamp);
+
+void drd_frame_pool_trim(DrdFramePool *self);
+guint64 drd_frame_pool_get_hits(DrdFramePool *self);
+guint64 drd_frame_pool_get_misses(DrdFramePool *self);
+
+G_END_DECLS
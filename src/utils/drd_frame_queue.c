@@ -1,55 +1,131 @@
 #include "utils/drd_frame_queue.h"
 
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils/drd_log.h"
+
+/* 消费者服务耗时 EWMA 的权重为 1/8 */
+#define DRD_FRAME_QUEUE_SERVICE_EWMA_SHIFT 3
+/* 单次耗时超过该值视为会话停顿（重连、激活等），不计入服务耗时 */
+#define DRD_FRAME_QUEUE_SERVICE_MAX_US G_USEC_PER_SEC
+/* 超过该时长没有客户端输入时放宽采集间隔 */
+#define DRD_FRAME_QUEUE_IDLE_BACKOFF_US (2 * G_USEC_PER_SEC)
+/* 空闲放宽后的采集间隔为目标间隔的倍数 */
+#define DRD_FRAME_QUEUE_IDLE_BACKOFF_FACTOR 2
+
 struct _DrdFrameQueue
 {
     GObject parent_instance;
 
-    GMutex mutex;
-    GCond cond;
-    DrdFrame *frames[DRD_FRAME_QUEUE_MAX_FRAMES];
-    guint head;
-    guint tail;
-    guint size;
-    gboolean running;
-    guint64 dropped_frames;
+    /*
+     * 每个显示器一个最新帧信箱：生产者用原子交换放入新帧并取回被覆盖的旧帧，消费者用原子交换取走帧，
+     * 交接路径不加锁；消费者无帧可取时阻塞在 eventfd 上，生产者只在消费者声明等待时写 eventfd。
+     */
+    DrdFrame *slots[DRD_FRAME_QUEUE_MAX_MONITORS];
+    guint next_slot; /* 消费者下一次优先检查的信箱，多显示器时轮转 */
+    gint running;
+    gint consumer_waiting;
+    gint dropped_frames;
+    int wakeup_fd;
+
+    GMutex pacing_mutex; /* 仅保护节奏反馈统计，交接路径不使用 */
+    gint64 consumer_busy_since; /* 最近一次取帧时刻，消费者再次等待时据此计算服务耗时 */
+    gint64 service_interval_us; /* 消费者服务耗时 EWMA：编码、发送与等待图形管线容量 */
+    gint64 last_input_us;
 };
 
 G_DEFINE_TYPE(DrdFrameQueue, drd_frame_queue, G_TYPE_OBJECT)
 
+/*
+ * 功能：原子地替换信箱中的帧指针并返回旧值。
+ * 逻辑：CAS 循环实现交换（GLib 2.74 之前没有 g_atomic_pointer_exchange），信箱只有一个生产者与一个消费者，循环很少重试。
+ * 参数：slot 信箱地址；frame 新值（可为 NULL）。
+ * 外部接口：GLib g_atomic_pointer_get/g_atomic_pointer_compare_and_exchange。
+ */
+static DrdFrame *
+drd_frame_queue_exchange(DrdFrame **slot, DrdFrame *frame)
+{
+    while (TRUE)
+    {
+        DrdFrame *current = g_atomic_pointer_get(slot);
+        if (g_atomic_pointer_compare_and_exchange(slot, current, frame))
+        {
+            return current;
+        }
+    }
+}
+
+/*
+ * 功能：清空全部信箱。
+ * 逻辑：逐个原子交换为 NULL 并释放取出的帧引用。
+ * 参数：self 队列实例。
+ * 外部接口：drd_frame_queue_exchange；GLib g_object_unref。
+ */
+static void
+drd_frame_queue_clear_slots(DrdFrameQueue *self)
+{
+    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_MONITORS; ++i)
+    {
+        DrdFrame *frame = drd_frame_queue_exchange(&self->slots[i], NULL);
+        if (frame != NULL)
+        {
+            g_object_unref(frame);
+        }
+    }
+}
+
+/*
+ * 功能：唤醒阻塞在 eventfd 上的消费者。
+ * 逻辑：向 eventfd 计数加 1；计数溢出（EAGAIN）时已有未消费的唤醒，忽略即可。
+ * 参数：self 队列实例。
+ * 外部接口：POSIX write。
+ */
+static void
+drd_frame_queue_signal(DrdFrameQueue *self)
+{
+    const guint64 one = 1;
+    if (self->wakeup_fd >= 0 && write(self->wakeup_fd, &one, sizeof(one)) < 0)
+    {
+        (void) one;
+    }
+}
+
 /*
  * 功能：释放帧队列中的帧对象。
- * 逻辑：持锁清理环形缓冲的帧引用并重置计数，随后交由父类 dispose。
+ * 逻辑：清空全部信箱，随后交由父类 dispose。
  * 参数：object 基类指针，期望为 DrdFrameQueue。
- * 外部接口：GLib g_clear_object；互斥锁保护。
+ * 外部接口：drd_frame_queue_clear_slots。
  */
 static void
 drd_frame_queue_dispose(GObject *object)
 {
     DrdFrameQueue *self = DRD_FRAME_QUEUE(object);
 
-    g_mutex_lock(&self->mutex);
-    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_FRAMES; ++i)
-    {
-        g_clear_object(&self->frames[i]);
-    }
-    self->size = 0;
-    g_mutex_unlock(&self->mutex);
+    drd_frame_queue_clear_slots(self);
 
     G_OBJECT_CLASS(drd_frame_queue_parent_class)->dispose(object);
 }
 
 /*
- * 功能：释放互斥量与条件变量。
- * 逻辑：清理锁与条件后交由父类 finalize。
+ * 功能：释放 eventfd 与统计锁。
+ * 逻辑：关闭 eventfd、清理互斥锁后交由父类 finalize。
  * 参数：object 基类指针。
- * 外部接口：GLib g_mutex_clear/g_cond_clear。
+ * 外部接口：POSIX close；GLib g_mutex_clear。
  */
 static void
 drd_frame_queue_finalize(GObject *object)
 {
     DrdFrameQueue *self = DRD_FRAME_QUEUE(object);
-    g_mutex_clear(&self->mutex);
-    g_cond_clear(&self->cond);
+    if (self->wakeup_fd >= 0)
+    {
+        close(self->wakeup_fd);
+        self->wakeup_fd = -1;
+    }
+    g_mutex_clear(&self->pacing_mutex);
     G_OBJECT_CLASS(drd_frame_queue_parent_class)->finalize(object);
 }
 
@@ -68,25 +144,32 @@ drd_frame_queue_class_init(DrdFrameQueueClass *klass)
 }
 
 /*
- * 功能：初始化帧队列的锁、条件和缓冲。
- * 逻辑：初始化互斥锁/条件变量，清空环形缓冲并设置运行标志与计数。
+ * 功能：初始化帧队列的信箱、eventfd 与统计。
+ * 逻辑：清空信箱，创建非阻塞 eventfd（失败时消费者退化为短周期轮询），设置运行标志与计数。
  * 参数：self 队列实例。
- * 外部接口：GLib g_mutex_init/g_cond_init。
+ * 外部接口：Linux eventfd；GLib g_mutex_init；日志 DRD_LOG_WARNING。
  */
 static void
 drd_frame_queue_init(DrdFrameQueue *self)
 {
-    g_mutex_init(&self->mutex);
-    g_cond_init(&self->cond);
-    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_FRAMES; ++i)
+    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_MONITORS; ++i)
     {
-        self->frames[i] = NULL;
+        self->slots[i] = NULL;
     }
-    self->head = 0;
-    self->tail = 0;
-    self->size = 0;
+    self->next_slot = 0;
     self->running = TRUE;
+    self->consumer_waiting = FALSE;
     self->dropped_frames = 0;
+    self->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (self->wakeup_fd < 0)
+    {
+        DRD_LOG_WARNING("Frame queue eventfd unavailable (%s), falling back to polling", g_strerror(errno));
+    }
+
+    g_mutex_init(&self->pacing_mutex);
+    self->consumer_busy_since = 0;
+    self->service_interval_us = 0;
+    self->last_input_us = g_get_monotonic_time();
 }
 
 /*
@@ -102,36 +185,43 @@ drd_frame_queue_new(void)
 }
 
 /*
- * 功能：重置队列状态并清空缓冲。
- * 逻辑：持锁恢复 running，清理所有帧引用，重置头尾指针与统计，并广播条件唤醒等待线程。
+ * 功能：重置队列状态并清空信箱。
+ * 逻辑：恢复 running，清空全部信箱与 eventfd 残留计数，重置丢帧统计与节奏反馈（视为刚有输入，新会话以目标帧率起步）。
  * 参数：self 队列实例。
- * 外部接口：GLib g_clear_object；互斥锁保护。
+ * 外部接口：drd_frame_queue_clear_slots；POSIX read；GLib 原子操作与互斥锁。
  */
 void
 drd_frame_queue_reset(DrdFrameQueue *self)
 {
     g_return_if_fail(DRD_IS_FRAME_QUEUE(self));
 
-    g_mutex_lock(&self->mutex);
-    self->running = TRUE;
-    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_FRAMES; ++i)
+    drd_frame_queue_clear_slots(self);
+    if (self->wakeup_fd >= 0)
     {
-        g_clear_object(&self->frames[i]);
-        self->frames[i] = NULL;
+        guint64 count = 0;
+        if (read(self->wakeup_fd, &count, sizeof(count)) < 0)
+        {
+            (void) count;
+        }
     }
-    self->head = 0;
-    self->tail = 0;
-    self->size = 0;
-    self->dropped_frames = 0;
-    g_cond_broadcast(&self->cond);
-    g_mutex_unlock(&self->mutex);
+    self->next_slot = 0;
+    g_atomic_int_set(&self->dropped_frames, 0);
+    g_atomic_int_set(&self->running, TRUE);
+
+    g_mutex_lock(&self->pacing_mutex);
+    self->consumer_busy_since = 0;
+    self->service_interval_us = 0;
+    self->last_input_us = g_get_monotonic_time();
+    g_mutex_unlock(&self->pacing_mutex);
 }
 
 /*
- * 功能：向队列推入一帧，满容量时丢弃最旧帧。
- * 逻辑：持锁检查运行状态；满队列时移除头部帧并累加丢弃计数；将新帧写入尾部并广播条件。
- * 参数：self 队列实例；frame 待推入帧。
- * 外部接口：GLib g_clear_object/g_cond_broadcast；互斥锁保护。
+ * 功能：把一帧放入所属显示器的信箱，覆盖未被取走的旧帧。
+ * 逻辑：按帧的显示器编号选择信箱（编号超出信箱数量属于调用方错误，直接拒绝而不与其他显示器的信箱合并），先原子取出尚未被消费的旧帧（取得其所有权后才能安全读取），把旧帧损坏并入新帧、累加丢帧计数并释放，
+ *       再原子放入新帧引用，消费者取到的帧因此总是携带自上次取帧以来的全部损坏；
+ *       放入后检查消费者是否声明等待，是则写 eventfd 唤醒（与消费者的“声明等待后复查信箱”配对，不会丢失唤醒）。
+ * 参数：self 队列实例；frame 待推入帧，入队后生产者不得再修改。
+ * 外部接口：drd_frame_queue_exchange/signal；drd_frame_merge_damage；GLib g_atomic_int_*。
  */
 void
 drd_frame_queue_push(DrdFrameQueue *self, DrdFrame *frame)
@@ -139,34 +229,95 @@ drd_frame_queue_push(DrdFrameQueue *self, DrdFrame *frame)
     g_return_if_fail(DRD_IS_FRAME_QUEUE(self));
     g_return_if_fail(DRD_IS_FRAME(frame));
 
-    g_mutex_lock(&self->mutex);
-    if (!self->running)
+    if (!g_atomic_int_get(&self->running))
     {
-        g_mutex_unlock(&self->mutex);
         return;
     }
 
-    if (self->size == DRD_FRAME_QUEUE_MAX_FRAMES)
+    const guint slot = drd_frame_get_monitor(frame);
+    g_return_if_fail(slot < DRD_FRAME_QUEUE_MAX_MONITORS);
+
+    DrdFrame *replaced = drd_frame_queue_exchange(&self->slots[slot], NULL);
+    if (replaced != NULL)
+    {
+        drd_frame_merge_damage(frame, replaced);
+        g_atomic_int_inc(&self->dropped_frames);
+        g_object_unref(replaced);
+    }
+    /* 每个信箱只有一个生产者，消费者只会把信箱置空，此处必然换出 NULL */
+    drd_frame_queue_exchange(&self->slots[slot], g_object_ref(frame));
+
+    if (g_atomic_int_get(&self->consumer_waiting))
+    {
+        drd_frame_queue_signal(self);
+    }
+}
+
+/*
+ * 功能：从信箱中取出一帧。
+ * 逻辑：从轮转起点依次原子交换各信箱，取到帧后把轮转起点移到下一个信箱，使多显示器帧交替交付。
+ * 参数：self 队列实例。
+ * 外部接口：drd_frame_queue_exchange；GLib g_atomic_pointer_get。
+ */
+static DrdFrame *
+drd_frame_queue_take(DrdFrameQueue *self)
+{
+    for (guint i = 0; i < DRD_FRAME_QUEUE_MAX_MONITORS; ++i)
+    {
+        const guint slot = (self->next_slot + i) % DRD_FRAME_QUEUE_MAX_MONITORS;
+        if (g_atomic_pointer_get(&self->slots[slot]) == NULL)
+        {
+            continue;
+        }
+
+        DrdFrame *frame = drd_frame_queue_exchange(&self->slots[slot], NULL);
+        if (frame != NULL)
+        {
+            self->next_slot = (slot + 1) % DRD_FRAME_QUEUE_MAX_MONITORS;
+            return frame;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 功能：阻塞等待 eventfd 唤醒或超时。
+ * 逻辑：ppoll 以微秒精度等待 eventfd 可读后读掉计数；eventfd 不可用时按 1 ms 轮询。
+ * 参数：self 队列实例；timeout_us 最长等待时间（<0 为无限等待）。
+ * 外部接口：Linux ppoll；POSIX read；GLib g_usleep。
+ */
+static void
+drd_frame_queue_block(DrdFrameQueue *self, gint64 timeout_us)
+{
+    if (self->wakeup_fd < 0)
     {
-        g_clear_object(&self->frames[self->head]);
-        self->frames[self->head] = NULL;
-        self->head = (self->head + 1) % DRD_FRAME_QUEUE_MAX_FRAMES;
-        self->size--;
-        self->dropped_frames++;
+        g_usleep(timeout_us >= 0 ? MIN(timeout_us, 1000) : 1000);
+        return;
     }
 
-    self->frames[self->tail] = g_object_ref(frame);
-    self->tail = (self->tail + 1) % DRD_FRAME_QUEUE_MAX_FRAMES;
-    self->size++;
-    g_cond_broadcast(&self->cond);
-    g_mutex_unlock(&self->mutex);
+    struct pollfd pfd = {self->wakeup_fd, POLLIN, 0};
+    struct timespec timeout = {0};
+    if (timeout_us >= 0)
+    {
+        timeout.tv_sec = timeout_us / G_USEC_PER_SEC;
+        timeout.tv_nsec = (timeout_us % G_USEC_PER_SEC) * 1000;
+    }
+    if (ppoll(&pfd, 1, timeout_us >= 0 ? &timeout : NULL, NULL) > 0)
+    {
+        guint64 count = 0;
+        if (read(self->wakeup_fd, &count, sizeof(count)) < 0)
+        {
+            (void) count;
+        }
+    }
 }
 
 /*
- * 功能：阻塞等待一帧输出，可选超时。
- * 逻辑：持锁检查运行状态；根据超时策略等待条件；取出头部帧返回并缩减大小。
+ * 功能：等待一帧输出，可选超时。
+ * 逻辑：若上次调用取到了帧，把取帧至本次进入的间隔计为一次消费者服务耗时并更新 EWMA；
+ *       先无锁尝试取帧，取不到时声明等待、复查信箱后阻塞在 eventfd 上，直到取到帧、超时或队列停止；取到帧时直接转交其引用并记录取帧时刻。
  * 参数：self 队列实例；timeout_us 超时时间（微秒，0 为立即返回，<0 为无限等待）；out_frame 输出帧。
- * 外部接口：GLib g_cond_wait/g_cond_wait_until/g_get_monotonic_time；互斥锁保护。
+ * 外部接口：drd_frame_queue_take/block；GLib g_get_monotonic_time/g_atomic_int_*；统计互斥锁。
  */
 gboolean
 drd_frame_queue_wait(DrdFrameQueue *self, gint64 timeout_us, DrdFrame **out_frame)
@@ -174,94 +325,156 @@ drd_frame_queue_wait(DrdFrameQueue *self, gint64 timeout_us, DrdFrame **out_fram
     g_return_val_if_fail(DRD_IS_FRAME_QUEUE(self), FALSE);
     g_return_val_if_fail(out_frame != NULL, FALSE);
 
-    gboolean result = FALSE;
-
-    g_mutex_lock(&self->mutex);
-    if (!self->running)
+    if (!g_atomic_int_get(&self->running))
     {
-        g_mutex_unlock(&self->mutex);
         return FALSE;
     }
 
-    gint64 deadline = 0;
-    if (timeout_us > 0)
-    {
-        deadline = g_get_monotonic_time() + timeout_us;
-    }
-
-    while (self->running && self->size == 0)
+    const gint64 now = g_get_monotonic_time();
+    if (self->consumer_busy_since > 0)
     {
-        if (timeout_us == 0)
+        const gint64 busy = now - self->consumer_busy_since;
+        if (busy < DRD_FRAME_QUEUE_SERVICE_MAX_US)
         {
-            g_mutex_unlock(&self->mutex);
-            return FALSE;
+            g_mutex_lock(&self->pacing_mutex);
+            self->service_interval_us = self->service_interval_us == 0
+                                                ? busy
+                                                : self->service_interval_us +
+                                                          ((busy - self->service_interval_us) >> DRD_FRAME_QUEUE_SERVICE_EWMA_SHIFT);
+            g_mutex_unlock(&self->pacing_mutex);
         }
+        self->consumer_busy_since = 0;
+    }
 
+    const gint64 deadline = timeout_us > 0 ? now + timeout_us : 0;
+    DrdFrame *frame = drd_frame_queue_take(self);
+    while (frame == NULL && timeout_us != 0 && g_atomic_int_get(&self->running))
+    {
+        gint64 remaining = -1;
         if (timeout_us > 0)
         {
-            if (!g_cond_wait_until(&self->cond, &self->mutex, deadline))
+            remaining = deadline - g_get_monotonic_time();
+            if (remaining <= 0)
             {
                 break;
             }
         }
-        else
+
+        g_atomic_int_set(&self->consumer_waiting, TRUE);
+        frame = drd_frame_queue_take(self);
+        if (frame == NULL && g_atomic_int_get(&self->running))
         {
-            g_cond_wait(&self->cond, &self->mutex);
+            drd_frame_queue_block(self, remaining);
+            frame = drd_frame_queue_take(self);
         }
+        g_atomic_int_set(&self->consumer_waiting, FALSE);
     }
 
-    if (self->running && self->size > 0)
+    if (frame == NULL)
     {
-        DrdFrame *frame = self->frames[self->head];
-        self->frames[self->head] = NULL;
-        self->head = (self->head + 1) % DRD_FRAME_QUEUE_MAX_FRAMES;
-        self->size--;
-        if (frame != NULL)
-        {
-            *out_frame = g_object_ref(frame);
-            g_clear_object(&frame);
-        }
-        else
-        {
-            *out_frame = NULL;
-        }
-        result = TRUE;
+        return FALSE;
+    }
+    if (!g_atomic_int_get(&self->running))
+    {
+        g_object_unref(frame);
+        return FALSE;
     }
 
-    g_mutex_unlock(&self->mutex);
-    return result;
+    self->consumer_busy_since = g_get_monotonic_time();
+    *out_frame = frame;
+    return TRUE;
 }
 
 /*
- * 功能：停止队列，唤醒所有等待者。
- * 逻辑：持锁将 running 置 FALSE 并广播条件。
+ * 功能：停止队列，唤醒等待者。
+ * 逻辑：清除 running 后写 eventfd，阻塞中的消费者立即返回。
  * 参数：self 队列实例。
- * 外部接口：GLib g_cond_broadcast；互斥锁保护。
+ * 外部接口：GLib g_atomic_int_set；drd_frame_queue_signal。
  */
 void
 drd_frame_queue_stop(DrdFrameQueue *self)
 {
     g_return_if_fail(DRD_IS_FRAME_QUEUE(self));
 
-    g_mutex_lock(&self->mutex);
-    self->running = FALSE;
-    g_cond_broadcast(&self->cond);
-    g_mutex_unlock(&self->mutex);
+    g_atomic_int_set(&self->running, FALSE);
+    drd_frame_queue_signal(self);
 }
 
 /*
  * 功能：获取队列累计丢帧数。
- * 逻辑：持锁读取 dropped_frames 并返回。
+ * 逻辑：原子读取被新帧覆盖的帧数。
  * 参数：self 队列实例。
- * 外部接口：互斥锁保护。
+ * 外部接口：GLib g_atomic_int_get。
  */
 guint64
 drd_frame_queue_get_dropped_frames(DrdFrameQueue *self)
 {
     g_return_val_if_fail(DRD_IS_FRAME_QUEUE(self), 0);
 
-    g_mutex_lock(&self->mutex);
-    guint64 dropped = self->dropped_frames;
-    g_mutex_unlock(&self->mutex);
-    return dropped;
+    return (guint64) (guint) g_atomic_int_get(&self->dropped_frames);
+}
+
+/*
+ * 功能：判断本轮采集推入的帧是否会覆盖未消费的帧。
+ * 逻辑：本轮帧会依次放入 0..n_frames-1 号信箱，其中任一信箱仍有未取走的帧时生产者应保留损坏稍后重试，使丢帧计数保持为 0。
+ * 参数：self 队列实例；n_frames 本轮将推入的帧数（多显示器时为输出数）。
+ * 外部接口：GLib g_atomic_pointer_get。
+ */
+gboolean
+drd_frame_queue_can_accept(DrdFrameQueue *self, guint n_frames)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_QUEUE(self), TRUE);
+
+    const guint n_slots = MIN(MAX(n_frames, 1), DRD_FRAME_QUEUE_MAX_MONITORS);
+    for (guint i = 0; i < n_slots; ++i)
+    {
+        if (g_atomic_pointer_get(&self->slots[i]) != NULL)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * 功能：根据下游反馈计算采集间隔。
+ * 逻辑：以目标间隔为下限，跟随每轮帧数乘以消费者单帧服务耗时 EWMA（编码与图形管线确认跟不上时降低采集速率）；
+ *       超过空闲阈值没有客户端输入时再放宽到目标间隔的固定倍数，输入到来后立即恢复。
+ * 参数：self 队列实例；target_interval_us 配置的采集间隔；n_frames 每轮采集推入的帧数。
+ * 外部接口：GLib g_get_monotonic_time；统计互斥锁保护。
+ */
+gint64
+drd_frame_queue_get_pacing_interval_us(DrdFrameQueue *self,
+                                       gint64 target_interval_us,
+                                       guint n_frames)
+{
+    g_return_val_if_fail(DRD_IS_FRAME_QUEUE(self), target_interval_us);
+
+    g_mutex_lock(&self->pacing_mutex);
+    const gint64 service = self->service_interval_us;
+    const gint64 last_input = self->last_input_us;
+    g_mutex_unlock(&self->pacing_mutex);
+
+    gint64 interval = MAX(target_interval_us, service * (gint64) MAX(n_frames, 1));
+    if (g_get_monotonic_time() - last_input > DRD_FRAME_QUEUE_IDLE_BACKOFF_US)
+    {
+        interval = MAX(interval, target_interval_us * DRD_FRAME_QUEUE_IDLE_BACKOFF_FACTOR);
+    }
+    return interval;
+}
+
+/*
+ * 功能：记录客户端输入活动。
+ * 逻辑：持锁刷新最近输入时刻，使采集间隔立即退出空闲放宽。
+ * 参数：self 队列实例。
+ * 外部接口：GLib g_get_monotonic_time；统计互斥锁保护。
+ */
+void
+drd_frame_queue_note_input_activity(DrdFrameQueue *self)
+{
+    g_return_if_fail(DRD_IS_FRAME_QUEUE(self));
+
+    g_mutex_lock(&self->pacing_mutex);
+    self->last_input_us = g_get_monotonic_time();
+    g_mutex_unlock(&self->pacing_mutex);
 }
@@ -4,7 +4,11 @@
 
 #include "utils/drd_frame.h"
 
-#define DRD_FRAME_QUEUE_MAX_FRAMES 3
+/*
+ * 每个显示器一个最新帧信箱，信箱数量即可同时交付的显示器流上限，取 Rdpgfx ResetGraphics 可描述的显示器数上限；
+ * 每个信箱只保留最新一帧，不是队列深度
+ */
+#define DRD_FRAME_QUEUE_MAX_MONITORS 16
 
 G_BEGIN_DECLS
 
@@ -21,4 +25,29 @@ gboolean drd_frame_queue_wait(DrdFrameQueue *self,
 void drd_frame_queue_stop(DrdFrameQueue *self);
 guint64 drd_frame_queue_get_dropped_frames(DrdFrameQueue *self);
 
+/**
+ * drd_frame_queue_can_accept:
+ * @self: the queue
+ * @n_frames: frames the producer is about to push in one capture cycle
+ *
+ * Returns: %TRUE when pushing @n_frames would not drop a pending frame. A
+ * producer that gets %FALSE should keep its damage and retry shortly.
+ */
+gboolean drd_frame_queue_can_accept(DrdFrameQueue *self, guint n_frames);
+
+/**
+ * drd_frame_queue_get_pacing_interval_us:
+ * @self: the queue
+ * @target_interval_us: configured capture interval
+ * @n_frames: frames the producer pushes per capture cycle
+ *
+ * Returns: the capture interval the producer should use, following the
+ * consumer's measured per-frame service time, widened while no input arrived for a
+ * while and reset to @target_interval_us on input activity.
+ */
+gint64 drd_frame_queue_get_pacing_interval_us(DrdFrameQueue *self,
+                                              gint64 target_interval_us,
+                                              guint n_frames);
+void drd_frame_queue_note_input_activity(DrdFrameQueue *self);
+
 G_END_DECLS